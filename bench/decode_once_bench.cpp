@@ -0,0 +1,247 @@
+/**
+ * decode_once_bench.cpp
+ *
+ * Benchmark of the decompression data path of decompressParquetFile, before
+ * and after every chunk was decoded only once. Both paths are replayed on the
+ * same .lzma chunk files with the codec calls they make:
+ *
+ *   two-pass: the pipeline reads a chunk and decodes it with
+ *             lzma_decompress_buffer to verify it, then the writer decodes the
+ *             file again with lzma_decompress_file into a temporary file and
+ *             reads that back;
+ *   one-pass: the pipeline reads a chunk and decodes it once with
+ *             lzma_decompress_alloc, and the buffer goes to the writer.
+ *
+ * The parquet writer itself is the same in both and is left out. Without an
+ * argument, synthetic chunks (sorted ids, prices, repetitive text) are
+ * compressed at the default level into a temporary directory; given a
+ * directory, every .lzma file in it is used, e.g. the chunks of an archive
+ * written by "infparquet compress".
+ *
+ * Usage: infparquet_decode_once_bench [chunk_directory]
+ */
+
+#include "compression/lzma_compressor.h"
+#include "compression/lzma_decompressor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Synthetic chunks: row groups x columns of this many bytes each
+const int SYNTHETIC_ROW_GROUPS = 4;
+const int SYNTHETIC_COLUMNS = 6;
+const uint64_t SYNTHETIC_CHUNK_SIZE = 4ull << 20;
+const int COMPRESSION_LEVEL = 5;   // CompressionOptions::compression_level default
+const int RUNS = 3;
+
+bool readFile(const std::string& path, std::vector<uint8_t>& contents) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    contents.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t read = contents.empty() ? 0 : fread(contents.data(), 1, contents.size(), file);
+    fclose(file);
+    return size > 0 && read == contents.size();
+}
+
+bool writeFile(const std::string& path, const void* data, uint64_t size) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && written;
+}
+
+// Column c of a row group, in the layout the chunk files hold
+std::vector<uint8_t> makeChunk(int row_group, int column) {
+    std::vector<uint8_t> chunk(SYNTHETIC_CHUNK_SIZE);
+    std::mt19937_64 random(row_group * 131 + column);
+    uint64_t count = SYNTHETIC_CHUNK_SIZE / sizeof(int64_t);
+    switch (column % 3) {
+        case 0: {  // Ascending ids with gaps
+            int64_t id = static_cast<int64_t>(row_group) << 32;
+            for (uint64_t i = 0; i < count; i++) {
+                id += 1 + static_cast<int64_t>(random() % 4);
+                memcpy(&chunk[i * sizeof(id)], &id, sizeof(id));
+            }
+            break;
+        }
+        case 1: {  // Prices in cents
+            for (uint64_t i = 0; i < count; i++) {
+                double price = static_cast<double>(random() % 100000) / 100.0;
+                memcpy(&chunk[i * sizeof(price)], &price, sizeof(price));
+            }
+            break;
+        }
+        default: {  // Length-prefixed words
+            static const char* const words[] = {"order", "shipped", "pending", "returned", "electronics",
+                                                "books", "garden", "express", "standard", "gift"};
+            size_t offset = 0;
+            while (offset + 4 + 16 <= chunk.size()) {
+                const char* word = words[random() % 10];
+                uint32_t length = static_cast<uint32_t>(strlen(word));
+                memcpy(&chunk[offset], &length, 4);
+                memcpy(&chunk[offset + 4], word, length);
+                offset += 4 + length;
+            }
+            chunk.resize(offset);
+            break;
+        }
+    }
+    return chunk;
+}
+
+bool writeSyntheticChunks(const fs::path& directory, std::vector<std::string>& paths) {
+    for (int row_group = 0; row_group < SYNTHETIC_ROW_GROUPS; row_group++) {
+        for (int column = 0; column < SYNTHETIC_COLUMNS; column++) {
+            std::vector<uint8_t> chunk = makeChunk(row_group, column);
+            std::vector<uint8_t> compressed(lzma_maximum_compressed_size(chunk.size()));
+            uint64_t compressed_size = compressed.size();
+            if (lzma_compress_buffer(chunk.data(), chunk.size(), compressed.data(), &compressed_size,
+                                     0, COMPRESSION_LEVEL) != 0) {
+                return false;
+            }
+            std::string path = (directory / ("bench_rg" + std::to_string(row_group) + "_col" +
+                                             std::to_string(column) + ".lzma")).string();
+            if (!writeFile(path, compressed.data(), compressed_size)) {
+                return false;
+            }
+            paths.push_back(path);
+        }
+    }
+    return true;
+}
+
+// The path before decode-once: decode to verify, then decode again through a temporary file
+bool twoPass(const std::string& path, const std::string& temp_path, uint64_t* decoded_bytes) {
+    std::vector<uint8_t> encoded;
+    if (!readFile(path, encoded)) {
+        return false;
+    }
+    uint64_t raw_size = lzma_get_decompressed_size(encoded.data(), encoded.size());
+    if (raw_size == 0) {
+        raw_size = encoded.size() * 4;
+    }
+    void* verified = malloc(raw_size);
+    if (!verified || lzma_decompress_buffer(encoded.data(), encoded.size(), verified, &raw_size) != 0) {
+        free(verified);
+        return false;
+    }
+    free(verified);
+
+    std::vector<uint8_t> written;
+    bool ok = lzma_decompress_file(path.c_str(), temp_path.c_str(), nullptr, nullptr) == 0 &&
+              readFile(temp_path, written);
+    remove(temp_path.c_str());
+    *decoded_bytes += written.size();
+    return ok;
+}
+
+// The path after decode-once: one in-memory decode whose buffer the writer takes
+bool onePass(const std::string& path, uint64_t* decoded_bytes) {
+    std::vector<uint8_t> encoded;
+    if (!readFile(path, encoded)) {
+        return false;
+    }
+    void* raw_data = nullptr;
+    uint64_t raw_size = 0;
+    if (lzma_decompress_alloc(encoded.data(), encoded.size(), nullptr, &raw_data, &raw_size) != 0) {
+        return false;
+    }
+    free(raw_data);
+    *decoded_bytes += raw_size;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    fs::path work_directory = fs::temp_directory_path() / "infparquet_decode_once_bench";
+    std::error_code ec;
+    fs::create_directories(work_directory, ec);
+
+    if (argc > 1) {
+        for (const auto& entry : fs::directory_iterator(argv[1], ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".lzma") {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        if (paths.empty()) {
+            std::fprintf(stderr, "No .lzma chunk files in %s\n", argv[1]);
+            return 1;
+        }
+    } else if (!writeSyntheticChunks(work_directory, paths)) {
+        std::fprintf(stderr, "Failed to write synthetic chunks to %s\n", work_directory.string().c_str());
+        return 1;
+    }
+
+    std::string temp_path = (work_directory / "chunk.temp").string();
+    double best_two_pass = 0.0;
+    double best_one_pass = 0.0;
+    uint64_t raw_bytes = 0;
+    for (int run = 0; run < RUNS; run++) {
+        uint64_t two_pass_bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& path : paths) {
+            if (!twoPass(path, temp_path, &two_pass_bytes)) {
+                std::fprintf(stderr, "Two-pass decode of %s failed\n", path.c_str());
+                return 1;
+            }
+        }
+        double two_pass = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t one_pass_bytes = 0;
+        start = std::chrono::steady_clock::now();
+        for (const std::string& path : paths) {
+            if (!onePass(path, &one_pass_bytes)) {
+                std::fprintf(stderr, "One-pass decode of %s failed\n", path.c_str());
+                return 1;
+            }
+        }
+        double one_pass = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (two_pass_bytes != one_pass_bytes) {
+            std::fprintf(stderr, "Paths decoded different sizes (%llu vs %llu bytes)\n",
+                         static_cast<unsigned long long>(two_pass_bytes),
+                         static_cast<unsigned long long>(one_pass_bytes));
+            return 1;
+        }
+        raw_bytes = one_pass_bytes;
+        best_two_pass = run == 0 ? two_pass : std::min(best_two_pass, two_pass);
+        best_one_pass = run == 0 ? one_pass : std::min(best_one_pass, one_pass);
+    }
+
+    if (argc <= 1) {
+        for (const std::string& path : paths) {
+            remove(path.c_str());
+        }
+    }
+    fs::remove(work_directory, ec);
+
+    double mib = static_cast<double>(raw_bytes) / (1024.0 * 1024.0);
+    std::printf("%zu chunks, %.1f MiB decoded, best of %d runs\n", paths.size(), mib, RUNS);
+    std::printf("two-pass (decode, decode to temp file, read back): %8.3f s  %8.1f MiB/s\n",
+                best_two_pass, mib / best_two_pass);
+    std::printf("one-pass (decode once in memory):                  %8.3f s  %8.1f MiB/s\n",
+                best_one_pass, mib / best_one_pass);
+    std::printf("speedup: %.2fx\n", best_two_pass / best_one_pass);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * chunk_cache.h
+ *
+ * This header file defines the cache of decompressed column chunks shared by
+ * every decompression path in the process. Entries are keyed by archive
+ * (the chunk path prefix, canonicalized so that different spellings of the
+ * same path share entries), row group and column, and are kept in a number of
+ * independently locked shards. The capacity is shared by all shards: once it
+ * is exceeded, the least recently used entries are evicted from whichever
+ * shard holds them. Entries in use are pinned and never evicted. Each entry
+ * remembers the size and modification time of the chunk file it was decoded
+ * from and is dropped by a lookup that finds the file changed.
+ */
+
+#ifndef INFPARQUET_CHUNK_CACHE_H
+#define INFPARQUET_CHUNK_CACHE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of independently locked shards */
+#define CHUNK_CACHE_SHARDS 16
+
+/**
+ * A pinned cache entry
+ *
+ * The data stays valid until the entry is released with chunk_cache_release.
+ */
+typedef struct ChunkCacheEntry ChunkCacheEntry;
+
+/**
+ * Counters of the cache
+ */
+typedef struct {
+    uint64_t hits;         /* Lookups that found their chunk */
+    uint64_t misses;       /* Lookups that did not */
+    uint64_t insertions;   /* Chunks added */
+    uint64_t evictions;    /* Chunks dropped to stay within the capacity */
+    uint64_t invalidations; /* Chunks dropped because their chunk file changed */
+    uint64_t entries;      /* Chunks currently cached */
+    uint64_t bytes;        /* Decompressed bytes currently cached */
+    uint64_t capacity;     /* Capacity in bytes (0 = cache disabled) */
+} ChunkCacheStats;
+
+/**
+ * Set the capacity of the cache
+ *
+ * Shrinking the cache evicts unpinned entries right away. A single chunk
+ * may take up to the whole capacity.
+ *
+ * capacity_bytes: Capacity in bytes (0 disables the cache, the default)
+ */
+void chunk_cache_set_capacity(uint64_t capacity_bytes);
+
+/**
+ * Get the capacity of the cache
+ *
+ * returns: Capacity in bytes (0 if the cache is disabled)
+ */
+uint64_t chunk_cache_get_capacity(void);
+
+/**
+ * Look up and pin a decompressed chunk
+ *
+ * Counts a hit or a miss (nothing is counted while the cache is disabled).
+ * An entry whose chunk file no longer has the size and modification time it
+ * had when the entry was inserted, or can no longer be examined, is dropped
+ * and the lookup counts as a miss.
+ *
+ * archive: Chunk path prefix of the archive
+ * row_group: Row group index
+ * column: Column index
+ * source: Path of the chunk file the entry was decoded from
+ * returns: The pinned entry, or NULL if the chunk is not cached
+ */
+ChunkCacheEntry* chunk_cache_acquire(const char* archive, int row_group, int column, const char* source);
+
+/**
+ * Add a decompressed chunk and pin it
+ *
+ * On success the cache takes ownership of the buffer, which must come from
+ * malloc. On failure (cache disabled, chunk larger than the capacity, chunk
+ * file missing, or too much of the cache pinned to make room) the caller
+ * keeps the buffer. An existing entry for the same key is replaced.
+ *
+ * archive: Chunk path prefix of the archive
+ * row_group: Row group index
+ * column: Column index
+ * source: Path of the chunk file the data was decoded from
+ * data: Decompressed chunk
+ * size: Size of the chunk in bytes
+ * returns: The pinned entry, or NULL if the chunk was not cached
+ */
+ChunkCacheEntry* chunk_cache_insert(const char* archive, int row_group, int column, const char* source,
+                                    void* data, uint64_t size);
+
+/**
+ * Get the data of a pinned entry
+ *
+ * entry: The entry
+ * returns: Decompressed chunk
+ */
+const void* chunk_cache_entry_data(const ChunkCacheEntry* entry);
+
+/**
+ * Get the size of a pinned entry
+ *
+ * entry: The entry
+ * returns: Size of the decompressed chunk in bytes
+ */
+uint64_t chunk_cache_entry_size(const ChunkCacheEntry* entry);
+
+/**
+ * Unpin an entry
+ *
+ * entry: Entry from chunk_cache_acquire or chunk_cache_insert (may be NULL)
+ */
+void chunk_cache_release(ChunkCacheEntry* entry);
+
+/**
+ * Drop every chunk of an archive
+ *
+ * Called when an archive is rewritten. Pinned entries are dropped once
+ * their last user releases them.
+ *
+ * archive: Chunk path prefix of the archive
+ */
+void chunk_cache_erase_archive(const char* archive);
+
+/**
+ * Drop every chunk and reset the counters
+ */
+void chunk_cache_clear(void);
+
+/**
+ * Get the counters of the cache
+ *
+ * stats: Pointer to receive the counters
+ */
+void chunk_cache_get_stats(ChunkCacheStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_CHUNK_CACHE_H */
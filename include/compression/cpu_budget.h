@@ -0,0 +1,111 @@
+/**
+ * cpu_budget.h
+ *
+ * This header file defines the CPU budget coordinator. Every CPU-bound worker
+ * in the process (pipeline codec workers, parallel processor threads and the
+ * extra match-finder thread LZMA starts inside each encoder) draws from one
+ * pool of tokens, one token per runnable thread, so that inter-task and
+ * intra-codec parallelism never multiply past the number of cores.
+ */
+
+#ifndef INFPARQUET_CPU_BUDGET_H
+#define INFPARQUET_CPU_BUDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Smallest average task size for which a second match-finder thread pays off */
+#define CPU_BUDGET_MT_CODEC_MIN_BYTES (4u * 1024u * 1024u)
+
+/**
+ * Parallelism handed out by the coordinator
+ *
+ * The grant holds task_threads * codec_threads tokens until it is released.
+ */
+typedef struct {
+    uint32_t task_threads;    /* Tasks to run at the same time */
+    uint32_t codec_threads;   /* Threads to use inside each codec call (1 or 2) */
+    uint32_t tokens;          /* Tokens held by this grant */
+} CpuBudgetGrant;
+
+/**
+ * Set the size of the token pool
+ *
+ * Grants already handed out are not affected; the new size applies to
+ * subsequent acquisitions.
+ *
+ * tokens: Number of tokens (0 = number of available CPU cores)
+ */
+void cpu_budget_set_tokens(uint32_t tokens);
+
+/**
+ * Get the size of the token pool
+ *
+ * returns: Number of tokens in the pool
+ */
+uint32_t cpu_budget_get_tokens(void);
+
+/**
+ * Get the number of tokens not currently held by any grant
+ *
+ * returns: Number of free tokens
+ */
+uint32_t cpu_budget_get_available(void);
+
+/**
+ * Acquire parallelism for a batch of tasks
+ *
+ * Waits until at least one token is free, then takes as many free tokens as
+ * the tasks can use and splits them between concurrent tasks and threads
+ * inside each codec call. Concurrent tasks are always preferred; a second
+ * codec thread is only granted when there are fewer tasks than tokens, the
+ * level uses the binary-tree match finder (5 and above) and the tasks are
+ * at least CPU_BUDGET_MT_CODEC_MIN_BYTES on average.
+ *
+ * task_count: Number of tasks to run
+ * average_task_bytes: Average uncompressed size of a task in bytes
+ * max_task_threads: Upper limit on concurrent tasks (0 = no limit)
+ * compression_level: LZMA level the tasks will use (0 for decompression)
+ * grant: Pointer to store the granted parallelism
+ */
+void cpu_budget_acquire(uint64_t task_count,
+                        uint64_t average_task_bytes,
+                        uint32_t max_task_threads,
+                        int compression_level,
+                        CpuBudgetGrant* grant);
+
+/**
+ * Try to acquire tokens for plain worker threads
+ *
+ * Takes up to max_threads of the free tokens without waiting. When nothing
+ * is free the caller should run its work on the calling thread, which keeps
+ * nested use from inside a granted worker deadlock-free.
+ *
+ * max_threads: Number of threads wanted
+ * returns: Number of tokens granted (0 if none are free)
+ */
+uint32_t cpu_budget_try_acquire_threads(uint32_t max_threads);
+
+/**
+ * Return a grant's tokens to the pool
+ *
+ * grant: Grant obtained from cpu_budget_acquire (may be NULL)
+ */
+void cpu_budget_release(CpuBudgetGrant* grant);
+
+/**
+ * Return tokens obtained from cpu_budget_try_acquire_threads to the pool
+ *
+ * tokens: Number of tokens to return
+ */
+void cpu_budget_release_threads(uint32_t tokens);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_CPU_BUDGET_H */
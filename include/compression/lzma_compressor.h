@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "lzma_settings.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,65 @@ int lzma_compress_buffer(const void* input_data, uint64_t input_size,
                          void* output_data, uint64_t* output_size,
                          uint32_t dictionary_size, int compression_level);
 
+/**
+ * Compresses data using LZMA2 algorithm with explicit codec settings
+ * 
+ * Same as lzma_compress_buffer, but takes the codec settings from the caller
+ * instead of the process defaults, so concurrent jobs can each use
+ * their own thread count and memory limit.
+ * 
+ * settings: Codec settings (NULL for the process defaults)
+ * input_data: Pointer to the data to be compressed
+ * input_size: Size of the input data in bytes
+ * output_data: Pointer to the buffer where compressed data will be written
+ * output_size: Pointer to a variable that will receive the size of the compressed data
+ * dictionary_size: Size of the dictionary to use for compression (0 for default)
+ * compression_level: Compression level (1-9, where 9 is highest compression)
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_compress_buffer_with_settings(const LzmaCodecSettings* settings,
+                                       const void* input_data, uint64_t input_size,
+                                       void* output_data, uint64_t* output_size,
+                                       uint32_t dictionary_size, int compression_level);
+
+/**
+ * Compresses data into a seekable buffer of independently decodable frames
+ * 
+ * The caller cuts the input at row boundaries; each frame is compressed on
+ * its own, so any frame can later be decoded without the ones before it.
+ * lzma_decompress_buffer decodes a seekable buffer like a plain one.
+ * 
+ * settings: Codec settings (NULL for the process defaults)
+ * input_data: Pointer to the data to be compressed
+ * input_size: Size of the input data in bytes
+ * frame_ends: End offset of each frame in the input, ascending, the last one equal to input_size
+ * frame_rows: Number of rows in each frame
+ * frame_count: Number of frames
+ * output_data: Buffer of at least lzma_maximum_seekable_size bytes
+ * output_size: In: size of the output buffer; out: size of the seekable buffer
+ * dictionary_size: Size of the dictionary to use for compression (0 for default)
+ * compression_level: Compression level (1-9, where 9 is highest compression)
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_compress_seekable(const LzmaCodecSettings* settings,
+                           const void* input_data, uint64_t input_size,
+                           const uint64_t* frame_ends, const uint32_t* frame_rows,
+                           uint32_t frame_count,
+                           void* output_data, uint64_t* output_size,
+                           uint32_t dictionary_size, int compression_level);
+
+/**
+ * Calculates the maximum possible size of a seekable buffer
+ * 
+ * input_size: Size of the input data in bytes
+ * frame_count: Number of frames the input is cut into
+ * 
+ * Return: Maximum possible size of the seekable buffer
+ */
+uint64_t lzma_maximum_seekable_size(uint64_t input_size, uint32_t frame_count);
+
 /**
  * Compresses data from a file using LZMA2 algorithm
  * 
@@ -86,7 +146,9 @@ uint64_t lzma_maximum_compressed_size(uint64_t input_size);
  * Sets the LZMA compression parameters
  * 
  * This function sets various LZMA compression parameters. It should be called
- * before calling lzma_compress_buffer or lzma_compress_file.
+ * before calling lzma_compress_buffer or lzma_compress_file. The parameters
+ * are process-wide defaults for calls without explicit settings; set them
+ * before any compression starts.
  * 
  * threads: Number of threads to use for compression (0 for automatic)
  * memory_limit: Memory limit in bytes (0 for default)
@@ -95,6 +157,17 @@ uint64_t lzma_maximum_compressed_size(uint64_t input_size);
  */
 int lzma_set_compression_parameters(uint32_t threads, uint64_t memory_limit);
 
+/**
+ * Get the last error message from the LZMA compressor
+ * 
+ * This function returns a string describing the last error that occurred.
+ * The returned string is valid until the next call to any LZMA function
+ * on the same thread.
+ * 
+ * Return: Pointer to a string describing the last error, or NULL if no error occurred
+ */
+const char* lzma_get_error_message(void);
+
 #ifdef __cplusplus
 }
 #endif
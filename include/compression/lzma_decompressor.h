@@ -8,8 +8,10 @@
 #ifndef INFPARQUET_LZMA_DECOMPRESSOR_H
 #define INFPARQUET_LZMA_DECOMPRESSOR_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "lzma_settings.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,11 +28,29 @@ extern "C" {
  */
 typedef bool (*DecompressionProgressCallback)(uint64_t total_size, uint64_t processed_size, void* user_data);
 
+/* Uncompressed size recorded by streams written without knowing it */
+#define LZMA_UNKNOWN_SIZE UINT64_MAX
+
+/* Largest output window of a windowed decode */
+#define LZMA_DECODE_WINDOW_SIZE (1u << 20)
+
+/**
+ * Callback function type receiving decoded data window by window
+ * 
+ * window: Decoded bytes, valid only during the call
+ * size: Number of decoded bytes in the window
+ * user_data: User-provided data passed to the decompression function
+ * 
+ * Return: 0 to continue, non-zero to abort the decode
+ */
+typedef int (*LzmaWindowCallback)(const void* window, size_t size, void* user_data);
+
 /**
  * Decompresses data using LZMA2 algorithm
  * 
  * This function decompresses the input data that was compressed using the LZMA2
- * algorithm and writes the decompressed data to the output buffer.
+ * algorithm and writes the decompressed data to the output buffer. Seekable
+ * buffers are decoded frame by frame into the same output.
  * 
  * input_data: Pointer to the compressed data
  * input_size: Size of the compressed data in bytes
@@ -42,6 +62,84 @@ typedef bool (*DecompressionProgressCallback)(uint64_t total_size, uint64_t proc
 int lzma_decompress_buffer(const void* input_data, uint64_t input_size,
                            void* output_data, uint64_t* output_size);
 
+/**
+ * Decompresses data through a fixed-size output window
+ * 
+ * The decoder works through an output window of at most
+ * LZMA_DECODE_WINDOW_SIZE bytes and hands every filled window to the
+ * callback, so its memory use is its dictionary plus one window however large
+ * the data is. Dictionaries are never larger than the data they decode, which
+ * keeps the seekable frames of a chunk to about twice the frame size. Streams
+ * whose header records LZMA_UNKNOWN_SIZE are decoded up to their end marker.
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit applies (NULL for the process defaults)
+ * callback: Function receiving each window of decoded data, in order
+ * user_data: User data passed to the callback
+ * 
+ * Return: 0 on success, 5 if the decoder would exceed the memory limit,
+ *         6 if the callback aborted, other non-zero codes on failure
+ */
+int lzma_decompress_windows(const void* input_data, uint64_t input_size,
+                            const LzmaCodecSettings* settings,
+                            LzmaWindowCallback callback, void* user_data);
+
+/**
+ * Decompresses data into a newly allocated buffer
+ * 
+ * The data is decoded through lzma_decompress_windows into a buffer
+ * allocated once from the size recorded in the header, or grown as windows
+ * arrive when there is none. The memory limit bounds the decoder, not the
+ * output the caller takes: when the dictionary does not fit beside the
+ * window, a recorded size is decoded in place instead, the output doubling as
+ * the dictionary, so no chunk is refused for its size.
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit applies (NULL for the process defaults)
+ * output_data: Pointer to store the decompressed data (free with free(); NULL if empty)
+ * output_size: Pointer to store the size of the decompressed data
+ * 
+ * Return: 0 on success, 5 if a stream without a recorded size needs a
+ *         decoder above the memory limit, other non-zero codes on failure
+ */
+int lzma_decompress_alloc(const void* input_data, uint64_t input_size,
+                          const LzmaCodecSettings* settings,
+                          void** output_data, uint64_t* output_size);
+
+/**
+ * Gets the working memory lzma_decompress_alloc needs beside its output
+ * 
+ * This is the windowed decoder's memory, or the probability tables of the
+ * largest frame when the limit sends a recorded size to the in-place decode.
+ * The decoded output itself is not included.
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit sizes the window (NULL for the process defaults)
+ * 
+ * Return: Bytes of decoder state, or 0 if the header is invalid
+ */
+uint64_t lzma_decompress_alloc_memory_usage(const void* input_data, uint64_t input_size,
+                                            const LzmaCodecSettings* settings);
+
+/**
+ * Gets the memory a windowed decode of the data needs
+ * 
+ * Covers the decoder's dictionary, its probability tables and the output
+ * window, for the largest frame of a seekable buffer. The decoded output
+ * itself is not included.
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit sizes the window (NULL for the process defaults)
+ * 
+ * Return: Bytes needed, or 0 if the header is invalid
+ */
+uint64_t lzma_decoder_memory_usage(const void* input_data, uint64_t input_size,
+                                   const LzmaCodecSettings* settings);
+
 /**
  * Decompresses data from a file using LZMA2 algorithm
  * 
@@ -72,11 +170,51 @@ int lzma_decompress_file(const char* input_file, const char* output_file,
  */
 uint64_t lzma_get_decompressed_size(const void* input_data, uint64_t input_size);
 
+/**
+ * Gets the number of frames of a seekable buffer
+ * 
+ * Only the fixed header is examined, so the first LZMA_SEEKABLE_HEADER_SIZE
+ * bytes of a chunk file are enough.
+ * 
+ * input_data: Pointer to the compressed data
+ * input_size: Size of the available data in bytes
+ * 
+ * Return: Number of frames, or 0 if the data is a plain LZMA buffer
+ */
+uint32_t lzma_seekable_frame_count(const void* input_data, uint64_t input_size);
+
+/**
+ * Gets the size of the header and frame table of a seekable buffer
+ * 
+ * frame_count: Number of frames from lzma_seekable_frame_count
+ * 
+ * Return: Bytes to read from the start of the buffer for lzma_seekable_read_index
+ */
+uint64_t lzma_seekable_index_size(uint32_t frame_count);
+
+/**
+ * Reads the frame table of a seekable buffer
+ * 
+ * input_data: Start of the seekable buffer
+ * input_size: Available bytes, at least lzma_seekable_index_size(frame_count)
+ * frames: Array receiving one entry per frame
+ * frame_count: Number of frames from lzma_seekable_frame_count
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_seekable_read_index(const void* input_data, uint64_t input_size,
+                             LzmaSeekFrame* frames, uint32_t frame_count);
+
 /**
  * Sets the LZMA decompression parameters
  * 
  * This function sets various LZMA decompression parameters. It should be called
- * before calling lzma_decompress_buffer or lzma_decompress_file.
+ * before calling lzma_decompress_buffer or lzma_decompress_file. The parameters
+ * are process-wide defaults for calls without explicit settings; set them
+ * before any decompression starts.
+ * 
+ * The memory limit bounds the decoder state and output window of windowed
+ * decodes; a stream whose dictionary does not fit is rejected.
  * 
  * threads: Number of threads to use for decompression (0 for automatic)
  * memory_limit: Memory limit in bytes (0 for default)
@@ -0,0 +1,77 @@
+/**
+ * lzma_settings.h
+ * 
+ * This header file defines the per-job settings shared by the LZMA compressor
+ * and decompressor.
+ */
+
+#ifndef INFPARQUET_LZMA_SETTINGS_H
+#define INFPARQUET_LZMA_SETTINGS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * LZMA codec settings
+ * 
+ * Passed explicitly to the *_with_settings functions so that independent jobs
+ * in one process each carry their own configuration. Functions without a
+ * settings argument use process-wide defaults, which are changed by
+ * lzma_set_compression_parameters and lzma_set_decompression_parameters.
+ */
+typedef struct {
+    uint32_t threads;        /* Threads inside the codec (0 for the LZMA default) */
+    uint64_t memory_limit;   /* Memory limit in bytes (0 for no limit) */
+} LzmaCodecSettings;
+
+/*
+ * Seekable buffers
+ * 
+ * A seekable buffer holds a sequence of independently decodable frames so a
+ * reader can decode only the frames covering the rows it needs. Its header
+ * has the same size as a plain LZMA header and keeps the total uncompressed
+ * size at the same place, but starts with a marker byte that is never a
+ * valid LZMA properties byte:
+ * 
+ *   marker (1) | frame count (4) | uncompressed size (8) | frame table | frames
+ * 
+ * The table has one entry of row count, uncompressed size and compressed
+ * size (4 bytes each, little-endian) per frame. Every frame is a complete
+ * plain LZMA buffer as written by lzma_compress_buffer.
+ */
+#define LZMA_SEEKABLE_MARKER 0xFF
+#define LZMA_SEEKABLE_HEADER_SIZE 13
+#define LZMA_SEEKABLE_ENTRY_SIZE 12
+
+/**
+ * Location of one frame of a seekable buffer
+ */
+typedef struct {
+    uint64_t first_row;        /* First row (value) held by the frame */
+    uint32_t row_count;        /* Rows held by the frame */
+    uint64_t raw_offset;       /* Offset of the frame in the uncompressed data */
+    uint32_t raw_size;         /* Uncompressed size of the frame */
+    uint64_t encoded_offset;   /* Offset of the frame in the seekable buffer */
+    uint32_t encoded_size;     /* Compressed size of the frame */
+} LzmaSeekFrame;
+
+/**
+ * Initializes codec settings with default values
+ * 
+ * settings: Settings structure to initialize
+ */
+static inline void lzma_codec_settings_init(LzmaCodecSettings* settings) {
+    if (settings) {
+        settings->threads = 0;
+        settings->memory_limit = 0;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_LZMA_SETTINGS_H */
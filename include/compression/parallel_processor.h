@@ -57,6 +57,22 @@ typedef void (*ParallelTaskCleanupFunction)(void* task_data, void* result);
  */
 typedef int (*WorkItemProcessor)(uint32_t item_index, uint32_t total_items, void* user_data);
 
+/**
+ * Callback function type for processing a work item on a known worker
+ * 
+ * The items of a worker are processed one after another, so state kept per
+ * worker index is never used by two threads at once.
+ * 
+ * worker_index: Index of the worker processing the item (below the number of items)
+ * item_index: Index of the work item being processed
+ * total_items: Total number of work items
+ * user_data: User-provided data passed to the processor function
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+typedef int (*WorkerItemProcessor)(uint32_t worker_index, uint32_t item_index, uint32_t total_items,
+                                   void* user_data);
+
 /**
  * Callback function type for reporting processing progress
  * 
@@ -105,7 +121,8 @@ void parallel_processor_free_results(void** task_results, int count);
  * Get the last error message from the parallel processor
  * 
  * This function returns a string describing the last error that occurred.
- * The returned string is valid until the next call to any parallel processor function.
+ * The returned string is valid until the next call to any parallel processor function
+ * on the same thread.
  * 
  * returns: A string describing the last error, or NULL if no error occurred
  */
@@ -124,7 +141,8 @@ int parallel_processor_get_max_tasks(void);
 /**
  * Set the maximum number of parallel tasks to run simultaneously
  * 
- * This function sets the maximum number of tasks that can run in parallel.
+ * This function sets the maximum number of tasks that can run in parallel
+ * for calls made from the calling thread.
  * If max_tasks is 0, the function will use the number of available CPU cores.
  * 
  * max_tasks: Maximum number of parallel tasks (0 for auto-detection)
@@ -152,6 +170,26 @@ int parallel_process_items(WorkItemProcessor processor,
                           ProcessingProgressCallback progress_callback,
                           void* user_data);
 
+/**
+ * Processes multiple work items in parallel, telling each item its worker
+ * 
+ * Same as parallel_process_items, but the processor also receives the index
+ * of the worker processing the item, for state kept per worker.
+ * 
+ * processor: Function to process each work item
+ * num_items: Number of items to process
+ * max_threads: Maximum number of threads to use (0 for automatic)
+ * progress_callback: Callback function for reporting progress (can be NULL)
+ * user_data: User data to pass to the processor and progress callback functions
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int parallel_process_items_by_worker(WorkerItemProcessor processor,
+                                     uint32_t num_items,
+                                     uint32_t max_threads,
+                                     ProcessingProgressCallback progress_callback,
+                                     void* user_data);
+
 /**
  * Gets the optimal number of threads for the current system
  * 
@@ -187,7 +225,8 @@ typedef struct {
 /**
  * Sets the configuration for the parallel processor
  * 
- * This function configures the behavior of the parallel processor.
+ * This function configures the behavior of the parallel processor for calls
+ * made from the calling thread; other threads keep their own configuration.
  * 
  * config: Pointer to the configuration structure
  * 
@@ -204,6 +243,50 @@ int parallel_set_config(const ParallelProcessorConfig* config);
  */
 void parallel_get_default_config(ParallelProcessorConfig* config);
 
+/**
+ * Processes multiple work items in parallel with an explicit configuration
+ * 
+ * Same as parallel_process_items, but reads the thread limits from the given
+ * configuration instead of the calling thread's configuration, so independent
+ * jobs can run with their own settings concurrently.
+ * 
+ * config: Configuration to use (NULL for the calling thread's configuration)
+ * processor: Function to process each work item
+ * num_items: Number of items to process
+ * progress_callback: Callback function for reporting progress (can be NULL)
+ * user_data: User data to pass to the processor and progress callback functions
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int parallel_process_items_with_config(const ParallelProcessorConfig* config,
+                                       WorkItemProcessor processor,
+                                       uint32_t num_items,
+                                       ProcessingProgressCallback progress_callback,
+                                       void* user_data);
+
+/**
+ * Execute a task in parallel for each row group with an explicit configuration
+ * 
+ * Same as parallel_processor_process_row_groups, but reads the thread limit
+ * from the given configuration instead of the calling thread's configuration.
+ * 
+ * config: Configuration to use (NULL for the calling thread's configuration)
+ * file: Structure of the parquet file to process
+ * task_function: Function to execute for each row group
+ * task_data: Array of task-specific data, one element per row group
+ * cleanup_function: Function to clean up task resources (can be NULL)
+ * task_results: Pointer to array to store task results (allocated by the function)
+ * returns: Error code (PARALLEL_PROCESSOR_OK on success)
+ */
+ParallelProcessorError parallel_processor_process_row_groups_with_config(
+    const ParallelProcessorConfig* config,
+    const ParquetFile* file,
+    ParallelTaskFunction task_function,
+    void** task_data,
+    ParallelTaskCleanupFunction cleanup_function,
+    void*** task_results
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,185 @@
+/**
+ * pipeline.h
+ *
+ * This header file defines the interface for the staged processing pipeline
+ * used by the compression and decompression paths. Work items flow through
+ * four stages (read -> analyze -> encode -> write) that are connected by
+ * bounded lock-free queues. Each stage runs with its own number of threads,
+ * and a full queue blocks the stage feeding it. Readers never start an item
+ * more than reorder_window sequence numbers ahead of the writer, so the
+ * number of items alive at once (queued, in a stage or waiting to be written
+ * in order) never exceeds the window.
+ */
+
+#ifndef INFPARQUET_PIPELINE_H
+#define INFPARQUET_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Error codes for pipeline functions
+ */
+typedef enum {
+    PIPELINE_OK = 0,
+    PIPELINE_INVALID_PARAMETER,
+    PIPELINE_MEMORY_ERROR,
+    PIPELINE_THREAD_ERROR,
+    PIPELINE_STAGE_ERROR,
+    PIPELINE_CANCELLED
+} PipelineError;
+
+/**
+ * Identifiers of the pipeline stages, in the order items pass through them
+ */
+typedef enum {
+    PIPELINE_STAGE_READ = 0,     /* I/O readers producing work items */
+    PIPELINE_STAGE_ANALYZE,      /* Statistics and filters */
+    PIPELINE_STAGE_ENCODE,       /* Codec workers */
+    PIPELINE_STAGE_WRITE,        /* Ordered writer */
+    PIPELINE_STAGE_COUNT
+} PipelineStage;
+
+/**
+ * Function type for the read stage
+ *
+ * Produces the work item for the given sequence number. Sequence numbers
+ * run from 0 to item_count - 1 and each one is handed to exactly one reader.
+ *
+ * sequence: Sequence number of the item to produce
+ * item: Pointer to store the produced work item
+ * user_data: User-provided data passed to pipeline_run
+ *
+ * returns: 0 on success, non-zero error code on failure
+ */
+typedef int (*PipelineReadFunction)(uint64_t sequence, void** item, void* user_data);
+
+/**
+ * Function type for the analyze and encode stages
+ *
+ * Transforms a work item in place. Calls for different items may run
+ * concurrently and in any order.
+ *
+ * sequence: Sequence number of the item
+ * item: The work item to process
+ * user_data: User-provided data passed to pipeline_run
+ *
+ * returns: 0 on success, non-zero error code on failure
+ */
+typedef int (*PipelineTransformFunction)(uint64_t sequence, void* item, void* user_data);
+
+/**
+ * Function type for the write stage
+ *
+ * Consumes a work item. The write stage runs on a single thread and items
+ * are delivered strictly in sequence order.
+ *
+ * sequence: Sequence number of the item
+ * item: The work item to write
+ * user_data: User-provided data passed to pipeline_run
+ *
+ * returns: 0 on success, non-zero error code on failure
+ */
+typedef int (*PipelineWriteFunction)(uint64_t sequence, void* item, void* user_data);
+
+/**
+ * Function type for releasing a work item
+ *
+ * Called exactly once for every item produced by the read stage, after it
+ * has been written or when the pipeline is aborted.
+ *
+ * item: The work item to release
+ * user_data: User-provided data passed to pipeline_run
+ */
+typedef void (*PipelineCleanupFunction)(void* item, void* user_data);
+
+/**
+ * Function type for polling cancellation
+ *
+ * Polled by the readers before each new item and by the writer while it
+ * waits (at least every few milliseconds), so a cancelled run stops within
+ * one item per codec worker.
+ *
+ * user_data: User-provided data passed to pipeline_run
+ *
+ * returns: Non-zero if the run should stop
+ */
+typedef int (*PipelineCancelFunction)(void* user_data);
+
+/**
+ * Stage functions making up a pipeline
+ */
+typedef struct {
+    PipelineReadFunction read;            /* Required */
+    PipelineTransformFunction analyze;    /* Optional, NULL to pass items through */
+    PipelineTransformFunction encode;     /* Optional, NULL to pass items through */
+    PipelineWriteFunction write;          /* Optional, NULL to discard items in order */
+    PipelineCleanupFunction cleanup;      /* Optional, NULL if items need no cleanup */
+    PipelineCancelFunction cancelled;     /* Optional, NULL if the run cannot be cancelled */
+    void* user_data;                      /* Passed to every stage function */
+} PipelineStages;
+
+/**
+ * Structure for pipeline configuration
+ */
+typedef struct {
+    uint32_t reader_threads;     /* Threads in the read stage (0 = default) */
+    uint32_t analyzer_threads;   /* Threads in the analyze stage (0 = default) */
+    uint32_t codec_threads;      /* Threads in the encode stage (0 = one per core) */
+    uint32_t queue_depth;        /* Capacity of each inter-stage queue (0 = default) */
+    uint32_t reorder_window;     /* Maximum items alive at once (0 = what the queues and
+                                    stage threads can hold) */
+} PipelineConfig;
+
+/**
+ * Gets the default configuration for the pipeline
+ *
+ * This function fills the provided configuration structure with default values:
+ * one reader, one analyzer, one codec worker per core, a queue depth of
+ * twice the number of codec workers and a reorder window derived from those.
+ *
+ * config: Pointer to the configuration structure to be filled
+ */
+void pipeline_get_default_config(PipelineConfig* config);
+
+/**
+ * Run items through the pipeline
+ *
+ * This function starts the stage threads, pushes item_count items through
+ * read, analyze, encode and write, and returns when every item has been
+ * written or a stage has failed. The write stage runs on the calling thread.
+ * On failure or cancellation the remaining items are released through the
+ * cleanup function and the first error is reported by pipeline_get_error.
+ *
+ * config: Pipeline configuration (NULL for defaults)
+ * stages: Stage functions
+ * item_count: Number of items to process
+ * returns: Error code (PIPELINE_OK on success, PIPELINE_CANCELLED if the
+ *          cancel function asked the run to stop)
+ */
+PipelineError pipeline_run(
+    const PipelineConfig* config,
+    const PipelineStages* stages,
+    uint64_t item_count
+);
+
+/**
+ * Get the last error message from the pipeline
+ *
+ * This function returns a string describing the last error that occurred.
+ * The returned string is valid until the next call to any pipeline function
+ * on the same thread.
+ *
+ * returns: A string describing the last error, or NULL if no error occurred
+ */
+const char* pipeline_get_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_PIPELINE_H */
@@ -52,11 +52,31 @@ int arrow_read_parquet_structure(const char* file_path, ParquetFile* parquet_fil
 int arrow_read_column_data(const char* file_path, int row_group_id, int column_id, 
                           void** buffer, size_t* buffer_size);
 
+/**
+ * Reads column data and its validity bitmap from a Parquet file using Arrow
+ * 
+ * Same as arrow_read_column_data, and also returns which rows are not null.
+ * Null rows are still present in the buffer, as 0 or an empty string.
+ * 
+ * file_path: Path to the Parquet file
+ * row_group_id: Index of the row group
+ * column_id: Index of the column
+ * buffer: Pointer to a void pointer that will receive the allocated buffer
+ * buffer_size: Pointer to a size_t that will receive the buffer size
+ * validity: Receives a bitmap with one bit per row, least significant bit first,
+ *           set for valid rows; NULL if no row is null (free with free(); may be NULL)
+ * 
+ * Return: 0 on success, non-zero on error
+ */
+int arrow_read_column_data_with_validity(const char* file_path, int row_group_id, int column_id,
+                                         void** buffer, size_t* buffer_size, uint8_t** validity);
+
 /**
  * Creates a new Parquet file with the given data and schema
  * 
  * This function creates a new Parquet file using Arrow, with the provided
- * column data and schema.
+ * column data and schema, written as a single row group through the
+ * streaming writer.
  * 
  * file_path: Path where the Parquet file will be written
  * column_data: Array of pointers to column data
@@ -72,6 +92,89 @@ int arrow_create_parquet_file(const char* file_path, void** column_data, size_t*
                              ParquetValueType* schema, int* fixed_len_sizes, 
                              int column_count, int64_t row_count);
 
+/**
+ * Streaming Parquet writer
+ * 
+ * Writes a Parquet file one row group at a time through parquet::arrow::FileWriter,
+ * so memory use stays bounded to roughly one row group regardless of file size.
+ */
+typedef struct ArrowParquetWriter ArrowParquetWriter;
+
+/**
+ * Options for the streaming Parquet writer
+ */
+typedef struct {
+    CompressionType compression;   /* Page codec (COMPRESSION_LZMA2 is not a Parquet codec) */
+    int compression_level;         /* Codec level (0 = codec default) */
+    int64_t data_page_size;        /* Target data page size in bytes (0 = Arrow default) */
+    uint32_t encode_threads;       /* Threads converting and encoding columns (0 = auto, 1 = serial) */
+} ArrowWriterOptions;
+
+/**
+ * Gets the default options for the streaming writer
+ * 
+ * Defaults are uncompressed pages of Arrow's default size, with columns
+ * converted and encoded in parallel.
+ * 
+ * options: Pointer to the options structure to be filled
+ */
+void arrow_writer_get_default_options(ArrowWriterOptions* options);
+
+/**
+ * Opens a streaming Parquet writer
+ * 
+ * file_path: Path where the Parquet file will be written ("-" for standard output)
+ * column_names: Array of column names, or NULL to name columns col_0, col_1, ...
+ * types: Array of ParquetValueType for each column
+ * fixed_len_sizes: Array of fixed lengths for FIXED_LEN_BYTE_ARRAY columns, or NULL for others
+ * column_count: Number of columns
+ * options: Writer options (NULL for defaults)
+ * 
+ * Return: A new writer, or NULL on error
+ */
+ArrowParquetWriter* arrow_writer_open(const char* file_path, const char* const* column_names,
+                                      const ParquetValueType* types, const int* fixed_len_sizes,
+                                      int column_count, const ArrowWriterOptions* options);
+
+/**
+ * Writes one row group
+ * 
+ * Column buffers use the layout produced by arrow_read_column_data. Columns
+ * are converted with bulk appends on parallel workers and encoded
+ * concurrently; the previous row group is flushed to disk first. A NULL
+ * buffer writes a column of nulls. The buffers can be freed on return.
+ * 
+ * writer: The writer
+ * column_data: Array of column buffers, one per column
+ * column_sizes: Array of buffer sizes in bytes
+ * row_count: Number of rows (0 to derive it from the buffers)
+ * 
+ * Return: 0 on success, non-zero on error
+ */
+int arrow_writer_write_row_group(ArrowParquetWriter* writer, const void* const* column_data,
+                                 const size_t* column_sizes, int64_t row_count);
+
+/**
+ * Writes the file footer and releases the writer
+ * 
+ * The writer is released even when writing the footer fails.
+ * 
+ * writer: The writer to close
+ * 
+ * Return: 0 on success, non-zero on error
+ */
+int arrow_writer_close(ArrowParquetWriter* writer);
+
+/**
+ * Gets the size of one value in the arrow_read_column_data layout
+ * 
+ * type: Value type of the column
+ * fixed_len: Byte length of FIXED_LEN_BYTE_ARRAY values (ignored for other types)
+ * 
+ * Return: Bytes per value, or 0 for length-prefixed (variable-length) values
+ */
+size_t arrow_column_value_size(ParquetValueType type, int fixed_len);
+
 /**
  * Gets the last error message from the Arrow adapter
  * 
@@ -81,6 +184,53 @@ const char* arrow_get_last_error();
 
 #ifdef __cplusplus
 }
+
+#include <memory>
+
+namespace arrow {
+class Schema;
+class RecordBatch;
+}
+
+/**
+ * Builds the Arrow schema for the given columns (C++ only)
+ * 
+ * column_names: Array of column names, or NULL to name columns col_0, col_1, ...
+ * types: Array of ParquetValueType for each column
+ * fixed_len_sizes: Array of fixed lengths for FIXED_LEN_BYTE_ARRAY columns, or NULL for others
+ * column_count: Number of columns
+ * 
+ * Return: The schema
+ */
+std::shared_ptr<arrow::Schema> arrow_make_schema(const char* const* column_names,
+                                                 const ParquetValueType* types,
+                                                 const int* fixed_len_sizes,
+                                                 int column_count);
+
+/**
+ * Builds a record batch over decoded column buffers (C++ only)
+ * 
+ * Takes ownership of the buffers, which must come from malloc. Fixed-width
+ * columns are wrapped without copying and freed together with the batch;
+ * booleans and variable-length values are converted and their buffers freed
+ * right away. The buffers are consumed on failure as well.
+ * 
+ * schema: Schema from arrow_make_schema
+ * types: Array of ParquetValueType for each column of the schema
+ * fixed_len_sizes: Array of fixed lengths for FIXED_LEN_BYTE_ARRAY columns, or NULL for others
+ * column_data: Array of column buffers in the arrow_read_column_data layout (NULL entries give null columns)
+ * column_sizes: Array of buffer sizes in bytes
+ * row_count: Number of rows (0 to derive it from the buffers)
+ * threads: Threads converting columns (0 = auto, 1 = serial)
+ * batch: Pointer to receive the record batch
+ * 
+ * Return: 0 on success, non-zero on error
+ */
+int arrow_make_record_batch(const std::shared_ptr<arrow::Schema>& schema,
+                            const ParquetValueType* types, const int* fixed_len_sizes,
+                            void** column_data, const size_t* column_sizes,
+                            int64_t row_count, uint32_t threads,
+                            std::shared_ptr<arrow::RecordBatch>* batch);
 #endif
 
 #endif /* INFPARQUET_ARROW_ADAPTER_H */ 
\ No newline at end of file
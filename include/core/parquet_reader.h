@@ -1,6 +1,7 @@
 #ifndef INFPARQUET_PARQUET_READER_H
 #define INFPARQUET_PARQUET_READER_H
 
+#include <stddef.h>
 #include "parquet_structure.h"
 
 #ifdef __cplusplus
@@ -80,6 +81,31 @@ ParquetReaderError parquet_reader_read_column(
     size_t* buffer_size
 );
 
+/**
+ * Read data and the validity bitmap from a specific column in a row group
+ * 
+ * Same as parquet_reader_read_column, and also returns which rows are not
+ * null; null rows are still present in the buffer, as 0 or an empty string.
+ * Free the bitmap with parquet_reader_free_buffer.
+ * 
+ * context: The reader context
+ * row_group_id: ID of the row group to read from
+ * column_id: ID of the column to read
+ * buffer: Pointer to store the allocated buffer
+ * buffer_size: Pointer to store the size of the allocated buffer
+ * validity: Pointer to store the bitmap, one bit per row, least significant bit
+ *           first, set for valid rows (NULL if no row is null; may be NULL)
+ * returns: Error code (PARQUET_READER_OK on success)
+ */
+ParquetReaderError parquet_reader_read_column_with_validity(
+    ParquetReaderContext* context,
+    int row_group_id,
+    int column_id,
+    void** buffer,
+    size_t* buffer_size,
+    uint8_t** validity
+);
+
 /**
  * Free a buffer allocated by parquet_reader_read_column
  * 
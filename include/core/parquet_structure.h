@@ -63,6 +63,21 @@ typedef struct {
     void* page_data;         /* Optional, can be NULL if data is not loaded */
 } ParquetPage;
 
+/**
+ * Statistics of a column chunk, taken from the file footer
+ * 
+ * Only statistics the Parquet reader trusts are kept: those of writers
+ * without known statistics bugs, under a sort order matching how values
+ * are compared when scanning (integers as signed values), with no NaN bounds.
+ */
+typedef struct {
+    bool has_min_max;        /* Whether min_value and max_value are set */
+    double min_value;        /* Smallest value; for INT96, seconds since the Unix epoch */
+    double max_value;        /* Largest value; for INT96, seconds since the Unix epoch */
+    bool has_null_count;     /* Whether null_count is set */
+    uint64_t null_count;     /* Number of null values */
+} ParquetColumnStatistics;
+
 /**
  * Structure representing a Parquet column
  */
@@ -78,6 +93,7 @@ typedef struct {
     void* column_data;       /* Optional, can be NULL if data is not loaded */
     char* compression_path;  /* Path to compressed file if applicable */
     uint32_t fixed_len_byte_array_size; /* Size in bytes for FIXED_LEN_BYTE_ARRAY type */
+    ParquetColumnStatistics statistics; /* Footer statistics of the column chunk */
 } ParquetColumn;
 
 /**
@@ -2,6 +2,8 @@
 #define INFPARQUET_PARQUET_WRITER_H
 
 #include "parquet_structure.h"
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +27,23 @@ typedef enum {
  */
 typedef struct ParquetWriterContext ParquetWriterContext;
 
+/**
+ * Output options for the parquet writer
+ */
+typedef struct {
+    CompressionType compression;   /* Page codec of the written file (COMPRESSION_NONE by default) */
+    int compression_level;         /* Codec level (0 = codec default) */
+    int64_t data_page_size;        /* Target data page size in bytes (0 = Arrow default) */
+    uint32_t encode_threads;       /* Threads converting and encoding columns (0 = auto, 1 = serial) */
+} ParquetWriterOptions;
+
+/**
+ * Get the default options for the writer
+ * 
+ * options: Pointer to the options structure to be filled
+ */
+void parquet_writer_get_default_options(ParquetWriterOptions* options);
+
 /**
  * Create a new parquet writer context
  * 
@@ -36,6 +55,21 @@ typedef struct ParquetWriterContext ParquetWriterContext;
  */
 ParquetWriterContext* parquet_writer_create(const char* file_path);
 
+/**
+ * Create a new parquet writer context with explicit output options
+ * 
+ * Row groups are streamed to the file as they end, so memory use stays
+ * bounded to roughly one row group.
+ * 
+ * file_path: Path where the parquet file will be written ("-" for standard output)
+ * options: Output codec, page size and encoding threads (NULL for defaults)
+ * returns: A new writer context, or NULL if an error occurred
+ */
+ParquetWriterContext* parquet_writer_create_with_options(
+    const char* file_path,
+    const ParquetWriterOptions* options
+);
+
 /**
  * Close a parquet writer context and free associated resources
  * 
@@ -66,10 +100,29 @@ ParquetWriterError parquet_writer_add_column(
     int* column_id
 );
 
+/**
+ * Add a column with a type length to the parquet schema
+ * 
+ * context: The writer context
+ * name: Name of the column
+ * type: Data type of the column
+ * type_length: Byte length of FIXED_LEN_BYTE_ARRAY values (ignored for other types)
+ * column_id: Pointer to store the assigned column ID
+ * returns: Error code (PARQUET_WRITER_OK on success)
+ */
+ParquetWriterError parquet_writer_add_column_with_length(
+    ParquetWriterContext* context,
+    const char* name,
+    ParquetValueType type,
+    int type_length,
+    int* column_id
+);
+
 /**
  * Start a new row group in the parquet file
  * 
- * This function begins a new row group in the parquet file.
+ * This function begins a new row group in the parquet file. The first call
+ * finalizes the schema and opens the output file.
  * 
  * context: The writer context
  * row_group_id: Pointer to store the assigned row group ID
@@ -83,7 +136,8 @@ ParquetWriterError parquet_writer_start_row_group(
 /**
  * Finish the current row group
  * 
- * This function completes the current row group.
+ * This function completes the current row group: its buffered columns are
+ * encoded in parallel and written to the file, then released.
  * 
  * context: The writer context
  * returns: Error code (PARQUET_WRITER_OK on success)
@@ -93,13 +147,15 @@ ParquetWriterError parquet_writer_end_row_group(ParquetWriterContext* context);
 /**
  * Write column data to the current row group
  * 
- * This function writes data for a column in the current row group.
+ * This function writes data for a column in the current row group. The data
+ * is copied, so the buffer can be released on return; it uses the layout of
+ * arrow_read_column_data and is encoded when the row group ends.
  * 
  * context: The writer context
  * column_id: ID of the column to write
  * buffer: Buffer containing the column data
  * buffer_size: Size of the buffer in bytes
- * row_count: Number of rows in the column
+ * row_count: Number of rows in the column (0 if unknown)
  * returns: Error code (PARQUET_WRITER_OK on success)
  */
 ParquetWriterError parquet_writer_write_column(
@@ -111,20 +167,25 @@ ParquetWriterError parquet_writer_write_column(
 );
 
 /**
- * Reconstruct a parquet file from multiple column files
+ * Hand a column buffer to the current row group
  * 
- * This function assembles a parquet file from separate column files.
- * Used during decompression to reconstruct the original parquet file.
+ * Like parquet_writer_write_column, but the writer takes ownership of the
+ * buffer instead of copying it, and frees it once the row group is written.
+ * On failure the caller keeps the buffer.
  * 
- * file_structure: Structure of the original parquet file
- * output_path: Path where the reconstructed file will be written
- * column_file_paths: Array of paths to the column files
+ * context: The writer context
+ * column_id: ID of the column to write
+ * buffer: Column data allocated with malloc
+ * buffer_size: Size of the buffer in bytes
+ * row_count: Number of rows in the column (0 if unknown)
  * returns: Error code (PARQUET_WRITER_OK on success)
  */
-ParquetWriterError parquet_writer_reconstruct_file(
-    const ParquetFile* file_structure,
-    const char* output_path,
-    char** column_file_paths
+ParquetWriterError parquet_writer_adopt_column(
+    ParquetWriterContext* context,
+    int column_id,
+    void* buffer,
+    size_t buffer_size,
+    int row_count
 );
 
 /**
@@ -0,0 +1,77 @@
+/**
+ * platform.h
+ * 
+ * This header file defines portability macros shared by the C and C++ modules.
+ */
+
+#ifndef INFPARQUET_PLATFORM_H
+#define INFPARQUET_PLATFORM_H
+
+/**
+ * Storage class for per-thread module state such as error message buffers,
+ * so that jobs running concurrently in one process never see each other's state
+ */
+#if defined(__cplusplus)
+#define INFPARQUET_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define INFPARQUET_THREAD_LOCAL __declspec(thread)
+#else
+#define INFPARQUET_THREAD_LOCAL _Thread_local
+#endif
+
+/**
+ * Defined when functions can be compiled for x86 vector extensions and
+ * chosen at run time, so one binary carries kernels for every CPU:
+ *
+ *   INFPARQUET_TARGET(isa)        marks a function compiled for the extension
+ *                                 (avx2 or avx512f)
+ *   INFPARQUET_CPU_SUPPORTS(isa)  tells whether this CPU and OS can run it
+ *   INFPARQUET_POPCOUNT(x)        counts the set bits of an unsigned int, for
+ *                                 use inside those functions
+ *
+ * GCC and Clang use __attribute__((target(...))) and __builtin_cpu_supports.
+ * MSVC compiles intrinsics in any function, so the target is empty, and the
+ * CPU is asked with __cpuid and _xgetbv, which also check that the OS saves
+ * the vector registers.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INFPARQUET_X86_DISPATCH 1
+#define INFPARQUET_TARGET(isa) __attribute__((target(#isa)))
+#define INFPARQUET_CPU_SUPPORTS(isa) __builtin_cpu_supports(#isa)
+#define INFPARQUET_POPCOUNT(x) __builtin_popcount(x)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define INFPARQUET_X86_DISPATCH 1
+#define INFPARQUET_TARGET(isa)
+#define INFPARQUET_CPU_SUPPORTS(isa) (infparquet_x86_features() & INFPARQUET_X86_##isa)
+#define INFPARQUET_POPCOUNT(x) __popcnt(x)
+
+#define INFPARQUET_X86_avx2    1
+#define INFPARQUET_X86_avx512f 2
+
+/* Extensions this CPU and OS support, detected once per module */
+static __inline int infparquet_x86_features(void) {
+    static int features = -1;
+    if (features < 0) {
+        int detected = 0;
+        int info[4];
+        __cpuid(info, 0);
+        int max_leaf = info[0];
+        __cpuid(info, 1);
+        if (max_leaf >= 7 && (info[2] & (1 << 27))) {  /* OSXSAVE: XCR0 is readable */
+            unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            if ((xcr0 & 0x06) == 0x06 && (info[1] & (1 << 5))) {           /* YMM state, AVX2 */
+                detected |= INFPARQUET_X86_avx2;
+            }
+            if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16))) {          /* ZMM state, AVX-512F */
+                detected |= INFPARQUET_X86_avx512f;
+            }
+        }
+        features = detected;
+    }
+    return features;
+}
+#endif
+
+#endif /* INFPARQUET_PLATFORM_H */
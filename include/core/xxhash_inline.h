@@ -0,0 +1,29 @@
+/**
+ * xxhash_inline.h
+ *
+ * This header includes the xxHash copy vendored with Arrow, with every
+ * function inlined (XXH_INLINE_ALL). Include it instead of xxhash.h.
+ */
+
+#ifndef INFPARQUET_XXHASH_INLINE_H
+#define INFPARQUET_XXHASH_INLINE_H
+
+/*
+ * Once XXH64 is inlined into a caller hashing a local variable, GCC at -O3
+ * loses track of the variable through the input-pointer arithmetic of
+ * XXH64_finalize and reports it as maybe uninitialized, which it never is.
+ * The warning is silenced for the vendored code only.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#define XXH_INLINE_ALL
+#include "arrow/vendored/xxhash/xxhash.h"
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif /* INFPARQUET_XXHASH_INLINE_H */
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 #include <memory>
 
 namespace infparquet {
@@ -21,8 +22,10 @@ namespace infparquet {
  */
 enum class CommandType {
     Compress,       /* Compress a Parquet file */
+    CompressBatch,  /* Compress every Parquet file in a directory or glob */
     Decompress,     /* Decompress a compressed Parquet file */
     List,           /* List metadata information */
+    Verify,         /* Check an archive against its chunk checksums */
     Query,          /* Query metadata */
     Help,           /* Display help information */
     Invalid         /* Invalid command */
@@ -37,6 +40,21 @@ struct CommandArgs {
     std::string output_path;                         /* Output file or directory path */
     int compression_level = 5;                       /* Compression level (1-9) */
     int threads = 0;                                 /* Number of threads (0 for automatic) */
+    int reader_threads = 0;                          /* Pipeline reader threads (0 for default) */
+    int analyzer_threads = 0;                        /* Pipeline analyzer threads (0 for default) */
+    int queue_depth = 0;                             /* Pipeline queue depth (0 for default) */
+    std::string output_codec = "none";               /* Page codec of a decompressed file */
+    int output_codec_level = 0;                      /* Level of the output codec (0 for default) */
+    int64_t page_size = 0;                           /* Data page size of a decompressed file (0 for default) */
+    std::vector<std::string> columns;                /* Columns to decompress (empty for all) */
+    std::vector<int> row_groups;                     /* Row groups to decompress (empty for all) */
+    std::vector<std::string> bloom_filter_columns;   /* Columns given row group Bloom filters */
+    double bloom_filter_fpp = 0.01;                  /* False-positive rate of the Bloom filters */
+    bool use_footer_statistics = false;              /* Answer numeric and timestamp chunks from footer statistics */
+    double metadata_sample_rate = 1.0;               /* Fraction of rows string and mode statistics are estimated from */
+    bool stream = false;                             /* Use a single-stream archive ("-" for stdin/stdout) */
+    std::string output_format = "parquet";           /* Output of a stream decompression: parquet or arrow */
+    bool full_verify = false;                        /* Decode chunks while verifying */
     bool use_basic_metadata = true;                  /* Whether to use basic metadata */
     std::string query;                               /* Query string for metadata querying */
     std::string custom_metadata_file;                /* Path to custom metadata JSON file */
@@ -127,6 +145,16 @@ private:
      */
     bool parseListCommand(const std::vector<std::string>& args, CommandArgs& command_args);
     
+    /**
+     * Parses a verify command
+     * 
+     * args: Vector of arguments
+     * command_args: Structure to store parsed arguments
+     * 
+     * Return: true if successful, false otherwise
+     */
+    bool parseVerifyCommand(const std::vector<std::string>& args, CommandArgs& command_args);
+    
     /**
      * Parses a query command
      * 
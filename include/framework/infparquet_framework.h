@@ -11,8 +11,16 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <future>
+
+namespace arrow {
+class RecordBatch;
+class RecordBatchReader;
+}
 
 namespace infparquet {
 
@@ -55,6 +63,7 @@ enum class FrameworkError {
     PARALLEL_PROCESSING_ERROR,
     INVALID_QUERY,       // Invalid SQL query
     WRITER_ERROR,        // Error in parquet writer
+    CANCELLED,           // Operation cancelled through its CancellationToken
     UNKNOWN_ERROR
 };
 
@@ -66,7 +75,15 @@ struct CompressionOptions {
     bool generate_base_metadata = true;  // Whether to generate base metadata
     bool generate_custom_metadata = false;  // Whether to generate custom metadata
     std::string custom_metadata_config;  // Path to JSON config for custom metadata
-    int parallel_tasks = 0;  // Number of parallel tasks (0 = auto)
+    int parallel_tasks = 0;  // Number of codec workers (0 = auto)
+    int reader_threads = 0;  // Number of threads reading column chunks (0 = default)
+    int analyzer_threads = 0;  // Number of threads analyzing column chunks (0 = default)
+    int queue_depth = 0;  // Capacity of each queue between pipeline stages (0 = default)
+    int seek_frame_size = 1 << 20;  // Uncompressed bytes per independently decodable frame (0 = one frame per chunk)
+    std::vector<std::string> bloom_filter_columns;  // Columns given a Bloom filter per row group, by name (empty = none)
+    double bloom_filter_fpp = 0.01;  // False-positive rate the Bloom filters are sized for
+    bool use_footer_statistics = false;  // Take min/max/null counts of numeric and timestamp chunks from the footer instead of scanning
+    double metadata_sample_rate = 1.0;  // Fraction of each row group's rows string and mode statistics are estimated from (1 = every row)
 };
 
 /**
@@ -74,7 +91,82 @@ struct CompressionOptions {
  */
 struct DecompressionOptions {
     std::string output_directory;  // Directory to store the decompressed file
-    int parallel_tasks = 0;  // Number of parallel tasks (0 = auto)
+    int parallel_tasks = 0;  // Number of codec workers (0 = auto)
+    int reader_threads = 0;  // Number of threads reading compressed chunks (0 = default)
+    int analyzer_threads = 0;  // Number of threads checking chunk headers (0 = default)
+    int queue_depth = 0;  // Capacity of each queue between pipeline stages (0 = default)
+    std::string output_codec = "none";  // Page codec of the restored file: none, snappy, gzip, lz4 or zstd
+    int output_codec_level = 0;  // Level of the output codec (0 = codec default)
+    int64_t page_size = 0;  // Target data page size of the restored file in bytes (0 = Arrow default)
+    std::vector<std::string> columns;  // Columns to restore, by name (empty = all)
+    std::vector<int> row_groups;  // Row groups to restore, by index (empty = all)
+    std::string output_format = "parquet";  // Output of decompressFromStream: parquet or arrow (Arrow IPC stream)
+};
+
+/**
+ * Result of compressing one file of a batch
+ */
+struct BatchFileResult {
+    std::string input_file;     // Path of the input Parquet file
+    bool success = false;       // Whether the file was compressed and its metadata written
+    std::string error;          // Reason for the failure (empty on success)
+    uint64_t input_bytes = 0;   // Uncompressed column bytes read from the file
+    uint64_t output_bytes = 0;  // Compressed bytes written for the file
+};
+
+/**
+ * Aggregate report of a batch compression
+ */
+struct BatchCompressionReport {
+    std::vector<BatchFileResult> files;  // One entry per input file, in sorted path order
+    int files_succeeded = 0;
+    int files_failed = 0;
+    uint64_t chunk_count = 0;     // Column chunks scheduled across all files
+    uint64_t input_bytes = 0;     // Uncompressed bytes of the committed files
+    uint64_t output_bytes = 0;    // Compressed bytes of the committed files
+    double elapsed_seconds = 0;   // Wall-clock time of the whole batch
+};
+
+/**
+ * Counters of the decompressed chunk cache
+ */
+struct ChunkCacheStatistics {
+    uint64_t hits = 0;         // Chunks served from the cache
+    uint64_t misses = 0;       // Chunks that had to be read and decoded
+    uint64_t insertions = 0;
+    uint64_t evictions = 0;    // Chunks dropped to stay within the capacity
+    uint64_t invalidations = 0; // Chunks dropped because their chunk file changed
+    uint64_t entries = 0;      // Chunks currently cached
+    uint64_t bytes = 0;        // Decompressed bytes currently cached
+    uint64_t capacity = 0;     // Capacity in bytes (0 = cache disabled)
+};
+
+/**
+ * Options for verifying an archive
+ */
+struct VerifyOptions {
+    bool full_decode = false;  // Also decode every chunk and check the decoded data
+    int parallel_tasks = 0;    // Chunks checked at the same time (0 = one per core)
+};
+
+/**
+ * A chunk that failed verification
+ */
+struct ChunkFault {
+    int row_group = 0;
+    int column = 0;
+    std::string reason;  // What did not match
+};
+
+/**
+ * Report of an archive verification
+ */
+struct VerificationReport {
+    uint64_t chunks_checked = 0;
+    uint64_t bytes_checked = 0;    // Compressed bytes read and hashed
+    uint64_t bytes_decoded = 0;    // Decoded bytes hashed (full decode only)
+    std::vector<ChunkFault> corrupt_chunks;  // Sorted by row group, then column
+    double elapsed_seconds = 0;
 };
 
 /**
@@ -88,6 +180,60 @@ struct MetadataQueryResult {
     std::vector<std::string> matching_columns;
 };
 
+/**
+ * Token for cooperative cancellation of asynchronous operations
+ * 
+ * Copies share the same state: the caller keeps one copy and passes another
+ * to the operation. A cancelled operation stops at its next checkpoint
+ * (between column chunks, or between the phases of a job) and cleans up
+ * its partial output as it would on failure.
+ */
+class CancellationToken {
+public:
+    /**
+     * Constructor
+     * 
+     * Creates a token that has not been cancelled
+     */
+    CancellationToken() : state_(std::make_shared<std::atomic<bool>>(false)) {}
+    
+    /**
+     * Requests cancellation of every operation holding a copy of this token
+     */
+    void cancel() { state_->store(true, std::memory_order_relaxed); }
+    
+    /**
+     * Checks whether cancellation was requested
+     * 
+     * Return: true if cancel() was called on any copy of the token
+     */
+    bool isCancelled() const { return state_->load(std::memory_order_relaxed); }
+    
+private:
+    std::shared_ptr<std::atomic<bool>> state_;
+};
+
+/**
+ * Outcome of an asynchronous operation
+ */
+struct JobResult {
+    bool success = false;     // Whether the operation completed successfully
+    bool cancelled = false;   // Whether the operation stopped because it was cancelled
+    FrameworkError error_code = FrameworkError::OK;
+    std::string error;        // Error message (empty on success)
+    std::string output;       // Query results (queryMetadataAsync only)
+};
+
+/**
+ * Callback function type for completion of an asynchronous operation
+ * 
+ * Called on the executor thread that ran the operation, before its future
+ * becomes ready.
+ * 
+ * result: Outcome of the operation
+ */
+using CompletionCallback = std::function<void(const JobResult& result)>;
+
 /**
  * Class encapsulating the InfParquet framework
  */
@@ -150,6 +296,41 @@ public:
                            int threads = 0,
                            bool use_basic_metadata = true);
     
+    /**
+     * Compresses a Parquet file using LZMA2 with full control over the options
+     * 
+     * input_file: Path to the input Parquet file
+     * output_dir: Directory where compressed files and metadata will be written
+     * options: Compression options, including the per-stage pipeline settings
+     * 
+     * Return: true on success, false on failure
+     */
+    bool compressParquetFile(const std::string& input_file,
+                           const std::string& output_dir,
+                           const CompressionOptions& options);
+    
+    /**
+     * Compresses every Parquet file matched by a directory or glob pattern
+     * 
+     * The column chunks of all files are scheduled on one shared pipeline, so
+     * codec workers stay busy across file boundaries instead of idling at the
+     * end of each file. Files are committed one at a time in order: a file's
+     * metadata is written only after all of its chunks, and a file that fails
+     * is rolled back without stopping the rest of the batch.
+     * 
+     * input_pattern: Directory (all *.parquet files in it), glob on the file
+     *                name such as data/part-*.parquet, or a single file
+     * output_dir: Directory where compressed files and metadata will be written
+     * options: Compression options applied to every file
+     * report: Optional pointer to receive per-file results and throughput figures
+     * 
+     * Return: true if every file was compressed, false otherwise
+     */
+    bool compressParquetBatch(const std::string& input_pattern,
+                            const std::string& output_dir,
+                            const CompressionOptions& options,
+                            BatchCompressionReport* report = nullptr);
+    
     /**
      * Decompresses a previously compressed Parquet file
      * 
@@ -163,6 +344,205 @@ public:
                              const std::string& output_file,
                              int threads = 0);
     
+    /**
+     * Decompresses a previously compressed Parquet file with full control over the options
+     * 
+     * input_dir: Directory containing compressed files and metadata
+     * output_file: Path where the decompressed Parquet file will be written
+     * options: Decompression options, including the per-stage pipeline settings
+     * 
+     * Return: true on success, false on failure
+     */
+    bool decompressParquetFile(const std::string& input_dir,
+                             const std::string& output_file,
+                             const DecompressionOptions& options);
+    
+    /**
+     * Compresses a Parquet file into a single-stream archive
+     * 
+     * The archive is one file written strictly front to back: a header with
+     * the schema, one frame per column chunk and a trailing frame index, so
+     * it can go to a pipe or a multipart upload. Frames are written as the
+     * pipeline encodes them, so memory stays bounded by the pipeline queues.
+     * No metadata file is generated. Parquet keeps its footer at the end, so
+     * input read from standard input is spooled to a temporary file first.
+     * 
+     * input_file: Path to the input Parquet file ("-" for standard input)
+     * output_file: Path of the archive ("-" for standard output)
+     * options: Compression options; the metadata options are ignored
+     * 
+     * Return: true on success, false on failure
+     */
+    bool compressToStream(const std::string& input_file,
+                          const std::string& output_file,
+                          const CompressionOptions& options);
+    
+    /**
+     * Decompresses a single-stream archive written by compressToStream
+     * 
+     * The archive is read front to back and each row group is written as
+     * soon as its columns are decoded, so the output can go to a pipe and
+     * memory stays bounded by a few row groups.
+     * 
+     * input_file: Path of the archive ("-" for standard input)
+     * output_file: Path of the output ("-" for standard output)
+     * options: Decompression options; output_format selects Parquet or an Arrow IPC stream
+     * 
+     * Return: true on success, false on failure
+     */
+    bool decompressFromStream(const std::string& input_file,
+                              const std::string& output_file,
+                              const DecompressionOptions& options);
+    
+    /**
+     * Verifies a compressed archive against its chunk checksums
+     * 
+     * Compression records an XXH3 checksum of every chunk file and of its
+     * decoded data. Verification hashes the chunk files in parallel without
+     * decoding them; with full_decode each chunk is also decoded and the
+     * result checked against the original column data.
+     * 
+     * input_dir: Path of the archive's metadata file
+     * options: Verification options
+     * report: Optional pointer to receive the counts and the corrupt chunks
+     * 
+     * Return: true if every chunk is intact, false otherwise
+     */
+    bool verifyArchive(const std::string& input_dir,
+                       const VerifyOptions& options,
+                       VerificationReport* report = nullptr);
+    
+    /**
+     * Opens a previously compressed Parquet file as a stream of Arrow record batches
+     * 
+     * Each selected row group becomes one record batch holding the selected
+     * columns, so callers can consume the data without a Parquet file being
+     * written. Chunks are decoded on the staged pipeline by a background
+     * thread, which stays at most prefetch_depth batches ahead of the reader.
+     * Fixed-width columns are handed over without copying. The progress
+     * callback is called from the background thread. Closing or destroying
+     * the reader stops the decoding.
+     * 
+     * input_dir: Directory containing compressed files and metadata
+     * options: Decompression options; columns and row_groups select the data,
+     *          the output codec settings are ignored
+     * prefetch_depth: Number of decoded batches that may wait for the reader (at least 1)
+     * 
+     * Return: The reader, or nullptr on failure (see getLastError)
+     */
+    std::shared_ptr<arrow::RecordBatchReader> openDecompressedStream(const std::string& input_dir,
+                                                                    const DecompressionOptions& options = DecompressionOptions(),
+                                                                    int prefetch_depth = 2);
+    
+    /**
+     * Reads a range of rows of one column without decoding the whole chunk
+     * 
+     * Column chunks are stored as frames of about seek_frame_size uncompressed
+     * bytes that decode independently, with the row count of every frame in
+     * the chunk header. Only the frames covering the requested rows are read
+     * and decoded; chunks stored as a single frame are decoded whole.
+     * 
+     * input_dir: Path of the archive's metadata file
+     * row_group: Index of the row group
+     * column: Name of the column
+     * first_row: First row to read, counted from the start of the row group
+     * row_count: Number of rows to read
+     * 
+     * Return: A record batch holding the one column, or nullptr on failure (see getLastError)
+     */
+    std::shared_ptr<arrow::RecordBatch> readRange(const std::string& input_dir,
+                                                  int row_group,
+                                                  const std::string& column,
+                                                  uint64_t first_row,
+                                                  uint64_t row_count);
+    
+    /**
+     * Compresses a Parquet file on the shared executor
+     * 
+     * The job runs with a snapshot of this instance's settings (progress
+     * callback, verbose mode), so several jobs can run at once and the instance
+     * may be destroyed before they finish. The progress callback is called
+     * from the executor thread.
+     * 
+     * input_file: Path to the input Parquet file
+     * output_dir: Directory where compressed files and metadata will be written
+     * options: Compression options
+     * token: Token to cancel the job with
+     * on_complete: Optional function to call when the job finishes
+     * 
+     * Return: Future receiving the outcome of the job
+     */
+    std::future<JobResult> compressParquetFileAsync(const std::string& input_file,
+                                                   const std::string& output_dir,
+                                                   const CompressionOptions& options,
+                                                   CancellationToken token = CancellationToken(),
+                                                   CompletionCallback on_complete = nullptr);
+    
+    /**
+     * Decompresses a previously compressed Parquet file on the shared executor
+     * 
+     * input_dir: Directory containing compressed files and metadata
+     * output_file: Path where the decompressed Parquet file will be written
+     * options: Decompression options
+     * token: Token to cancel the job with
+     * on_complete: Optional function to call when the job finishes
+     * 
+     * Return: Future receiving the outcome of the job
+     */
+    std::future<JobResult> decompressParquetFileAsync(const std::string& input_dir,
+                                                     const std::string& output_file,
+                                                     const DecompressionOptions& options,
+                                                     CancellationToken token = CancellationToken(),
+                                                     CompletionCallback on_complete = nullptr);
+    
+    /**
+     * Queries metadata on the shared executor
+     * 
+     * Cancellation is checked before the query starts.
+     * 
+     * input_dir: Directory containing compressed files and metadata
+     * query: SQL-like query to execute against the metadata
+     * token: Token to cancel the job with
+     * on_complete: Optional function to call when the job finishes
+     * 
+     * Return: Future receiving the outcome; the query results are in JobResult::output
+     */
+    std::future<JobResult> queryMetadataAsync(const std::string& input_dir,
+                                             const std::string& query,
+                                             CancellationToken token = CancellationToken(),
+                                             CompletionCallback on_complete = nullptr);
+    
+    /**
+     * Sets the number of threads of the executor shared by all instances
+     * 
+     * This limits how many asynchronous jobs run at the same time; further
+     * jobs wait in the executor's queue.
+     * 
+     * threads: Maximum number of concurrent jobs (0 = number of available CPU cores)
+     */
+    static void setAsyncThreads(int threads);
+    
+    /**
+     * Sets the capacity of the decompressed chunk cache shared by all instances
+     * 
+     * Decompression, the record batch reader and readRange look chunks up
+     * here before reading and decoding them, keyed by archive, row group and
+     * column, so repeated access to hot columns skips the LZMA decoder. The
+     * cache is split into independently locked shards, each evicting its least
+     * recently used chunks; chunks in use are pinned and never evicted.
+     * Compressing into an archive drops its cached chunks.
+     * 
+     * bytes: Capacity in decompressed bytes (0 disables the cache, the default)
+     */
+    static void setChunkCacheCapacity(uint64_t bytes);
+    
+    /**
+     * Gets the counters of the decompressed chunk cache
+     * 
+     * Return: Hit, miss, insertion and eviction counts and the current size
+     */
+    static ChunkCacheStatistics getChunkCacheStatistics();
+    
     /**
      * Adds a custom metadata item based on an SQL query
      * 
@@ -222,6 +602,17 @@ public:
      */
     void setVerbose(bool verbose);
     
+    /**
+     * Sets the memory limit of the LZMA codec
+     * 
+     * Applies to the jobs this instance runs afterwards, including asynchronous
+     * ones, which take a copy when they are started. A chunk whose decoded data
+     * and decoder do not fit is rejected instead of being decompressed.
+     * 
+     * bytes: Memory limit in bytes (0 for no limit)
+     */
+    void setCodecMemoryLimit(uint64_t bytes);
+    
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -0,0 +1,85 @@
+/**
+ * job_executor.h
+ * 
+ * This header file defines the job executor shared by the asynchronous
+ * InfParquet API. Jobs are queued and run on a bounded pool of worker
+ * threads, so a service can keep many compressions and queries in flight
+ * without dedicating an OS thread to each of them.
+ */
+
+#ifndef INFPARQUET_JOB_EXECUTOR_H
+#define INFPARQUET_JOB_EXECUTOR_H
+
+#include <functional>
+#include <memory>
+#include <cstddef>
+
+namespace infparquet {
+
+/**
+ * Class running jobs on a shared pool of worker threads
+ * 
+ * Workers start on demand, up to the thread limit, and stay alive for later
+ * jobs. Job threads mostly coordinate: the CPU-heavy work inside a job draws
+ * its threads from the process-wide CPU budget, so the limit bounds the number
+ * of concurrent jobs rather than the CPU use.
+ */
+class JobExecutor {
+public:
+    /**
+     * Gets the executor shared by all InfParquet instances
+     * 
+     * Return: The shared executor
+     */
+    static JobExecutor& shared();
+    
+    /**
+     * Destructor
+     * 
+     * Lets running jobs finish and discards jobs that have not started
+     */
+    ~JobExecutor();
+    
+    JobExecutor(const JobExecutor&) = delete;
+    JobExecutor& operator=(const JobExecutor&) = delete;
+    
+    /**
+     * Queues a job
+     * 
+     * job: Function to run on a worker thread
+     */
+    void submit(std::function<void()> job);
+    
+    /**
+     * Sets the maximum number of worker threads
+     * 
+     * Lowering the limit does not stop workers that are already running.
+     * 
+     * threads: Maximum number of workers (0 = number of available CPU cores)
+     */
+    void setThreadLimit(unsigned int threads);
+    
+    /**
+     * Gets the maximum number of worker threads
+     * 
+     * Return: Maximum number of workers
+     */
+    unsigned int getThreadLimit() const;
+    
+    /**
+     * Gets the number of queued jobs that have not started yet
+     * 
+     * Return: Number of pending jobs
+     */
+    size_t getPendingJobs() const;
+    
+private:
+    JobExecutor();
+    
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace infparquet
+
+#endif /* INFPARQUET_JOB_EXECUTOR_H */
@@ -0,0 +1,173 @@
+/**
+ * bloom_filter.h
+ *
+ * This header file defines the split-block Bloom filter used to prune row
+ * groups on equality predicates such as customer_id = 123456, which min/max
+ * statistics cannot answer for high-cardinality columns. The layout and
+ * hashing follow the Parquet specification: values are hashed with XXH64
+ * over their plain encoding, the upper 32 bits of the hash pick a 256-bit
+ * block and the lower 32 bits set one bit in each of the block's eight
+ * 32-bit words, so a probe touches one cache line and maps onto one 256-bit
+ * vector operation.
+ */
+
+#ifndef INFPARQUET_BLOOM_FILTER_H
+#define INFPARQUET_BLOOM_FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../core/parquet_structure.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 32-bit words per block, one bit set in each per value */
+#define BLOOM_FILTER_BLOCK_WORDS 8
+
+/* Bytes per block */
+#define BLOOM_FILTER_BLOCK_BYTES (BLOOM_FILTER_BLOCK_WORDS * 4)
+
+/* False-positive rate a filter is sized for when none is configured */
+#define BLOOM_FILTER_DEFAULT_FPP 0.01
+
+/* Largest filter per column chunk when none is configured */
+#define BLOOM_FILTER_DEFAULT_MAX_BYTES (1024 * 1024)
+
+/**
+ * A block: eight 32-bit words, 256 bits
+ */
+typedef struct {
+    uint32_t words[BLOOM_FILTER_BLOCK_WORDS];
+} BloomFilterBlock;
+
+/**
+ * Split-block Bloom filter
+ */
+typedef struct {
+    uint32_t block_count;       /* Number of blocks; 0 for no filter */
+    BloomFilterBlock* blocks;   /* Blocks, owned by the filter */
+} BloomFilter;
+
+/**
+ * Get the size of a filter holding a number of distinct values
+ *
+ * distinct_count: Expected number of distinct values
+ * fpp: Target false-positive rate, between 0 and 1 exclusive
+ * max_bytes: Largest size allowed (0 = BLOOM_FILTER_DEFAULT_MAX_BYTES)
+ *
+ * Return: Size in bytes, a multiple of BLOOM_FILTER_BLOCK_BYTES
+ */
+size_t bloom_filter_optimal_bytes(uint64_t distinct_count, double fpp, size_t max_bytes);
+
+/**
+ * Create an empty filter
+ *
+ * filter: Filter to initialize
+ * bytes: Size in bytes, rounded up to whole blocks
+ *
+ * Return: 0 on success, 1 for invalid parameters, 2 if out of memory
+ */
+int bloom_filter_init(BloomFilter* filter, size_t bytes);
+
+/**
+ * Release the blocks of a filter, leaving an empty filter
+ *
+ * filter: Filter to release (can be NULL)
+ */
+void bloom_filter_free(BloomFilter* filter);
+
+/**
+ * Hash a value given as bytes (the plain encoding of the value)
+ *
+ * value: Bytes of the value
+ * length: Number of bytes
+ *
+ * Return: XXH64 of the bytes with seed 0
+ */
+uint64_t bloom_filter_hash(const void* value, size_t length);
+
+/**
+ * Hash a query literal as a value of a column type
+ *
+ * Integers are parsed in base 10, floating-point values with strtod; string
+ * columns hash the literal's bytes.
+ *
+ * literal: Text of the value
+ * type: Type of the column
+ * hash: Receives the hash
+ *
+ * Return: 0 on success, 1 if the literal is not a value of the type or the type has no filters
+ */
+int bloom_filter_hash_literal(const char* literal, ParquetValueType type, uint64_t* hash);
+
+/**
+ * Insert a hash
+ *
+ * filter: The filter
+ * hash: Hash of the value
+ */
+void bloom_filter_insert(BloomFilter* filter, uint64_t hash);
+
+/**
+ * Check whether a hash may have been inserted
+ *
+ * filter: The filter
+ * hash: Hash of the value
+ *
+ * Return: false if the value was certainly never inserted
+ */
+bool bloom_filter_check(const BloomFilter* filter, uint64_t hash);
+
+/**
+ * Insert an array of fixed-width values
+ *
+ * NaN values are skipped like nulls and -0.0 is inserted as 0.0, so that
+ * equal floating-point values always share a hash.
+ *
+ * filter: The filter
+ * values: Values, stored as int32_t, int64_t, float or double
+ * value_count: Number of values
+ * type: PARQUET_INT32, PARQUET_INT64, PARQUET_FLOAT or PARQUET_DOUBLE
+ *
+ * Return: 0 on success, 1 for invalid parameters or an unsupported type
+ */
+int bloom_filter_add_values(BloomFilter* filter, const void* values, uint64_t value_count,
+                            ParquetValueType type);
+
+/**
+ * Encode a filter as base64 text
+ *
+ * filter: The filter
+ * text: Buffer receiving the null-terminated text
+ * capacity: Size of the buffer; bloom_filter_encoded_size() bytes always suffice
+ *
+ * Return: Length of the text, or 0 if the buffer is too small
+ */
+size_t bloom_filter_encode(const BloomFilter* filter, char* text, size_t capacity);
+
+/**
+ * Get the buffer size bloom_filter_encode needs for a filter
+ *
+ * filter: The filter
+ *
+ * Return: Bytes, including the terminator
+ */
+size_t bloom_filter_encoded_size(const BloomFilter* filter);
+
+/**
+ * Decode a filter encoded by bloom_filter_encode
+ *
+ * filter: Filter receiving the blocks; released first
+ * text: Encoded text
+ *
+ * Return: 0 on success, 1 if the text is not a valid filter, 2 if out of memory
+ */
+int bloom_filter_decode(BloomFilter* filter, const char* text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_BLOOM_FILTER_H */
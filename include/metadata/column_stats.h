@@ -0,0 +1,84 @@
+/**
+ * column_stats.h
+ *
+ * This header file defines the kernels computing minimum, maximum, sum and
+ * null counts of fixed-width columns for numeric and timestamp metadata.
+ * Each physical type has a scalar kernel and, on x86, AVX2 and AVX-512
+ * kernels; the widest one the CPU supports is chosen at run time. All
+ * kernels accumulate floating-point sums in the same eight lanes in the same
+ * order, so they return bit-identical results.
+ */
+
+#ifndef INFPARQUET_COLUMN_STATS_H
+#define INFPARQUET_COLUMN_STATS_H
+
+#include <stdint.h>
+#include "../core/parquet_structure.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Kernel families
+ */
+typedef enum {
+    COLUMN_STATS_AUTO = 0,      /* Widest kernel supported by the CPU */
+    COLUMN_STATS_SCALAR,
+    COLUMN_STATS_AVX2,
+    COLUMN_STATS_AVX512
+} ColumnStatsKernel;
+
+/**
+ * Statistics of a column
+ */
+typedef struct {
+    double min;            /* Smallest value counted (0 if none) */
+    double max;            /* Largest value counted (0 if none) */
+    double sum;            /* Sum of the values counted */
+    int64_t int_min;       /* Exact smallest value of integer and boolean columns */
+    int64_t int_max;       /* Exact largest value of integer and boolean columns */
+    uint64_t count;        /* Values counted */
+    uint64_t null_count;   /* Values skipped: null in the validity bitmap, or NaN */
+} ColumnStats;
+
+/**
+ * Compute the statistics of a column
+ *
+ * values: Values back to back, as in the layout of arrow_read_column_data
+ *         (booleans take one byte each)
+ * value_count: Number of values
+ * type: Physical type (BOOLEAN, INT32, INT64, FLOAT or DOUBLE)
+ * validity: Arrow validity bitmap, least significant bit first (NULL if every value is valid)
+ * stats: Pointer to receive the statistics
+ *
+ * Return: 0 on success, 1 for invalid parameters or types
+ */
+int column_stats_compute(const void* values, uint64_t value_count, ParquetValueType type,
+                         const uint8_t* validity, ColumnStats* stats);
+
+/**
+ * Compute the statistics of a column with a given kernel
+ *
+ * Falls back to the scalar kernel if the CPU or the build lacks the requested one.
+ *
+ * kernel: Kernel family to use
+ * values, value_count, type, validity, stats: As for column_stats_compute
+ *
+ * Return: 0 on success, 1 for invalid parameters or types
+ */
+int column_stats_compute_with_kernel(ColumnStatsKernel kernel, const void* values, uint64_t value_count,
+                                     ParquetValueType type, const uint8_t* validity, ColumnStats* stats);
+
+/**
+ * Get the kernel family column_stats_compute uses on this CPU
+ *
+ * Return: COLUMN_STATS_SCALAR, COLUMN_STATS_AVX2 or COLUMN_STATS_AVX512
+ */
+ColumnStatsKernel column_stats_best_kernel(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_COLUMN_STATS_H */
@@ -0,0 +1,118 @@
+/**
+ * heavy_hitters.h
+ *
+ * This header file defines the Space-Saving sketch used to find the most
+ * frequent strings of string columns. The sketch monitors a fixed number of
+ * strings, identified by a 64-bit hash, and replaces the least frequent one
+ * whenever an unmonitored string arrives, in constant time per string.
+ * Sketches of different row groups or files can be merged without losing
+ * their error guarantees.
+ */
+
+#ifndef INFPARQUET_HEAVY_HITTERS_H
+#define INFPARQUET_HEAVY_HITTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default number of strings monitored by a sketch */
+#define HEAVY_HITTERS_DEFAULT_COUNTERS 1024
+
+/* Bytes of each string kept for reporting; longer strings are truncated but hashed in full */
+#define HEAVY_HITTERS_MAX_VALUE_LENGTH 255
+
+/**
+ * Space-Saving sketch (opaque)
+ */
+typedef struct HeavyHitterSketch HeavyHitterSketch;
+
+/**
+ * A monitored string
+ *
+ * The true number of occurrences lies in [count - error, count].
+ */
+typedef struct {
+    const char* value;     /* NUL-terminated string, valid until the sketch changes */
+    uint64_t count;        /* Estimated occurrences, never below the true count */
+    uint64_t error;        /* Occurrences the estimate may exceed the true count by */
+} HeavyHitter;
+
+/**
+ * Create a sketch
+ *
+ * A sketch of k counters over n strings lists every string occurring more
+ * than n / k times, and overestimates each count by at most n / k.
+ *
+ * counters: Strings monitored (0 for HEAVY_HITTERS_DEFAULT_COUNTERS)
+ *
+ * Return: The sketch, or NULL if out of memory
+ */
+HeavyHitterSketch* heavy_hitters_create(uint32_t counters);
+
+/**
+ * Free a sketch
+ *
+ * sketch: Sketch to free (may be NULL)
+ */
+void heavy_hitters_free(HeavyHitterSketch* sketch);
+
+/**
+ * Empty a sketch for reuse
+ *
+ * sketch: Sketch to empty; its counters stay allocated
+ */
+void heavy_hitters_reset(HeavyHitterSketch* sketch);
+
+/**
+ * Count one occurrence of a string
+ *
+ * sketch: The sketch
+ * value: String bytes
+ * length: Length of the string in bytes
+ */
+void heavy_hitters_add(HeavyHitterSketch* sketch, const char* value, size_t length);
+
+/**
+ * Merge another sketch into a sketch
+ *
+ * The result carries the same guarantees as a sketch of the same size that
+ * had seen the strings of both.
+ *
+ * sketch: Sketch receiving the strings
+ * other: Sketch to merge (left unchanged; must differ from sketch)
+ *
+ * Return: 0 on success, 1 for invalid parameters, 2 if out of memory
+ */
+int heavy_hitters_merge(HeavyHitterSketch* sketch, const HeavyHitterSketch* other);
+
+/**
+ * Get the number of strings counted by a sketch
+ *
+ * sketch: The sketch
+ *
+ * Return: Strings counted, including those of merged sketches
+ */
+uint64_t heavy_hitters_total(const HeavyHitterSketch* sketch);
+
+/**
+ * Get the most frequent strings of a sketch
+ *
+ * Strings are ordered by decreasing count, then by increasing error.
+ *
+ * sketch: The sketch
+ * items: Array receiving the strings
+ * max_items: Capacity of the array
+ *
+ * Return: Number of strings written
+ */
+uint32_t heavy_hitters_top(const HeavyHitterSketch* sketch, HeavyHitter* items, uint32_t max_items);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_HEAVY_HITTERS_H */
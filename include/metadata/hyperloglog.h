@@ -0,0 +1,120 @@
+/**
+ * hyperloglog.h
+ *
+ * This header file defines the HyperLogLog sketch used to estimate the number
+ * of distinct values of a column. A sketch is a fixed array of registers kept
+ * inside the column metadata, so the sketches of column chunks can be merged
+ * into the distinct count of a whole file, or of several files, without
+ * reading the data again.
+ */
+
+#ifndef INFPARQUET_HYPERLOGLOG_H
+#define INFPARQUET_HYPERLOGLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../core/parquet_structure.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bits of the hash selecting a register; the standard error is 1.04 / sqrt(2^precision), about 1.6% */
+#define HYPERLOGLOG_PRECISION 12
+
+/* Number of registers of a sketch */
+#define HYPERLOGLOG_REGISTERS (1u << HYPERLOGLOG_PRECISION)
+
+/* Buffer size that holds any encoded sketch, including the terminating NUL */
+#define HYPERLOGLOG_ENCODED_SIZE (HYPERLOGLOG_REGISTERS + 1)
+
+/**
+ * HyperLogLog sketch
+ *
+ * All sketches share one precision, so any two of them can be merged.
+ */
+typedef struct {
+    uint8_t registers[HYPERLOGLOG_REGISTERS];  /* Longest run of leading zero hash bits per register, plus one */
+} HyperLogLog;
+
+/**
+ * Initialize an empty sketch
+ *
+ * sketch: Sketch to initialize
+ */
+void hyperloglog_init(HyperLogLog* sketch);
+
+/**
+ * Add a value given as bytes
+ *
+ * sketch: The sketch
+ * value: Value bytes
+ * length: Length of the value in bytes
+ */
+void hyperloglog_add(HyperLogLog* sketch, const void* value, size_t length);
+
+/**
+ * Add an array of fixed-width values
+ *
+ * Integers are compared by value, floating-point values by their value as a
+ * double, with -0.0 equal to 0.0; NaN values are skipped like nulls.
+ *
+ * sketch: The sketch
+ * values: Values, stored as bool, int32_t, int64_t, float or double
+ * value_count: Number of values
+ * type: PARQUET_BOOLEAN, PARQUET_INT32, PARQUET_INT64, PARQUET_FLOAT or PARQUET_DOUBLE
+ *
+ * Return: 0 on success, 1 for invalid parameters or an unsupported type
+ */
+int hyperloglog_add_values(HyperLogLog* sketch, const void* values, uint64_t value_count,
+                           ParquetValueType type);
+
+/**
+ * Merge another sketch into a sketch
+ *
+ * The result is the sketch of the union of both value sets.
+ *
+ * sketch: Sketch receiving the values
+ * other: Sketch to merge
+ */
+void hyperloglog_merge(HyperLogLog* sketch, const HyperLogLog* other);
+
+/**
+ * Estimate the number of distinct values added to a sketch
+ *
+ * sketch: The sketch
+ *
+ * Return: Estimated number of distinct values (0 for an empty sketch)
+ */
+uint64_t hyperloglog_estimate(const HyperLogLog* sketch);
+
+/**
+ * Encode a sketch as text
+ *
+ * Each register becomes one base64url character; runs of equal registers,
+ * such as the empty registers of a column with few distinct values, are
+ * shortened to the character, '*' and the run length.
+ *
+ * sketch: The sketch
+ * text: Buffer receiving the NUL-terminated text
+ * capacity: Size of the buffer (HYPERLOGLOG_ENCODED_SIZE always suffices)
+ *
+ * Return: Length of the text, or 0 if the buffer is too small
+ */
+size_t hyperloglog_encode(const HyperLogLog* sketch, char* text, size_t capacity);
+
+/**
+ * Decode a sketch encoded by hyperloglog_encode
+ *
+ * sketch: Sketch receiving the registers
+ * text: NUL-terminated text
+ *
+ * Return: 0 on success, 1 if the text is not a valid sketch
+ */
+int hyperloglog_decode(HyperLogLog* sketch, const char* text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_HYPERLOGLOG_H */
@@ -123,6 +123,17 @@ bool extract_json_bool(const char* json, bool* result);
  */
 int parse_string_array(const char* json, char** strings, uint32_t* counts, int max_count);
 
+/**
+ * Parse an array of unsigned integers from a JSON string
+ * 
+ * json: The JSON string containing the array
+ * values: Array to store the values
+ * max_count: Maximum number of values to parse
+ * 
+ * Return: Number of values parsed, or -1 on error
+ */
+int parse_uint64_array(const char* json, uint64_t* values, int max_count);
+
 /**
  * Parse a metadata item from a JSON string
  * 
@@ -148,18 +159,6 @@ void set_error(const char* format, ...);
  */
 const char* json_helper_get_error();
 
-/**
- * Serialize metadata to JSON
- * 
- * This function serializes metadata to a JSON string.
- * 
- * metadata: The metadata to serialize
- * 
- * Return: A newly allocated string containing the JSON representation,
- *         or NULL if serialization fails
- */
-char* json_serialization_metadata_to_json(const Metadata* metadata);
-
 /**
  * Serialize metadata to a JSON file
  * 
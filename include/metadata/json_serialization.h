@@ -40,7 +40,7 @@ JsonSerializationError json_serialization_metadata_to_json(
  * 
  * This function parses a JSON string into a metadata structure.
  * The caller is responsible for freeing the returned metadata using
- * metadata_generator_free_metadata.
+ * metadata_release.
  * 
  * json_string: JSON string to parse
  * metadata: Pointer to store the parsed metadata structure
@@ -72,7 +72,7 @@ JsonSerializationError json_serialization_save_to_binary(
  * 
  * This function reads a binary file created with json_serialization_save_to_binary
  * and parses it into a metadata structure. The caller is responsible for
- * freeing the returned metadata using metadata_generator_free_metadata.
+ * freeing the returned metadata using metadata_release.
  * 
  * file_path: Path to the binary file
  * metadata: Pointer to store the parsed metadata structure
@@ -96,7 +96,8 @@ void json_serialization_free_string(char* json_string);
  * Get the last error message from JSON serialization operations
  * 
  * This function returns a string describing the last error that occurred.
- * The returned string is valid until the next call to any JSON serialization function.
+ * The returned string is valid until the next call to any JSON serialization function
+ * on the same thread.
  * 
  * returns: A string describing the last error, or NULL if no error occurred
  */
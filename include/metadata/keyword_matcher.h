@@ -0,0 +1,112 @@
+/**
+ * keyword_matcher.h
+ *
+ * This header file defines the keyword matcher used to find special strings
+ * (strings containing keywords such as "error" or "crash") in string columns.
+ * All keywords are compiled into one Aho-Corasick automaton that ignores
+ * ASCII case, so each string is scanned once, one table lookup per byte,
+ * however many keywords there are.
+ */
+
+#ifndef INFPARQUET_KEYWORD_MATCHER_H
+#define INFPARQUET_KEYWORD_MATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compiled keyword list (opaque)
+ *
+ * A matcher is never modified after creation, so threads may share it.
+ */
+typedef struct KeywordMatcher KeywordMatcher;
+
+/**
+ * Per-keyword counts of the strings scanned
+ */
+typedef struct {
+    uint64_t* counts;      /* Strings containing each keyword, in keyword order */
+    uint64_t* last_seen;   /* Serial of the last string counted for each keyword */
+    uint64_t serial;       /* Serial of the last string scanned */
+    uint32_t keyword_count;
+} KeywordCounts;
+
+/**
+ * Compile a keyword list
+ *
+ * Matching ignores ASCII case. Empty and NULL keywords never match.
+ *
+ * keywords: Keywords to find
+ * keyword_count: Number of keywords
+ *
+ * Return: The matcher, or NULL if out of memory
+ */
+KeywordMatcher* keyword_matcher_create(const char* const* keywords, uint32_t keyword_count);
+
+/**
+ * Free a matcher
+ *
+ * matcher: Matcher to free (may be NULL)
+ */
+void keyword_matcher_free(KeywordMatcher* matcher);
+
+/**
+ * Get the number of keywords of a matcher
+ *
+ * matcher: The matcher
+ *
+ * Return: Number of keywords, including those that never match
+ */
+uint32_t keyword_matcher_keyword_count(const KeywordMatcher* matcher);
+
+/**
+ * Get a keyword of a matcher
+ *
+ * matcher: The matcher
+ * index: Keyword index
+ *
+ * Return: The keyword as given, or NULL if the index is out of range
+ */
+const char* keyword_matcher_keyword(const KeywordMatcher* matcher, uint32_t index);
+
+/**
+ * Scan a string for keywords
+ *
+ * Each keyword found is counted once per string, however often it occurs.
+ *
+ * matcher: The matcher
+ * text: String bytes
+ * length: Length of the string in bytes
+ * counts: Counts to update (NULL to stop at the first keyword found)
+ *
+ * Return: Number of distinct keywords found (with counts NULL, 1 if any keyword occurs)
+ */
+uint32_t keyword_matcher_scan(const KeywordMatcher* matcher, const char* text, size_t length,
+                              KeywordCounts* counts);
+
+/**
+ * Allocate zeroed counts for the keywords of a matcher
+ *
+ * counts: Counts to initialize
+ * matcher: The matcher
+ *
+ * Return: 0 on success, 1 for invalid parameters, 2 if out of memory
+ */
+int keyword_counts_init(KeywordCounts* counts, const KeywordMatcher* matcher);
+
+/**
+ * Free counts
+ *
+ * counts: Counts to free
+ */
+void keyword_counts_free(KeywordCounts* counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_KEYWORD_MATCHER_H */
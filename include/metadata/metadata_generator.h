@@ -22,6 +22,10 @@ extern "C" {
  * (using the MetadataGeneratorError enum)
  */
 
+/* Keywords marking special strings when the options do not configure any */
+extern const char* const METADATA_DEFAULT_SPECIAL_KEYWORDS[];
+#define METADATA_DEFAULT_SPECIAL_KEYWORD_COUNT 11
+
 /**
  * Options for metadata generation
  */
@@ -32,6 +36,18 @@ typedef struct {
     uint32_t max_high_freq_strings;        /* Maximum number of high-frequency strings to track */
     uint32_t max_special_strings;          /* Maximum number of special strings to track */
     uint32_t max_high_freq_categories;     /* Maximum number of high-frequency categories to track */
+    uint64_t mode_exact_limit;             /* Distinct values per column counted exactly for the mode (0 = no limit) */
+    uint32_t mode_sketch_counters;         /* Counters of the Misra-Gries mode estimate used above that limit */
+    uint32_t string_sketch_counters;       /* Strings monitored per sketch when finding high-frequency strings */
+    const char* const* special_keywords;   /* Keywords marking special strings, matched ignoring case */
+    uint32_t special_keyword_count;        /* Number of special keywords */
+    const char* const* bloom_filter_columns; /* Columns given per-row-group Bloom filters, by name (NULL = none) */
+    uint32_t bloom_filter_column_count;    /* Number of Bloom filter columns */
+    double bloom_filter_fpp;               /* False-positive rate the Bloom filters are sized for */
+    uint32_t bloom_filter_max_bytes;       /* Largest Bloom filter per column chunk */
+    uint32_t thread_count;                 /* Threads analyzing column chunks (0 = automatic) */
+    bool use_footer_statistics;            /* Answer numeric and timestamp chunks from footer statistics when present */
+    double sample_rate;                    /* Fraction of each row group's rows string and mode statistics are estimated from (1 = every row) */
 } MetadataGeneratorOptions;
 
 /**
@@ -53,7 +69,7 @@ void metadata_generator_init_options(MetadataGeneratorOptions* options);
  */
 MetadataGeneratorError metadata_generator_generate(
     const ParquetFile* file,
-    void* reader_context,
+    ParquetReaderContext* reader_context,
     const MetadataGeneratorOptions* options,
     Metadata** metadata
 );
@@ -98,7 +114,11 @@ Metadata* metadata_generator_generate_row_group_metadata(
 /**
  * Save metadata to a file
  * 
- * metadata: Pointer to metadata structure to save
+ * The metadata is written as JSON: the file-level items, each row group's
+ * aggregates and Bloom filters, and each column's aggregates merged across
+ * the row groups.
+ * 
+ * metadata: File metadata generated by metadata_generator_generate
  * file_path: Path where the metadata will be saved
  * 
  * Returns: Error code (METADATA_GEN_OK on success)
@@ -111,6 +131,9 @@ MetadataGeneratorError metadata_generator_save_metadata(
 /**
  * Load metadata from a file
  * 
+ * The loaded metadata is a plain Metadata tree, released with metadata_release
+ * rather than metadata_generator_free_metadata.
+ * 
  * file_path: Path to the metadata file
  * metadata: Pointer to store the loaded metadata
  * 
@@ -128,6 +151,58 @@ MetadataGeneratorError metadata_generator_load_metadata(
  */
 void metadata_generator_free_metadata(Metadata* metadata);
 
+/**
+ * Merge the distinct-value sketches of a column's chunks into a sketch
+ * 
+ * Merging the metadata of several files into one sketch gives the distinct
+ * values of the column across all of them.
+ * 
+ * metadata: Metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * sketch: Sketch receiving the column's distinct values
+ * 
+ * Returns: Error code (METADATA_GEN_OK on success, METADATA_GEN_INVALID_PARAMETER
+ *          if no row group has the column, METADATA_GEN_SKETCH_UNAVAILABLE if
+ *          some of its chunks were answered from footer statistics)
+ */
+MetadataGeneratorError metadata_generator_merge_distinct_sketch(
+    const Metadata* metadata,
+    int column_id,
+    HyperLogLog* sketch
+);
+
+/**
+ * Estimate the number of distinct values of a column across a file
+ * 
+ * metadata: Metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * 
+ * Returns: Estimated number of distinct values (0 if no row group has the column
+ *          or some of its chunks were answered from footer statistics)
+ */
+uint64_t metadata_generator_distinct_count(const Metadata* metadata, int column_id);
+
+/**
+ * Merge the quantile digests of a column's chunks into a digest
+ * 
+ * Numeric columns contribute their values and timestamp columns their
+ * timestamps in seconds. Merging the metadata of several files into one
+ * digest gives the quantiles of the column across all of them.
+ * 
+ * metadata: Metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * sketch: Digest receiving the column's values
+ * 
+ * Returns: Error code (METADATA_GEN_OK on success, METADATA_GEN_INVALID_PARAMETER
+ *          if no row group has the column, METADATA_GEN_SKETCH_UNAVAILABLE if
+ *          some of its chunks were answered from footer statistics)
+ */
+MetadataGeneratorError metadata_generator_merge_quantile_sketch(
+    const Metadata* metadata,
+    int column_id,
+    QuantileSketch* sketch
+);
+
 /**
  * Get the last error message from metadata generation operations
  * 
@@ -12,6 +12,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <time.h>
+#include "hyperloglog.h"
+#include "quantile_sketch.h"
+#include "bloom_filter.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,7 +53,8 @@ typedef enum {
     METADATA_GEN_INVALID_PARAMETER,
     METADATA_GEN_PARQUET_ERROR,
     METADATA_GEN_FILE_ERROR,
-    METADATA_GEN_CUSTOM_METADATA_ERROR
+    METADATA_GEN_CUSTOM_METADATA_ERROR,
+    METADATA_GEN_SKETCH_UNAVAILABLE       /* Some chunks were answered from footer statistics, without sketches */
 } MetadataGeneratorError;
 
 /**
@@ -89,6 +93,11 @@ typedef struct {
     uint64_t count;                     /* Number of timestamp values */
     uint32_t null_count;                /* Number of null timestamp values */
     bool has_timestamp_data;            /* Flag indicating presence of timestamp data */
+    time_t p50;                         /* Median timestamp */
+    time_t p95;                         /* 95th percentile timestamp */
+    time_t p99;                         /* 99th percentile timestamp */
+    QuantileSketch quantiles;           /* Digest of the timestamps in seconds, mergeable across chunks and files */
+    bool from_footer;                   /* Whether some values are known only from footer statistics: the percentiles are unavailable */
 } TimestampMetadata;
 
 /**
@@ -107,6 +116,7 @@ typedef struct {
     bool has_string_data;                                          /* Whether this metadata has string data */
     char high_frequency_strings[MAX_HIGH_FREQ_STRINGS][MAX_STRING_LENGTH];  /* Most frequent strings */
     int frequencies[MAX_HIGH_FREQ_STRINGS];                        /* Count of each high frequency string */
+    uint64_t frequency_errors[MAX_HIGH_FREQ_STRINGS];              /* How far each count may exceed the true count */
     uint32_t count;                                                /* Number of high frequency strings stored */
     uint32_t min_length;                                           /* Minimum string length */
     uint32_t max_length;                                           /* Maximum string length */
@@ -128,6 +138,13 @@ typedef struct {
         uint32_t count;
     } high_freq_strings[MAX_HIGH_FREQ_STRINGS];                    /* High frequency strings with counts */
     uint32_t high_freq_count;                                      /* Number of high frequency strings */
+    
+    // Row sampling: when set, the high frequency and special string counts are
+    // estimates scaled up from a sample of the rows
+    bool is_sampled;                                               /* Whether the counts were estimated from a row sample */
+    double sample_rate;                                            /* Fraction of the rows sampled */
+    uint64_t sample_errors[MAX_HIGH_FREQ_STRINGS];                 /* Error bound (about 95%) of each high frequency count */
+    uint32_t special_string_errors[MAX_SPECIAL_STRINGS];           /* Error bound (about 95%) of each special string count */
 } StringMetadata;
 
 /**
@@ -144,6 +161,15 @@ typedef struct {
     uint64_t mode_count;                /* Count of the mode value */
     uint64_t total_count;               /* Total number of values */
     uint32_t null_count;                /* Number of null values */
+    uint64_t count;                     /* Number of non-null values the mean covers (0 if the mean is unavailable) */
+    double p50;                         /* Median (50th percentile) */
+    double p95;                         /* 95th percentile */
+    double p99;                         /* 99th percentile */
+    QuantileSketch quantiles;           /* Digest of the values, mergeable across chunks and files */
+    bool mode_is_sampled;               /* Whether the mode was estimated from a row sample */
+    double mode_sample_rate;            /* Fraction of the rows the mode was estimated from */
+    uint64_t mode_count_error;          /* Error bound (about 95%) of the estimated mode count */
+    bool from_footer;                   /* Whether some values are known only from footer statistics: mean, mode and percentiles are unavailable */
 } NumericMetadata;
 
 /**
@@ -157,6 +183,8 @@ typedef struct {
     uint32_t high_freq_category_count;                              /* Number of high frequency categories stored */
     uint32_t total_category_count;                                  /* Total number of distinct categories */
     uint64_t total_value_count;                                     /* Total number of values */
+    uint64_t distinct_count;                                        /* Estimated number of distinct values */
+    HyperLogLog distinct_sketch;                                    /* Sketch of the distinct values, mergeable across chunks and files */
 } CategoricalMetadata;
 
 /**
@@ -203,16 +231,29 @@ typedef struct {
     bool use_basic_metadata;                          /* Whether to use basic metadata */
 } FileMetadata;
 
+/**
+ * Structure for the Bloom filter of one column chunk
+ */
+typedef struct {
+    uint32_t column_index;                            /* Index of the column */
+    char column_name[MAX_METADATA_ITEM_NAME_LENGTH];  /* Name of the column */
+    ParquetValueType value_type;                      /* Type the values were hashed as */
+    BloomFilter filter;                               /* Filter of the chunk's values */
+} ColumnBloomFilter;
+
 /**
  * Structure for row group metadata
  */
 typedef struct {
     uint32_t row_group_index;                         /* Index of the row group */
+    uint64_t row_count;                               /* Number of rows in the row group */
     uint32_t metadata_count;                          /* Number of metadata items */
     MetadataItem* metadata;                           /* Array of metadata items */
     BaseMetadata* base_metadata;                      /* Base metadata for this row group */
     uint32_t column_count;                            /* Number of columns in this row group */
     struct ColumnMetadata** columns;                  /* Array of column metadata */
+    uint32_t bloom_filter_count;                      /* Number of Bloom filters */
+    ColumnBloomFilter* bloom_filters;                 /* Bloom filters of the columns that opted in */
 } RowGroupMetadata;
 
 /**
@@ -0,0 +1,93 @@
+/**
+ * quantile_sketch.h
+ *
+ * This header file defines the t-digest used to estimate quantiles (such as
+ * the median, p95 and p99) of numeric and timestamp columns. A digest is a
+ * fixed array of weighted centroids kept inside the column metadata, so the
+ * digests of column chunks can be merged into the quantiles of a whole file,
+ * or of several files, without reading the data again.
+ */
+
+#ifndef INFPARQUET_QUANTILE_SKETCH_H
+#define INFPARQUET_QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include "../core/parquet_structure.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compression of a digest; quantile errors shrink towards the tails, to about 0.1% of rank at p99 */
+#define QUANTILE_SKETCH_COMPRESSION 100
+
+/* Centroid capacity; a digest of compression 100 never holds more than 102 centroids */
+#define QUANTILE_SKETCH_MAX_CENTROIDS 128
+
+/**
+ * A centroid: the mean of a run of adjacent values and their number
+ */
+typedef struct {
+    double mean;
+    uint64_t weight;
+} QuantileCentroid;
+
+/**
+ * t-digest
+ *
+ * Centroids are ordered by mean; all digests share one compression, so any
+ * two of them can be merged.
+ */
+typedef struct {
+    uint64_t count;                                             /* Values added, the sum of the weights */
+    double min;                                                 /* Smallest value added */
+    double max;                                                 /* Largest value added */
+    uint32_t centroid_count;                                    /* Centroids in use */
+    QuantileCentroid centroids[QUANTILE_SKETCH_MAX_CENTROIDS];  /* Centroids in increasing mean order */
+} QuantileSketch;
+
+/**
+ * Initialize an empty digest
+ *
+ * sketch: Digest to initialize
+ */
+void quantile_sketch_init(QuantileSketch* sketch);
+
+/**
+ * Add an array of values
+ *
+ * NaN values are skipped like nulls.
+ *
+ * sketch: The digest
+ * values: Values, stored as bool, int32_t, int64_t, float or double
+ * value_count: Number of values
+ * type: PARQUET_BOOLEAN, PARQUET_INT32, PARQUET_INT64, PARQUET_FLOAT or PARQUET_DOUBLE
+ *
+ * Return: 0 on success, 1 for invalid parameters or an unsupported type, 2 if out of memory
+ */
+int quantile_sketch_add_values(QuantileSketch* sketch, const void* values, uint64_t value_count,
+                               ParquetValueType type);
+
+/**
+ * Merge another digest into a digest
+ *
+ * sketch: Digest receiving the values
+ * other: Digest to merge
+ */
+void quantile_sketch_merge(QuantileSketch* sketch, const QuantileSketch* other);
+
+/**
+ * Estimate a quantile
+ *
+ * sketch: The digest
+ * q: Quantile, from 0 (the minimum) to 1 (the maximum)
+ *
+ * Return: Estimated value at the quantile, or NaN for an empty digest
+ */
+double quantile_sketch_quantile(const QuantileSketch* sketch, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_QUANTILE_SKETCH_H */
@@ -0,0 +1,78 @@
+/**
+ * value_frequency.h
+ *
+ * This header file defines the mode (most frequent value) computation used
+ * for numeric metadata. Values are counted exactly in an open-addressing
+ * hash table keyed by their bit pattern, in time linear in the number of
+ * values. Columns with more distinct values than a configurable limit fall
+ * back to a Misra-Gries sketch with a fixed number of counters, which bounds
+ * memory and reports how far its count may fall short of the true one.
+ */
+
+#ifndef INFPARQUET_VALUE_FREQUENCY_H
+#define INFPARQUET_VALUE_FREQUENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../core/parquet_structure.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default number of distinct values counted exactly (about 32 MiB of table) */
+#define VALUE_MODE_EXACT_LIMIT (1u << 20)
+
+/* Default number of counters of the Misra-Gries fallback */
+#define VALUE_MODE_SKETCH_COUNTERS 1024
+
+/**
+ * Options for computing a mode
+ */
+typedef struct {
+    uint64_t exact_limit;       /* Distinct values counted exactly before falling back (0 = never fall back) */
+    uint32_t sketch_counters;   /* Counters of the Misra-Gries fallback (0 = default) */
+} ValueModeOptions;
+
+/**
+ * Mode of a column
+ */
+typedef struct {
+    double value;          /* Most frequent value */
+    uint64_t count;        /* Occurrences of the value (a lower bound if approximate) */
+    uint64_t max_error;    /* Occurrences the count may miss (0 if exact) */
+    uint64_t counted;      /* Values counted; NaN values are skipped */
+    bool approximate;      /* Whether the Misra-Gries fallback was used */
+} ValueMode;
+
+/**
+ * Initialize mode options with default values
+ *
+ * options: Options structure to initialize
+ */
+void value_mode_init_options(ValueModeOptions* options);
+
+/**
+ * Compute the mode of a column of fixed-width values
+ *
+ * Values compare like ==, so -0.0 and 0.0 are counted together and NaN
+ * values are not counted. Ties go to the smaller value. With the fallback,
+ * a value occurring more than counted / (sketch_counters + 1) times is
+ * always found, and its true count lies in [count, count + max_error].
+ *
+ * values: Values in the layout of arrow_read_column_data
+ * value_count: Number of values
+ * type: Physical type (BOOLEAN, INT32, INT64, FLOAT or DOUBLE)
+ * options: Options (NULL for defaults)
+ * mode: Pointer to receive the mode
+ *
+ * Return: 0 on success, 1 for invalid parameters or types, 2 if out of memory
+ */
+int value_mode_compute(const void* values, uint64_t value_count, ParquetValueType type,
+                       const ValueModeOptions* options, ValueMode* mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFPARQUET_VALUE_FREQUENCY_H */
@@ -0,0 +1,387 @@
+/**
+ * chunk_cache.cpp
+ *
+ * This file implements the chunk cache declared in chunk_cache.h. Each shard
+ * keeps its entries in a hash map for lookup and in a list ordered from most
+ * to least recently used, both guarded by the shard's mutex. The capacity is
+ * shared: bytes are counted across all shards, and eviction takes the least
+ * recently used unpinned entry of whichever shard holds the oldest one, as
+ * told by a global use tick. An entry removed from its shard while pinned is
+ * freed by its last release.
+ */
+
+#include "compression/chunk_cache.h"
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+struct ChunkCacheEntry {
+    std::string archive;
+    int row_group;
+    int column;
+    void* data;
+    uint64_t size;
+    uint64_t source_size;                       /* Size of the file the chunk was decoded from */
+    int64_t source_mtime;                       /* Modification time of that file */
+    uint64_t last_use;                          /* Global use tick of the last insert or hit */
+    uint32_t shard;
+    uint32_t pins;                              /* Users holding the entry; guarded by the shard mutex */
+    bool linked;                                /* Still reachable through the shard */
+    std::list<ChunkCacheEntry*>::iterator lru;  /* Position in the shard's list while linked */
+};
+
+namespace {
+
+struct CacheKey {
+    std::string archive;
+    int row_group;
+    int column;
+
+    bool operator==(const CacheKey& other) const {
+        return row_group == other.row_group && column == other.column && archive == other.archive;
+    }
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const {
+        /* Mix the indices into every bit, since shards are picked from the low bits */
+        uint64_t hash = std::hash<std::string>()(key.archive);
+        hash ^= ((uint64_t)(uint32_t)key.row_group << 32) | (uint32_t)key.column;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return (size_t)hash;
+    }
+};
+
+struct Shard {
+    std::mutex mutex;
+    std::unordered_map<CacheKey, ChunkCacheEntry*, CacheKeyHash> entries;
+    std::list<ChunkCacheEntry*> lru;   /* Most recently used first */
+    uint64_t bytes = 0;
+};
+
+Shard g_shards[CHUNK_CACHE_SHARDS];
+std::atomic<uint64_t> g_capacity{0};
+std::atomic<uint64_t> g_bytes{0};      /* Bytes cached or reserved by inserts in progress */
+std::atomic<uint64_t> g_use_tick{0};
+std::atomic<uint32_t> g_next_victim{0};
+std::atomic<uint64_t> g_hits{0};
+std::atomic<uint64_t> g_misses{0};
+std::atomic<uint64_t> g_insertions{0};
+std::atomic<uint64_t> g_evictions{0};
+std::atomic<uint64_t> g_invalidations{0};
+
+uint32_t shard_of(const CacheKey& key) {
+    return (uint32_t)(CacheKeyHash()(key) % CHUNK_CACHE_SHARDS);
+}
+
+/* Archive prefixes name the same archive however they are spelled, as long as they resolve alike */
+std::string canonical_archive(const char* archive) {
+    std::error_code error;
+    std::filesystem::path path = std::filesystem::weakly_canonical(archive, error);
+    return error ? std::string(archive) : path.string();
+}
+
+/**
+ * Get the size and modification time of the file a chunk is decoded from
+ *
+ * returns: true if the file could be examined
+ */
+bool source_identity(const char* source, uint64_t* size, int64_t* mtime) {
+    std::error_code error;
+    uint64_t file_size = std::filesystem::file_size(source, error);
+    if (error) {
+        return false;
+    }
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(source, error);
+    if (error) {
+        return false;
+    }
+    *size = file_size;
+    *mtime = (int64_t)time.time_since_epoch().count();
+    return true;
+}
+
+void free_entry(ChunkCacheEntry* entry) {
+    free(entry->data);
+    delete entry;
+}
+
+/* Remove an entry from its shard; the caller must hold the shard mutex */
+void unlink_locked(Shard& shard, ChunkCacheEntry* entry) {
+    shard.entries.erase(CacheKey{entry->archive, entry->row_group, entry->column});
+    shard.lru.erase(entry->lru);
+    shard.bytes -= entry->size;
+    g_bytes.fetch_sub(entry->size, std::memory_order_relaxed);
+    entry->linked = false;
+    if (entry->pins == 0) {
+        free_entry(entry);
+    }
+}
+
+/* Least recently used unpinned entry of a shard; the caller must hold the shard mutex */
+ChunkCacheEntry* oldest_unpinned_locked(Shard& shard) {
+    for (auto it = shard.lru.rbegin(); it != shard.lru.rend(); ++it) {
+        if ((*it)->pins == 0) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Evict least recently used entries until the cache holds at most limit bytes
+ *
+ * Each round finds the shard whose oldest unpinned entry was used longest
+ * ago and evicts that shard's oldest unpinned entry, taking one shard mutex
+ * at a time. Pinned entries are skipped. The caller must hold no shard mutex.
+ *
+ * returns: true if the cache is within the limit
+ */
+bool evict_to(uint64_t limit) {
+    while (g_bytes.load(std::memory_order_relaxed) > limit) {
+        uint32_t victim = CHUNK_CACHE_SHARDS;
+        uint64_t oldest = UINT64_MAX;
+        uint32_t first = g_next_victim.fetch_add(1, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < CHUNK_CACHE_SHARDS; i++) {
+            uint32_t index = (first + i) % CHUNK_CACHE_SHARDS;
+            std::lock_guard<std::mutex> lock(g_shards[index].mutex);
+            ChunkCacheEntry* entry = oldest_unpinned_locked(g_shards[index]);
+            if (entry && entry->last_use < oldest) {
+                oldest = entry->last_use;
+                victim = index;
+            }
+        }
+        if (victim == CHUNK_CACHE_SHARDS) {
+            return false;  /* Everything left is pinned */
+        }
+
+        /* The shard may have changed since it was looked at; its oldest entry is still a fair pick */
+        Shard& shard = g_shards[victim];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ChunkCacheEntry* entry = oldest_unpinned_locked(shard);
+        if (entry) {
+            unlink_locked(shard, entry);
+            g_evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * Set the capacity of the cache
+ */
+void chunk_cache_set_capacity(uint64_t capacity_bytes) {
+    g_capacity.store(capacity_bytes, std::memory_order_relaxed);
+    evict_to(capacity_bytes);
+}
+
+/**
+ * Get the capacity of the cache
+ */
+uint64_t chunk_cache_get_capacity(void) {
+    return g_capacity.load(std::memory_order_relaxed);
+}
+
+/**
+ * Look up and pin a decompressed chunk
+ */
+ChunkCacheEntry* chunk_cache_acquire(const char* archive, int row_group, int column, const char* source) {
+    if (!archive || !source || g_capacity.load(std::memory_order_relaxed) == 0) {
+        return NULL;
+    }
+
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    bool have_source = source_identity(source, &source_size, &source_mtime);
+
+    CacheKey key{canonical_archive(archive), row_group, column};
+    Shard& shard = g_shards[shard_of(key)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.entries.find(key);
+    if (found == shard.entries.end()) {
+        g_misses.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    /* A chunk whose file was rewritten or removed since it was decoded is stale */
+    ChunkCacheEntry* entry = found->second;
+    if (!have_source || entry->source_size != source_size || entry->source_mtime != source_mtime) {
+        unlink_locked(shard, entry);
+        g_invalidations.fetch_add(1, std::memory_order_relaxed);
+        g_misses.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    entry->pins++;
+    entry->last_use = g_use_tick.fetch_add(1, std::memory_order_relaxed);
+    shard.lru.splice(shard.lru.begin(), shard.lru, entry->lru);
+    g_hits.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+/**
+ * Add a decompressed chunk and pin it
+ */
+ChunkCacheEntry* chunk_cache_insert(const char* archive, int row_group, int column, const char* source,
+                                    void* data, uint64_t size) {
+    uint64_t capacity = g_capacity.load(std::memory_order_relaxed);
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    if (!archive || !source || !data || size == 0 || size > capacity ||
+        !source_identity(source, &source_size, &source_mtime)) {
+        return NULL;
+    }
+
+    CacheKey key{canonical_archive(archive), row_group, column};
+    uint32_t index = shard_of(key);
+    Shard& shard = g_shards[index];
+
+    /* Drop the entry being replaced before making room, so its bytes count as free */
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.entries.find(key);
+        if (found != shard.entries.end()) {
+            unlink_locked(shard, found->second);
+        }
+    }
+
+    /* Reserve the bytes, then make room; give up rather than exceed the capacity when too much is pinned */
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (!evict_to(capacity)) {
+        g_bytes.fetch_sub(size, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.entries.find(key);
+    if (found != shard.entries.end()) {
+        unlink_locked(shard, found->second);  /* Inserted by another thread meanwhile */
+    }
+
+    ChunkCacheEntry* entry = new ChunkCacheEntry();
+    entry->archive = key.archive;
+    entry->row_group = row_group;
+    entry->column = column;
+    entry->data = data;
+    entry->size = size;
+    entry->source_size = source_size;
+    entry->source_mtime = source_mtime;
+    entry->last_use = g_use_tick.fetch_add(1, std::memory_order_relaxed);
+    entry->shard = index;
+    entry->pins = 1;
+    entry->linked = true;
+    shard.lru.push_front(entry);
+    entry->lru = shard.lru.begin();
+    shard.entries.emplace(std::move(key), entry);
+    shard.bytes += size;  /* Already counted in g_bytes by the reservation */
+    g_insertions.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+/**
+ * Get the data of a pinned entry
+ */
+const void* chunk_cache_entry_data(const ChunkCacheEntry* entry) {
+    return entry ? entry->data : NULL;
+}
+
+/**
+ * Get the size of a pinned entry
+ */
+uint64_t chunk_cache_entry_size(const ChunkCacheEntry* entry) {
+    return entry ? entry->size : 0;
+}
+
+/**
+ * Unpin an entry
+ */
+void chunk_cache_release(ChunkCacheEntry* entry) {
+    if (!entry) {
+        return;
+    }
+
+    {
+        Shard& shard = g_shards[entry->shard];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (--entry->pins > 0) {
+            return;
+        }
+        if (!entry->linked) {
+            free_entry(entry);
+            return;
+        }
+    }
+    /* A shrink may have left the cache over its capacity while this entry was pinned */
+    evict_to(g_capacity.load(std::memory_order_relaxed));
+}
+
+/**
+ * Drop every chunk of an archive
+ */
+void chunk_cache_erase_archive(const char* archive) {
+    if (!archive) {
+        return;
+    }
+
+    std::string canonical = canonical_archive(archive);
+    for (Shard& shard : g_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+            ChunkCacheEntry* entry = *it++;
+            if (entry->archive == canonical) {
+                unlink_locked(shard, entry);
+            }
+        }
+    }
+}
+
+/**
+ * Drop every chunk and reset the counters
+ */
+void chunk_cache_clear(void) {
+    for (Shard& shard : g_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (!shard.lru.empty()) {
+            unlink_locked(shard, shard.lru.front());
+        }
+    }
+    g_hits.store(0, std::memory_order_relaxed);
+    g_misses.store(0, std::memory_order_relaxed);
+    g_insertions.store(0, std::memory_order_relaxed);
+    g_evictions.store(0, std::memory_order_relaxed);
+    g_invalidations.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Get the counters of the cache
+ */
+void chunk_cache_get_stats(ChunkCacheStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    stats->entries = 0;
+    stats->bytes = 0;
+    for (Shard& shard : g_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats->entries += shard.entries.size();
+        stats->bytes += shard.bytes;
+    }
+    stats->hits = g_hits.load(std::memory_order_relaxed);
+    stats->misses = g_misses.load(std::memory_order_relaxed);
+    stats->insertions = g_insertions.load(std::memory_order_relaxed);
+    stats->evictions = g_evictions.load(std::memory_order_relaxed);
+    stats->invalidations = g_invalidations.load(std::memory_order_relaxed);
+    stats->capacity = g_capacity.load(std::memory_order_relaxed);
+}
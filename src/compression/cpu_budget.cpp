@@ -0,0 +1,165 @@
+/**
+ * cpu_budget.cpp
+ *
+ * This file implements the CPU budget coordinator declared in cpu_budget.h.
+ * The pool is a counter guarded by a mutex; acquisitions that find it empty
+ * wait on a condition variable until a grant is released.
+ */
+
+#include "compression/cpu_budget.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+namespace {
+
+std::mutex g_budget_mutex;
+std::condition_variable g_budget_released;
+uint32_t g_total_tokens = 0;   /* 0 until first use, then the pool size */
+uint32_t g_used_tokens = 0;
+
+uint32_t hardware_tokens() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+/* Pool size; the caller must hold g_budget_mutex */
+uint32_t total_tokens_locked() {
+    if (g_total_tokens == 0) {
+        g_total_tokens = hardware_tokens();
+    }
+    return g_total_tokens;
+}
+
+/**
+ * Wait for at least one free token and take up to wanted tokens
+ *
+ * A pool that was shrunk below the tokens in use counts as empty, so
+ * callers wait for running grants to drain instead of oversubscribing.
+ */
+uint32_t take_tokens(uint32_t wanted) {
+    std::unique_lock<std::mutex> lock(g_budget_mutex);
+    g_budget_released.wait(lock, [] {
+        return g_used_tokens < total_tokens_locked();
+    });
+
+    uint32_t available = total_tokens_locked() - g_used_tokens;
+    uint32_t taken = std::max<uint32_t>(1, std::min(wanted, available));
+    g_used_tokens += taken;
+    return taken;
+}
+
+void give_tokens(uint32_t tokens) {
+    if (tokens == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_budget_mutex);
+        g_used_tokens = tokens > g_used_tokens ? 0 : g_used_tokens - tokens;
+    }
+    g_budget_released.notify_all();
+}
+
+} // namespace
+
+/**
+ * Set the size of the token pool
+ */
+void cpu_budget_set_tokens(uint32_t tokens) {
+    {
+        std::lock_guard<std::mutex> lock(g_budget_mutex);
+        g_total_tokens = tokens > 0 ? tokens : hardware_tokens();
+    }
+    g_budget_released.notify_all();
+}
+
+/**
+ * Get the size of the token pool
+ */
+uint32_t cpu_budget_get_tokens(void) {
+    std::lock_guard<std::mutex> lock(g_budget_mutex);
+    return total_tokens_locked();
+}
+
+/**
+ * Get the number of tokens not currently held by any grant
+ */
+uint32_t cpu_budget_get_available(void) {
+    std::lock_guard<std::mutex> lock(g_budget_mutex);
+    uint32_t total = total_tokens_locked();
+    return g_used_tokens < total ? total - g_used_tokens : 0;
+}
+
+/**
+ * Acquire parallelism for a batch of tasks
+ */
+void cpu_budget_acquire(uint64_t task_count,
+                        uint64_t average_task_bytes,
+                        uint32_t max_task_threads,
+                        int compression_level,
+                        CpuBudgetGrant* grant) {
+    if (!grant) {
+        return;
+    }
+
+    /* Concurrent tasks beyond the task count or the caller's limit are useless */
+    uint64_t useful_tasks = task_count > 0 ? task_count : 1;
+    if (max_task_threads > 0 && useful_tasks > max_task_threads) {
+        useful_tasks = max_task_threads;
+    }
+    if (useful_tasks > UINT32_MAX / 2) {
+        useful_tasks = UINT32_MAX / 2;
+    }
+
+    /* LZMA only runs its match finder on a second thread for the binary-tree
+       modes (level 5 and above), and only large inputs amortise the thread */
+    bool codec_can_split = compression_level >= 5 &&
+                           average_task_bytes >= CPU_BUDGET_MT_CODEC_MIN_BYTES;
+    uint32_t wanted = (uint32_t)useful_tasks * (codec_can_split ? 2 : 1);
+
+    uint32_t taken = take_tokens(wanted);
+
+    /* Fill the grant with tasks first; split a codec only when tokens are left over */
+    uint32_t tasks = (uint32_t)std::min<uint64_t>(useful_tasks, taken);
+    uint32_t codec = (codec_can_split && tasks * 2 <= taken) ? 2 : 1;
+
+    grant->task_threads = tasks;
+    grant->codec_threads = codec;
+    grant->tokens = tasks * codec;
+
+    /* Return what the split does not use */
+    give_tokens(taken - grant->tokens);
+}
+
+/**
+ * Try to acquire tokens for plain worker threads
+ */
+uint32_t cpu_budget_try_acquire_threads(uint32_t max_threads) {
+    std::lock_guard<std::mutex> lock(g_budget_mutex);
+    uint32_t total = total_tokens_locked();
+    uint32_t available = g_used_tokens < total ? total - g_used_tokens : 0;
+    uint32_t taken = std::min(max_threads, available);
+    g_used_tokens += taken;
+    return taken;
+}
+
+/**
+ * Return a grant's tokens to the pool
+ */
+void cpu_budget_release(CpuBudgetGrant* grant) {
+    if (!grant) {
+        return;
+    }
+    give_tokens(grant->tokens);
+    grant->tokens = 0;
+    grant->task_threads = 0;
+    grant->codec_threads = 0;
+}
+
+/**
+ * Return tokens obtained from cpu_budget_try_acquire_threads to the pool
+ */
+void cpu_budget_release_threads(uint32_t tokens) {
+    give_tokens(tokens);
+}
@@ -11,16 +11,17 @@
 
 #include "compression/lzma_compressor.h"
 #include "compression/lzma_decompressor.h" /* Include for function declarations only */
+#include "core/platform.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-// Global state
-static uint32_t g_threads = 0;
-static uint64_t g_memory_limit = 0;
+/* Process-wide defaults for calls without explicit settings; jobs that need
+   their own configuration pass LzmaCodecSettings instead */
+static LzmaCodecSettings s_default_settings = { 0, 0 };
 
-/* Static global for error messages */
-static char s_error_message[256];
+/* Per-thread buffer for error messages */
+static INFPARQUET_THREAD_LOCAL char s_error_message[256];
 
 /* LZMA2 allocation functions */
 static void* lzma_alloc(ISzAllocPtr p, size_t size) {
@@ -124,6 +125,32 @@ static SRes lzma_progress_callback(void* p, UInt64 in_size, UInt64 out_size) {
 int lzma_compress_buffer(const void* input_data, uint64_t input_size,
                          void* output_data, uint64_t* output_size,
                          uint32_t dictionary_size, int compression_level) {
+    return lzma_compress_buffer_with_settings(NULL, input_data, input_size,
+                                              output_data, output_size,
+                                              dictionary_size, compression_level);
+}
+
+/**
+ * Compresses data using LZMA2 algorithm with explicit codec settings
+ * 
+ * settings: Codec settings (NULL for the process defaults)
+ * input_data: Pointer to the data to be compressed
+ * input_size: Size of the input data in bytes
+ * output_data: Pointer to the buffer where compressed data will be written
+ * output_size: Pointer to a variable that will receive the size of the compressed data
+ * dictionary_size: Size of the dictionary to use for compression (0 for default)
+ * compression_level: Compression level (1-9, where 9 is highest compression)
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_compress_buffer_with_settings(const LzmaCodecSettings* settings,
+                                       const void* input_data, uint64_t input_size,
+                                       void* output_data, uint64_t* output_size,
+                                       uint32_t dictionary_size, int compression_level) {
+    if (!settings) {
+        settings = &s_default_settings;
+    }
+    
     if (!input_data || input_size == 0 || 
         (!output_data && output_size && *output_size > 0) || 
         !output_size ||
@@ -147,13 +174,13 @@ int lzma_compress_buffer(const void* input_data, uint64_t input_size,
     }
     
     // Set threads if configured
-    if (g_threads > 0) {
-        props.numThreads = g_threads;
+    if (settings->threads > 0) {
+        props.numThreads = settings->threads;
     }
     
     // Set memory limit if configured
-    if (g_memory_limit > 0) {
-        props.reduceSize = g_memory_limit;
+    if (settings->memory_limit > 0) {
+        props.reduceSize = settings->memory_limit;
     }
     
     // Prepare encoder
@@ -212,6 +239,111 @@ int lzma_compress_buffer(const void* input_data, uint64_t input_size,
     return 0;  // Success
 }
 
+/* Store a little-endian integer of the given width */
+static void put_le(Byte* dest, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        dest[i] = (Byte)(value >> (i * 8));
+    }
+}
+
+/**
+ * Compresses data into a seekable buffer of independently decodable frames
+ * 
+ * settings: Codec settings (NULL for the process defaults)
+ * input_data: Pointer to the data to be compressed
+ * input_size: Size of the input data in bytes
+ * frame_ends: End offset of each frame in the input, ascending, the last one equal to input_size
+ * frame_rows: Number of rows in each frame
+ * frame_count: Number of frames
+ * output_data: Buffer of at least lzma_maximum_seekable_size bytes
+ * output_size: In: size of the output buffer; out: size of the seekable buffer
+ * dictionary_size: Size of the dictionary to use for compression (0 for default)
+ * compression_level: Compression level (1-9, where 9 is highest compression)
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_compress_seekable(const LzmaCodecSettings* settings,
+                           const void* input_data, uint64_t input_size,
+                           const uint64_t* frame_ends, const uint32_t* frame_rows,
+                           uint32_t frame_count,
+                           void* output_data, uint64_t* output_size,
+                           uint32_t dictionary_size, int compression_level) {
+    if (!input_data || input_size == 0 || !frame_ends || !frame_rows || frame_count == 0 ||
+        frame_ends[frame_count - 1] != input_size || !output_data || !output_size) {
+        snprintf(s_error_message, sizeof(s_error_message), 
+                "Invalid parameters for seekable compression");
+        return 1;  // Invalid parameters
+    }
+    
+    uint64_t index_size = LZMA_SEEKABLE_HEADER_SIZE + (uint64_t)frame_count * LZMA_SEEKABLE_ENTRY_SIZE;
+    if (*output_size < index_size) {
+        snprintf(s_error_message, sizeof(s_error_message), 
+                "Output buffer too small for the frame table");
+        return 2;
+    }
+    
+    Byte* header = (Byte*)output_data;
+    header[0] = LZMA_SEEKABLE_MARKER;
+    put_le(header + 1, frame_count, 4);
+    put_le(header + LZMA_PROPS_SIZE, input_size, 8);
+    
+    const Byte* input = (const Byte*)input_data;
+    uint64_t written = index_size;
+    uint64_t frame_start = 0;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        uint64_t frame_size = frame_ends[i] - frame_start;
+        if (frame_ends[i] < frame_start || frame_size == 0 || frame_size > UINT32_MAX) {
+            snprintf(s_error_message, sizeof(s_error_message), 
+                    "Invalid size of frame %u", i);
+            return 1;
+        }
+        
+        // A dictionary larger than the frame only costs memory
+        uint32_t frame_dictionary = dictionary_size;
+        if (frame_dictionary == 0 || frame_dictionary > frame_size) {
+            frame_dictionary = frame_size < 4096 ? 4096 : (uint32_t)frame_size;
+        }
+        
+        uint64_t encoded_size = *output_size - written;
+        int result = lzma_compress_buffer_with_settings(settings, input + frame_start, frame_size,
+                                                        header + written, &encoded_size,
+                                                        frame_dictionary, compression_level);
+        if (result != 0) {
+            return result;
+        }
+        if (encoded_size > UINT32_MAX) {
+            snprintf(s_error_message, sizeof(s_error_message), 
+                    "Compressed frame %u is too large", i);
+            return 3;
+        }
+        
+        Byte* entry = header + LZMA_SEEKABLE_HEADER_SIZE + (uint64_t)i * LZMA_SEEKABLE_ENTRY_SIZE;
+        put_le(entry, frame_rows[i], 4);
+        put_le(entry + 4, frame_size, 4);
+        put_le(entry + 8, encoded_size, 4);
+        
+        written += encoded_size;
+        frame_start = frame_ends[i];
+    }
+    
+    *output_size = written;
+    return 0;  // Success
+}
+
+/**
+ * Calculates the maximum possible size of a seekable buffer
+ * 
+ * input_size: Size of the input data in bytes
+ * frame_count: Number of frames the input is cut into
+ * 
+ * Return: Maximum possible size of the seekable buffer
+ */
+uint64_t lzma_maximum_seekable_size(uint64_t input_size, uint32_t frame_count) {
+    // Every frame carries its own header and worst-case overhead
+    return lzma_maximum_compressed_size(input_size) + LZMA_SEEKABLE_HEADER_SIZE +
+           (uint64_t)frame_count * (LZMA_SEEKABLE_ENTRY_SIZE + LZMA_PROPS_SIZE + 8 + 64);
+}
+
 /**
  * Compresses data from a file using LZMA2 algorithm
  * 
@@ -292,13 +424,13 @@ int lzma_compress_file(const char* input_file, const char* output_file,
     props.level = compression_level;
     
     // Set threads if configured
-    if (g_threads > 0) {
-        props.numThreads = g_threads;
+    if (s_default_settings.threads > 0) {
+        props.numThreads = s_default_settings.threads;
     }
     
     // Set memory limit if configured
-    if (g_memory_limit > 0) {
-        props.reduceSize = g_memory_limit;
+    if (s_default_settings.memory_limit > 0) {
+        props.reduceSize = s_default_settings.memory_limit;
     }
     
     // Set properties
@@ -391,7 +523,9 @@ uint64_t lzma_maximum_compressed_size(uint64_t input_size) {
  * Sets the LZMA compression parameters
  * 
  * This function sets various LZMA compression parameters. It should be called
- * before calling lzma_compress_buffer or lzma_compress_file.
+ * before calling lzma_compress_buffer or lzma_compress_file. The parameters
+ * are process-wide defaults for calls without explicit settings; set them
+ * before any compression starts.
  * 
  * threads: Number of threads to use for compression (0 for automatic)
  * memory_limit: Memory limit in bytes (0 for default)
@@ -399,8 +533,8 @@ uint64_t lzma_maximum_compressed_size(uint64_t input_size) {
  * Return: 0 on success, non-zero error code on failure
  */
 int lzma_set_compression_parameters(uint32_t threads, uint64_t memory_limit) {
-    g_threads = threads;
-    g_memory_limit = memory_limit;
+    s_default_settings.threads = threads;
+    s_default_settings.memory_limit = memory_limit;
     return 0;  // Success
 }
 
@@ -410,10 +544,11 @@ int lzma_set_compression_parameters(uint32_t threads, uint64_t memory_limit) {
  * Get the last error message from the LZMA compressor
  * 
  * This function returns a string describing the last error that occurred.
- * The returned string is valid until the next call to any LZMA function.
+ * The returned string is valid until the next call to any LZMA function
+ * on the same thread.
  * 
  * Return: Pointer to a string describing the last error, or NULL if no error occurred
  */
-const char* lzma_get_error_message() {
+const char* lzma_get_error_message(void) {
     return s_error_message[0] != '\0' ? s_error_message : NULL;
 } 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "compression/lzma_decompressor.h"
+#include "core/platform.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -19,12 +20,12 @@ typedef enum {
     LZMA_DECOMPRESSOR_FILE_ERROR
 } LzmaDecompressorError;
 
-// Global state
-static uint32_t g_threads = 0;
-static uint64_t g_memory_limit = 0;
+/* Process-wide defaults for calls without explicit settings; jobs that need
+   their own configuration pass LzmaCodecSettings instead */
+static LzmaCodecSettings s_default_settings = { 0, 0 };
 
-/* Static global for error messages */
-static char s_error_message[256];
+/* Per-thread buffer for error messages */
+static INFPARQUET_THREAD_LOCAL char s_error_message[256];
 
 /* LZMA2 allocation functions */
 static void* lzma_alloc(ISzAllocPtr p, size_t size) {
@@ -40,6 +41,237 @@ static void lzma_free(ISzAllocPtr p, void* address) {
 /* LZMA2 allocator */
 static ISzAlloc g_alloc = { lzma_alloc, lzma_free };
 
+/* Read a little-endian integer of the given width */
+static uint64_t get_le(const Byte* src, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)src[i] << (i * 8);
+    }
+    return value;
+}
+
+/* Size of the literal probability tables per (lc + lp) step, as in LzmaDec.c */
+#define LZMA_BASE_PROBS 1984
+#define LZMA_LITERAL_PROBS 0x300
+
+/* Smallest dictionary the decoder accepts */
+#define LZMA_DICTIONARY_MIN (1 << 12)
+
+/**
+ * Copy the properties of a plain buffer, shrinking the dictionary to the data
+ * 
+ * A stream never references more history than it holds, so a dictionary larger
+ * than the uncompressed size is never filled. The encoder records its level's
+ * full dictionary (16 MiB from level 5), which would otherwise be allocated for
+ * every frame however small.
+ */
+static void clamp_props(const Byte* props, uint64_t uncompressed_size, Byte* clamped) {
+    memcpy(clamped, props, LZMA_PROPS_SIZE);
+    uint64_t dictionary_size = get_le(props + 1, 4);
+    if (uncompressed_size != LZMA_UNKNOWN_SIZE && uncompressed_size < dictionary_size) {
+        dictionary_size = uncompressed_size > LZMA_DICTIONARY_MIN ? uncompressed_size : LZMA_DICTIONARY_MIN;
+        for (int i = 0; i < 4; i++) {
+            clamped[1 + i] = (Byte)(dictionary_size >> (i * 8));
+        }
+    }
+}
+
+/* Bytes allocated by the decoder for clamped properties: dictionary and probability tables */
+static uint64_t decoder_state_size(const Byte* clamped) {
+    CLzmaProps props;
+    if (LzmaProps_Decode(&props, clamped, LZMA_PROPS_SIZE) != SZ_OK) {
+        return 0;
+    }
+    uint64_t probs = LZMA_BASE_PROBS + ((uint64_t)LZMA_LITERAL_PROBS << (props.lc + props.lp));
+    return (uint64_t)props.dicSize + probs * sizeof(CLzmaProb);
+}
+
+/* Bytes of probability tables a decode into the output buffer allocates, or 0 if the properties are invalid */
+static uint64_t decoder_probs_size(const Byte* props_data) {
+    CLzmaProps props;
+    if (LzmaProps_Decode(&props, props_data, LZMA_PROPS_SIZE) != SZ_OK) {
+        return 0;
+    }
+    return (LZMA_BASE_PROBS + ((uint64_t)LZMA_LITERAL_PROBS << (props.lc + props.lp))) * sizeof(CLzmaProb);
+}
+
+/* Output window for a stream of the given size, kept within what the memory limit leaves */
+static uint64_t window_size_for(uint64_t uncompressed_size, uint64_t state_size, uint64_t memory_limit) {
+    uint64_t window = LZMA_DECODE_WINDOW_SIZE;
+    if (uncompressed_size < window) {
+        window = uncompressed_size > 0 ? uncompressed_size : 1;
+    }
+    if (memory_limit > 0 && state_size < memory_limit && memory_limit - state_size < window) {
+        window = memory_limit - state_size;
+    }
+    return window;
+}
+
+/* Decoder memory of one plain buffer, or 0 if its header is invalid */
+static uint64_t plain_memory_usage(const Byte* input_data, uint64_t input_size, uint64_t memory_limit) {
+    if (input_size <= LZMA_PROPS_SIZE + 8) {
+        return 0;
+    }
+    uint64_t uncompressed_size = get_le(input_data + LZMA_PROPS_SIZE, 8);
+    Byte clamped[LZMA_PROPS_SIZE];
+    clamp_props(input_data, uncompressed_size, clamped);
+    uint64_t state_size = decoder_state_size(clamped);
+    if (state_size == 0) {
+        return 0;
+    }
+    return state_size + window_size_for(uncompressed_size, state_size, memory_limit);
+}
+
+/**
+ * Decode one plain buffer through a fixed output window
+ * 
+ * Each filled window is handed to the callback, so the decoder holds its
+ * dictionary and one window however large the data is. Buffers whose header
+ * records an unknown size are decoded up to their end marker.
+ * 
+ * Return: 0 on success, non-zero error code on failure; *decoded receives the bytes produced
+ */
+static int decode_plain_windows(const Byte* input_data, uint64_t input_size, uint64_t memory_limit,
+                                LzmaWindowCallback callback, void* user_data, uint64_t* decoded) {
+    *decoded = 0;
+    if (input_size <= LZMA_PROPS_SIZE + 8) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid parameters for decompression");
+        return 1;
+    }
+    
+    uint64_t uncompressed_size = get_le(input_data + LZMA_PROPS_SIZE, 8);
+    Byte props[LZMA_PROPS_SIZE];
+    clamp_props(input_data, uncompressed_size, props);
+    uint64_t state_size = decoder_state_size(props);
+    if (state_size == 0) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Unsupported LZMA properties");
+        return 4;
+    }
+    if (memory_limit > 0 && state_size >= memory_limit) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "LZMA decoder needs %" PRIu64 " bytes, above the memory limit of %" PRIu64,
+                state_size, memory_limit);
+        return 5;
+    }
+    
+    uint64_t window_size = window_size_for(uncompressed_size, state_size, memory_limit);
+    Byte* window = (Byte*)malloc((size_t)window_size);
+    if (!window) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate the decode window");
+        return 3;
+    }
+    
+    CLzmaDec state;
+    LzmaDec_Construct(&state);
+    SRes res = LzmaDec_Allocate(&state, props, LZMA_PROPS_SIZE, &g_alloc);
+    if (res != SZ_OK) {
+        free(window);
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate LZMA decoder: %d", res);
+        return 3;
+    }
+    LzmaDec_Init(&state);
+    
+    const Byte* src = input_data + LZMA_PROPS_SIZE + 8;
+    uint64_t src_left = input_size - (LZMA_PROPS_SIZE + 8);
+    uint64_t remaining = uncompressed_size;
+    int result = 0;
+    while (remaining > 0) {
+        SizeT out_len = (SizeT)(remaining < window_size ? remaining : window_size);
+        SizeT in_len = (SizeT)src_left;
+        ELzmaStatus status;
+        res = LzmaDec_DecodeToBuf(&state, window, &out_len, src, &in_len, LZMA_FINISH_ANY, &status);
+        src += in_len;
+        src_left -= in_len;
+        if (res != SZ_OK) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "LZMA decompression failed with error code %d, status %d", res, status);
+            result = 4;
+            break;
+        }
+        
+        if (out_len > 0) {
+            *decoded += out_len;
+            if (uncompressed_size != LZMA_UNKNOWN_SIZE) {
+                remaining -= out_len;
+            }
+            if (callback(window, out_len, user_data) != 0) {
+                snprintf(s_error_message, sizeof(s_error_message),
+                        "Decoded data was rejected by the consumer");
+                result = 6;
+                break;
+            }
+        }
+        
+        if (status == LZMA_STATUS_FINISHED_WITH_MARK) {
+            break;
+        }
+        if (out_len == 0 && in_len == 0) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "LZMA stream ends after %" PRIu64 " bytes", *decoded);
+            result = 4;
+            break;
+        }
+    }
+    
+    LzmaDec_Free(&state, &g_alloc);
+    free(window);
+    
+    if (result == 0 && uncompressed_size != LZMA_UNKNOWN_SIZE && *decoded != uncompressed_size) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "LZMA stream decoded to %" PRIu64 " bytes instead of %" PRIu64, *decoded, uncompressed_size);
+        result = 4;
+    }
+    return result;
+}
+
+/* Decode every frame of a seekable buffer into one output buffer */
+static int decompress_seekable(const void* input_data, uint64_t input_size, uint32_t frame_count,
+                               void* output_data, uint64_t* output_size) {
+    LzmaSeekFrame* frames = (LzmaSeekFrame*)malloc((size_t)frame_count * sizeof(LzmaSeekFrame));
+    if (!frames) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate the frame table");
+        return 3;
+    }
+    
+    int result = lzma_seekable_read_index(input_data, input_size, frames, frame_count);
+    if (result == 0 && frames[frame_count - 1].raw_offset + frames[frame_count - 1].raw_size > *output_size) {
+        snprintf(s_error_message, sizeof(s_error_message), 
+                "Output buffer too small for LZMA decompression");
+        result = 2;  // Output buffer too small
+    }
+    
+    uint64_t decoded = 0;
+    for (uint32_t i = 0; result == 0 && i < frame_count; i++) {
+        if (frames[i].encoded_offset + frames[i].encoded_size > input_size) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Frame %u extends past the end of the buffer", i);
+            result = 4;
+            break;
+        }
+        uint64_t frame_size = frames[i].raw_size;
+        result = lzma_decompress_buffer((const Byte*)input_data + frames[i].encoded_offset,
+                                        frames[i].encoded_size,
+                                        (Byte*)output_data + frames[i].raw_offset, &frame_size);
+        if (result == 0 && frame_size != frames[i].raw_size) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Frame %u decoded to %" PRIu64 " bytes instead of %u", i, frame_size, frames[i].raw_size);
+            result = 4;
+        }
+        decoded += frame_size;
+    }
+    
+    free(frames);
+    if (result == 0) {
+        *output_size = decoded;
+    }
+    return result;
+}
+
 /**
  * Decompresses data using LZMA2 algorithm
  * 
@@ -62,6 +294,12 @@ int lzma_decompress_buffer(const void* input_data, uint64_t input_size,
         return 1;  // Invalid parameters
     }
     
+    // Seekable buffers hold plain buffers back to back, decoded one frame at a time
+    uint32_t frame_count = lzma_seekable_frame_count(input_data, input_size);
+    if (frame_count > 0) {
+        return decompress_seekable(input_data, input_size, frame_count, output_data, output_size);
+    }
+    
     // Get the LZMA properties from the header
     const Byte* props = (const Byte*)input_data;
     
@@ -87,29 +325,19 @@ int lzma_decompress_buffer(const void* input_data, uint64_t input_size,
     // Size of the uncompressed data
     SizeT dest_len = uncompressed_size;
     
-    // Create decoder state
-    CLzmaDec state;
-    LzmaDec_Construct(&state);
+    // Decode straight into the output, which doubles as the dictionary: only the
+    // probability tables are allocated and nothing is copied afterwards
+    ELzmaStatus status;
+    SRes res = LzmaDecode((Byte*)output_data, &dest_len,
+                          compressed_data, &compressed_size,
+                          props, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_alloc);
     
-    // Initialize decoder with properties
-    SRes res = LzmaDec_Allocate(&state, props, LZMA_PROPS_SIZE, &g_alloc);
-    if (res != SZ_OK) {
+    if (res == SZ_ERROR_MEM) {
         snprintf(s_error_message, sizeof(s_error_message), 
                 "Failed to allocate LZMA decoder: %d", res);
         return 3;  // Decoder allocation failed
     }
     
-    LzmaDec_Init(&state);
-    
-    // Decompress the data
-    ELzmaStatus status;
-    res = LzmaDec_DecodeToBuf(&state, 
-                           (Byte*)output_data, &dest_len, 
-                           compressed_data, &compressed_size, 
-                           LZMA_FINISH_END, &status);
-    
-    LzmaDec_Free(&state, &g_alloc);
-    
     if (res != SZ_OK) {
         snprintf(s_error_message, sizeof(s_error_message), 
                 "LZMA decompression failed with error code %d, status %d", res, status);
@@ -122,6 +350,292 @@ int lzma_decompress_buffer(const void* input_data, uint64_t input_size,
     return 0;  // Success
 }
 
+/* Output filled window by window by lzma_decompress_alloc */
+typedef struct {
+    Byte* data;
+    uint64_t size;
+    uint64_t capacity;
+    int fixed;           /* Set when the capacity is the recorded size and must not grow */
+} WindowBuffer;
+
+static int append_window(const void* window, size_t size, void* user_data) {
+    WindowBuffer* buffer = (WindowBuffer*)user_data;
+    if (buffer->size + size > buffer->capacity) {
+        if (buffer->fixed) {
+            return 1;  // More data than the header records
+        }
+        uint64_t capacity = buffer->capacity > 0 ? buffer->capacity * 2 : LZMA_DECODE_WINDOW_SIZE;
+        while (capacity < buffer->size + size) {
+            capacity *= 2;
+        }
+        Byte* grown = (Byte*)realloc(buffer->data, (size_t)capacity);
+        if (!grown) {
+            return 1;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, window, size);
+    buffer->size += size;
+    return 0;
+}
+
+/* Probability tables of the largest frame decoded in place, or 0 if a header is invalid */
+static uint64_t in_place_memory_usage(const void* input_data, uint64_t input_size) {
+    uint32_t frame_count = lzma_seekable_frame_count(input_data, input_size);
+    if (frame_count == 0) {
+        return decoder_probs_size((const Byte*)input_data);
+    }
+    
+    LzmaSeekFrame* frames = (LzmaSeekFrame*)malloc((size_t)frame_count * sizeof(LzmaSeekFrame));
+    if (!frames) {
+        return 0;
+    }
+    
+    uint64_t probs = 0;
+    if (lzma_seekable_read_index(input_data, input_size, frames, frame_count) == 0) {
+        for (uint32_t i = 0; i < frame_count; i++) {
+            uint64_t frame_probs = 0;
+            if (frames[i].encoded_offset + frames[i].encoded_size <= input_size &&
+                frames[i].encoded_size > LZMA_PROPS_SIZE) {
+                frame_probs = decoder_probs_size((const Byte*)input_data + frames[i].encoded_offset);
+            }
+            if (frame_probs == 0) {
+                probs = 0;
+                break;
+            }
+            if (frame_probs > probs) {
+                probs = frame_probs;
+            }
+        }
+    }
+    free(frames);
+    return probs;
+}
+
+/**
+ * Decompresses data through a fixed-size output window
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit applies (NULL for the process defaults)
+ * callback: Function receiving each window of decoded data, in order
+ * user_data: User data passed to the callback
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_decompress_windows(const void* input_data, uint64_t input_size,
+                            const LzmaCodecSettings* settings,
+                            LzmaWindowCallback callback, void* user_data) {
+    if (!settings) {
+        settings = &s_default_settings;
+    }
+    if (!input_data || input_size <= LZMA_PROPS_SIZE + 8 || !callback) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid parameters for decompression");
+        return 1;
+    }
+    
+    uint64_t decoded = 0;
+    uint32_t frame_count = lzma_seekable_frame_count(input_data, input_size);
+    if (frame_count == 0) {
+        return decode_plain_windows((const Byte*)input_data, input_size, settings->memory_limit,
+                                    callback, user_data, &decoded);
+    }
+    
+    // Frames are independent, so only one frame's decoder is alive at a time
+    LzmaSeekFrame* frames = (LzmaSeekFrame*)malloc((size_t)frame_count * sizeof(LzmaSeekFrame));
+    if (!frames) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate the frame table");
+        return 3;
+    }
+    
+    int result = lzma_seekable_read_index(input_data, input_size, frames, frame_count);
+    for (uint32_t i = 0; result == 0 && i < frame_count; i++) {
+        if (frames[i].encoded_offset + frames[i].encoded_size > input_size) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Frame %u extends past the end of the buffer", i);
+            result = 4;
+            break;
+        }
+        result = decode_plain_windows((const Byte*)input_data + frames[i].encoded_offset,
+                                      frames[i].encoded_size, settings->memory_limit,
+                                      callback, user_data, &decoded);
+        if (result == 0 && decoded != frames[i].raw_size) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Frame %u decoded to %" PRIu64 " bytes instead of %u", i, decoded, frames[i].raw_size);
+            result = 4;
+        }
+    }
+    
+    free(frames);
+    return result;
+}
+
+/**
+ * Decompresses data into a newly allocated buffer
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit applies (NULL for the process defaults)
+ * output_data: Pointer to store the decompressed data (free with free(); NULL if empty)
+ * output_size: Pointer to store the size of the decompressed data
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_decompress_alloc(const void* input_data, uint64_t input_size,
+                          const LzmaCodecSettings* settings,
+                          void** output_data, uint64_t* output_size) {
+    if (!output_data || !output_size) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid parameters for decompression");
+        return 1;
+    }
+    *output_data = NULL;
+    *output_size = 0;
+    if (!settings) {
+        settings = &s_default_settings;
+    }
+    
+    uint64_t decoder_usage = lzma_decoder_memory_usage(input_data, input_size, settings);
+    if (decoder_usage == 0) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid LZMA header");
+        return 4;
+    }
+    
+    // A recorded size is allocated once; the decoder fills it window by window
+    uint64_t recorded_size = lzma_get_decompressed_size(input_data, input_size);
+    WindowBuffer buffer = { NULL, 0, 0, 0 };
+    if (recorded_size > 0 && recorded_size != LZMA_UNKNOWN_SIZE) {
+        buffer.data = (Byte*)malloc((size_t)recorded_size);
+        if (!buffer.data) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Failed to allocate %" PRIu64 " bytes for decompression", recorded_size);
+            return 3;
+        }
+        buffer.capacity = recorded_size;
+        buffer.fixed = 1;
+        
+        // A dictionary the limit leaves no room for is replaced by the output itself,
+        // which the caller holds anyway, so the chunk still decodes within the limit
+        if (settings->memory_limit > 0 && decoder_usage > settings->memory_limit) {
+            uint64_t decoded_size = recorded_size;
+            int result = lzma_decompress_buffer(input_data, input_size, buffer.data, &decoded_size);
+            if (result == 0 && decoded_size != recorded_size) {
+                snprintf(s_error_message, sizeof(s_error_message),
+                        "LZMA stream decoded to %" PRIu64 " bytes instead of %" PRIu64, decoded_size, recorded_size);
+                result = 4;
+            }
+            if (result != 0) {
+                free(buffer.data);
+                return result;
+            }
+            *output_data = buffer.data;
+            *output_size = recorded_size;
+            return 0;
+        }
+    }
+    
+    // Windows fill the recorded size, or a buffer that doubles when there is none
+    int result = lzma_decompress_windows(input_data, input_size, settings, append_window, &buffer);
+    if (result == 0 && buffer.fixed && buffer.size != recorded_size) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "LZMA stream decoded to %" PRIu64 " bytes instead of %" PRIu64, buffer.size, recorded_size);
+        result = 4;
+    }
+    if (result != 0) {
+        free(buffer.data);
+        if (result == 6) {
+            // The consumer fails only on a failed allocation or more data than recorded
+            return buffer.fixed ? 4 : 3;
+        }
+        return result;
+    }
+    
+    *output_data = buffer.data;
+    *output_size = buffer.size;
+    return 0;
+}
+
+/**
+ * Gets the working memory lzma_decompress_alloc needs beside its output
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit sizes the window (NULL for the process defaults)
+ * 
+ * Return: Bytes of decoder state, or 0 if the header is invalid
+ */
+uint64_t lzma_decompress_alloc_memory_usage(const void* input_data, uint64_t input_size,
+                                            const LzmaCodecSettings* settings) {
+    if (!settings) {
+        settings = &s_default_settings;
+    }
+    uint64_t decoder_usage = lzma_decoder_memory_usage(input_data, input_size, settings);
+    if (decoder_usage == 0 || settings->memory_limit == 0 || decoder_usage <= settings->memory_limit) {
+        return decoder_usage;
+    }
+    
+    // Over the limit, a recorded size is decoded in place with only the probability tables
+    uint64_t recorded_size = lzma_get_decompressed_size(input_data, input_size);
+    if (recorded_size == 0 || recorded_size == LZMA_UNKNOWN_SIZE) {
+        return decoder_usage;
+    }
+    return in_place_memory_usage(input_data, input_size);
+}
+
+/**
+ * Gets the memory a windowed decode of the data needs
+ * 
+ * input_data: Pointer to the compressed data (plain or seekable)
+ * input_size: Size of the compressed data in bytes
+ * settings: Codec settings whose memory limit sizes the window (NULL for the process defaults)
+ * 
+ * Return: Bytes of decoder state and window, or 0 if the header is invalid
+ */
+uint64_t lzma_decoder_memory_usage(const void* input_data, uint64_t input_size,
+                                   const LzmaCodecSettings* settings) {
+    if (!settings) {
+        settings = &s_default_settings;
+    }
+    if (!input_data || input_size <= LZMA_PROPS_SIZE + 8) {
+        return 0;
+    }
+    
+    uint32_t frame_count = lzma_seekable_frame_count(input_data, input_size);
+    if (frame_count == 0) {
+        return plain_memory_usage((const Byte*)input_data, input_size, settings->memory_limit);
+    }
+    
+    LzmaSeekFrame* frames = (LzmaSeekFrame*)malloc((size_t)frame_count * sizeof(LzmaSeekFrame));
+    if (!frames) {
+        return 0;
+    }
+    
+    uint64_t usage = 0;
+    if (lzma_seekable_read_index(input_data, input_size, frames, frame_count) == 0) {
+        for (uint32_t i = 0; i < frame_count; i++) {
+            if (frames[i].encoded_offset + frames[i].encoded_size > input_size) {
+                usage = 0;
+                break;
+            }
+            uint64_t frame_usage = plain_memory_usage((const Byte*)input_data + frames[i].encoded_offset,
+                                                      frames[i].encoded_size, settings->memory_limit);
+            if (frame_usage == 0) {
+                usage = 0;
+                break;
+            }
+            if (frame_usage > usage) {
+                usage = frame_usage;
+            }
+        }
+    }
+    free(frames);
+    return usage;
+}
+
 /**
  * Decompresses data from a file using LZMA2 algorithm
  * 
@@ -282,11 +796,85 @@ uint64_t lzma_get_decompressed_size(const void* input_data, uint64_t input_size)
     return uncompressed_size;
 }
 
+/**
+ * Gets the number of frames of a seekable buffer
+ * 
+ * input_data: Pointer to the compressed data
+ * input_size: Size of the available data in bytes
+ * 
+ * Return: Number of frames, or 0 if the data is a plain LZMA buffer
+ */
+uint32_t lzma_seekable_frame_count(const void* input_data, uint64_t input_size) {
+    const Byte* header = (const Byte*)input_data;
+    if (!header || input_size < LZMA_SEEKABLE_HEADER_SIZE || header[0] != LZMA_SEEKABLE_MARKER) {
+        return 0;
+    }
+    return (uint32_t)get_le(header + 1, 4);
+}
+
+/**
+ * Gets the size of the header and frame table of a seekable buffer
+ * 
+ * frame_count: Number of frames from lzma_seekable_frame_count
+ * 
+ * Return: Bytes to read from the start of the buffer for lzma_seekable_read_index
+ */
+uint64_t lzma_seekable_index_size(uint32_t frame_count) {
+    return LZMA_SEEKABLE_HEADER_SIZE + (uint64_t)frame_count * LZMA_SEEKABLE_ENTRY_SIZE;
+}
+
+/**
+ * Reads the frame table of a seekable buffer
+ * 
+ * input_data: Start of the seekable buffer
+ * input_size: Available bytes, at least lzma_seekable_index_size(frame_count)
+ * frames: Array receiving one entry per frame
+ * frame_count: Number of frames from lzma_seekable_frame_count
+ * 
+ * Return: 0 on success, non-zero error code on failure
+ */
+int lzma_seekable_read_index(const void* input_data, uint64_t input_size,
+                             LzmaSeekFrame* frames, uint32_t frame_count) {
+    uint64_t index_size = lzma_seekable_index_size(frame_count);
+    if (!input_data || !frames || frame_count == 0 || input_size < index_size) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid parameters or truncated frame table");
+        return 1;
+    }
+    
+    const Byte* header = (const Byte*)input_data;
+    uint64_t total_size = get_le(header + LZMA_PROPS_SIZE, 8);
+    uint64_t row = 0;
+    uint64_t raw_offset = 0;
+    uint64_t encoded_offset = index_size;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const Byte* entry = header + LZMA_SEEKABLE_HEADER_SIZE + (uint64_t)i * LZMA_SEEKABLE_ENTRY_SIZE;
+        frames[i].first_row = row;
+        frames[i].row_count = (uint32_t)get_le(entry, 4);
+        frames[i].raw_offset = raw_offset;
+        frames[i].raw_size = (uint32_t)get_le(entry + 4, 4);
+        frames[i].encoded_offset = encoded_offset;
+        frames[i].encoded_size = (uint32_t)get_le(entry + 8, 4);
+        row += frames[i].row_count;
+        raw_offset += frames[i].raw_size;
+        encoded_offset += frames[i].encoded_size;
+    }
+    
+    if (raw_offset != total_size) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Frame table does not add up to the uncompressed size");
+        return 2;
+    }
+    return 0;
+}
+
 /**
  * Sets the LZMA decompression parameters
  * 
  * This function sets various LZMA decompression parameters. It should be called
- * before calling lzma_decompress_buffer or lzma_decompress_file.
+ * before calling lzma_decompress_buffer or lzma_decompress_file. The parameters
+ * are process-wide defaults for calls without explicit settings; set them
+ * before any decompression starts.
  * 
  * threads: Number of threads to use for decompression (0 for automatic)
  * memory_limit: Memory limit in bytes (0 for default)
@@ -294,8 +882,8 @@ uint64_t lzma_get_decompressed_size(const void* input_data, uint64_t input_size)
  * Return: 0 on success, non-zero error code on failure
  */
 int lzma_set_decompression_parameters(uint32_t threads, uint64_t memory_limit) {
-    g_threads = threads;
-    g_memory_limit = memory_limit;
+    s_default_settings.threads = threads;
+    s_default_settings.memory_limit = memory_limit;
     return 0;  // Success
 }
 
@@ -468,7 +1056,8 @@ void lzma_decompressor_free_buffer(void* buffer) {
  * Get the last error message from the decompressor
  * 
  * This function returns a string describing the last error that occurred.
- * The returned string is valid until the next call to any decompressor function.
+ * The returned string is valid until the next call to any decompressor function
+ * on the same thread.
  * 
  * returns: A string describing the last error, or NULL if no error occurred
  */
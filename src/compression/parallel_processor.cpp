@@ -7,6 +7,7 @@
  */
 
 #include "compression/parallel_processor.h"
+#include "compression/cpu_budget.h"
 #include <thread>
 #include <vector>
 #include <mutex>
@@ -15,11 +16,12 @@
 #include <cstdio>
 #include <memory>
 
-/* Static error message buffer */
-static char g_error_message[256] = {0};
+/* Per-thread error message buffer */
+static thread_local char g_error_message[256] = {0};
 
-/* Static configuration */
-static ParallelProcessorConfig g_config = {
+/* Configuration used by the calls without an explicit configuration; kept
+   per thread so that concurrent jobs cannot overwrite each other's settings */
+static thread_local ParallelProcessorConfig g_config = {
     0,              /* max_threads: 0 means auto-detect */
     1,              /* min_items_per_thread: Default to at least 1 item per thread */
     0,              /* thread_stack_size: 0 means use system default */
@@ -35,6 +37,7 @@ struct ThreadWork {
     uint32_t end_item;
     uint32_t total_items;
     WorkItemProcessor processor;
+    WorkerItemProcessor worker_processor;   /* Used instead of processor when set */
     ProcessingProgressCallback progress_callback;
     void* user_data;
     int result;
@@ -70,7 +73,9 @@ static void process_items_thread(ThreadWork* work) {
     
     for (item = work->start_item; item < work->end_item && result == 0; item++) {
         /* Call processor function for this item */
-        result = work->processor(item, work->total_items, work->user_data);
+        result = work->worker_processor ?
+                 work->worker_processor(work->thread_id, item, work->total_items, work->user_data) :
+                 work->processor(item, work->total_items, work->user_data);
         
         /* Report progress if callback is provided */
         if (work->progress_callback) {
@@ -196,21 +201,28 @@ void parallel_get_default_config(ParallelProcessorConfig* config) {
 }
 
 /**
- * Processes multiple work items in parallel
+ * Distribute work items over the worker threads; exactly one of processor
+ * and worker_processor is set
  */
-int parallel_process_items(WorkItemProcessor processor, 
+static int process_items(const ParallelProcessorConfig* config,
+                         WorkItemProcessor processor,
+                         WorkerItemProcessor worker_processor,
                          uint32_t num_items,
-                         uint32_t max_threads,
                          ProcessingProgressCallback progress_callback,
                          void* user_data) {
-    if (!processor || num_items == 0) {
+    if (!config) {
+        config = &g_config;
+    }
+    uint32_t min_items_per_thread = config->min_items_per_thread > 0 ? config->min_items_per_thread : 1;
+    
+    if ((!processor && !worker_processor) || num_items == 0) {
         snprintf(g_error_message, sizeof(g_error_message), 
                 "Invalid parameters for parallel processing");
         return PARALLEL_PROCESSOR_INVALID_PARAMETER;
     }
     
     /* Determine number of threads to use */
-    uint32_t available_threads = (max_threads > 0) ? max_threads : g_config.max_threads;
+    uint32_t available_threads = config->max_threads;
     if (available_threads == 0) {
         available_threads = parallel_get_optimal_threads();
     }
@@ -218,6 +230,12 @@ int parallel_process_items(WorkItemProcessor processor,
     /* Don't use more threads than items */
     uint32_t threads_to_use = (available_threads > num_items) ? num_items : available_threads;
     
+    /* Draw the worker threads from the shared CPU budget; when no tokens are
+       free the items are processed on the calling thread instead */
+    uint32_t granted_tokens = cpu_budget_try_acquire_threads(threads_to_use);
+    bool run_inline = (granted_tokens == 0);
+    threads_to_use = run_inline ? 1 : granted_tokens;
+    
     /* Allocate work structures */
     std::vector<ThreadWork> work(threads_to_use);
     
@@ -226,8 +244,8 @@ int parallel_process_items(WorkItemProcessor processor,
     uint32_t remainder = num_items % threads_to_use;
     
     /* Make sure each thread has at least the minimum number of items */
-    if (base_items_per_thread < g_config.min_items_per_thread) {
-        threads_to_use = num_items / g_config.min_items_per_thread;
+    if (base_items_per_thread < min_items_per_thread) {
+        threads_to_use = num_items / min_items_per_thread;
         if (threads_to_use == 0) threads_to_use = 1;
         
         base_items_per_thread = num_items / threads_to_use;
@@ -249,6 +267,7 @@ int parallel_process_items(WorkItemProcessor processor,
         work[i].end_item = start_item + work[i].items_per_thread;
         work[i].total_items = num_items;
         work[i].processor = processor;
+        work[i].worker_processor = worker_processor;
         work[i].progress_callback = progress_callback;
         work[i].user_data = user_data;
         work[i].result = 0;
@@ -261,8 +280,12 @@ int parallel_process_items(WorkItemProcessor processor,
     threads.reserve(threads_to_use);
     
     try {
-        for (uint32_t i = 0; i < threads_to_use; i++) {
-            threads.emplace_back(process_items_thread, &work[i]);
+        if (run_inline) {
+            process_items_thread(&work[0]);
+        } else {
+            for (uint32_t i = 0; i < threads_to_use; i++) {
+                threads.emplace_back(process_items_thread, &work[i]);
+            }
         }
         
         /* Wait for all threads to finish */
@@ -278,14 +301,65 @@ int parallel_process_items(WorkItemProcessor processor,
             }
         }
     } catch (const std::exception& e) {
+        for (auto& thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        cpu_budget_release_threads(granted_tokens);
         snprintf(g_error_message, sizeof(g_error_message), 
                 "Thread error: %s", e.what());
         return PARALLEL_PROCESSOR_THREAD_ERROR;
     }
     
+    cpu_budget_release_threads(granted_tokens);
     return result;
 }
 
+/**
+ * Processes multiple work items in parallel
+ */
+int parallel_process_items(WorkItemProcessor processor, 
+                         uint32_t num_items,
+                         uint32_t max_threads,
+                         ProcessingProgressCallback progress_callback,
+                         void* user_data) {
+    ParallelProcessorConfig config = g_config;
+    if (max_threads > 0) {
+        config.max_threads = max_threads;
+    }
+    
+    return parallel_process_items_with_config(&config, processor, num_items,
+                                              progress_callback, user_data);
+}
+
+/**
+ * Processes multiple work items in parallel, telling each item its worker
+ */
+int parallel_process_items_by_worker(WorkerItemProcessor processor,
+                                     uint32_t num_items,
+                                     uint32_t max_threads,
+                                     ProcessingProgressCallback progress_callback,
+                                     void* user_data) {
+    ParallelProcessorConfig config = g_config;
+    if (max_threads > 0) {
+        config.max_threads = max_threads;
+    }
+    
+    return process_items(&config, nullptr, processor, num_items, progress_callback, user_data);
+}
+
+/**
+ * Processes multiple work items in parallel with an explicit configuration
+ */
+int parallel_process_items_with_config(const ParallelProcessorConfig* config,
+                                       WorkItemProcessor processor,
+                                       uint32_t num_items,
+                                       ProcessingProgressCallback progress_callback,
+                                       void* user_data) {
+    return process_items(config, processor, nullptr, num_items, progress_callback, user_data);
+}
+
 /**
  * Execute a task in parallel for each row group in a parquet file
  */
@@ -296,6 +370,25 @@ ParallelProcessorError parallel_processor_process_row_groups(
     ParallelTaskCleanupFunction cleanup_function,
     void*** task_results
 ) {
+    return parallel_processor_process_row_groups_with_config(
+        &g_config, file, task_function, task_data, cleanup_function, task_results);
+}
+
+/**
+ * Execute a task in parallel for each row group with an explicit configuration
+ */
+ParallelProcessorError parallel_processor_process_row_groups_with_config(
+    const ParallelProcessorConfig* config,
+    const ParquetFile* file,
+    ParallelTaskFunction task_function,
+    void** task_data,
+    ParallelTaskCleanupFunction cleanup_function,
+    void*** task_results
+) {
+    if (!config) {
+        config = &g_config;
+    }
+    
     if (!file || !task_function || !task_data || !task_results) {
         snprintf(g_error_message, sizeof(g_error_message), 
                 "Invalid parameters for row group processing");
@@ -309,7 +402,7 @@ ParallelProcessorError parallel_processor_process_row_groups(
     }
     
     /* Determine number of threads to use */
-    uint32_t available_threads = g_config.max_threads;
+    uint32_t available_threads = config->max_threads;
     if (available_threads == 0) {
         available_threads = parallel_get_optimal_threads();
     }
@@ -318,12 +411,19 @@ ParallelProcessorError parallel_processor_process_row_groups(
     uint32_t threads_to_use = (available_threads > file->row_group_count) ? 
                             file->row_group_count : available_threads;
     
+    /* Draw the worker threads from the shared CPU budget; when no tokens are
+       free the row groups are processed one at a time on the calling thread */
+    uint32_t granted_tokens = cpu_budget_try_acquire_threads(threads_to_use);
+    bool run_inline = (granted_tokens == 0);
+    threads_to_use = run_inline ? 1 : granted_tokens;
+    
     /* Allocate task structures */
     std::vector<RowGroupTask> tasks(file->row_group_count);
     
     /* Allocate results array */
     void** results = (void**)malloc(file->row_group_count * sizeof(void*));
     if (!results) {
+        cpu_budget_release_threads(granted_tokens);
         snprintf(g_error_message, sizeof(g_error_message), 
                 "Failed to allocate memory for row group results");
         return PARALLEL_PROCESSOR_MEMORY_ERROR;
@@ -357,7 +457,11 @@ ParallelProcessorError parallel_processor_process_row_groups(
             
             for (uint32_t i = 0; i < batch_size; i++) {
                 uint32_t task_idx = start_idx + i;
-                threads.emplace_back(process_row_group_thread, &tasks[task_idx]);
+                if (run_inline) {
+                    process_row_group_thread(&tasks[task_idx]);
+                } else {
+                    threads.emplace_back(process_row_group_thread, &tasks[task_idx]);
+                }
             }
             
             /* Wait for threads in this batch to finish */
@@ -398,9 +502,12 @@ ParallelProcessorError parallel_processor_process_row_groups(
         }
         
         free(results);
+        cpu_budget_release_threads(granted_tokens);
         return PARALLEL_PROCESSOR_THREAD_ERROR;
     }
     
+    cpu_budget_release_threads(granted_tokens);
+    
     /* Return results even if some tasks failed */
     *task_results = results;
     return error;
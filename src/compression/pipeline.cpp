@@ -0,0 +1,610 @@
+/**
+ * pipeline.cpp
+ *
+ * This file implements the staged pipeline declared in pipeline.h. The
+ * inter-stage queues are bounded multi-producer/multi-consumer ring buffers
+ * in which every cell carries its own turn counter, so producers and
+ * consumers only synchronise through atomics on the cell they claim and
+ * never take a lock. A stage that finds its queue empty or full spins
+ * briefly and then sleeps on an event count until the other side makes
+ * progress, so idle stages cost no CPU.
+ */
+
+#include "compression/pipeline.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <system_error>
+
+/* Per-thread error message buffer */
+static thread_local char g_error_message[256] = {0};
+
+/* Names of the stages, used in error messages */
+static const char* const g_stage_names[PIPELINE_STAGE_COUNT] = {
+    "read", "analyze", "encode", "write"
+};
+
+namespace {
+
+/* Spins before a waiting stage goes to sleep */
+static const uint32_t PIPELINE_SPIN_LIMIT = 128;
+
+/* Longest the writer sleeps before polling the cancel function again */
+static const std::chrono::milliseconds PIPELINE_CANCEL_POLL(5);
+
+/**
+ * Event count used to sleep until another thread makes progress
+ *
+ * A waiter registers with prepare_wait, re-checks its condition and then
+ * calls wait (or cancel_wait if the condition already holds). notify only
+ * takes the lock when someone is registered, so the fast path of a busy
+ * pipeline stays lock-free.
+ */
+class EventCount {
+public:
+    EventCount() : waiters_(0), epoch_(0) {}
+
+    uint64_t prepare_wait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(mutex_);
+        return epoch_;
+    }
+
+    void cancel_wait() {
+        waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    /* Sleep until notify is called after prepare_wait returned key, or the timeout expires */
+    void wait(uint64_t key, std::chrono::milliseconds timeout = std::chrono::milliseconds::zero()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (timeout.count() > 0) {
+                cond_.wait_for(lock, timeout, [&] { return epoch_ != key; });
+            } else {
+                cond_.wait(lock, [&] { return epoch_ != key; });
+            }
+        }
+        waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            epoch_++;
+        }
+        cond_.notify_all();
+    }
+
+private:
+    std::atomic<uint32_t> waiters_;
+    uint64_t epoch_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+};
+
+/* A work item travelling between two stages */
+struct PipelineSlot {
+    uint64_t sequence;
+    void* item;
+};
+
+/**
+ * Bounded lock-free MPMC queue
+ *
+ * Each cell's turn counter tells producers and consumers whether the cell
+ * is free for the lap they are on. A producer claims a position by advancing
+ * tail_, fills the cell and publishes it by bumping the turn; consumers do
+ * the same with head_. try_push fails when the queue is full and try_pop
+ * fails when it is empty; neither ever blocks. Successful operations wake
+ * threads sleeping on the opposite event.
+ */
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : tail_(0), head_(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            cells_[i].turn.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(const PipelineSlot& slot) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t turn = cell.turn.load(std::memory_order_acquire);
+            ptrdiff_t diff = (ptrdiff_t)turn - (ptrdiff_t)pos;
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.slot = slot;
+                    cell.turn.store(pos + 1, std::memory_order_release);
+                    not_empty.notify();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  /* Full */
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(PipelineSlot& slot) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t turn = cell.turn.load(std::memory_order_acquire);
+            ptrdiff_t diff = (ptrdiff_t)turn - (ptrdiff_t)(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot = cell.slot;
+                    cell.turn.store(pos + mask_ + 1, std::memory_order_release);
+                    not_full.notify();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  /* Empty */
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    EventCount not_empty;   /* Notified after every push */
+    EventCount not_full;    /* Notified after every pop */
+
+private:
+    struct Cell {
+        std::atomic<size_t> turn;
+        PipelineSlot slot;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) std::atomic<size_t> head_;
+};
+
+/* A transform stage that is active in the current run */
+struct TransformStage {
+    PipelineStage stage;
+    PipelineTransformFunction function;
+    uint32_t threads;
+    BoundedQueue* input;
+    BoundedQueue* output;
+    std::atomic<uint64_t> taken;
+};
+
+/* Shared state of one pipeline_run call */
+struct PipelineRun {
+    const PipelineStages* stages;
+    uint64_t item_count;
+    uint64_t window;
+    std::atomic<uint64_t> next_read;
+    std::atomic<uint64_t> written;      /* Items the writer has finished */
+    EventCount window_open;             /* Notified when written advances */
+    std::vector<EventCount*> events;    /* Every event a stage may sleep on */
+    std::atomic<bool> aborted;
+    std::atomic<bool> cancelled;
+
+    std::mutex error_mutex;
+    bool has_error;
+    PipelineStage failed_stage;
+    uint64_t failed_sequence;
+    int failed_code;
+};
+
+/* Abort the run and wake every sleeping stage so it can notice */
+void abort_run(PipelineRun* run) {
+    run->aborted.store(true, std::memory_order_seq_cst);
+    for (EventCount* event : run->events) {
+        event->notify();
+    }
+}
+
+/**
+ * Wait until ready() holds or the run is aborted
+ *
+ * Spins and then yields for a short while so a busy stage reacts within a
+ * few hundred nanoseconds, then sleeps on the event. If timeout is non-zero
+ * the sleep is cut short so the caller can poll something else; the function
+ * then returns false with ready() still unmet.
+ *
+ * returns: true if ready() holds, false if the run was aborted or timed out
+ */
+template <typename Ready>
+bool wait_for_event(PipelineRun* run, EventCount& event, Ready ready,
+                    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero()) {
+    for (uint32_t spins = 0; spins < PIPELINE_SPIN_LIMIT; spins++) {
+        if (ready()) {
+            return true;
+        }
+        if (run->aborted.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (spins >= PIPELINE_SPIN_LIMIT / 2) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (;;) {
+        uint64_t key = event.prepare_wait();
+        if (ready()) {
+            event.cancel_wait();
+            return true;
+        }
+        if (run->aborted.load(std::memory_order_seq_cst)) {
+            event.cancel_wait();
+            return false;
+        }
+        event.wait(key, timeout);
+        if (timeout.count() > 0) {
+            return ready();
+        }
+    }
+}
+
+void release_item(PipelineRun* run, void* item) {
+    if (item && run->stages->cleanup) {
+        run->stages->cleanup(item, run->stages->user_data);
+    }
+}
+
+/* Record the first failure and tell every stage to stop */
+void fail_run(PipelineRun* run, PipelineStage stage, uint64_t sequence, int code) {
+    {
+        std::lock_guard<std::mutex> lock(run->error_mutex);
+        if (!run->has_error) {
+            run->has_error = true;
+            run->failed_stage = stage;
+            run->failed_sequence = sequence;
+            run->failed_code = code;
+        }
+    }
+    abort_run(run);
+}
+
+/* Poll the cancel function and abort the run if it asks to stop */
+bool check_cancelled(PipelineRun* run) {
+    if (run->stages->cancelled && run->stages->cancelled(run->stages->user_data)) {
+        run->cancelled.store(true, std::memory_order_relaxed);
+        abort_run(run);
+        return true;
+    }
+    return false;
+}
+
+/* Push with back-pressure: wait while the queue is full unless the run was aborted */
+bool push_slot(PipelineRun* run, BoundedQueue* queue, const PipelineSlot& slot) {
+    return wait_for_event(run, queue->not_full, [&] { return queue->try_push(slot); });
+}
+
+/**
+ * Claim the next sequence number to read
+ *
+ * A sequence number is only handed out once it lies inside the reorder
+ * window, i.e. less than window items ahead of the writer; otherwise the
+ * reader sleeps until the writer catches up.
+ *
+ * returns: true with sequence set, false when all items are claimed or the run stopped
+ */
+bool claim_sequence(PipelineRun* run, uint64_t& sequence) {
+    bool exhausted = false;
+    bool claimed = wait_for_event(run, run->window_open, [&] {
+        uint64_t next = run->next_read.load(std::memory_order_relaxed);
+        for (;;) {
+            if (next >= run->item_count) {
+                exhausted = true;
+                return true;
+            }
+            if (next >= run->written.load(std::memory_order_acquire) + run->window) {
+                return false;
+            }
+            if (run->next_read.compare_exchange_weak(next, next + 1, std::memory_order_relaxed)) {
+                sequence = next;
+                return true;
+            }
+        }
+    });
+    return claimed && !exhausted;
+}
+
+void read_stage_thread(PipelineRun* run, BoundedQueue* output) {
+    while (!run->aborted.load(std::memory_order_acquire) && !check_cancelled(run)) {
+        uint64_t sequence = 0;
+        if (!claim_sequence(run, sequence)) {
+            break;
+        }
+
+        void* item = NULL;
+        int rc = run->stages->read(sequence, &item, run->stages->user_data);
+        if (rc != 0) {
+            release_item(run, item);
+            fail_run(run, PIPELINE_STAGE_READ, sequence, rc);
+            break;
+        }
+
+        PipelineSlot slot = { sequence, item };
+        if (!push_slot(run, output, slot)) {
+            release_item(run, item);
+            break;
+        }
+    }
+}
+
+void transform_stage_thread(PipelineRun* run, TransformStage* stage) {
+    for (;;) {
+        /* Sleep until an item arrives or every item has been claimed by some thread of this stage */
+        PipelineSlot slot;
+        bool have_slot = false;
+        bool ready = wait_for_event(run, stage->input->not_empty, [&] {
+            have_slot = stage->input->try_pop(slot);
+            return have_slot || stage->taken.load(std::memory_order_acquire) >= run->item_count;
+        });
+        if (!ready || !have_slot) {
+            break;
+        }
+
+        /* The thread claiming the last item wakes the others so they can exit */
+        if (stage->taken.fetch_add(1, std::memory_order_acq_rel) + 1 == run->item_count) {
+            stage->input->not_empty.notify();
+        }
+
+        int rc = stage->function(slot.sequence, slot.item, run->stages->user_data);
+        if (rc != 0) {
+            release_item(run, slot.item);
+            fail_run(run, stage->stage, slot.sequence, rc);
+            break;
+        }
+
+        if (!push_slot(run, stage->output, slot)) {
+            release_item(run, slot.item);
+            break;
+        }
+    }
+}
+
+/**
+ * Ordered write stage, run on the calling thread
+ *
+ * Items arrive in completion order; they are parked in a reorder map until
+ * every earlier sequence number has been written. Readers stay inside the
+ * reorder window, so the map never holds more than window items.
+ */
+void write_stage(PipelineRun* run, BoundedQueue* input) {
+    std::map<uint64_t, void*> pending;
+    uint64_t next_write = 0;
+
+    while (next_write < run->item_count && !run->aborted.load(std::memory_order_acquire)) {
+        PipelineSlot slot;
+        if (!wait_for_event(run, input->not_empty, [&] { return input->try_pop(slot); },
+                            PIPELINE_CANCEL_POLL)) {
+            if (check_cancelled(run)) {
+                break;
+            }
+            continue;
+        }
+        pending.emplace(slot.sequence, slot.item);
+
+        std::map<uint64_t, void*>::iterator it;
+        while ((it = pending.find(next_write)) != pending.end()) {
+            int rc = 0;
+            if (run->stages->write) {
+                rc = run->stages->write(it->first, it->second, run->stages->user_data);
+            }
+            release_item(run, it->second);
+            pending.erase(it);
+
+            if (rc != 0) {
+                fail_run(run, PIPELINE_STAGE_WRITE, next_write, rc);
+                break;
+            }
+            next_write++;
+            run->written.store(next_write, std::memory_order_release);
+            run->window_open.notify();
+        }
+    }
+
+    /* Release anything still waiting for an earlier item after an abort */
+    for (auto& entry : pending) {
+        release_item(run, entry.second);
+    }
+}
+
+void drain_queue(PipelineRun* run, BoundedQueue* queue) {
+    PipelineSlot slot;
+    while (queue->try_pop(slot)) {
+        release_item(run, slot.item);
+    }
+}
+
+} // namespace
+
+/**
+ * Gets the default configuration for the pipeline
+ */
+void pipeline_get_default_config(PipelineConfig* config) {
+    if (!config) {
+        return;
+    }
+
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        cores = 1;
+    }
+
+    config->reader_threads = 1;
+    config->analyzer_threads = 1;
+    config->codec_threads = cores;
+    config->queue_depth = cores * 2 < 4 ? 4 : cores * 2;
+    config->reorder_window = 0;
+}
+
+/**
+ * Run items through the pipeline
+ */
+PipelineError pipeline_run(
+    const PipelineConfig* config,
+    const PipelineStages* stages,
+    uint64_t item_count
+) {
+    g_error_message[0] = '\0';
+
+    if (!stages || !stages->read) {
+        snprintf(g_error_message, sizeof(g_error_message),
+                "Invalid parameters: stages and read function must be provided");
+        return PIPELINE_INVALID_PARAMETER;
+    }
+
+    if (item_count == 0) {
+        return PIPELINE_OK;
+    }
+
+    /* Fill in defaults for anything left at zero */
+    PipelineConfig defaults;
+    pipeline_get_default_config(&defaults);
+    PipelineConfig cfg = config ? *config : defaults;
+    if (cfg.reader_threads == 0) cfg.reader_threads = defaults.reader_threads;
+    if (cfg.analyzer_threads == 0) cfg.analyzer_threads = defaults.analyzer_threads;
+    if (cfg.codec_threads == 0) cfg.codec_threads = defaults.codec_threads;
+    if (cfg.queue_depth == 0) cfg.queue_depth = defaults.queue_depth;
+
+    PipelineRun run;
+    run.stages = stages;
+    run.item_count = item_count;
+    run.window = 0;
+    run.next_read.store(0);
+    run.written.store(0);
+    run.aborted.store(false);
+    run.cancelled.store(false);
+    run.has_error = false;
+    run.failed_stage = PIPELINE_STAGE_READ;
+    run.failed_sequence = 0;
+    run.failed_code = 0;
+
+    /* Only stages with a function get threads; the others are skipped */
+    TransformStage transforms[2];
+    uint32_t transform_count = 0;
+    if (stages->analyze) {
+        transforms[transform_count].stage = PIPELINE_STAGE_ANALYZE;
+        transforms[transform_count].function = stages->analyze;
+        transforms[transform_count].threads = cfg.analyzer_threads;
+        transform_count++;
+    }
+    if (stages->encode) {
+        transforms[transform_count].stage = PIPELINE_STAGE_ENCODE;
+        transforms[transform_count].function = stages->encode;
+        transforms[transform_count].threads = cfg.codec_threads;
+        transform_count++;
+    }
+
+    std::vector<std::unique_ptr<BoundedQueue>> queues;
+    try {
+        for (uint32_t i = 0; i <= transform_count; i++) {
+            queues.emplace_back(new BoundedQueue(cfg.queue_depth));
+        }
+    } catch (const std::bad_alloc&) {
+        snprintf(g_error_message, sizeof(g_error_message),
+                "Memory allocation failed for pipeline queues");
+        return PIPELINE_MEMORY_ERROR;
+    }
+
+    for (uint32_t i = 0; i < transform_count; i++) {
+        transforms[i].input = queues[i].get();
+        transforms[i].output = queues[i + 1].get();
+        transforms[i].taken.store(0);
+    }
+
+    /* By default the window is what the queues and stage threads can hold at once */
+    if (cfg.reorder_window > 0) {
+        run.window = cfg.reorder_window;
+    } else {
+        run.window = (uint64_t)cfg.queue_depth * (transform_count + 1) + cfg.reader_threads;
+        for (uint32_t i = 0; i < transform_count; i++) {
+            run.window += transforms[i].threads;
+        }
+    }
+
+    run.events.push_back(&run.window_open);
+    for (auto& queue : queues) {
+        run.events.push_back(&queue->not_empty);
+        run.events.push_back(&queue->not_full);
+    }
+
+    /* Start the stage threads */
+    std::vector<std::thread> threads;
+    bool thread_error = false;
+    try {
+        for (uint32_t i = 0; i < cfg.reader_threads; i++) {
+            threads.emplace_back(read_stage_thread, &run, queues[0].get());
+        }
+        for (uint32_t t = 0; t < transform_count; t++) {
+            for (uint32_t i = 0; i < transforms[t].threads; i++) {
+                threads.emplace_back(transform_stage_thread, &run, &transforms[t]);
+            }
+        }
+    } catch (const std::system_error&) {
+        thread_error = true;
+        abort_run(&run);
+    }
+
+    if (!thread_error) {
+        write_stage(&run, queues[transform_count].get());
+    }
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    /* Release items left in the queues after an abort */
+    for (auto& queue : queues) {
+        drain_queue(&run, queue.get());
+    }
+
+    if (thread_error) {
+        snprintf(g_error_message, sizeof(g_error_message),
+                "Failed to create pipeline threads");
+        return PIPELINE_THREAD_ERROR;
+    }
+
+    if (run.has_error) {
+        snprintf(g_error_message, sizeof(g_error_message),
+                "Pipeline %s stage failed on item %llu (error code %d)",
+                g_stage_names[run.failed_stage],
+                (unsigned long long)run.failed_sequence,
+                run.failed_code);
+        return PIPELINE_STAGE_ERROR;
+    }
+
+    if (run.cancelled.load()) {
+        snprintf(g_error_message, sizeof(g_error_message), "Pipeline cancelled");
+        return PIPELINE_CANCELLED;
+    }
+
+    return PIPELINE_OK;
+}
+
+/**
+ * Get the last error message from the pipeline
+ */
+const char* pipeline_get_error(void) {
+    return g_error_message[0] != '\0' ? g_error_message : NULL;
+}
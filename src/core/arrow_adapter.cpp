@@ -10,16 +10,21 @@
 #include <vector>
 #include <cstring>
 #include <cstdarg>  // For va_start and va_end
+#include <limits>
+#include <cmath>
+#include "compression/parallel_processor.h"
 #include "arrow/api.h"
 #include "arrow/io/api.h"
+#include "arrow/io/stdio.h"
 #include "arrow/buffer.h"
 #include "arrow/csv/api.h"
 #include "parquet/arrow/reader.h"
 #include "parquet/arrow/writer.h"
 #include "parquet/exception.h"
+#include "parquet/statistics.h"
 
 // Static error message buffer
-static char s_last_error[1024] = {0};
+static thread_local char s_last_error[1024] = {0};
 
 // Set the last error message
 static void set_error(const char* format, ...) {
@@ -59,6 +64,88 @@ static ParquetValueType convert_arrow_type(const std::shared_ptr<arrow::DataType
     }
 }
 
+// Copy the footer statistics of a column chunk, keeping only those that can be trusted:
+// is_stats_set() rejects writers with known statistics bugs and sort orders the reader
+// cannot interpret, integers must be ordered as signed values, as scans compare them,
+// and floating-point bounds must not be NaN
+static void read_column_statistics(const parquet::ColumnChunkMetaData& chunk,
+                                   const parquet::ColumnDescriptor* descriptor,
+                                   ParquetColumnStatistics* statistics) {
+    memset(statistics, 0, sizeof(ParquetColumnStatistics));
+    if (!chunk.is_stats_set()) {
+        return;
+    }
+    std::shared_ptr<parquet::Statistics> stats = chunk.statistics();
+    if (!stats) {
+        return;
+    }
+    
+    if (stats->HasNullCount() && stats->null_count() >= 0) {
+        statistics->has_null_count = true;
+        statistics->null_count = static_cast<uint64_t>(stats->null_count());
+    }
+    if (!stats->HasMinMax()) {
+        return;
+    }
+    
+    double min_value;
+    double max_value;
+    switch (descriptor->physical_type()) {
+        case parquet::Type::BOOLEAN: {
+            auto typed = std::static_pointer_cast<parquet::BoolStatistics>(stats);
+            min_value = typed->min() ? 1.0 : 0.0;
+            max_value = typed->max() ? 1.0 : 0.0;
+            break;
+        }
+        case parquet::Type::INT32: {
+            if (descriptor->sort_order() != parquet::SortOrder::SIGNED) {
+                return;
+            }
+            auto typed = std::static_pointer_cast<parquet::Int32Statistics>(stats);
+            min_value = static_cast<double>(typed->min());
+            max_value = static_cast<double>(typed->max());
+            break;
+        }
+        case parquet::Type::INT64: {
+            if (descriptor->sort_order() != parquet::SortOrder::SIGNED) {
+                return;
+            }
+            auto typed = std::static_pointer_cast<parquet::Int64Statistics>(stats);
+            min_value = static_cast<double>(typed->min());
+            max_value = static_cast<double>(typed->max());
+            break;
+        }
+        case parquet::Type::FLOAT: {
+            auto typed = std::static_pointer_cast<parquet::FloatStatistics>(stats);
+            min_value = static_cast<double>(typed->min());
+            max_value = static_cast<double>(typed->max());
+            break;
+        }
+        case parquet::Type::DOUBLE: {
+            auto typed = std::static_pointer_cast<parquet::DoubleStatistics>(stats);
+            min_value = typed->min();
+            max_value = typed->max();
+            break;
+        }
+        case parquet::Type::INT96: {
+            // Truncated to whole seconds, like scanned timestamps
+            auto typed = std::static_pointer_cast<parquet::TypedStatistics<parquet::Int96Type>>(stats);
+            min_value = static_cast<double>(parquet::Int96GetNanoSeconds(typed->min()) / 1000000000);
+            max_value = static_cast<double>(parquet::Int96GetNanoSeconds(typed->max()) / 1000000000);
+            break;
+        }
+        default:
+            return;
+    }
+    
+    if (std::isnan(min_value) || std::isnan(max_value) || min_value > max_value) {
+        return;
+    }
+    statistics->has_min_max = true;
+    statistics->min_value = min_value;
+    statistics->max_value = max_value;
+}
+
 /**
  * Read the structure of a Parquet file using Arrow
  */
@@ -218,6 +305,9 @@ int arrow_read_parquet_structure(const char* file_path, ParquetFile* parquet_fil
                 column->compression_path = NULL;
                 column->column_data = NULL;
                 
+                // Footer statistics, which can answer numeric and timestamp metadata without a scan
+                read_column_statistics(*column_metadata, column_desc, &column->statistics);
+                
                 // Get page information if possible
                 column->page_count = 0;
                 column->pages = NULL;
@@ -260,6 +350,14 @@ int arrow_read_parquet_structure(const char* file_path, ParquetFile* parquet_fil
  */
 int arrow_read_column_data(const char* file_path, int row_group_id, int column_id, 
                            void** buffer, size_t* buffer_size) {
+    return arrow_read_column_data_with_validity(file_path, row_group_id, column_id, buffer, buffer_size, NULL);
+}
+
+/**
+ * Read column data and its validity bitmap from a Parquet file using Arrow
+ */
+int arrow_read_column_data_with_validity(const char* file_path, int row_group_id, int column_id,
+                                         void** buffer, size_t* buffer_size, uint8_t** validity) {
     if (!file_path || !buffer || !buffer_size) {
         set_error("Invalid parameters");
         return -1;
@@ -268,6 +366,9 @@ int arrow_read_column_data(const char* file_path, int row_group_id, int column_i
     // Initialize output parameters
     *buffer = NULL;
     *buffer_size = 0;
+    if (validity) {
+        *validity = NULL;
+    }
     
     try {
         // Open the file
@@ -547,6 +648,29 @@ int arrow_read_column_data(const char* file_path, int row_group_id, int column_i
             }
         }
         
+        // Null rows hold 0 (or an empty string) in the buffer; the bitmap tells them apart
+        if (validity && column_chunk->null_count() > 0) {
+            size_t num_values = column_chunk->length();
+            uint8_t* bits = static_cast<uint8_t*>(calloc((num_values + 7) / 8, 1));
+            if (!bits) {
+                set_error("Failed to allocate memory for the validity bitmap");
+                free(*buffer);
+                *buffer = NULL;
+                *buffer_size = 0;
+                return -1;
+            }
+            size_t row = 0;
+            for (int chunk_idx = 0; chunk_idx < column_chunk->num_chunks(); chunk_idx++) {
+                std::shared_ptr<arrow::Array> chunk = column_chunk->chunk(chunk_idx);
+                for (int64_t i = 0; i < chunk->length() && row < num_values; i++, row++) {
+                    if (chunk->IsValid(i)) {
+                        bits[row / 8] |= static_cast<uint8_t>(1u << (row % 8));
+                    }
+                }
+            }
+            *validity = bits;
+        }
+        
         return 0;
     } catch (const std::exception& e) {
         set_error("Arrow exception: %s", e.what());
@@ -559,6 +683,205 @@ int arrow_read_column_data(const char* file_path, int row_group_id, int column_i
     }
 }
 
+// Convert ParquetValueType to the Arrow type written for it
+static std::shared_ptr<arrow::DataType> make_arrow_type(ParquetValueType type, int fixed_len) {
+    switch (type) {
+        case PARQUET_BOOLEAN:
+            return arrow::boolean();
+        case PARQUET_INT32:
+            return arrow::int32();
+        case PARQUET_INT64:
+            return arrow::int64();
+        case PARQUET_FLOAT:
+            return arrow::float32();
+        case PARQUET_DOUBLE:
+            return arrow::float64();
+        case PARQUET_STRING:
+            return arrow::utf8();
+        case PARQUET_TIMESTAMP:
+            return arrow::timestamp(arrow::TimeUnit::MICRO);
+        case PARQUET_FIXED_LEN_BYTE_ARRAY:
+            return arrow::fixed_size_binary(fixed_len);
+        case PARQUET_INT96:
+            // INT96 is always 12 bytes (96 bits)
+            return arrow::fixed_size_binary(12);
+        default:
+            return arrow::binary();
+    }
+}
+
+// Size of one value in a column buffer, or 0 for length-prefixed values
+static size_t fixed_value_size(ParquetValueType type, int fixed_len) {
+    switch (type) {
+        case PARQUET_BOOLEAN:
+            return sizeof(bool);
+        case PARQUET_INT32:
+            return sizeof(int32_t);
+        case PARQUET_FLOAT:
+            return sizeof(float);
+        case PARQUET_INT64:
+        case PARQUET_TIMESTAMP:
+            return sizeof(int64_t);
+        case PARQUET_DOUBLE:
+            return sizeof(double);
+        case PARQUET_INT96:
+            return 12;
+        case PARQUET_FIXED_LEN_BYTE_ARRAY:
+            return fixed_len > 0 ? (size_t)fixed_len : 0;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Gets the size of one value in the arrow_read_column_data layout
+ */
+size_t arrow_column_value_size(ParquetValueType type, int fixed_len) {
+    return fixed_value_size(type, fixed_len);
+}
+
+/**
+ * Count the values in a column buffer
+ * 
+ * Buffers use the layout produced by arrow_read_column_data: fixed-width
+ * values back to back, or uint32_t length + bytes for variable-length values.
+ * 
+ * Returns: Number of values, or -1 if the buffer is malformed
+ */
+static int64_t count_column_values(ParquetValueType type, int fixed_len, const void* data, size_t size) {
+    size_t value_size = fixed_value_size(type, fixed_len);
+    if (value_size > 0) {
+        return size % value_size == 0 ? (int64_t)(size / value_size) : -1;
+    }
+    if (type == PARQUET_FIXED_LEN_BYTE_ARRAY) {
+        return -1;
+    }
+    
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t offset = 0;
+    int64_t count = 0;
+    while (offset < size) {
+        uint32_t length = 0;
+        if (size - offset < sizeof(uint32_t)) {
+            return -1;
+        }
+        memcpy(&length, bytes + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if (size - offset < length) {
+            return -1;
+        }
+        offset += length;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Build an Arrow array from a column buffer
+ * 
+ * Fixed-width columns are appended with a single AppendValues call; variable
+ * length columns are sized in one pass and copied without per-value checks.
+ * A missing buffer produces row_count nulls.
+ */
+static arrow::Status build_column_array(ParquetValueType type, int fixed_len,
+                                        const void* data, size_t size, int64_t row_count,
+                                        std::shared_ptr<arrow::Array>* out) {
+    std::shared_ptr<arrow::DataType> data_type = make_arrow_type(type, fixed_len);
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    ARROW_RETURN_NOT_OK(arrow::MakeBuilder(arrow::default_memory_pool(), data_type, &builder));
+    ARROW_RETURN_NOT_OK(builder->Reserve(row_count));
+    
+    if (!data || size == 0) {
+        ARROW_RETURN_NOT_OK(builder->AppendNulls(row_count));
+        return builder->Finish(out);
+    }
+    
+    size_t value_size = fixed_value_size(type, fixed_len);
+    if (value_size > 0 && size < (size_t)row_count * value_size) {
+        return arrow::Status::Invalid("column buffer holds fewer than ", row_count, " values");
+    }
+    
+    switch (type) {
+        case PARQUET_BOOLEAN:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::BooleanBuilder*>(builder.get())->AppendValues(
+                static_cast<const uint8_t*>(data), row_count));
+            break;
+        case PARQUET_INT32:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::Int32Builder*>(builder.get())->AppendValues(
+                static_cast<const int32_t*>(data), row_count));
+            break;
+        case PARQUET_INT64:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::Int64Builder*>(builder.get())->AppendValues(
+                static_cast<const int64_t*>(data), row_count));
+            break;
+        case PARQUET_FLOAT:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::FloatBuilder*>(builder.get())->AppendValues(
+                static_cast<const float*>(data), row_count));
+            break;
+        case PARQUET_DOUBLE:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::DoubleBuilder*>(builder.get())->AppendValues(
+                static_cast<const double*>(data), row_count));
+            break;
+        case PARQUET_TIMESTAMP:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::TimestampBuilder*>(builder.get())->AppendValues(
+                static_cast<const int64_t*>(data), row_count));
+            break;
+        case PARQUET_FIXED_LEN_BYTE_ARRAY:
+        case PARQUET_INT96:
+            ARROW_RETURN_NOT_OK(static_cast<arrow::FixedSizeBinaryBuilder*>(builder.get())->AppendValues(
+                static_cast<const uint8_t*>(data), row_count));
+            break;
+        default: {
+            // Strings and binary values: uint32_t length followed by the bytes
+            if (count_column_values(type, fixed_len, data, size) < row_count) {
+                return arrow::Status::Invalid("malformed variable-length column buffer");
+            }
+            
+            // StringBuilder derives from BinaryBuilder, so one path serves both
+            auto binary_builder = static_cast<arrow::BinaryBuilder*>(builder.get());
+            ARROW_RETURN_NOT_OK(binary_builder->ReserveData(
+                (int64_t)size - row_count * (int64_t)sizeof(uint32_t)));
+            
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            size_t offset = 0;
+            for (int64_t j = 0; j < row_count; j++) {
+                uint32_t length = 0;
+                memcpy(&length, bytes + offset, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                binary_builder->UnsafeAppend(bytes + offset, (int32_t)length);
+                offset += length;
+            }
+            break;
+        }
+    }
+    
+    return builder->Finish(out);
+}
+
+// Map a CompressionType to the Parquet page codec
+static bool to_parquet_codec(CompressionType compression, parquet::Compression::type* codec) {
+    switch (compression) {
+        case COMPRESSION_NONE:
+            *codec = parquet::Compression::UNCOMPRESSED;
+            return true;
+        case COMPRESSION_SNAPPY:
+            *codec = parquet::Compression::SNAPPY;
+            return true;
+        case COMPRESSION_GZIP:
+            *codec = parquet::Compression::GZIP;
+            return true;
+        case COMPRESSION_LZ4:
+            *codec = parquet::Compression::LZ4;
+            return true;
+        case COMPRESSION_ZSTD:
+            *codec = parquet::Compression::ZSTD;
+            return true;
+        default:
+            // LZMA2 is the archive codec; Parquet pages cannot use it
+            return false;
+    }
+}
+
 /**
  * Create a Parquet file from column data using Arrow
  * 
@@ -579,285 +902,284 @@ int arrow_create_parquet_file(const char* file_path, void** column_data, size_t*
         return -1;
     }
     
+    ArrowParquetWriter* writer = arrow_writer_open(file_path, NULL, schema, fixed_len_sizes,
+                                                   column_count, NULL);
+    if (!writer) {
+        return -1;
+    }
+    
+    // The whole file is a single row group, as it was when the table was built in one piece
+    int result = arrow_writer_write_row_group(writer, (const void* const*)column_data,
+                                              column_sizes, row_count);
+    if (result != 0) {
+        std::string message = s_last_error;
+        arrow_writer_close(writer);
+        set_error("%s", message.c_str());
+        return result;
+    }
+    
+    return arrow_writer_close(writer);
+}
+
+/**
+ * Streaming Parquet writer state
+ */
+struct ArrowParquetWriter {
+    std::vector<ParquetValueType> types;
+    std::vector<int> fixed_lens;
+    std::shared_ptr<arrow::Schema> schema;
+    std::unique_ptr<parquet::arrow::FileWriter> file_writer;
+    uint32_t encode_threads;
+};
+
+/**
+ * Get the default options for the streaming writer
+ */
+void arrow_writer_get_default_options(ArrowWriterOptions* options) {
+    if (!options) {
+        return;
+    }
+    options->compression = COMPRESSION_NONE;
+    options->compression_level = 0;
+    options->data_page_size = 0;
+    options->encode_threads = 0;
+}
+
+/**
+ * Open a streaming Parquet writer
+ */
+ArrowParquetWriter* arrow_writer_open(const char* file_path, const char* const* column_names,
+                                      const ParquetValueType* types, const int* fixed_len_sizes,
+                                      int column_count, const ArrowWriterOptions* options) {
+    if (!file_path || !types || column_count <= 0) {
+        set_error("Invalid parameters");
+        return NULL;
+    }
+    
+    ArrowWriterOptions defaults;
+    arrow_writer_get_default_options(&defaults);
+    if (!options) {
+        options = &defaults;
+    }
+    
+    parquet::Compression::type codec;
+    if (!to_parquet_codec(options->compression, &codec)) {
+        set_error("Compression type %d cannot be used for Parquet pages", (int)options->compression);
+        return NULL;
+    }
+    
     try {
-        // Create a schema based on the provided types
-        std::vector<std::shared_ptr<arrow::Field>> fields;
+        std::unique_ptr<ArrowParquetWriter> writer(new ArrowParquetWriter());
+        
         for (int i = 0; i < column_count; i++) {
-            std::shared_ptr<arrow::DataType> data_type;
-            
-            // Convert ParquetValueType to Arrow DataType
-            switch (schema[i]) {
-                case PARQUET_BOOLEAN:
-                    data_type = arrow::boolean();
-                    break;
-                case PARQUET_INT32:
-                    data_type = arrow::int32();
-                    break;
-                case PARQUET_INT64:
-                    data_type = arrow::int64();
-                    break;
-                case PARQUET_FLOAT:
-                    data_type = arrow::float32();
-                    break;
-                case PARQUET_DOUBLE:
-                    data_type = arrow::float64();
-                    break;
-                case PARQUET_STRING:
-                    data_type = arrow::utf8();
-                    break;
-                case PARQUET_BINARY:
-                    data_type = arrow::binary();
-                    break;
-                case PARQUET_TIMESTAMP:
-                    data_type = arrow::timestamp(arrow::TimeUnit::MICRO);
-                    break;
-                case PARQUET_FIXED_LEN_BYTE_ARRAY:
-                    if (!fixed_len_sizes) {
-                        set_error("Fixed length sizes array is required for FIXED_LEN_BYTE_ARRAY columns");
-                        return -1;
-                    }
-                    data_type = arrow::fixed_size_binary(fixed_len_sizes[i]);
-                    break;
-                case PARQUET_INT96:
-                    // INT96 is always 12 bytes (96 bits)
-                    data_type = arrow::fixed_size_binary(12);
-                    break;
-                default:
-                    data_type = arrow::binary();
-                    break;
+            int fixed_len = fixed_len_sizes ? fixed_len_sizes[i] : 0;
+            if (types[i] == PARQUET_FIXED_LEN_BYTE_ARRAY && fixed_len <= 0) {
+                set_error("Invalid fixed length size for column %d: %d", i, fixed_len);
+                return NULL;
             }
-            
-            fields.push_back(arrow::field("col_" + std::to_string(i), data_type));
+            writer->types.push_back(types[i]);
+            writer->fixed_lens.push_back(fixed_len);
         }
+        writer->schema = arrow_make_schema(column_names, types, fixed_len_sizes, column_count);
+        writer->encode_threads = options->encode_threads;
         
-        auto schema_arrow = arrow::schema(fields);
+        // "-" streams the file to standard output; the writer only ever appends
+        std::shared_ptr<arrow::io::OutputStream> outfile;
+        if (strcmp(file_path, "-") == 0) {
+            outfile = std::make_shared<arrow::io::StdoutStream>();
+        } else {
+            PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(file_path));
+        }
         
-        // Create arrays from the provided data
-        std::vector<std::shared_ptr<arrow::Array>> arrays;
-        for (int i = 0; i < column_count; i++) {
-            std::unique_ptr<arrow::ArrayBuilder> builder;
-            
-            switch (schema[i]) {
-                case PARQUET_BOOLEAN:
-                    builder.reset(new arrow::BooleanBuilder());
-                    break;
-                case PARQUET_INT32:
-                    builder.reset(new arrow::Int32Builder());
-                    break;
-                case PARQUET_INT64:
-                    builder.reset(new arrow::Int64Builder());
-                    break;
-                case PARQUET_FLOAT:
-                    builder.reset(new arrow::FloatBuilder());
-                    break;
-                case PARQUET_DOUBLE:
-                    builder.reset(new arrow::DoubleBuilder());
-                    break;
-                case PARQUET_STRING:
-                    builder.reset(new arrow::StringBuilder());
-                    break;
-                case PARQUET_BINARY:
-                    builder.reset(new arrow::BinaryBuilder());
-                    break;
-                case PARQUET_TIMESTAMP:
-                    builder.reset(new arrow::TimestampBuilder(arrow::timestamp(arrow::TimeUnit::MICRO),
-                                                             arrow::default_memory_pool()));
-                    break;
-                case PARQUET_FIXED_LEN_BYTE_ARRAY:
-                    if (!fixed_len_sizes) {
-                        set_error("Fixed length sizes array is required for FIXED_LEN_BYTE_ARRAY columns");
-                        return -1;
-                    }
-                    builder.reset(new arrow::FixedSizeBinaryBuilder(
-                        arrow::fixed_size_binary(fixed_len_sizes[i]), 
-                        arrow::default_memory_pool()));
-                    break;
-                case PARQUET_INT96:
-                    // INT96 is always 12 bytes (96 bits)
-                    builder.reset(new arrow::FixedSizeBinaryBuilder(
-                        arrow::fixed_size_binary(12), 
-                        arrow::default_memory_pool()));
-                    break;
-                default:
-                    builder.reset(new arrow::BinaryBuilder());
-                    break;
-            }
-            
-            if (!builder) {
-                set_error("Failed to create array builder");
-                return -1;
-            }
-            
-            // Append the data to the builder
-            // Provide complete conversion implementation for each data type
-            if (column_data[i] && column_sizes[i] > 0) {
-                switch (schema[i]) {
-                    case PARQUET_BOOLEAN: {
-                        auto bool_builder = static_cast<arrow::BooleanBuilder*>(builder.get());
-                        const bool* bool_data = static_cast<const bool*>(column_data[i]);
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(bool_builder->Append(bool_data[j]));
-                        }
-                        break;
-                    }
-                    case PARQUET_INT32: {
-                        auto int_builder = static_cast<arrow::Int32Builder*>(builder.get());
-                        const int32_t* int_data = static_cast<const int32_t*>(column_data[i]);
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(int_builder->Append(int_data[j]));
-                        }
-                        break;
-                    }
-                    case PARQUET_INT64: {
-                        auto int_builder = static_cast<arrow::Int64Builder*>(builder.get());
-                        const int64_t* int_data = static_cast<const int64_t*>(column_data[i]);
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(int_builder->Append(int_data[j]));
-                        }
-                        break;
-                    }
-                    case PARQUET_FLOAT: {
-                        auto float_builder = static_cast<arrow::FloatBuilder*>(builder.get());
-                        const float* float_data = static_cast<const float*>(column_data[i]);
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(float_builder->Append(float_data[j]));
-                        }
-                        break;
-                    }
-                    case PARQUET_DOUBLE: {
-                        auto double_builder = static_cast<arrow::DoubleBuilder*>(builder.get());
-                        const double* double_data = static_cast<const double*>(column_data[i]);
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(double_builder->Append(double_data[j]));
-                        }
-                        break;
-                    }
-                    case PARQUET_STRING: {
-                        auto string_builder = static_cast<arrow::StringBuilder*>(builder.get());
-                        // String data needs special handling, as they have variable length
-                        // Assuming the format is: length (uint32_t) + string data + length + string data...
-                        const uint8_t* data = static_cast<const uint8_t*>(column_data[i]);
-                        size_t offset = 0;
-                        
-                        for (int64_t j = 0; j < row_count && offset < column_sizes[i]; j++) {
-                            uint32_t length = 0;
-                            // Get the string length
-                            if (offset + sizeof(uint32_t) <= column_sizes[i]) {
-                                memcpy(&length, data + offset, sizeof(uint32_t));
-                                offset += sizeof(uint32_t);
-                            } else {
-                                // Data format error
-                                PARQUET_THROW_NOT_OK(string_builder->AppendNull());
-                                continue;
-                            }
-                            
-                            // Check if there is enough data
-                            if (offset + length <= column_sizes[i]) {
-                                // Add the string value
-                                PARQUET_THROW_NOT_OK(string_builder->Append(
-                                    reinterpret_cast<const char*>(data + offset), length));
-                                offset += length;
-                            } else {
-                                // String length exceeds buffer
-                                PARQUET_THROW_NOT_OK(string_builder->AppendNull());
-                            }
-                        }
-                        break;
-                    }
-                    case PARQUET_BINARY: {
-                        auto binary_builder = static_cast<arrow::BinaryBuilder*>(builder.get());
-                        // Binary data is similar to strings
-                        const uint8_t* data = static_cast<const uint8_t*>(column_data[i]);
-                        size_t offset = 0;
-                        
-                        for (int64_t j = 0; j < row_count && offset < column_sizes[i]; j++) {
-                            uint32_t length = 0;
-                            if (offset + sizeof(uint32_t) <= column_sizes[i]) {
-                                memcpy(&length, data + offset, sizeof(uint32_t));
-                                offset += sizeof(uint32_t);
-                            } else {
-                                PARQUET_THROW_NOT_OK(binary_builder->AppendNull());
-                                continue;
-                            }
-                            
-                            if (offset + length <= column_sizes[i]) {
-                                PARQUET_THROW_NOT_OK(binary_builder->Append(data + offset, length));
-                                offset += length;
-                            } else {
-                                PARQUET_THROW_NOT_OK(binary_builder->AppendNull());
-                            }
-                        }
-                        break;
-                    }
-                    case PARQUET_TIMESTAMP: {
-                        auto ts_builder = static_cast<arrow::TimestampBuilder*>(builder.get());
-                        const int64_t* ts_data = static_cast<const int64_t*>(column_data[i]);
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(ts_builder->Append(ts_data[j]));
-                        }
-                        break;
-                    }
-                    case PARQUET_INT96: {
-                        // INT96 is typically used for old-style timestamp formats in Parquet
-                        // Since there is no direct INT96 Builder, we use FixedSizeBinaryBuilder
-                        auto fixed_builder = static_cast<arrow::FixedSizeBinaryBuilder*>(builder.get());
-                        const uint8_t* data = static_cast<const uint8_t*>(column_data[i]);
-                        
-                        // INT96 is always 12 bytes (96 bits)
-                        const int fixed_len = 12;
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(fixed_builder->Append(data + j * fixed_len));
-                        }
-                        break;
-                    }
-                    case PARQUET_FIXED_LEN_BYTE_ARRAY: {
-                        // Get the actual fixed length from the provided array
-                        const int fixed_len = fixed_len_sizes[i];
-                        if (fixed_len <= 0) {
-                            set_error("Invalid fixed length size for column %d: %d", i, fixed_len);
-                            return -1;
-                        }
-                        
-                        auto fixed_builder = static_cast<arrow::FixedSizeBinaryBuilder*>(builder.get());
-                        const uint8_t* data = static_cast<const uint8_t*>(column_data[i]);
-                        
-                        for (int64_t j = 0; j < row_count; j++) {
-                            PARQUET_THROW_NOT_OK(fixed_builder->Append(data + j * fixed_len));
-                        }
-                        break;
-                    }
-                    default:
-                        set_error("Unsupported data type for column %d", i);
-                        return -1;
-                }
-            }
-            
-            // Build the array
-            std::shared_ptr<arrow::Array> array;
-            PARQUET_THROW_NOT_OK(builder->Finish(&array));
-            arrays.push_back(array);
+        // Row groups are written exactly as they are handed in, never split
+        parquet::WriterProperties::Builder builder;
+        builder.compression(codec);
+        builder.max_row_group_length(std::numeric_limits<int64_t>::max());
+        if (codec != parquet::Compression::UNCOMPRESSED && options->compression_level > 0) {
+            builder.compression_level(options->compression_level);
+        }
+        if (options->data_page_size > 0) {
+            builder.data_pagesize(options->data_page_size);
         }
         
-        // Create a table from the arrays
-        auto table = arrow::Table::Make(schema_arrow, arrays);
+        // use_threads lets Arrow encode the columns of a row group concurrently
+        parquet::ArrowWriterProperties::Builder arrow_builder;
+        arrow_builder.set_use_threads(options->encode_threads != 1);
         
-        // Open the output file
-        std::shared_ptr<arrow::io::FileOutputStream> outfile;
         PARQUET_ASSIGN_OR_THROW(
-            outfile, 
-            arrow::io::FileOutputStream::Open(file_path)
-        );
-        
-        // Create Parquet writer properties
-        auto builder = parquet::WriterProperties::Builder();
-        builder.compression(parquet::Compression::UNCOMPRESSED);
-        std::shared_ptr<parquet::WriterProperties> props = builder.build();
-        
-        // Write the table to the Parquet file
-        PARQUET_THROW_NOT_OK(
-            parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), outfile, row_count, props)
+            writer->file_writer,
+            parquet::arrow::FileWriter::Open(*writer->schema, arrow::default_memory_pool(), outfile,
+                                             builder.build(), arrow_builder.build())
         );
         
+        return writer.release();
+    } catch (const std::exception& e) {
+        set_error("Arrow exception: %s", e.what());
+        return NULL;
+    }
+}
+
+/**
+ * Buffer over malloc'd column data, freed with the last array that references it
+ */
+class MallocBuffer : public arrow::Buffer {
+public:
+    MallocBuffer(void* data, int64_t size)
+        : arrow::Buffer(static_cast<const uint8_t*>(data), size), owned_(data) {}
+    ~MallocBuffer() override { free(owned_); }
+
+private:
+    void* owned_;
+};
+
+/**
+ * Build an Arrow array that takes ownership of a column buffer
+ * 
+ * Fixed-width values already have Arrow's layout, so the buffer is wrapped
+ * without copying. Booleans (bit-packed in Arrow) and variable-length values
+ * are converted and the buffer is freed right away.
+ */
+static arrow::Status adopt_column_array(ParquetValueType type, int fixed_len,
+                                        void* data, size_t size, int64_t row_count,
+                                        std::shared_ptr<arrow::Array>* out) {
+    size_t value_size = fixed_value_size(type, fixed_len);
+    if (data && size > 0 && value_size > 0 && type != PARQUET_BOOLEAN) {
+        if (size < (size_t)row_count * value_size) {
+            free(data);
+            return arrow::Status::Invalid("column buffer holds fewer than ", row_count, " values");
+        }
+        auto buffer = std::make_shared<MallocBuffer>(data, (int64_t)size);
+        *out = arrow::MakeArray(arrow::ArrayData::Make(make_arrow_type(type, fixed_len), row_count,
+                                                       {nullptr, buffer}, 0));
+        return arrow::Status::OK();
+    }
+    
+    arrow::Status status = build_column_array(type, fixed_len, data, size, row_count, out);
+    free(data);
+    return status;
+}
+
+/**
+ * Shared state of one row group conversion
+ */
+struct RowGroupBuild {
+    const ParquetValueType* types;
+    const int* fixed_lens;
+    void* const* column_data;
+    const size_t* column_sizes;
+    int64_t row_count;
+    bool take_ownership;
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    std::vector<arrow::Status> statuses;
+    std::vector<char> started;    // Columns a worker has picked up (and, with ownership, consumed)
+};
+
+// Work item processor converting one column of a row group
+static int build_row_group_column(uint32_t item_index, uint32_t total_items, void* user_data) {
+    (void)total_items;
+    RowGroupBuild* build = static_cast<RowGroupBuild*>(user_data);
+    build->started[item_index] = 1;
+    if (build->take_ownership) {
+        build->statuses[item_index] = adopt_column_array(
+            build->types[item_index], build->fixed_lens[item_index],
+            build->column_data[item_index], build->column_sizes[item_index],
+            build->row_count, &build->arrays[item_index]);
+    } else {
+        build->statuses[item_index] = build_column_array(
+            build->types[item_index], build->fixed_lens[item_index],
+            build->column_data[item_index], build->column_sizes[item_index],
+            build->row_count, &build->arrays[item_index]);
+    }
+    return build->statuses[item_index].ok() ? 0 : -1;
+}
+
+/**
+ * Convert the column buffers of one row group into a record batch
+ * 
+ * Columns are independent, so they are converted concurrently. With
+ * take_ownership every buffer is consumed, whether or not the call succeeds.
+ */
+static int build_record_batch(const std::shared_ptr<arrow::Schema>& schema,
+                              const ParquetValueType* types, const int* fixed_lens,
+                              void* const* column_data, const size_t* column_sizes,
+                              int64_t row_count, uint32_t threads, bool take_ownership,
+                              std::shared_ptr<arrow::RecordBatch>* batch) {
+    int column_count = schema->num_fields();
+    
+    // Derive the row count from the first column that has data when the caller does not know it
+    if (row_count <= 0) {
+        row_count = 0;
+        for (int i = 0; i < column_count; i++) {
+            if (column_data[i] && column_sizes[i] > 0) {
+                row_count = count_column_values(types[i], fixed_lens[i], column_data[i], column_sizes[i]);
+                break;
+            }
+        }
+    }
+    
+    RowGroupBuild build;
+    build.types = types;
+    build.fixed_lens = fixed_lens;
+    build.column_data = column_data;
+    build.column_sizes = column_sizes;
+    build.row_count = row_count;
+    build.take_ownership = take_ownership;
+    build.arrays.resize(column_count);
+    build.statuses.resize(column_count, arrow::Status::Invalid("column was not converted"));
+    build.started.resize(column_count, 0);
+    
+    if (row_count < 0) {
+        set_error("Malformed column buffer");
+    } else {
+        parallel_process_items(build_row_group_column, (uint32_t)column_count, threads, NULL, &build);
+    }
+    
+    int failed_column = -1;
+    for (int i = 0; i < column_count; i++) {
+        if (!build.statuses[i].ok() || !build.arrays[i]) {
+            // Buffers the workers never reached are still owned here
+            if (take_ownership && !build.started[i]) {
+                free(column_data[i]);
+            }
+            if (failed_column < 0) {
+                failed_column = i;
+            }
+        }
+    }
+    if (row_count < 0) {
+        return -1;
+    }
+    if (failed_column >= 0) {
+        set_error("Failed to convert column %d: %s", failed_column,
+                  build.statuses[failed_column].ToString().c_str());
+        return -1;
+    }
+    
+    *batch = arrow::RecordBatch::Make(schema, row_count, build.arrays);
+    return 0;
+}
+
+/**
+ * Write one row group
+ */
+int arrow_writer_write_row_group(ArrowParquetWriter* writer, const void* const* column_data,
+                                 const size_t* column_sizes, int64_t row_count) {
+    if (!writer || !column_data || !column_sizes) {
+        set_error("Invalid parameters");
+        return -1;
+    }
+    
+    std::shared_ptr<arrow::RecordBatch> batch;
+    if (build_record_batch(writer->schema, writer->types.data(), writer->fixed_lens.data(),
+                           const_cast<void* const*>(column_data), column_sizes, row_count,
+                           writer->encode_threads, false, &batch) != 0) {
+        return -1;
+    }
+    
+    try {
+        // Each call flushes the previous row group, so at most one is held in memory
+        PARQUET_THROW_NOT_OK(writer->file_writer->NewBufferedRowGroup());
+        PARQUET_THROW_NOT_OK(writer->file_writer->WriteRecordBatch(*batch));
         return 0;
     } catch (const std::exception& e) {
         set_error("Arrow exception: %s", e.what());
@@ -865,6 +1187,65 @@ int arrow_create_parquet_file(const char* file_path, void** column_data, size_t*
     }
 }
 
+/**
+ * Build the Arrow schema for the given columns
+ */
+std::shared_ptr<arrow::Schema> arrow_make_schema(const char* const* column_names,
+                                                 const ParquetValueType* types,
+                                                 const int* fixed_len_sizes,
+                                                 int column_count) {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (int i = 0; i < column_count; i++) {
+        int fixed_len = fixed_len_sizes ? fixed_len_sizes[i] : 0;
+        std::string name = column_names && column_names[i] && column_names[i][0]
+                         ? column_names[i] : "col_" + std::to_string(i);
+        fields.push_back(arrow::field(name, make_arrow_type(types[i], fixed_len)));
+    }
+    return arrow::schema(fields);
+}
+
+/**
+ * Build a record batch over decoded column buffers
+ */
+int arrow_make_record_batch(const std::shared_ptr<arrow::Schema>& schema,
+                            const ParquetValueType* types, const int* fixed_len_sizes,
+                            void** column_data, const size_t* column_sizes,
+                            int64_t row_count, uint32_t threads,
+                            std::shared_ptr<arrow::RecordBatch>* batch) {
+    if (!schema || !types || !column_data || !column_sizes || !batch) {
+        set_error("Invalid parameters");
+        return -1;
+    }
+    
+    std::vector<int> fixed_lens(schema->num_fields(), 0);
+    if (fixed_len_sizes) {
+        fixed_lens.assign(fixed_len_sizes, fixed_len_sizes + schema->num_fields());
+    }
+    return build_record_batch(schema, types, fixed_lens.data(), column_data, column_sizes,
+                              row_count, threads, true, batch);
+}
+
+/**
+ * Finish the file and release the writer
+ */
+int arrow_writer_close(ArrowParquetWriter* writer) {
+    if (!writer) {
+        set_error("Invalid parameters");
+        return -1;
+    }
+    
+    int result = 0;
+    try {
+        PARQUET_THROW_NOT_OK(writer->file_writer->Close());
+    } catch (const std::exception& e) {
+        set_error("Arrow exception: %s", e.what());
+        result = -1;
+    }
+    
+    delete writer;
+    return result;
+}
+
 /**
  * Get the last error message from Arrow operations
  */
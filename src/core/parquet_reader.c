@@ -140,13 +140,39 @@ ParquetReaderError parquet_reader_read_column(
     int column_id,
     void** buffer,
     size_t* buffer_size
+) {
+    return parquet_reader_read_column_with_validity(context, row_group_id, column_id, buffer, buffer_size, NULL);
+}
+
+/**
+ * Read data and the validity bitmap from a specific column in a row group
+ * 
+ * Same as parquet_reader_read_column, and also returns which rows are not
+ * null. Free the bitmap with parquet_reader_free_buffer.
+ * 
+ * context: The reader context
+ * row_group_id: ID of the row group to read from
+ * column_id: ID of the column to read
+ * buffer: Pointer to store the allocated buffer
+ * buffer_size: Pointer to store the size of the allocated buffer
+ * validity: Pointer to store the validity bitmap (NULL if no row is null; may be NULL)
+ * returns: Error code (PARQUET_READER_OK on success)
+ */
+ParquetReaderError parquet_reader_read_column_with_validity(
+    ParquetReaderContext* context,
+    int row_group_id,
+    int column_id,
+    void** buffer,
+    size_t* buffer_size,
+    uint8_t** validity
 ) {
     if (!context || !buffer || !buffer_size) {
         return PARQUET_READER_INVALID_PARAMETER;
     }
     
     // Use arrow_adapter to read the column data
-    int result = arrow_read_column_data(context->file_path, row_group_id, column_id, buffer, buffer_size);
+    int result = arrow_read_column_data_with_validity(context->file_path, row_group_id, column_id,
+                                                      buffer, buffer_size, validity);
     if (result != 0) {
         const char* error_msg = arrow_get_last_error();
         if (error_msg) {
@@ -200,6 +200,7 @@ ParquetColumn* addColumnToRowGroup(ParquetRowGroup* row_group, const char* name,
     column->pages = NULL;
     column->column_data = NULL;
     column->compression_path = NULL;
+    memset(&column->statistics, 0, sizeof(ParquetColumnStatistics));  // No footer statistics
     
     // Update row group
     row_group->column_count = new_count;
@@ -1,5 +1,6 @@
 #include "core/parquet_writer.h"
 #include "core/parquet_structure.h"
+#include "core/arrow_adapter.h"
 #include "lzma/LzmaDec.h"
 #include <stdlib.h>
 #include <string.h>
@@ -20,14 +21,62 @@
  */
 struct ParquetWriterContext {
     char* file_path;
-    void* arrow_writer;  // Internal writer state for the Parquet file
+    void* arrow_writer;  // Streaming Arrow writer, opened when the first row group starts
     int current_row_group;
     int total_columns;
     char error_message[256];
     int current_column;
     int schema_finalized;
+    int row_groups_written;
+    
+    // Schema collected by parquet_writer_add_column
+    int column_capacity;
+    char** column_names;
+    ParquetValueType* column_types;
+    int* column_lengths;
+    
+    // Column buffers of the current row group; only one row group is held at a time
+    void** row_group_data;
+    size_t* row_group_sizes;
+    int row_group_rows;
+    
+    ParquetWriterOptions options;
 };
 
+// Release the column buffers of the current row group
+static void clear_row_group(ParquetWriterContext* context) {
+    for (int i = 0; i < context->total_columns; i++) {
+        free(context->row_group_data[i]);
+        context->row_group_data[i] = NULL;
+        context->row_group_sizes[i] = 0;
+    }
+    context->row_group_rows = 0;
+}
+
+// Hand a column buffer to the current row group, which frees it once written
+static void adopt_column(ParquetWriterContext* context, int column_id,
+                         void* buffer, size_t buffer_size, int row_count) {
+    free(context->row_group_data[column_id]);
+    context->row_group_data[column_id] = buffer;
+    context->row_group_sizes[column_id] = buffer_size;
+    if (row_count > 0) {
+        context->row_group_rows = row_count;
+    }
+}
+
+/**
+ * Get the default options for the writer
+ */
+void parquet_writer_get_default_options(ParquetWriterOptions* options) {
+    if (!options) {
+        return;
+    }
+    options->compression = COMPRESSION_NONE;
+    options->compression_level = 0;
+    options->data_page_size = 0;
+    options->encode_threads = 0;
+}
+
 /**
  * Create a new parquet writer context
  * 
@@ -38,6 +87,20 @@ struct ParquetWriterContext {
  * returns: A new writer context, or NULL if an error occurred
  */
 ParquetWriterContext* parquet_writer_create(const char* file_path) {
+    return parquet_writer_create_with_options(file_path, NULL);
+}
+
+/**
+ * Create a new parquet writer context with explicit output options
+ * 
+ * file_path: Path where the parquet file will be written
+ * options: Output codec, page size and encoding threads (NULL for defaults)
+ * returns: A new writer context, or NULL if an error occurred
+ */
+ParquetWriterContext* parquet_writer_create_with_options(
+    const char* file_path,
+    const ParquetWriterOptions* options
+) {
     if (!file_path) {
         return NULL;
     }
@@ -67,6 +130,12 @@ ParquetWriterContext* parquet_writer_create(const char* file_path) {
     context->current_row_group = -1;  // No row group started yet
     context->total_columns = 0;
     
+    if (options) {
+        context->options = *options;
+    } else {
+        parquet_writer_get_default_options(&context->options);
+    }
+    
     return context;
 }
 
@@ -84,11 +153,33 @@ ParquetWriterError parquet_writer_close(ParquetWriterContext* context) {
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
-    // Close the writer if it exists
+    ParquetWriterError result = PARQUET_WRITER_OK;
+    
+    // A row group left open is incomplete and is not written
+    if (context->current_row_group >= 0) {
+        result = PARQUET_WRITER_INVALID_PARAMETER;
+    }
+    
+    // Close the writer if it exists; this writes the footer
     if (context->arrow_writer) {
-        // Finalize and close the writer
+        if (arrow_writer_close((ArrowParquetWriter*)context->arrow_writer) != 0) {
+            result = PARQUET_WRITER_ARROW_ERROR;
+        }
     }
     
+    // Free the schema and any buffered column data
+    if (context->row_group_data) {
+        clear_row_group(context);
+    }
+    for (int i = 0; i < context->total_columns; i++) {
+        free(context->column_names[i]);
+    }
+    free(context->column_names);
+    free(context->column_types);
+    free(context->column_lengths);
+    free(context->row_group_data);
+    free(context->row_group_sizes);
+    
     // Free the file path
     if (context->file_path) {
         free(context->file_path);
@@ -97,7 +188,7 @@ ParquetWriterError parquet_writer_close(ParquetWriterContext* context) {
     // Free the context
     free(context);
     
-    return PARQUET_WRITER_OK;
+    return result;
 }
 
 /**
@@ -117,19 +208,66 @@ ParquetWriterError parquet_writer_add_column(
     const char* name,
     ParquetValueType type,
     int* column_id
+) {
+    return parquet_writer_add_column_with_length(context, name, type, 0, column_id);
+}
+
+/**
+ * Add a column with a type length to the parquet schema
+ * 
+ * context: The writer context
+ * name: Name of the column
+ * type: Data type of the column
+ * type_length: Byte length of FIXED_LEN_BYTE_ARRAY values (ignored for other types)
+ * column_id: Pointer to store the assigned column ID
+ * returns: Error code (PARQUET_WRITER_OK on success)
+ */
+ParquetWriterError parquet_writer_add_column_with_length(
+    ParquetWriterContext* context,
+    const char* name,
+    ParquetValueType type,
+    int type_length,
+    int* column_id
 ) {
     if (!context || !name || !column_id) {
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
     // Make sure we haven't started writing row groups yet
-    if (context->current_row_group >= 0) {
+    if (context->current_row_group >= 0 || context->schema_finalized) {
         snprintf(context->error_message, sizeof(context->error_message),
                 "Cannot add columns after starting to write row groups");
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
+    // Grow the schema arrays
+    if (context->total_columns == context->column_capacity) {
+        int capacity = context->column_capacity > 0 ? context->column_capacity * 2 : 16;
+        char** names = (char**)realloc(context->column_names, capacity * sizeof(char*));
+        if (names) context->column_names = names;
+        ParquetValueType* types = (ParquetValueType*)realloc(context->column_types, capacity * sizeof(ParquetValueType));
+        if (types) context->column_types = types;
+        int* lengths = (int*)realloc(context->column_lengths, capacity * sizeof(int));
+        if (lengths) context->column_lengths = lengths;
+        if (!names || !types || !lengths) {
+            snprintf(context->error_message, sizeof(context->error_message),
+                    "Failed to allocate memory for the schema");
+            return PARQUET_WRITER_MEMORY_ERROR;
+        }
+        context->column_capacity = capacity;
+    }
+    
     // Add a column to the parquet schema
+    size_t name_len = strlen(name) + 1;
+    char* name_copy = (char*)malloc(name_len);
+    if (!name_copy) {
+        return PARQUET_WRITER_MEMORY_ERROR;
+    }
+    memcpy(name_copy, name, name_len);
+    
+    context->column_names[context->total_columns] = name_copy;
+    context->column_types[context->total_columns] = type;
+    context->column_lengths[context->total_columns] = type_length;
     
     // Assign a column ID
     *column_id = context->total_columns++;
@@ -140,7 +278,8 @@ ParquetWriterError parquet_writer_add_column(
 /**
  * Start a new row group in the parquet file
  * 
- * This function begins a new row group in the parquet file.
+ * This function begins a new row group in the parquet file. The first call
+ * finalizes the schema and opens the output file.
  * 
  * context: The writer context
  * row_group_id: Pointer to store the assigned row group ID
@@ -168,10 +307,37 @@ ParquetWriterError parquet_writer_start_row_group(
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
-    // Start a new row group in the file
+    // Finalize the schema and open the file on the first row group
+    if (!context->schema_finalized) {
+        context->row_group_data = (void**)calloc(context->total_columns, sizeof(void*));
+        context->row_group_sizes = (size_t*)calloc(context->total_columns, sizeof(size_t));
+        if (!context->row_group_data || !context->row_group_sizes) {
+            snprintf(context->error_message, sizeof(context->error_message),
+                    "Failed to allocate memory for row group buffers");
+            return PARQUET_WRITER_MEMORY_ERROR;
+        }
+        
+        ArrowWriterOptions arrow_options;
+        arrow_options.compression = context->options.compression;
+        arrow_options.compression_level = context->options.compression_level;
+        arrow_options.data_page_size = context->options.data_page_size;
+        arrow_options.encode_threads = context->options.encode_threads;
+        
+        context->arrow_writer = arrow_writer_open(
+            context->file_path, (const char* const*)context->column_names,
+            context->column_types, context->column_lengths,
+            context->total_columns, &arrow_options);
+        if (!context->arrow_writer) {
+            snprintf(context->error_message, sizeof(context->error_message),
+                    "Failed to open %s: %s", context->file_path,
+                    arrow_get_last_error() ? arrow_get_last_error() : "unknown error");
+            return PARQUET_WRITER_ARROW_ERROR;
+        }
+        context->schema_finalized = 1;
+    }
     
     // Start a new row group
-    context->current_row_group = (context->current_row_group < 0) ? 0 : context->current_row_group + 1;
+    context->current_row_group = context->row_groups_written;
     *row_group_id = context->current_row_group;
     
     return PARQUET_WRITER_OK;
@@ -180,7 +346,8 @@ ParquetWriterError parquet_writer_start_row_group(
 /**
  * Finish the current row group
  * 
- * This function completes the current row group.
+ * This function completes the current row group: its buffered columns are
+ * encoded and written to the file, then released.
  * 
  * context: The writer context
  * returns: Error code (PARQUET_WRITER_OK on success)
@@ -197,24 +364,40 @@ ParquetWriterError parquet_writer_end_row_group(ParquetWriterContext* context) {
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
-    // End the current row group in the file
+    // Write the buffered columns as one row group
+    int result = arrow_writer_write_row_group(
+        (ArrowParquetWriter*)context->arrow_writer,
+        (const void* const*)context->row_group_data,
+        context->row_group_sizes,
+        context->row_group_rows);
+    clear_row_group(context);
     
     // End the current row group
     context->current_row_group = -1;  // Mark that no row group is active
     
+    if (result != 0) {
+        snprintf(context->error_message, sizeof(context->error_message),
+                "Failed to write row group: %s",
+                arrow_get_last_error() ? arrow_get_last_error() : "unknown error");
+        return PARQUET_WRITER_ARROW_ERROR;
+    }
+    
+    context->row_groups_written++;
     return PARQUET_WRITER_OK;
 }
 
 /**
  * Write column data to the current row group
  * 
- * This function writes data for a column in the current row group.
+ * This function writes data for a column in the current row group. The data
+ * is copied, so the buffer can be released on return; it is encoded when the
+ * row group ends.
  * 
  * context: The writer context
  * column_id: ID of the column to write
  * buffer: Buffer containing the column data
  * buffer_size: Size of the buffer in bytes
- * row_count: Number of rows in the column
+ * row_count: Number of rows in the column (0 if unknown)
  * returns: Error code (PARQUET_WRITER_OK on success)
  */
 ParquetWriterError parquet_writer_write_column(
@@ -224,7 +407,7 @@ ParquetWriterError parquet_writer_write_column(
     size_t buffer_size,
     int row_count
 ) {
-    if (!context || !buffer || buffer_size == 0 || row_count <= 0) {
+    if (!context || !buffer || buffer_size == 0 || row_count < 0) {
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
@@ -242,141 +425,46 @@ ParquetWriterError parquet_writer_write_column(
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
-    // Write the column data to the parquet file
+    // Buffer the column data until the row group ends
+    void* copy = malloc(buffer_size);
+    if (!copy) {
+        snprintf(context->error_message, sizeof(context->error_message),
+                "Failed to allocate memory for column %d", column_id);
+        return PARQUET_WRITER_MEMORY_ERROR;
+    }
+    memcpy(copy, buffer, buffer_size);
+    adopt_column(context, column_id, copy, buffer_size, row_count);
     
     return PARQUET_WRITER_OK;
 }
 
 /**
- * Reconstructs a parquet file from column files
- * 
- * This function reconstructs a parquet file from compressed column files.
- * Used during decompression to reconstruct the original parquet file.
- * 
- * file_structure: Structure describing the parquet file organization
- * output_path: Path where the reconstructed file will be written
- * column_file_paths: Array of paths to compressed column files
- * 
- * Return: Error code (PARQUET_WRITER_OK on success)
+ * Hand a column buffer to the current row group
  */
-ParquetWriterError parquet_writer_reconstruct_file(
-    const ParquetFile* file_structure,
-    const char* output_path,
-    char** column_file_paths
+ParquetWriterError parquet_writer_adopt_column(
+    ParquetWriterContext* context,
+    int column_id,
+    void* buffer,
+    size_t buffer_size,
+    int row_count
 ) {
-    if (!file_structure || !output_path || !column_file_paths) {
+    if (!context || !buffer || buffer_size == 0 || row_count < 0) {
         return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
-    // Create a new writer context
-    ParquetWriterContext* context = parquet_writer_create(output_path);
-    if (!context) {
-        return PARQUET_WRITER_MEMORY_ERROR;
-    }
-    
-    // Process each row group
-    for (int rg = 0; rg < file_structure->row_group_count; rg++) {
-        const ParquetRowGroup* row_group = &file_structure->row_groups[rg];
-        int row_group_id;
-        
-        // Start a new row group
-        ParquetWriterError err = parquet_writer_start_row_group(context, &row_group_id);
-        if (err != PARQUET_WRITER_OK) {
-            parquet_writer_close(context);
-            return err;
-        }
-        
-        // Process each column in the row group
-        for (int col = 0; col < row_group->column_count; col++) {
-            const ParquetColumn* column = &row_group->columns[col];
-            char* column_file_path = column_file_paths[rg * row_group->column_count + col];
-            
-            if (!column_file_path) {
-                parquet_writer_close(context);
-                return PARQUET_WRITER_INVALID_PARAMETER;
-            }
-            
-            // Create a temporary output file for decompression
-            char temp_file[1024];
-            snprintf(temp_file, sizeof(temp_file), "%s.temp.%d.%d", output_path, rg, col);
-            
-            // Define a null progress callback for decompression
-            DecompressionProgressCallback progress_cb = NULL;
-            
-            // Use LZMA to decompress the file
-            int decompression_result = lzma_decompress_file(column_file_path, temp_file, progress_cb, NULL);
-            if (decompression_result != 0) {
-                parquet_writer_close(context);
-                return PARQUET_WRITER_INVALID_PARAMETER;
-            }
-            
-            // Read the decompressed data
-            FILE* temp_fp = fopen(temp_file, "rb");
-            if (!temp_fp) {
-                remove(temp_file);
-                parquet_writer_close(context);
-                return PARQUET_WRITER_FILE_ERROR;
-            }
-            
-            // Read the row count
-            int row_count = 0;
-            if (fread(&row_count, sizeof(int), 1, temp_fp) != 1) {
-                fclose(temp_fp);
-                remove(temp_file);
-                parquet_writer_close(context);
-                return PARQUET_WRITER_FILE_ERROR;
-            }
-            
-            // Get the size of the remaining data
-            fseek(temp_fp, 0, SEEK_END);
-            long file_size = ftell(temp_fp);
-            size_t data_size = file_size - sizeof(int);
-            fseek(temp_fp, sizeof(int), SEEK_SET);
-            
-            // Allocate memory and read the data
-            void* buffer = malloc(data_size);
-            if (!buffer) {
-                fclose(temp_fp);
-                remove(temp_file);
-                parquet_writer_close(context);
-                return PARQUET_WRITER_MEMORY_ERROR;
-            }
-            
-            if (fread(buffer, 1, data_size, temp_fp) != data_size) {
-                free(buffer);
-                fclose(temp_fp);
-                remove(temp_file);
-                parquet_writer_close(context);
-                return PARQUET_WRITER_FILE_ERROR;
-            }
-            
-            fclose(temp_fp);
-            remove(temp_file);  // Delete the temporary file
-            
-            // Write the column data
-            err = parquet_writer_write_column(context, col, buffer, data_size, row_count);
-            free(buffer);
-            
-            if (err != PARQUET_WRITER_OK) {
-                parquet_writer_close(context);
-                return err;
-            }
-        }
-        
-        // End the row group
-        ParquetWriterError err_end = parquet_writer_end_row_group(context);
-        if (err_end != PARQUET_WRITER_OK) {
-            parquet_writer_close(context);
-            return err_end;
-        }
+    if (context->current_row_group < 0) {
+        snprintf(context->error_message, sizeof(context->error_message),
+                "No active row group to write to");
+        return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
-    // Close the parquet writer context
-    ParquetWriterError close_err = parquet_writer_close(context);
-    if (close_err != PARQUET_WRITER_OK) {
-        return close_err;
+    if (column_id < 0 || column_id >= context->total_columns) {
+        snprintf(context->error_message, sizeof(context->error_message),
+                "Invalid column ID: %d", column_id);
+        return PARQUET_WRITER_INVALID_PARAMETER;
     }
     
+    adopt_column(context, column_id, buffer, buffer_size, row_count);
     return PARQUET_WRITER_OK;
 }
 
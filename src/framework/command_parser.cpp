@@ -1,5 +1,6 @@
 #include "framework/command_parser.h"
 #include "framework/infparquet_framework.h"
+#include "core/parquet_structure.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -82,8 +83,12 @@ struct CommandParser::Impl {
         ss << "Commands:\n";
         ss << "  compress <input_file.parquet> --output-dir <output_directory>\n";
         ss << "    Compress a Parquet file using LZMA2 and generate metadata.\n\n";
+        ss << "  compress-batch <directory|glob> --output-dir <output_directory>\n";
+        ss << "    Compress many Parquet files on one shared pipeline (e.g. \"data/*.parquet\").\n\n";
         ss << "  decompress <metadata_file.meta> --output-dir <output_directory>\n";
         ss << "    Decompress a previously compressed Parquet file.\n\n";
+        ss << "  verify <metadata_file.meta> [--full]\n";
+        ss << "    Check every compressed chunk against the checksums recorded at compression.\n\n";
         ss << "  query <metadata_directory> --sql \"<query_string>\"\n";
         ss << "    Query metadata files for specific patterns or values.\n\n";
         ss << "  list <metadata_directory>\n";
@@ -96,12 +101,38 @@ struct CommandParser::Impl {
         ss << "  --level <1-9>             Compression level (1=fastest, 9=highest compression)\n";
         ss << "  --no-base-metadata        Don't generate base metadata\n";
         ss << "  --custom-metadata <file>  Use custom metadata configuration from JSON file\n";
-        ss << "  --parallel <N>            Use N parallel tasks (default: auto-detect)\n\n";
+        ss << "  --parallel <N>            Use N parallel tasks (default: auto-detect)\n";
+        ss << "  --bloom-filter <a,b,c>    Build a Bloom filter per row group for these columns\n";
+        ss << "  --bloom-fpp <rate>        False-positive rate of the Bloom filters (default: 0.01)\n";
+        ss << "  --footer-stats            Take numeric and timestamp min/max from footer statistics\n";
+        ss << "  --metadata-sample-rate <r> Estimate string and mode statistics from this fraction of rows\n";
+        ss << "  --stream                  Write one single-stream archive to the -o path ('-' = stdout);\n";
+        ss << "                            the input may be '-' for stdin\n\n";
         ss << "Decompression Options:\n";
-        ss << "  --parallel <N>            Use N parallel tasks (default: auto-detect)\n\n";
+        ss << "  --parallel <N>            Use N parallel tasks (default: auto-detect)\n";
+        ss << "  --columns <a,b,c>         Restore only these columns\n";
+        ss << "  --row-groups <0-9,42>     Restore only these row groups\n";
+        ss << "  --codec <name>            Page codec of the restored file: none, snappy, gzip, lz4, zstd\n";
+        ss << "  --codec-level <N>         Level of the page codec (default: codec default)\n";
+        ss << "  --page-size <bytes>       Data page size of the restored file (default: 1 MiB)\n";
+        ss << "  --stream                  Read a single-stream archive ('-' = stdin); -o may be '-' for stdout\n";
+        ss << "  --format <parquet|arrow>  Output of --stream: Parquet or an Arrow IPC stream (default: parquet)\n\n";
+        ss << "Verify Options:\n";
+        ss << "  --full                    Also decode every chunk and check the decoded data\n";
+        ss << "  --parallel <N>            Check N chunks at a time (default: auto-detect)\n\n";
+        ss << "Pipeline Options (compress and decompress):\n";
+        ss << "  --readers <N>             Threads reading column chunks (default: 1)\n";
+        ss << "  --analyzers <N>           Threads analyzing column chunks (default: 1)\n";
+        ss << "  --queue-depth <N>         Chunks buffered between stages (default: 2 x codec threads)\n\n";
         ss << "Examples:\n";
         ss << "  infparquet compress data.parquet --output-dir compressed\n";
+        ss << "  infparquet compress-batch \"nightly/*.parquet\" --output-dir compressed\n";
+        ss << "  infparquet compress events.parquet --output-dir compressed --bloom-filter customer_id\n";
         ss << "  infparquet decompress compressed/data.parquet.meta --output-dir decompressed\n";
+        ss << "  infparquet decompress compressed/data.parquet.meta -o subset --columns id,price --row-groups 0-9,42\n";
+        ss << "  cat data.parquet | infparquet compress - --stream -o - > data.ipqs\n";
+        ss << "  infparquet decompress - --stream --format arrow -o - < data.ipqs\n";
+        ss << "  infparquet verify compressed/data.parquet.meta --full\n";
         ss << "  infparquet query metadata_dir --sql \"SELECT * WHERE column_name = 'value'\"\n";
         ss << "  infparquet list metadata_dir\n";
         
@@ -122,8 +153,11 @@ struct CommandParser::Impl {
     bool parseCompressCommand(const std::vector<std::string>& args, CommandArgs& command_args);
     bool parseDecompressCommand(const std::vector<std::string>& args, CommandArgs& command_args);
     bool parseListCommand(const std::vector<std::string>& args, CommandArgs& command_args);
+    bool parseVerifyCommand(const std::vector<std::string>& args, CommandArgs& command_args);
     bool parseQueryCommand(const std::vector<std::string>& args, CommandArgs& command_args);
     bool parseHelpCommand(const std::vector<std::string>& args, CommandArgs& command_args);
+    bool parsePipelineOption(const std::vector<std::string>& args, size_t& i, CommandArgs& command_args);
+    bool parseRowGroupList(const std::string& value, std::vector<int>& row_groups);
     
     // Parse command line arguments
     CommandArgs parse(int argc, char* argv[]) {
@@ -155,6 +189,12 @@ struct CommandParser::Impl {
             if (!parseCompressCommand(arg_vec, args)) {
                 return args;
             }
+        } else if (cmd == "compress-batch") {
+            // Same options as compress; the input is a directory or glob
+            args.command = CommandType::CompressBatch;
+            if (!parseCompressCommand(arg_vec, args)) {
+                return args;
+            }
         } else if (cmd == "decompress") {
             args.command = CommandType::Decompress;
             if (!parseDecompressCommand(arg_vec, args)) {
@@ -165,6 +205,11 @@ struct CommandParser::Impl {
             if (!parseListCommand(arg_vec, args)) {
                 return args;
             }
+        } else if (cmd == "verify") {
+            args.command = CommandType::Verify;
+            if (!parseVerifyCommand(arg_vec, args)) {
+                return args;
+            }
         } else if (cmd == "query") {
             args.command = CommandType::Query;
             if (!parseQueryCommand(arg_vec, args)) {
@@ -186,7 +231,8 @@ struct CommandParser::Impl {
         }
         
         // process command related file paths, ensuring cross-platform compatibility
-        if (!args.input_path.empty()) {
+        // (a batch input may be a glob and stream paths may be "-", so neither gets a trailing separator)
+        if (!args.input_path.empty() && args.command != CommandType::CompressBatch && !args.stream) {
             char* normalized = normalize_path(args.input_path.c_str());
             if (normalized) {
                 args.input_path = normalized;
@@ -194,7 +240,7 @@ struct CommandParser::Impl {
             }
         }
         
-        if (!args.output_path.empty()) {
+        if (!args.output_path.empty() && !args.stream) {
             char* normalized = normalize_path(args.output_path.c_str());
             if (normalized) {
                 args.output_path = normalized;
@@ -209,6 +255,7 @@ struct CommandParser::Impl {
     bool validateArgs(const CommandArgs& args) {
         switch (args.command) {
             case CommandType::Compress:
+            case CommandType::CompressBatch:
                 if (args.input_path.empty()) {
                     last_error = "Error: Compress command missing input file path";
                     return false;
@@ -241,6 +288,13 @@ struct CommandParser::Impl {
                 }
                 break;
                 
+            case CommandType::Verify:
+                if (args.input_path.empty()) {
+                    last_error = "Error: Verify command missing metadata file path";
+                    return false;
+                }
+                break;
+                
             case CommandType::Query:
                 if (args.input_path.empty()) {
                     last_error = "Error: Query command missing metadata directory path";
@@ -300,6 +354,24 @@ bool CommandParser::Impl::parseCompressCommand(const std::vector<std::string>& a
             }
         } else if (option == "--no-base-metadata") {
             command_args.use_basic_metadata = false;
+        } else if (option == "--footer-stats") {
+            command_args.use_footer_statistics = true;
+        } else if (option == "--metadata-sample-rate") {
+            if (i + 1 < args.size()) {
+                try {
+                    command_args.metadata_sample_rate = std::stod(args[++i]);
+                } catch (const std::exception&) {
+                    last_error = "Error: Invalid metadata sample rate '" + args[i] + "'";
+                    return false;
+                }
+                if (!(command_args.metadata_sample_rate > 0.0 && command_args.metadata_sample_rate <= 1.0)) {
+                    last_error = "Error: --metadata-sample-rate must be greater than 0 and at most 1";
+                    return false;
+                }
+            } else {
+                last_error = "Error: --metadata-sample-rate option missing value";
+                return false;
+            }
         } else if (option == "--custom-metadata") {
             if (i + 1 < args.size()) {
                 command_args.custom_metadata_file = args[++i];
@@ -321,6 +393,45 @@ bool CommandParser::Impl::parseCompressCommand(const std::vector<std::string>& a
             }
         } else if (option == "--verbose" || option == "-v") {
             command_args.verbose = true;
+        } else if (option == "--stream") {
+            command_args.stream = true;
+        } else if (option == "--readers" || option == "--analyzers" || option == "--queue-depth") {
+            if (!parsePipelineOption(args, i, command_args)) {
+                return false;
+            }
+        } else if (option == "--bloom-filter") {
+            if (i + 1 < args.size()) {
+                std::istringstream list(args[++i]);
+                std::string name;
+                while (std::getline(list, name, ',')) {
+                    if (!name.empty()) {
+                        command_args.bloom_filter_columns.push_back(name);
+                    }
+                }
+                if (command_args.bloom_filter_columns.empty()) {
+                    last_error = "Error: --bloom-filter option needs at least one column name";
+                    return false;
+                }
+            } else {
+                last_error = "Error: --bloom-filter option missing value";
+                return false;
+            }
+        } else if (option == "--bloom-fpp") {
+            if (i + 1 < args.size()) {
+                try {
+                    command_args.bloom_filter_fpp = std::stod(args[++i]);
+                } catch (const std::exception&) {
+                    last_error = "Error: Invalid Bloom filter false-positive rate '" + args[i] + "'";
+                    return false;
+                }
+                if (!(command_args.bloom_filter_fpp > 0.0 && command_args.bloom_filter_fpp < 1.0)) {
+                    last_error = "Error: --bloom-fpp must be between 0 and 1";
+                    return false;
+                }
+            } else {
+                last_error = "Error: --bloom-fpp option missing value";
+                return false;
+            }
         } else {
             last_error = "Error: Unknown option '" + option + "'";
             return false;
@@ -365,6 +476,76 @@ bool CommandParser::Impl::parseDecompressCommand(const std::vector<std::string>&
             }
         } else if (option == "--verbose" || option == "-v") {
             command_args.verbose = true;
+        } else if (option == "--stream") {
+            command_args.stream = true;
+        } else if (option == "--readers" || option == "--analyzers" || option == "--queue-depth") {
+            if (!parsePipelineOption(args, i, command_args)) {
+                return false;
+            }
+        } else if (option == "--columns") {
+            if (i + 1 < args.size()) {
+                std::istringstream list(args[++i]);
+                std::string name;
+                while (std::getline(list, name, ',')) {
+                    if (!name.empty()) {
+                        command_args.columns.push_back(name);
+                    }
+                }
+                if (command_args.columns.empty()) {
+                    last_error = "Error: --columns option needs at least one column name";
+                    return false;
+                }
+            } else {
+                last_error = "Error: --columns option missing value";
+                return false;
+            }
+        } else if (option == "--row-groups") {
+            if (i + 1 < args.size()) {
+                if (!parseRowGroupList(args[++i], command_args.row_groups)) {
+                    return false;
+                }
+            } else {
+                last_error = "Error: --row-groups option missing value";
+                return false;
+            }
+        } else if (option == "--codec") {
+            if (i + 1 < args.size()) {
+                command_args.output_codec = args[++i];
+            } else {
+                last_error = "Error: --codec option missing value";
+                return false;
+            }
+        } else if (option == "--format") {
+            if (i + 1 >= args.size()) {
+                last_error = "Error: --format option missing value";
+                return false;
+            }
+            command_args.output_format = args[++i];
+            if (command_args.output_format != "parquet" && command_args.output_format != "arrow") {
+                last_error = "Error: --format must be parquet or arrow";
+                return false;
+            }
+        } else if (option == "--codec-level" || option == "--page-size") {
+            if (i + 1 >= args.size()) {
+                last_error = "Error: " + option + " option missing value";
+                return false;
+            }
+            long long value = 0;
+            try {
+                value = std::stoll(args[++i]);
+            } catch (const std::exception&) {
+                last_error = "Error: Invalid value for " + option + " '" + args[i] + "'";
+                return false;
+            }
+            if (value < 0) {
+                last_error = "Error: " + option + " must not be negative";
+                return false;
+            }
+            if (option == "--codec-level") {
+                command_args.output_codec_level = static_cast<int>(value);
+            } else {
+                command_args.page_size = value;
+            }
         } else {
             last_error = "Error: Unknown option '" + option + "'";
             return false;
@@ -399,6 +580,45 @@ bool CommandParser::Impl::parseListCommand(const std::vector<std::string>& args,
     return true;
 }
 
+// Parse verify command arguments
+bool CommandParser::Impl::parseVerifyCommand(const std::vector<std::string>& args, CommandArgs& command_args) {
+    if (args.empty()) {
+        last_error = "Error: Verify command missing metadata file";
+        return false;
+    }
+    
+    // Set metadata file path
+    command_args.input_path = args[0];
+    
+    // Parse options
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string& option = args[i];
+        
+        if (option == "--full") {
+            command_args.full_verify = true;
+        } else if (option == "--parallel" || option == "-p") {
+            if (i + 1 < args.size()) {
+                try {
+                    command_args.threads = std::stoi(args[++i]);
+                } catch (const std::exception&) {
+                    last_error = "Error: Invalid number of parallel tasks '" + args[i] + "'";
+                    return false;
+                }
+            } else {
+                last_error = "Error: --parallel option missing value";
+                return false;
+            }
+        } else if (option == "--verbose" || option == "-v") {
+            command_args.verbose = true;
+        } else {
+            last_error = "Error: Unknown option '" + option + "'";
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 // Parse query command arguments
 bool CommandParser::Impl::parseQueryCommand(const std::vector<std::string>& args, CommandArgs& command_args) {
     if (args.empty()) {
@@ -431,6 +651,99 @@ bool CommandParser::Impl::parseQueryCommand(const std::vector<std::string>& args
     return true;
 }
 
+// Parse a pipeline stage option (--readers, --analyzers, --queue-depth)
+bool CommandParser::Impl::parsePipelineOption(const std::vector<std::string>& args, size_t& i, CommandArgs& command_args) {
+    const std::string& option = args[i];
+    if (i + 1 >= args.size()) {
+        last_error = "Error: " + option + " option missing value";
+        return false;
+    }
+    
+    int value = 0;
+    try {
+        value = std::stoi(args[++i]);
+    } catch (const std::exception&) {
+        last_error = "Error: Invalid value for " + option + " '" + args[i] + "'";
+        return false;
+    }
+    if (value < 0) {
+        last_error = "Error: " + option + " must not be negative";
+        return false;
+    }
+    
+    if (option == "--readers") {
+        command_args.reader_threads = value;
+    } else if (option == "--analyzers") {
+        command_args.analyzer_threads = value;
+    } else {
+        command_args.queue_depth = value;
+    }
+    return true;
+}
+
+// Parse a row group list such as "0-9,42" into individual indices. Indices
+// are bounded by MAX_ROWGROUPS_PER_FILE and kept once each, in first-seen
+// order, so the list never outgrows the row groups a file can have
+bool CommandParser::Impl::parseRowGroupList(const std::string& value, std::vector<int>& row_groups) {
+    // A row group index: decimal digits only, so "3x" or " 3" is rejected
+    // rather than read as 3
+    auto parseIndex = [](const std::string& text, int& index) {
+        if (text.empty() || !std::all_of(text.begin(), text.end(),
+                                         [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            return false;
+        }
+        try {
+            index = std::stoi(text);
+        } catch (const std::exception&) {
+            return false;  // Out of range of int
+        }
+        return true;
+    };
+    
+    std::vector<bool> listed(MAX_ROWGROUPS_PER_FILE, false);
+    for (int row_group : row_groups) {
+        if (row_group >= 0 && row_group < MAX_ROWGROUPS_PER_FILE) {
+            listed[row_group] = true;
+        }
+    }
+    
+    std::istringstream list(value);
+    std::string range;
+    while (std::getline(list, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        
+        int first = 0;
+        int last = 0;
+        size_t dash = range.find('-');
+        if (!parseIndex(range.substr(0, dash), first) ||
+            !parseIndex(dash == std::string::npos ? range : range.substr(dash + 1), last) ||
+            last < first) {
+            last_error = "Error: Invalid row group range '" + range + "'";
+            return false;
+        }
+        if (last >= MAX_ROWGROUPS_PER_FILE) {
+            last_error = "Error: Row group range '" + range + "' exceeds the limit of " +
+                         std::to_string(MAX_ROWGROUPS_PER_FILE) + " row groups per file";
+            return false;
+        }
+        
+        for (int row_group = first; row_group <= last; row_group++) {
+            if (!listed[row_group]) {
+                listed[row_group] = true;
+                row_groups.push_back(row_group);
+            }
+        }
+    }
+    
+    if (row_groups.empty()) {
+        last_error = "Error: --row-groups option needs at least one row group";
+        return false;
+    }
+    return true;
+}
+
 // Parse help command arguments
 bool CommandParser::Impl::parseHelpCommand(const std::vector<std::string>& args, CommandArgs& command_args) {
     // Help command doesn't need extra processing
@@ -467,19 +780,60 @@ void CommandParser::showUsage(const std::string& command) const {
             ss << "  --no-base-metadata        Don't generate base metadata\n";
             ss << "  --custom-metadata <file>  Use custom metadata configuration (JSON format)\n";
             ss << "  --parallel, -p <N>        Use N parallel tasks (0=auto-detect, default:0)\n";
+            ss << "  --readers <N>             Threads reading column chunks (default:1)\n";
+            ss << "  --analyzers <N>           Threads analyzing column chunks (default:1)\n";
+            ss << "  --queue-depth <N>         Chunks buffered between pipeline stages (0=auto, default:0)\n";
+            ss << "  --bloom-filter <a,b,c>    Build a Bloom filter per row group for these columns, so\n";
+            ss << "                            queries on column = value skip files without the value\n";
+            ss << "  --bloom-fpp <rate>        False-positive rate of the Bloom filters (default:0.01)\n";
+            ss << "  --footer-stats            Take min/max and null counts of numeric and timestamp chunks\n";
+            ss << "                            from the footer statistics instead of scanning them; those\n";
+            ss << "                            chunks get no mean, mode, percentiles or distinct count\n";
+            ss << "  --metadata-sample-rate <r> Estimate high-frequency strings, special strings and modes\n";
+            ss << "                            from a stratified sample of this fraction of each row group's\n";
+            ss << "                            rows, storing an error bound with each estimate (default:1)\n";
+            ss << "  --stream                  Write one single-stream archive to the -o path ('-' = stdout);\n";
+            ss << "                            the input may be '-' for stdin\n";
             ss << "  --verbose, -v             Enable verbose output\n";
+        } else if (command == "compress-batch") {
+            ss << "InfParquet Compress-Batch Command:\n";
+            ss << "  infparquet compress-batch <directory|glob> --output-dir <output_directory> [options]\n\n";
+            ss << "  A directory selects every *.parquet file in it; a glob may use * and ?\n";
+            ss << "  in the file name. Column chunks of all files share one pipeline, and\n";
+            ss << "  each file's metadata is written once all of its chunks are stored.\n\n";
+            ss << "Options:\n";
+            ss << "  Same as the compress command\n";
         } else if (command == "decompress") {
             ss << "InfParquet Decompress Command:\n";
             ss << "  infparquet decompress <metadata_file.meta> --output-dir <output_directory> [options]\n\n";
             ss << "Options:\n";
             ss << "  --output-dir, -o <dir>    Specify output directory\n";
             ss << "  --parallel, -p <N>        Use N parallel tasks (0=auto-detect, default:0)\n";
+            ss << "  --readers <N>             Threads reading compressed chunks (default:1)\n";
+            ss << "  --analyzers <N>           Threads checking chunk headers (default:1)\n";
+            ss << "  --queue-depth <N>         Chunks buffered between pipeline stages (0=auto, default:0)\n";
+            ss << "  --columns <a,b,c>         Restore only these columns (default: all)\n";
+            ss << "  --row-groups <0-9,42>     Restore only these row groups (default: all)\n";
+            ss << "  --codec <name>            Page codec of the restored file: none, snappy, gzip, lz4, zstd (default:none)\n";
+            ss << "  --codec-level <N>         Level of the page codec (0=codec default, default:0)\n";
+            ss << "  --page-size <bytes>       Data page size of the restored file (0=1 MiB, default:0)\n";
+            ss << "  --stream                  Read a single-stream archive ('-' = stdin); -o may be '-' for stdout\n";
+            ss << "  --format <parquet|arrow>  Output of --stream: Parquet or an Arrow IPC stream (default:parquet)\n";
             ss << "  --verbose, -v             Enable verbose output\n";
         } else if (command == "list") {
             ss << "InfParquet List Command:\n";
             ss << "  infparquet list <metadata_directory> [options]\n\n";
             ss << "Options:\n";
             ss << "  --verbose, -v             Enable verbose output\n";
+        } else if (command == "verify") {
+            ss << "InfParquet Verify Command:\n";
+            ss << "  infparquet verify <metadata_file.meta> [options]\n\n";
+            ss << "  Hashes every chunk file with XXH3 and compares it with the checksum\n";
+            ss << "  recorded at compression; corrupt chunks are listed by row group and column.\n\n";
+            ss << "Options:\n";
+            ss << "  --full                    Also decode every chunk and check the decoded data\n";
+            ss << "  --parallel, -p <N>        Check N chunks at a time (0=auto-detect, default:0)\n";
+            ss << "  --verbose, -v             Enable verbose output\n";
         } else if (command == "query") {
             ss << "InfParquet Query Command:\n";
             ss << "  infparquet query <metadata_directory> --sql \"<query_string>\" [options]\n\n";
@@ -1,12 +1,27 @@
 #include "framework/infparquet_framework.h"
+#include "framework/job_executor.h"
 #include "core/parquet_structure.h"
 #include "core/parquet_reader.h"
 #include "core/parquet_writer.h"
 #include "metadata/metadata_generator.h"
 #include "metadata/metadata_types.h"
+#include "metadata/value_frequency.h"
+#include "metadata/column_stats.h"
+#include "metadata/hyperloglog.h"
+#include "metadata/quantile_sketch.h"
+#include "metadata/bloom_filter.h"
 #include "compression/lzma_compressor.h"
 #include "compression/lzma_decompressor.h"
 #include "compression/parallel_processor.h"
+#include "compression/pipeline.h"
+#include "compression/cpu_budget.h"
+#include "compression/chunk_cache.h"
+#include "core/arrow_adapter.h"
+#include "arrow/record_batch.h"
+#include "arrow/io/file.h"
+#include "arrow/io/stdio.h"
+#include "arrow/ipc/writer.h"
+#include "core/xxhash_inline.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -23,8 +38,16 @@
 #include <unordered_map>  // For std::unordered_map
 #include <iomanip>  // For std::setw, std::setfill
 #include <cmath>  // For std::isnan
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "metadata/custom_metadata.h"
 #include "metadata/sql_query_parser.h"
+#include "metadata/json_serialization.h"
 
 // Forward declare required functions from json_helper.h to avoid conflicts
 extern "C" {
@@ -39,16 +62,6 @@ extern "C" {
     extern const char* json_helper_get_last_error();
 }
 
-// Forward declare required functions from json_serialization.h to avoid conflicts
-extern "C" {
-    typedef enum {
-        JSON_SERIALIZATION_OK = 0,
-        // Other enum values omitted
-    } JsonSerializationError;
-
-    extern JsonSerializationError json_serialization_load_from_binary(const char* file_path, Metadata** metadata);
-}
-
 // Implementation of the missing functions
 extern "C" {
     JsonHelperError json_parse_custom_metadata_config(const char* file_path, 
@@ -122,7 +135,7 @@ extern "C" {
         return JSON_HELPER_OK;
     }
     
-    static std::string last_error;
+    static thread_local std::string last_error;
     
     const char* json_helper_get_last_error() {
         return last_error.c_str();
@@ -148,17 +161,6 @@ enum LzmaCompressionLevel {
     LZMA_LEVEL_MAX = 9
 };
 
-// Metadata type definitions
-#define METADATA_TYPE_FILE 1
-
-// Metadata structure for compatibility
-struct MetadataFields {
-    int type;                    // Type of metadata
-    int child_count;             // Number of child metadata items
-    struct MetadataFields** child_metadata;  // Array of child metadata
-    const char* name;            // Name of the metadata item
-};
-
 // Forward declarations for parquet writer functions
 ParquetWriterContext* parquet_writer_create_context();
 ParquetWriterError parquet_writer_free_context(ParquetWriterContext* context);
@@ -185,7 +187,8 @@ ParquetFile* parquet_file_init(const char* file_path) {
     return file;
 }
 
-void parquet_file_free(ParquetFile* file) {
+// Free the row groups and path of a file structure, but not the structure itself
+void parquet_file_clear(ParquetFile* file) {
     if (!file) return;
     
     // Free row groups
@@ -208,6 +211,16 @@ void parquet_file_free(ParquetFile* file) {
         free(file->file_path);
     }
     
+    file->row_groups = nullptr;
+    file->row_group_count = 0;
+    file->file_path = nullptr;
+}
+
+void parquet_file_free(ParquetFile* file) {
+    if (!file) return;
+    
+    parquet_file_clear(file);
+    
     // Free the file structure
     free(file);
 }
@@ -217,7 +230,9 @@ void parquet_file_free(ParquetFile* file) {
 // Private implementation (Pimpl pattern)
 class InfParquet::Impl {
 public:
-    Impl() : progress_callback(nullptr), verbose(false) {}
+    Impl() : progress_callback(nullptr), verbose(false) {
+        lzma_codec_settings_init(&codec_settings);
+    }
     ~Impl() {}
     
     // Last error message
@@ -229,444 +244,1939 @@ public:
     // Verbose mode flag
     bool verbose;
     
+    // Codec settings of this instance; every job copies them with the rest of the Impl
+    // and each pipeline run starts from them (codec threads come from the CPU budget)
+    LzmaCodecSettings codec_settings;
+    
     // Set the last error message
     void setError(const std::string& message) {
         last_error = message;
     }
     
-    // Compression task data structure
-    struct CompressionTaskData {
-        const ParquetFile* file;
+    // Work item for one column chunk travelling through the pipeline
+    struct ChunkWorkItem {
+        uint32_t file_index;        // Index into ChunkPipelineData::files
         int row_group_id;
-        const std::string* output_directory;
-        LzmaCompressionLevel compression_level;
+        int column_id;
+        void* raw_data;             // Uncompressed column data
+        uint64_t raw_size;
+        void* encoded_data;         // LZMA-compressed column data
+        uint64_t encoded_size;
+        uint32_t dictionary_size;   // Dictionary size picked by the analyze stage
+        uint64_t raw_checksum;      // XXH3 of the uncompressed data (compression only)
+        uint64_t encoded_checksum;  // XXH3 of the compressed data (compression only)
+        ChunkCacheEntry* cached;    // Pinned cache entry owning raw_data (decompression only)
+        int error;                  // Stage error deferred to the writer (batch runs only)
     };
     
-    // Compression task function
-    static int compressRowGroup(void* task_data, void** result) {
-        CompressionTaskData* data = static_cast<CompressionTaskData*>(task_data);
-        
-        // Get the row group
-        const ParquetRowGroup* row_group = &data->file->row_groups[data->row_group_id];
-        
-        // Create a reader context to read the parquet file
-        ParquetReaderContext* reader_context = parquet_reader_open(data->file->file_path);
-        if (!reader_context) {
-            // Return an error code if we can't open the file
-            return 1;
+    // Position of one column chunk in the pipeline's sequence
+    struct ChunkRef {
+        uint32_t file_index;
+        int row_group_id;
+        int column_id;
+    };
+    
+    // Checksums of one stored column chunk
+    struct ChunkChecksum {
+        int row_group_id;
+        int column_id;
+        uint64_t encoded_size;
+        uint64_t encoded_checksum;  // XXH3 of the chunk file
+        uint64_t raw_size;
+        uint64_t raw_checksum;      // XXH3 of the decoded column data
+    };
+    
+    // A file whose column chunks take part in a pipeline run
+    struct ChunkSourceFile {
+        const ParquetFile* file;    // Source file (compression only)
+        std::string chunk_prefix;   // <directory>/<file name>, prefix of chunk files
+    };
+    
+    struct BatchState;
+    struct BatchStream;
+    struct StreamArchive;
+    
+    // Shared state of a compression or decompression pipeline run
+    struct ChunkPipelineData {
+        std::vector<ChunkSourceFile> files;       // Files the chunks belong to
+        std::vector<ChunkRef> chunks;             // Chunk per sequence number, grouped by file
+        int compression_level;
+        LzmaCodecSettings codec_settings;         // Codec threads and memory limit for this run
+        int total_row_groups;
+        ProgressCallback progress_callback;
+        ParquetWriterContext* writer;             // Destination of decoded chunks (decompression only)
+        std::vector<int> output_columns;          // Writer column of each archive column (decompression only)
+        BatchState* batch;                        // Per-file commit state (batch compression only)
+        BatchStream* stream;                      // Destination of decoded row groups (streaming only)
+        StreamArchive* archive;                   // Single-stream archive written or read in order (may be null)
+        const CancellationToken* cancel_token;    // Polled between chunks (may be null)
+        std::vector<ChunkChecksum> checksums;     // Chunks stored so far (single-file compression only)
+        uint64_t seek_frame_size = 0;             // Target frame size of seekable chunks (0 = plain chunks)
+        uint32_t cpu_tokens = 0;                  // Budget tokens held by the codec workers (decompression only)
+    };
+    
+    // Per-file state of a batch compression
+    struct BatchFile {
+        std::string input_path;
+        ParquetFile* file;                        // Structure of the file, freed on commit
+        Metadata* metadata;                       // Generated metadata, saved on commit
+        std::string metadata_path;
+        uint64_t first_chunk;                     // Sequence number of the file's first chunk
+        uint64_t chunk_count;
+        std::vector<std::string> written_chunks;  // Chunk files to roll back on failure
+        std::vector<ChunkChecksum> checksums;     // Checksums of the written chunks, saved on commit
+        BatchFileResult result;
+        bool committed;
+    };
+    
+    // Shared state of a batch compression
+    struct BatchState {
+        std::vector<BatchFile> files;
+        std::unique_ptr<std::atomic<bool>[]> failed;  // Set by any stage to skip a file's remaining chunks
+        const CompressionOptions* options;
+        int files_committed;
+    };
+    
+    // Build the path of the compressed file holding one column chunk
+    static std::string chunkFilePath(const std::string& chunk_prefix, int row_group_id, int column_id) {
+        std::stringstream ss;
+        ss << chunk_prefix << "_rg" << row_group_id << "_col" << column_id << ".lzma";
+        return ss.str();
+    }
+    
+    static std::string chunkFilePath(const ChunkPipelineData* data, uint32_t file_index,
+                                     int row_group_id, int column_id) {
+        return chunkFilePath(data->files[file_index].chunk_prefix, row_group_id, column_id);
+    }
+    
+    // Build the pipeline configuration from the per-stage thread counts
+    static PipelineConfig makePipelineConfig(int codec_threads, int reader_threads,
+                                             int analyzer_threads, int queue_depth) {
+        PipelineConfig config;
+        pipeline_get_default_config(&config);
+        if (codec_threads > 0) config.codec_threads = static_cast<uint32_t>(codec_threads);
+        if (reader_threads > 0) config.reader_threads = static_cast<uint32_t>(reader_threads);
+        if (analyzer_threads > 0) config.analyzer_threads = static_cast<uint32_t>(analyzer_threads);
+        if (queue_depth > 0) config.queue_depth = static_cast<uint32_t>(queue_depth);
+        return config;
+    }
+    
+    // Report progress once the last column of a row group has been written
+    static void reportChunkProgress(const ChunkPipelineData* data, uint64_t sequence,
+                                    const char* operation, int first_percent, int last_percent) {
+        if (!data->progress_callback) {
+            return;
+        }
+        const ChunkRef& current = data->chunks[sequence];
+        if (sequence + 1 < data->chunks.size() &&
+            data->chunks[sequence + 1].file_index == current.file_index &&
+            data->chunks[sequence + 1].row_group_id == current.row_group_id) {
+            return;
+        }
+        int total = data->total_row_groups > 0 ? data->total_row_groups : 1;
+        int percent = first_percent + (last_percent - first_percent) * (current.row_group_id + 1) / total;
+        data->progress_callback(operation, current.row_group_id, data->total_row_groups, percent);
+    }
+    
+    // Cancel function of the chunk pipelines
+    static int isChunkPipelineCancelled(void* user_data) {
+        const ChunkPipelineData* data = static_cast<const ChunkPipelineData*>(user_data);
+        return data->cancel_token && data->cancel_token->isCancelled() ? 1 : 0;
+    }
+    
+    // Whether an operation was asked to stop
+    static bool isCancelled(const CancellationToken* cancel_token) {
+        return cancel_token && cancel_token->isCancelled();
+    }
+    
+    // Remove the chunk files a run may have written
+    static void removeChunkFiles(const ChunkPipelineData* data) {
+        for (const auto& chunk : data->chunks) {
+            std::error_code ec;
+            fs::remove(chunkFilePath(data, chunk.file_index, chunk.row_group_id, chunk.column_id), ec);
         }
-        
-        int rc = 0;  // Return code
-        
-        // Compress each column in the row group
-        for (int i = 0; i < row_group->column_count; i++) {
-            const ParquetColumn* column = &row_group->columns[i];
-            
-            // Build the output file path
-            std::stringstream ss;
-            ss << *data->output_directory << "/" 
-               << fs::path(data->file->file_path).filename().string() 
-               << "_rg" << data->row_group_id 
-               << "_col" << i << ".lzma";
-            std::string output_path = ss.str();
-            
-            // Read the column data
-            void* column_data = nullptr;
-            size_t column_data_size = 0;
-            ParquetReaderError read_error = parquet_reader_read_column(
-                reader_context, 
-                data->row_group_id, 
-                i, 
-                &column_data, 
-                &column_data_size
-            );
-            
-            if (read_error != PARQUET_READER_OK) {
-                rc = 2;  // Read error
-                break;
-            }
-            
-            // Calculate the maximum compressed size
-            uint64_t max_compressed_size = lzma_maximum_compressed_size(column_data_size);
-            
-            // Allocate memory for the compressed data
-            void* compressed_data = malloc(max_compressed_size);
-            if (!compressed_data) {
-                parquet_reader_free_buffer(column_data);
-                rc = 3;  // Memory allocation error
-                break;
+    }
+    
+    // Column of the schema file stored next to the chunks of an archive
+    struct ArchiveColumn {
+        std::string name;
+        ParquetValueType type;
+        int type_length;    // Byte length of FIXED_LEN_BYTE_ARRAY values
+    };
+    
+    static std::string schemaFilePath(const std::string& chunk_prefix) {
+        return chunk_prefix + ".schema";
+    }
+    
+    static std::string checksumFilePath(const std::string& chunk_prefix) {
+        return chunk_prefix + ".xxh3";
+    }
+    
+    static bool writeChunkChecksums(const std::vector<ChunkChecksum>& checksums, const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        out << std::hex << std::setfill('0');
+        for (const auto& checksum : checksums) {
+            out << std::dec << checksum.row_group_id << '\t' << checksum.column_id << '\t'
+                << checksum.encoded_size << '\t' << std::hex << std::setw(16) << checksum.encoded_checksum << '\t'
+                << std::dec << checksum.raw_size << '\t' << std::hex << std::setw(16) << checksum.raw_checksum << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+    
+    static bool readChunkChecksums(const std::string& path, std::vector<ChunkChecksum>& checksums) {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            ChunkChecksum checksum;
+            if (!(fields >> std::dec >> checksum.row_group_id >> checksum.column_id >> checksum.encoded_size
+                         >> std::hex >> checksum.encoded_checksum
+                         >> std::dec >> checksum.raw_size >> std::hex >> checksum.raw_checksum)) {
+                return false;
             }
-            
-            // Compress the column data
-            uint64_t compressed_size = max_compressed_size;
-            int compression_error = lzma_compress_buffer(
-                column_data, 
-                column_data_size, 
-                compressed_data, 
-                &compressed_size, 
-                0,  // Default dictionary size
-                static_cast<int>(data->compression_level)
-            );
-            
-            if (compression_error != 0) {
-                free(compressed_data);
-                parquet_reader_free_buffer(column_data);
-                rc = 4;  // Compression error
-                break;
+            checksums.push_back(checksum);
+        }
+        return true;
+    }
+    
+    // Write one "type<TAB>length<TAB>name" line per column of the file
+    static bool writeArchiveSchema(const ParquetFile* file, const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        if (file->row_group_count > 0 && file->row_groups[0].columns) {
+            const ParquetRowGroup& row_group = file->row_groups[0];
+            for (uint32_t j = 0; j < row_group.column_count; j++) {
+                const ParquetColumn& column = row_group.columns[j];
+                out << static_cast<int>(column.type) << '\t'
+                    << column.fixed_len_byte_array_size << '\t'
+                    << column.name << '\n';
             }
-            
-            // Write the compressed data to the output file
-            FILE* out = fopen(output_path.c_str(), "wb");
-            if (!out) {
-                free(compressed_data);
-                parquet_reader_free_buffer(column_data);
-                rc = 5;  // Failed to create output file
-                break;
+        }
+        return static_cast<bool>(out);
+    }
+    
+    static bool readArchiveSchema(const std::string& path, std::vector<ArchiveColumn>& columns) {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            int type = 0;
+            ArchiveColumn column;
+            if (!(fields >> type >> column.type_length) || fields.get() != '\t') {
+                return false;
             }
-            
-            // Write the compressed data
-            if (fwrite(compressed_data, 1, compressed_size, out) != compressed_size) {
-                fclose(out);
-                free(compressed_data);
-                parquet_reader_free_buffer(column_data);
-                rc = 6;  // Failed to write output file
-                break;
+            std::getline(fields, column.name);
+            column.type = static_cast<ParquetValueType>(type);
+            columns.push_back(column);
+        }
+        return !columns.empty();
+    }
+    
+    // Map an output codec name to the Parquet page codec
+    static bool parseOutputCodec(const std::string& name, CompressionType* compression) {
+        std::string codec = name;
+        std::transform(codec.begin(), codec.end(), codec.begin(), ::tolower);
+        if (codec.empty() || codec == "none" || codec == "uncompressed") {
+            *compression = COMPRESSION_NONE;
+        } else if (codec == "snappy") {
+            *compression = COMPRESSION_SNAPPY;
+        } else if (codec == "gzip") {
+            *compression = COMPRESSION_GZIP;
+        } else if (codec == "lz4") {
+            *compression = COMPRESSION_LZ4;
+        } else if (codec == "zstd") {
+            *compression = COMPRESSION_ZSTD;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    // Append the column chunks of one file to the pipeline sequence
+    // returns: Total uncompressed size of the chunks, from the file structure
+    static uint64_t addFileChunks(ChunkPipelineData* data, uint32_t file_index, const ParquetFile* file) {
+        uint64_t total_bytes = 0;
+        for (uint32_t i = 0; i < file->row_group_count; i++) {
+            for (uint32_t j = 0; j < file->row_groups[i].column_count; j++) {
+                data->chunks.push_back({file_index, static_cast<int>(i), static_cast<int>(j)});
+                if (file->row_groups[i].columns) {
+                    total_bytes += file->row_groups[i].columns[j].total_uncompressed_size;
+                }
             }
-            
-            // Close the output file
-            fclose(out);
-            
-            // Free memory
-            free(compressed_data);
-            parquet_reader_free_buffer(column_data);
+        }
+        return total_bytes;
+    }
+    
+    // Describe a chunk stage error code
+    static const char* chunkErrorText(int code) {
+        switch (code) {
+            case 1: return "failed to open the file";
+            case 2: return "failed to read a column chunk";
+            case 3: return "out of memory";
+            case 4: return "LZMA coding failed";
+            case 5: return "failed to create a chunk file";
+            case 6: return "failed to write a chunk file";
+            case 7: return "failed to write the parquet file";
+            case 8: return "failed to build a record batch";
+            case 9: return "LZMA decoder would exceed the memory limit";
+            default: return "unknown error";
+        }
+    }
+    
+    // Fail a chunk: a single-file run aborts, a batch run only gives up on the chunk's file
+    static int failChunk(ChunkPipelineData* data, ChunkWorkItem* chunk, int code) {
+        if (!data->batch) {
+            return code;
+        }
+        chunk->error = code;
+        data->batch->failed[chunk->file_index].store(true, std::memory_order_relaxed);
+        return 0;
+    }
+    
+    // Whether a batch chunk should pass through the remaining stages untouched
+    static bool skipChunk(const ChunkPipelineData* data, const ChunkWorkItem* chunk) {
+        return data->batch &&
+               (chunk->error != 0 || data->batch->failed[chunk->file_index].load(std::memory_order_relaxed));
+    }
+    
+    // Release a chunk work item
+    static void releaseChunk(void* item, void* user_data) {
+        (void)user_data;
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        if (chunk->cached) {
+            chunk_cache_release(chunk->cached);  // The cache owns raw_data
+        } else if (chunk->raw_data) {
+            free(chunk->raw_data);
+        }
+        if (chunk->encoded_data) free(chunk->encoded_data);
+        delete chunk;
+    }
+    
+    // Read stage of compression: load one column chunk from the parquet file
+    static int readChunkForCompression(uint64_t sequence, void** item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        
+        ChunkWorkItem* chunk = new ChunkWorkItem();
+        chunk->file_index = data->chunks[sequence].file_index;
+        chunk->row_group_id = data->chunks[sequence].row_group_id;
+        chunk->column_id = data->chunks[sequence].column_id;
+        *item = chunk;
+        
+        if (skipChunk(data, chunk)) {
+            return 0;
+        }
+        
+        // Reader contexts are cheap (the file is opened per read), so each call gets its own
+        ParquetReaderContext* reader_context = parquet_reader_open(data->files[chunk->file_index].file->file_path);
+        if (!reader_context) {
+            return failChunk(data, chunk, 1);
         }
         
-        // Close the reader context
+        size_t column_data_size = 0;
+        ParquetReaderError read_error = parquet_reader_read_column(
+            reader_context, chunk->row_group_id, chunk->column_id,
+            &chunk->raw_data, &column_data_size);
         parquet_reader_close(reader_context);
         
-        // Allocate and return a result (not used in this example)
-        int* ret_code = static_cast<int*>(malloc(sizeof(int)));
-        if (ret_code) {
-            *ret_code = rc;
-            *result = ret_code;
+        if (read_error != PARQUET_READER_OK) {
+            return failChunk(data, chunk, 2);  // Read error
         }
+        chunk->raw_size = column_data_size;
         
-        return rc;
+        return 0;
     }
     
-    // Decompression task data structure
-    struct DecompressionTaskData {
-        const Metadata* file_metadata;
-        int row_group_id;
-        const std::string* output_directory;
-        std::vector<std::string>* column_files;
-    };
+    // Analyze stage of compression: size the LZMA dictionary to the chunk
+    static int analyzeChunkForCompression(uint64_t sequence, void* item, void* user_data) {
+        (void)sequence;
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        if (skipChunk(data, chunk)) {
+            return 0;
+        }
+        
+        // The encoder allocates its match finder for the full dictionary, so a
+        // chunk smaller than the level's dictionary only needs one of its own size
+        int level = data->compression_level;
+        uint32_t level_dictionary = level <= 4 ? (1u << (level * 2 + 16)) :
+                                    level <= 8 ? (1u << (level + 20)) : (1u << 28);
+        uint32_t dictionary = 1u << 12;
+        while (dictionary < chunk->raw_size && dictionary < level_dictionary) {
+            dictionary <<= 1;
+        }
+        chunk->dictionary_size = dictionary;
+        
+        return 0;
+    }
     
-    // Decompression task function
-    static int decompressRowGroup(void* task_data, void** result) {
-        DecompressionTaskData* data = static_cast<DecompressionTaskData*>(task_data);
-        
-        // Access metadata safely using the helper functions
-        const Metadata* metadata = data->file_metadata;
-        const MetadataFields* fields = reinterpret_cast<const MetadataFields*>(metadata);
-        
-        // Get the child metadata for this row group
-        Metadata* rowGroupMetadata = nullptr;
-        if (fields && data->row_group_id >= 0 && 
-            data->row_group_id < fields->child_count) {
-            rowGroupMetadata = reinterpret_cast<Metadata*>(fields->child_metadata[data->row_group_id]);
-        }
-        
-        // Get the number of columns in this row group
-        int columnCount = 0;
-        if (rowGroupMetadata) {
-            columnCount = reinterpret_cast<MetadataFields*>(rowGroupMetadata)->child_count;
-        }
-        
-        // Build the file names for each column and prepare data structures
-        std::vector<std::string> files;
-        std::string input_directory = fs::path(fields->name).parent_path().string();
-        std::vector<void*> decompressed_data;
-        std::vector<size_t> decompressed_sizes;
-        
-        // Reserve space to avoid reallocations
-        files.reserve(columnCount);
-        decompressed_data.reserve(columnCount);
-        decompressed_sizes.reserve(columnCount);
-        
-        // Collect all column files and prepare for decompression
-        for (int i = 0; i < columnCount; i++) {
-            // Build the input file path
-            std::stringstream ss;
-            ss << input_directory << "/" << fs::path(fields->name).filename().string() 
-               << "_rg" << data->row_group_id 
-               << "_col" << i << ".lzma";
-            std::string file_path = ss.str();
-            files.push_back(file_path);
-            
-            // Check if file exists
-            if (!fs::exists(file_path)) {
-                // Log error and continue with other columns
-                std::cerr << "Error: Compressed file not found: " << file_path << std::endl;
-                decompressed_data.push_back(nullptr);
-                decompressed_sizes.push_back(0);
-                continue;
-            }
-            
-            // Open the compressed file
-            FILE* compressed_file = fopen(file_path.c_str(), "rb");
-            if (!compressed_file) {
-                // Log error and continue with other columns
-                std::cerr << "Error: Failed to open compressed file: " << file_path << std::endl;
-                decompressed_data.push_back(nullptr);
-                decompressed_sizes.push_back(0);
-                continue;
+    // Cut a chunk into frames of about frame_size bytes, each ending on a value boundary
+    static bool planSeekFrames(const ChunkWorkItem* chunk, const ParquetColumn& column, uint64_t frame_size,
+                               std::vector<uint64_t>& frame_ends, std::vector<uint32_t>& frame_rows) {
+        size_t value_size = arrow_column_value_size(column.type, static_cast<int>(column.fixed_len_byte_array_size));
+        if (value_size > 0) {
+            if (chunk->raw_size % value_size != 0) {
+                return false;
             }
-            
-            // Get file size
-            fseek(compressed_file, 0, SEEK_END);
-            size_t compressed_size = ftell(compressed_file);
-            rewind(compressed_file);
-            
-            // Allocate memory for compressed data
-            void* compressed_data = malloc(compressed_size);
-            if (!compressed_data) {
-                // Log error and continue with other columns
-                std::cerr << "Error: Failed to allocate memory for compressed data" << std::endl;
-                fclose(compressed_file);
-                decompressed_data.push_back(nullptr);
-                decompressed_sizes.push_back(0);
-                continue;
+            uint64_t value_count = chunk->raw_size / value_size;
+            uint64_t rows_per_frame = std::max<uint64_t>(1, frame_size / value_size);
+            for (uint64_t row = 0; row < value_count; row += rows_per_frame) {
+                uint64_t rows = std::min(rows_per_frame, value_count - row);
+                frame_ends.push_back((row + rows) * value_size);
+                frame_rows.push_back(static_cast<uint32_t>(rows));
             }
-            
-            // Read compressed data
-            size_t bytes_read = fread(compressed_data, 1, compressed_size, compressed_file);
-            fclose(compressed_file);
-            
-            if (bytes_read != compressed_size) {
-                // Log error and continue with other columns
-                std::cerr << "Error: Failed to read compressed data: " << file_path << std::endl;
-                free(compressed_data);
-                decompressed_data.push_back(nullptr);
-                decompressed_sizes.push_back(0);
-                continue;
+            return true;
+        }
+        if (column.type == PARQUET_FIXED_LEN_BYTE_ARRAY) {
+            return false;  // No value length recorded
+        }
+        
+        // Variable-length values: uint32_t length followed by the bytes
+        const uint8_t* bytes = static_cast<const uint8_t*>(chunk->raw_data);
+        uint64_t frame_start = 0;
+        uint64_t offset = 0;
+        uint32_t rows = 0;
+        while (offset < chunk->raw_size) {
+            uint32_t length = 0;
+            if (chunk->raw_size - offset < sizeof(uint32_t)) {
+                return false;
             }
-            
-            // Get the decompressed size (stored in the LZMA header or from metadata)
-            size_t decompressed_size = lzma_get_decompressed_size(compressed_data, compressed_size);
-            
-            if (decompressed_size == 0) {
-                // If header doesn't contain size or error occurred, use a reasonable estimate
-                // In a real implementation, this would be stored in metadata
-                decompressed_size = compressed_size * 4; // Estimate: compression ratio of 4:1
+            memcpy(&length, bytes + offset, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+            if (chunk->raw_size - offset < length) {
+                return false;
             }
-            
-            // Allocate memory for decompressed data
-            void* decompressed_buffer = malloc(decompressed_size);
-            if (!decompressed_buffer) {
-                // Log error and continue with other columns
-                std::cerr << "Error: Failed to allocate memory for decompressed data" << std::endl;
-                free(compressed_data);
-                decompressed_data.push_back(nullptr);
-                decompressed_sizes.push_back(0);
-                continue;
+            offset += length;
+            rows++;
+            if (offset - frame_start >= frame_size || offset == chunk->raw_size) {
+                frame_ends.push_back(offset);
+                frame_rows.push_back(rows);
+                frame_start = offset;
+                rows = 0;
             }
-            
-            // Decompress data
-            int decomp_result = lzma_decompress_buffer(
-                compressed_data, compressed_size,
-                decompressed_buffer, &decompressed_size
-            );
-            
-            // Free compressed data as it's no longer needed
-            free(compressed_data);
-            
-            if (decomp_result != 0) {
-                // Log error and continue with other columns
-                std::cerr << "Error: Failed to decompress data: " << file_path 
-                          << " (error code: " << decomp_result << ")" << std::endl;
-                free(decompressed_buffer);
-                decompressed_data.push_back(nullptr);
-                decompressed_sizes.push_back(0);
-                continue;
+        }
+        return true;
+    }
+    
+    // Encode stage of compression: compress the chunk with LZMA
+    static int encodeChunk(uint64_t sequence, void* item, void* user_data) {
+        (void)sequence;
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        if (skipChunk(data, chunk)) {
+            return 0;
+        }
+        
+        // Large chunks are cut into frames that decode on their own, for readRange
+        std::vector<uint64_t> frame_ends;
+        std::vector<uint32_t> frame_rows;
+        if (data->seek_frame_size > 0 && chunk->raw_size > data->seek_frame_size) {
+            const ParquetColumn& column =
+                data->files[chunk->file_index].file->row_groups[chunk->row_group_id].columns[chunk->column_id];
+            if (!planSeekFrames(chunk, column, data->seek_frame_size, frame_ends, frame_rows)) {
+                frame_ends.clear();  // Layout not understood: keep the chunk as one plain frame
             }
-            
-            // Store decompressed data
-            decompressed_data.push_back(decompressed_buffer);
-            decompressed_sizes.push_back(decompressed_size);
         }
+        bool seekable = frame_ends.size() > 1;
         
-        // Store the column files in the output vector
-        *data->column_files = files;
+        uint64_t max_compressed_size = seekable
+            ? lzma_maximum_seekable_size(chunk->raw_size, static_cast<uint32_t>(frame_ends.size()))
+            : lzma_maximum_compressed_size(chunk->raw_size);
+        chunk->encoded_data = malloc(max_compressed_size);
+        if (!chunk->encoded_data) {
+            return failChunk(data, chunk, 3);  // Memory allocation error
+        }
         
-        // Create a result structure to pass back decompressed data
-        struct DecompressionResult {
-            std::vector<void*> data;
-            std::vector<size_t> sizes;
-            int row_group_id;
-        };
+        chunk->encoded_size = max_compressed_size;
+        int compression_error = seekable
+            ? lzma_compress_seekable(&data->codec_settings, chunk->raw_data, chunk->raw_size,
+                                     frame_ends.data(), frame_rows.data(),
+                                     static_cast<uint32_t>(frame_ends.size()),
+                                     chunk->encoded_data, &chunk->encoded_size,
+                                     chunk->dictionary_size, data->compression_level)
+            : lzma_compress_buffer_with_settings(&data->codec_settings, chunk->raw_data, chunk->raw_size,
+                                                 chunk->encoded_data, &chunk->encoded_size,
+                                                 chunk->dictionary_size, data->compression_level);
         
-        DecompressionResult* decomp_result = new DecompressionResult{
-            decompressed_data,
-            decompressed_sizes,
-            data->row_group_id
-        };
+        // Both checksums are taken here, on the codec workers, while the data is hot in cache
+        chunk->raw_checksum = XXH3_64bits(chunk->raw_data, chunk->raw_size);
+        if (compression_error == 0) {
+            chunk->encoded_checksum = XXH3_64bits(chunk->encoded_data, chunk->encoded_size);
+        }
         
-        *result = decomp_result;
+        // The raw data is no longer needed; drop it before the item waits for the writer
+        free(chunk->raw_data);
+        chunk->raw_data = nullptr;
         
-        return 0;  // Success
+        return compression_error != 0 ? failChunk(data, chunk, 4) : 0;  // Compression error
     }
     
-    // Compress a parquet file
-    FrameworkError compressParquetFile(
-        const std::string& input_path,
-        const std::string& output_directory,
-        const CompressionOptions& options,
-        ProgressCallback progress_callback
-    ) {
-        // Make sure the output directory exists
-        if (!fs::exists(output_directory)) {
-            try {
-                fs::create_directories(output_directory);
-            } catch (const std::exception& e) {
-                setError("Failed to create output directory: " + std::string(e.what()));
-                return FrameworkError::PERMISSION_DENIED;
-            }
+    // Checksum record of a compressed chunk
+    static ChunkChecksum chunkChecksum(const ChunkWorkItem* chunk) {
+        return {chunk->row_group_id, chunk->column_id, chunk->encoded_size, chunk->encoded_checksum,
+                chunk->raw_size, chunk->raw_checksum};
+    }
+    
+    // Store a compressed chunk in its chunk file
+    static int storeCompressedChunk(const ChunkWorkItem* chunk, const std::string& output_path) {
+        FILE* out = fopen(output_path.c_str(), "wb");
+        if (!out) {
+            return 5;  // Failed to create output file
         }
         
-        // Open the parquet file
-        ParquetReaderContext* reader_context = parquet_reader_open(input_path.c_str());
-        if (!reader_context) {
-            setError("Failed to open parquet file: " + input_path);
-            return FrameworkError::FILE_NOT_FOUND;
+        if (fwrite(chunk->encoded_data, 1, chunk->encoded_size, out) != chunk->encoded_size) {
+            fclose(out);
+            return 6;  // Failed to write output file
         }
+        fclose(out);
+        return 0;
+    }
+    
+    // Write stage of compression: store the compressed chunk, in chunk order
+    static int writeCompressedChunk(uint64_t sequence, void* item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
         
-        // Initialize the parquet file structure
-        ParquetFile* file = parquet_file_init(input_path.c_str());
-        if (!file) {
-            parquet_reader_close(reader_context);
-            setError("Failed to initialize parquet file structure");
-            return FrameworkError::MEMORY_ERROR;
+        std::string output_path = chunkFilePath(data, chunk->file_index, chunk->row_group_id, chunk->column_id);
+        if (data->batch) {
+            return writeBatchChunk(data, sequence, chunk, output_path);
         }
         
-        // Load the parquet file structure
-        ParquetReaderError reader_error = parquet_reader_get_structure(reader_context, file);
-        if (reader_error != PARQUET_READER_OK) {
-            parquet_file_free(file);
-            parquet_reader_close(reader_context);
-            setError("Failed to load parquet file structure: " + 
-                     std::string(parquet_reader_get_error(reader_context)));
-            return FrameworkError::PARQUET_ERROR;
+        int write_error = storeCompressedChunk(chunk, output_path);
+        if (write_error != 0) {
+            return write_error;
         }
+        data->checksums.push_back(chunkChecksum(chunk));
         
-        if (progress_callback) {
-            progress_callback("Parquet file structure loaded", -1, file->row_group_count, 10);
+        reportChunkProgress(data, sequence, "Compressing row groups", 30, 90);
+        return 0;
+    }
+    
+    // Write stage of a batch: store the chunk and commit its file after the file's last chunk
+    static int writeBatchChunk(ChunkPipelineData* data, uint64_t sequence, ChunkWorkItem* chunk,
+                               const std::string& output_path) {
+        BatchFile& batch_file = data->batch->files[chunk->file_index];
+        
+        if (!skipChunk(data, chunk)) {
+            int write_error = storeCompressedChunk(chunk, output_path);
+            if (write_error == 0) {
+                batch_file.written_chunks.push_back(output_path);
+                batch_file.checksums.push_back(chunkChecksum(chunk));
+                batch_file.result.input_bytes += chunk->raw_size;
+                batch_file.result.output_bytes += chunk->encoded_size;
+            } else {
+                failChunk(data, chunk, write_error);
+            }
         }
-        
-        // Generate metadata for the parquet file
-        MetadataGeneratorOptions generator_options;
-        metadata_generator_init_options(&generator_options);
-        generator_options.generate_base_metadata = options.generate_base_metadata;
-        generator_options.generate_custom_metadata = options.generate_custom_metadata;
-        if (options.generate_custom_metadata && !options.custom_metadata_config.empty()) {
-            generator_options.custom_metadata_config_path = options.custom_metadata_config.c_str();
+        if (chunk->error != 0 && batch_file.result.error.empty()) {
+            batch_file.result.error = "Row group " + std::to_string(chunk->row_group_id) +
+                                      ", column " + std::to_string(chunk->column_id) + ": " +
+                                      chunkErrorText(chunk->error);
         }
         
-        Metadata* file_metadata = nullptr;
-        MetadataGeneratorError metadata_error = metadata_generator_generate(
-            file, reader_context, &generator_options, &file_metadata);
-        
-        if (metadata_error != METADATA_GEN_OK) {
-            parquet_file_free(file);
-            parquet_reader_close(reader_context);
-            setError("Failed to generate metadata: " + 
-                     std::string(metadata_generator_get_error()));
-            return FrameworkError::METADATA_ERROR;
+        if (sequence + 1 == batch_file.first_chunk + batch_file.chunk_count) {
+            commitBatchFile(data, chunk->file_index);
         }
-        
-        if (progress_callback) {
-            progress_callback("Metadata generated", -1, file->row_group_count, 20);
+        return 0;
+    }
+    
+    // Commit one file of a batch: publish its metadata, or roll back its chunk files
+    static void commitBatchFile(ChunkPipelineData* data, uint32_t file_index) {
+        BatchState* batch = data->batch;
+        BatchFile& batch_file = batch->files[file_index];
+        
+        // The metadata file is what decompress, list and query look for, so it is
+        // written last and a file only becomes visible once all its chunks exist
+        std::string schema_path = schemaFilePath(data->files[file_index].chunk_prefix);
+        std::string checksum_path = checksumFilePath(data->files[file_index].chunk_prefix);
+        if (!batch->failed[file_index].load(std::memory_order_relaxed) && batch_file.result.error.empty()) {
+            MetadataGeneratorError metadata_error = METADATA_GEN_OK;
+            if (!writeArchiveSchema(batch_file.file, schema_path)) {
+                batch_file.result.error = "Failed to save column schema: " + schema_path;
+            } else if (!writeChunkChecksums(batch_file.checksums, checksum_path)) {
+                batch_file.result.error = "Failed to save chunk checksums: " + checksum_path;
+            } else {
+                metadata_error = metadata_generator_save_metadata(
+                    batch_file.metadata, batch_file.metadata_path.c_str());
+            }
+            if (metadata_error != METADATA_GEN_OK) {
+                const char* message = metadata_generator_get_error();
+                batch_file.result.error = "Failed to save metadata: " + std::string(message ? message : "");
+            }
+        } else if (batch_file.result.error.empty()) {
+            batch_file.result.error = "Compression failed";
         }
         
-        // Save the file metadata
-        std::string metadata_path = output_directory + "/" + 
-                                  fs::path(input_path).filename().string() + ".meta";
-        
-        metadata_error = metadata_generator_save_metadata(file_metadata, metadata_path.c_str());
-        if (metadata_error != METADATA_GEN_OK) {
-            metadata_generator_free_metadata(file_metadata);
-            parquet_file_free(file);
-            parquet_reader_close(reader_context);
-            setError("Failed to save metadata: " + 
-                     std::string(metadata_generator_get_error()));
-            return FrameworkError::METADATA_ERROR;
+        batch_file.result.success = batch_file.result.error.empty();
+        if (!batch_file.result.success) {
+            for (const auto& chunk_file : batch_file.written_chunks) {
+                std::error_code ec;
+                fs::remove(chunk_file, ec);
+            }
+            std::error_code ec;
+            fs::remove(schema_path, ec);
+            fs::remove(checksum_path, ec);
+            batch_file.result.output_bytes = 0;
+        }
+        batch_file.written_chunks.clear();
+        batch_file.checksums.clear();
+        batch_file.committed = true;
+        
+        // Every chunk of the file has passed the reader, so its structures can go
+        metadata_generator_free_metadata(batch_file.metadata);
+        batch_file.metadata = nullptr;
+        parquet_file_free(batch_file.file);
+        batch_file.file = nullptr;
+        data->files[file_index].file = nullptr;
+        
+        batch->files_committed++;
+        if (data->progress_callback) {
+            int total = static_cast<int>(batch->files.size());
+            std::string operation = (batch_file.result.success ? "Compressed " : "Failed ") +
+                                    fs::path(batch_file.input_path).filename().string() + " (" +
+                                    std::to_string(batch->files_committed) + "/" +
+                                    std::to_string(total) + " files)";
+            data->progress_callback(operation, -1, total, 20 + 80 * batch->files_committed / total);
+        }
+    }
+    
+    // Read stage of decompression: load one compressed column chunk
+    static int readChunkForDecompression(uint64_t sequence, void** item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        
+        ChunkWorkItem* chunk = new ChunkWorkItem();
+        chunk->file_index = data->chunks[sequence].file_index;
+        chunk->row_group_id = data->chunks[sequence].row_group_id;
+        chunk->column_id = data->chunks[sequence].column_id;
+        *item = chunk;
+        
+        // A cached chunk skips the decoder entirely; only its file is examined for changes
+        std::string file_path = chunkFilePath(data, chunk->file_index, chunk->row_group_id, chunk->column_id);
+        chunk->cached = chunk_cache_acquire(data->files[chunk->file_index].chunk_prefix.c_str(),
+                                            chunk->row_group_id, chunk->column_id, file_path.c_str());
+        if (chunk->cached) {
+            chunk->raw_data = const_cast<void*>(chunk_cache_entry_data(chunk->cached));
+            chunk->raw_size = chunk_cache_entry_size(chunk->cached);
+            return 0;
+        }
+        
+        FILE* compressed_file = fopen(file_path.c_str(), "rb");
+        if (!compressed_file) {
+            return 1;  // Compressed file missing
+        }
+        
+        fseek(compressed_file, 0, SEEK_END);
+        long file_size = ftell(compressed_file);
+        rewind(compressed_file);
+        if (file_size <= 0) {
+            fclose(compressed_file);
+            return 2;
         }
         
-        if (progress_callback) {
-            progress_callback("Metadata saved", -1, file->row_group_count, 30);
+        chunk->encoded_size = static_cast<uint64_t>(file_size);
+        chunk->encoded_data = malloc(chunk->encoded_size);
+        if (!chunk->encoded_data) {
+            fclose(compressed_file);
+            return 3;  // Memory allocation error
         }
         
-        // Set the maximum number of parallel tasks
-        if (options.parallel_tasks > 0) {
-            parallel_processor_set_max_tasks(options.parallel_tasks);
+        size_t bytes_read = fread(chunk->encoded_data, 1, chunk->encoded_size, compressed_file);
+        fclose(compressed_file);
+        
+        return bytes_read == chunk->encoded_size ? 0 : 2;
+    }
+    
+    // Analyze stage of decompression: check the header, and the decoder's working
+    // memory against the memory limit, before any codec worker allocates it
+    static int analyzeChunkForDecompression(uint64_t sequence, void* item, void* user_data) {
+        (void)sequence;
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        if (chunk->cached) {
+            return 0;
+        }
+        
+        uint64_t decode_memory = lzma_decompress_alloc_memory_usage(chunk->encoded_data, chunk->encoded_size,
+                                                                    &data->codec_settings);
+        if (decode_memory == 0) {
+            return 4;
+        }
+        uint64_t memory_limit = data->codec_settings.memory_limit;
+        return memory_limit > 0 && decode_memory > memory_limit ? 9 : 0;
+    }
+    
+    // Encode stage of decompression: decode the LZMA stream into the chunk's buffer
+    static int decodeChunk(uint64_t sequence, void* item, void* user_data) {
+        (void)sequence;
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        if (chunk->cached) {
+            return 0;
+        }
+        
+        // The decoder fills the output window by window; the limit bounds the decoder, not the chunk
+        int decomp_result = lzma_decompress_alloc(chunk->encoded_data, chunk->encoded_size,
+                                                  &data->codec_settings, &chunk->raw_data, &chunk->raw_size);
+        
+        free(chunk->encoded_data);
+        chunk->encoded_data = nullptr;
+        
+        if (decomp_result != 0) {
+            return decomp_result == 3 ? 3 : decomp_result == 5 ? 9 : 4;
+        }
+        
+        // Hand the buffer to the cache; chunks of single-stream archives have no stable key
+        if (!data->archive && chunk->raw_size > 0) {
+            std::string file_path = chunkFilePath(data, chunk->file_index, chunk->row_group_id, chunk->column_id);
+            chunk->cached = chunk_cache_insert(data->files[chunk->file_index].chunk_prefix.c_str(),
+                                               chunk->row_group_id, chunk->column_id, file_path.c_str(),
+                                               chunk->raw_data, chunk->raw_size);
+        }
+        return 0;
+    }
+    
+    // Write stage of decompression: hand the decoded chunk straight to the parquet writer
+    static int writeDecodedChunk(uint64_t sequence, void* item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        const ChunkRef& current = data->chunks[sequence];
+        
+        // Chunks arrive in order, so row group boundaries follow from the neighbours
+        bool first_in_row_group = sequence == 0 ||
+                                  data->chunks[sequence - 1].row_group_id != current.row_group_id;
+        bool last_in_row_group = sequence + 1 == data->chunks.size() ||
+                                 data->chunks[sequence + 1].row_group_id != current.row_group_id;
+        
+        if (first_in_row_group) {
+            int row_group_id = 0;
+            if (parquet_writer_start_row_group(data->writer, &row_group_id) != PARQUET_WRITER_OK) {
+                return 7;
+            }
         }
         
-        // Set up task data for parallel processing
-        std::vector<CompressionTaskData> task_data(file->row_group_count);
-        std::vector<void*> task_data_ptrs(file->row_group_count);
+        // The writer takes over the decoded buffer; a cached buffer stays with the cache and is copied
+        if (chunk->raw_size > 0) {
+            const ParquetFile* file = data->files[current.file_index].file;
+            int row_count = static_cast<int>(file->row_groups[current.row_group_id].num_rows);
+            int column = data->output_columns[chunk->column_id];
+            size_t size = static_cast<size_t>(chunk->raw_size);
+            if (chunk->cached) {
+                if (parquet_writer_write_column(data->writer, column, chunk->raw_data, size,
+                                                row_count) != PARQUET_WRITER_OK) {
+                    return 7;
+                }
+            } else {
+                if (parquet_writer_adopt_column(data->writer, column, chunk->raw_data, size,
+                                                row_count) != PARQUET_WRITER_OK) {
+                    return 7;
+                }
+                chunk->raw_data = nullptr;
+            }
+        }
+        
+        if (last_in_row_group && parquet_writer_end_row_group(data->writer) != PARQUET_WRITER_OK) {
+            return 7;
+        }
         
-        for (int i = 0; i < file->row_group_count; i++) {
-            task_data[i].file = file;
-            task_data[i].row_group_id = i;
-            task_data[i].output_directory = &output_directory;
-            task_data[i].compression_level = static_cast<LzmaCompressionLevel>(options.compression_level);
-            task_data_ptrs[i] = &task_data[i];
+        reportChunkProgress(data, sequence, "Decompressing row groups", 10, 90);
+        return 0;
+    }
+    
+    // Hand-off between a decompression pipeline and the record batch reader consuming it
+    struct BatchStream {
+        std::shared_ptr<arrow::Schema> schema;
+        std::vector<ParquetValueType> types;      // Per output column
+        std::vector<int> fixed_lens;
+        std::vector<void*> column_data;           // Decoded buffers of the row group being assembled
+        std::vector<size_t> column_sizes;
+        size_t prefetch_depth;                    // Completed batches allowed to wait for the reader
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::shared_ptr<arrow::RecordBatch>> batches;
+        bool finished = false;
+        std::string error;
+        CancellationToken cancel;                 // Set when the reader is closed
+        std::shared_ptr<arrow::ipc::RecordBatchWriter> sink;  // Takes the batches instead of the queue (may be null)
+        
+        ~BatchStream() {
+            for (void* buffer : column_data) {
+                free(buffer);
+            }
+        }
+    };
+    
+    // Write stage of streaming decompression: assemble each row group into a record batch
+    static int streamDecodedChunk(uint64_t sequence, void* item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        BatchStream* stream = data->stream;
+        const ChunkRef& current = data->chunks[sequence];
+        
+        // The batch takes over the decoded buffer, so fixed-width columns are never copied;
+        // a cached buffer stays with the cache and the batch gets a copy
+        int column = data->output_columns[chunk->column_id];
+        if (chunk->raw_size > 0) {
+            void* buffer = chunk->raw_data;
+            if (chunk->cached) {
+                buffer = malloc(chunk->raw_size);
+                if (!buffer) {
+                    return 3;
+                }
+                memcpy(buffer, chunk->raw_data, chunk->raw_size);
+            }
+            stream->column_data[column] = buffer;
+            stream->column_sizes[column] = static_cast<size_t>(chunk->raw_size);
+            chunk->raw_data = nullptr;
+        }
+        
+        bool last_in_row_group = sequence + 1 == data->chunks.size() ||
+                                 data->chunks[sequence + 1].row_group_id != current.row_group_id;
+        if (last_in_row_group) {
+            const ParquetFile* file = data->files[current.file_index].file;
+            std::shared_ptr<arrow::RecordBatch> batch;
+            int result = arrow_make_record_batch(stream->schema, stream->types.data(), stream->fixed_lens.data(),
+                                                 stream->column_data.data(), stream->column_sizes.data(),
+                                                 static_cast<int64_t>(file->row_groups[current.row_group_id].num_rows),
+                                                 0, &batch);
+            std::fill(stream->column_data.begin(), stream->column_data.end(), nullptr);
+            std::fill(stream->column_sizes.begin(), stream->column_sizes.end(), 0);
+            if (result != 0) {
+                return 8;
+            }
+            if (stream->sink) {
+                if (!stream->sink->WriteRecordBatch(*batch).ok()) {
+                    return 7;
+                }
+            } else {
+                // A full queue holds the pipeline back until the reader catches up; the
+                // codec workers' tokens go back to the pool meanwhile, so a reader nobody
+                // consumes never keeps other jobs from running
+                std::unique_lock<std::mutex> lock(stream->mutex);
+                auto ready = [stream] {
+                    return stream->batches.size() < stream->prefetch_depth || stream->cancel.isCancelled();
+                };
+                if (!ready()) {
+                    uint32_t lent_tokens = data->cpu_tokens;
+                    cpu_budget_release_threads(lent_tokens);
+                    data->cpu_tokens = 0;
+                    stream->changed.wait(lock, ready);
+                    data->cpu_tokens = cpu_budget_try_acquire_threads(lent_tokens);
+                }
+                if (!stream->cancel.isCancelled()) {
+                    stream->batches.push_back(std::move(batch));
+                    stream->changed.notify_all();
+                }
+            }
         }
         
-        // Process the row groups in parallel
-        void** task_results = nullptr;
-        ParallelProcessorError parallel_error = parallel_processor_process_row_groups(
-            file,
-            compressRowGroup,
-            task_data_ptrs.data(),
-            nullptr,
-            &task_results
-        );
+        reportChunkProgress(data, sequence, "Decompressing row groups", 10, 90);
+        return 0;
+    }
+    
+    // Single-stream archive, written and read strictly front to back (integers are little-endian):
+    //   header   magic, u32 column count, per column u32 type, u32 type length, u32 name length
+    //            and name, then u32 row group count and per row group u64 rows, u32 columns
+    //   frames   per column chunk in row group order: u32 row group, u32 column, u64 size, LZMA stream
+    //   index    index magic, u64 frame count, per frame u32 row group, u32 column, u64 offset, u64 size
+    //   trailer  u64 offset of the index, magic
+    static constexpr char STREAM_ARCHIVE_MAGIC[] = "IPQSTRM1";
+    static constexpr char STREAM_INDEX_MAGIC[] = "IPQINDEX";
+    
+    // Position of one frame in a single-stream archive
+    struct StreamFrameEntry {
+        int row_group_id;
+        int column_id;
+        uint64_t offset;    // Offset of the frame header from the start of the archive
+        uint64_t size;      // Size of the LZMA stream
+    };
+    
+    // Single-stream archive being written or read by a pipeline
+    struct StreamArchive {
+        std::ostream* out = nullptr;               // Destination (compression)
+        std::istream* in = nullptr;                // Source (decompression)
+        uint64_t offset = 0;                       // Bytes written so far
+        std::vector<StreamFrameEntry> index;       // Frames written so far
+    };
+    
+    static void putStreamInt(std::ostream& out, uint64_t value, int bytes) {
+        char buffer[8];
+        for (int i = 0; i < bytes; i++) {
+            buffer[i] = static_cast<char>(value >> (8 * i));
+        }
+        out.write(buffer, bytes);
+    }
+    
+    static bool getStreamInt(std::istream& in, int bytes, uint64_t* value) {
+        unsigned char buffer[8];
+        if (!in.read(reinterpret_cast<char*>(buffer), bytes)) {
+            return false;
+        }
+        *value = 0;
+        for (int i = 0; i < bytes; i++) {
+            *value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+        }
+        return true;
+    }
+    
+    // Write the header of a single-stream archive: the schema and the row group layout
+    static bool writeStreamHeader(StreamArchive* archive, const ParquetFile* file) {
+        std::ostringstream header;
+        header.write(STREAM_ARCHIVE_MAGIC, 8);
+        uint32_t column_count = file->row_group_count > 0 && file->row_groups[0].columns ?
+                                file->row_groups[0].column_count : 0;
+        putStreamInt(header, column_count, 4);
+        for (uint32_t j = 0; j < column_count; j++) {
+            const ParquetColumn& column = file->row_groups[0].columns[j];
+            size_t name_length = strlen(column.name);
+            putStreamInt(header, static_cast<uint32_t>(column.type), 4);
+            putStreamInt(header, column.fixed_len_byte_array_size, 4);
+            putStreamInt(header, name_length, 4);
+            header.write(column.name, name_length);
+        }
+        putStreamInt(header, file->row_group_count, 4);
+        for (uint32_t i = 0; i < file->row_group_count; i++) {
+            putStreamInt(header, file->row_groups[i].num_rows, 8);
+            putStreamInt(header, file->row_groups[i].column_count, 4);
+        }
+        
+        std::string bytes = header.str();
+        archive->out->write(bytes.data(), bytes.size());
+        archive->offset += bytes.size();
+        return static_cast<bool>(*archive->out);
+    }
+    
+    // Write the trailing frame index, which lets a seekable reader find any frame
+    static bool writeStreamIndex(StreamArchive* archive) {
+        std::ostream& out = *archive->out;
+        uint64_t index_offset = archive->offset;
+        out.write(STREAM_INDEX_MAGIC, 8);
+        putStreamInt(out, archive->index.size(), 8);
+        for (const auto& entry : archive->index) {
+            putStreamInt(out, static_cast<uint32_t>(entry.row_group_id), 4);
+            putStreamInt(out, static_cast<uint32_t>(entry.column_id), 4);
+            putStreamInt(out, entry.offset, 8);
+            putStreamInt(out, entry.size, 8);
+        }
+        putStreamInt(out, index_offset, 8);
+        out.write(STREAM_ARCHIVE_MAGIC, 8);
+        out.flush();
+        return static_cast<bool>(out);
+    }
+    
+    // Write stage of stream compression: append the chunk's frame to the archive
+    static int writeStreamFrame(uint64_t sequence, void* item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        ChunkWorkItem* chunk = static_cast<ChunkWorkItem*>(item);
+        StreamArchive* archive = data->archive;
+        std::ostream& out = *archive->out;
+        
+        archive->index.push_back({chunk->row_group_id, chunk->column_id, archive->offset, chunk->encoded_size});
+        putStreamInt(out, static_cast<uint32_t>(chunk->row_group_id), 4);
+        putStreamInt(out, static_cast<uint32_t>(chunk->column_id), 4);
+        putStreamInt(out, chunk->encoded_size, 8);
+        out.write(static_cast<const char*>(chunk->encoded_data), static_cast<std::streamsize>(chunk->encoded_size));
+        archive->offset += 16 + chunk->encoded_size;
+        if (!out) {
+            return 6;
+        }
+        
+        reportChunkProgress(data, sequence, "Compressing row groups", 30, 90);
+        return 0;
+    }
+    
+    // Read stage of stream decompression: take the chunk's frame from the archive, skipping
+    // the frames of unselected chunks. Frames can only be read in order, so this stage must
+    // run on a single reader thread
+    static int readStreamFrame(uint64_t sequence, void** item, void* user_data) {
+        ChunkPipelineData* data = static_cast<ChunkPipelineData*>(user_data);
+        std::istream& in = *data->archive->in;
+        
+        ChunkWorkItem* chunk = new ChunkWorkItem();
+        chunk->file_index = data->chunks[sequence].file_index;
+        chunk->row_group_id = data->chunks[sequence].row_group_id;
+        chunk->column_id = data->chunks[sequence].column_id;
+        *item = chunk;
+        
+        uint64_t wanted = (static_cast<uint64_t>(chunk->row_group_id) << 32) | static_cast<uint32_t>(chunk->column_id);
+        for (;;) {
+            uint64_t row_group = 0, column = 0, size = 0;
+            if (!getStreamInt(in, 4, &row_group) || !getStreamInt(in, 4, &column) || !getStreamInt(in, 8, &size)) {
+                return 2;
+            }
+            uint64_t position = (row_group << 32) | column;
+            if (position > wanted || size == 0) {
+                return 2;  // Frame missing or archive corrupt
+            }
+            if (position < wanted) {
+                in.ignore(static_cast<std::streamsize>(size));
+                continue;
+            }
+            
+            chunk->encoded_size = size;
+            chunk->encoded_data = malloc(size);
+            if (!chunk->encoded_data) {
+                return 3;
+            }
+            return in.read(static_cast<char*>(chunk->encoded_data), static_cast<std::streamsize>(size)) ? 0 : 2;
+        }
+    }
+    
+
+    // Compress a parquet file
+    FrameworkError compressParquetFile(
+        const std::string& input_path,
+        const std::string& output_directory,
+        const CompressionOptions& options,
+        ProgressCallback progress_callback,
+        const CancellationToken* cancel_token = nullptr
+    ) {
+        // Make sure the output directory exists
+        if (!fs::exists(output_directory)) {
+            try {
+                fs::create_directories(output_directory);
+            } catch (const std::exception& e) {
+                setError("Failed to create output directory: " + std::string(e.what()));
+                return FrameworkError::PERMISSION_DENIED;
+            }
+        }
         
-        if (parallel_error != PARALLEL_PROCESSOR_OK) {
+        // Open the parquet file
+        ParquetReaderContext* reader_context = parquet_reader_open(input_path.c_str());
+        if (!reader_context) {
+            setError("Failed to open parquet file: " + input_path);
+            return FrameworkError::FILE_NOT_FOUND;
+        }
+        
+        // Initialize the parquet file structure
+        ParquetFile* file = parquet_file_init(input_path.c_str());
+        if (!file) {
+            parquet_reader_close(reader_context);
+            setError("Failed to initialize parquet file structure");
+            return FrameworkError::MEMORY_ERROR;
+        }
+        
+        // Load the parquet file structure
+        ParquetReaderError reader_error = parquet_reader_get_structure(reader_context, file);
+        if (reader_error != PARQUET_READER_OK) {
+            parquet_file_free(file);
+            parquet_reader_close(reader_context);
+            setError("Failed to load parquet file structure: " + 
+                     std::string(parquet_reader_get_error(reader_context)));
+            return FrameworkError::PARQUET_ERROR;
+        }
+        
+        if (progress_callback) {
+            progress_callback("Parquet file structure loaded", -1, file->row_group_count, 10);
+        }
+        
+        // Generate metadata for the parquet file
+        MetadataGeneratorOptions generator_options;
+        metadata_generator_init_options(&generator_options);
+        generator_options.generate_base_metadata = options.generate_base_metadata;
+        generator_options.generate_custom_metadata = options.generate_custom_metadata;
+        if (options.generate_custom_metadata && !options.custom_metadata_config.empty()) {
+            generator_options.custom_metadata_config_path = options.custom_metadata_config.c_str();
+        }
+        std::vector<const char*> bloom_filter_columns;
+        for (const auto& column : options.bloom_filter_columns) {
+            bloom_filter_columns.push_back(column.c_str());
+        }
+        generator_options.bloom_filter_columns = bloom_filter_columns.data();
+        generator_options.bloom_filter_column_count = static_cast<uint32_t>(bloom_filter_columns.size());
+        generator_options.bloom_filter_fpp = options.bloom_filter_fpp;
+        generator_options.use_footer_statistics = options.use_footer_statistics;
+        generator_options.sample_rate = options.metadata_sample_rate;
+        generator_options.thread_count = options.parallel_tasks > 0 ? static_cast<uint32_t>(options.parallel_tasks) : 0;
+        
+        Metadata* file_metadata = nullptr;
+        MetadataGeneratorError metadata_error = metadata_generator_generate(
+            file, reader_context, &generator_options, &file_metadata);
+        
+        if (metadata_error != METADATA_GEN_OK) {
+            parquet_file_free(file);
+            parquet_reader_close(reader_context);
+            setError("Failed to generate metadata: " + 
+                     std::string(metadata_generator_get_error()));
+            return FrameworkError::METADATA_ERROR;
+        }
+        
+        if (progress_callback) {
+            progress_callback("Metadata generated", -1, file->row_group_count, 20);
+        }
+        
+        if (isCancelled(cancel_token)) {
             metadata_generator_free_metadata(file_metadata);
             parquet_file_free(file);
             parquet_reader_close(reader_context);
-            setError("Failed to process row groups: " + 
-                     std::string(parallel_processor_get_error()));
+            setError("Compression cancelled");
+            return FrameworkError::CANCELLED;
+        }
+        
+        // The metadata file is what decompress, list and query look for, so it is written
+        // last, after the chunks, schema and checksums, as commitBatchFile does
+        std::string chunk_prefix = output_directory + "/" + fs::path(input_path).filename().string();
+        std::string metadata_path = chunk_prefix + ".meta";
+        std::string schema_path = schemaFilePath(chunk_prefix);
+        std::string checksum_path = checksumFilePath(chunk_prefix);
+        
+        // Every column chunk becomes one item of the read -> analyze -> encode -> write pipeline
+        ChunkPipelineData pipeline_data;
+        pipeline_data.files.push_back({file, chunk_prefix});
+        chunk_cache_erase_archive(pipeline_data.files[0].chunk_prefix.c_str());  // Chunks get rewritten
+        std::error_code stale_ec;
+        fs::remove(metadata_path, stale_ec);  // An earlier archive of the file stops being visible meanwhile
+        pipeline_data.compression_level = options.compression_level;
+        pipeline_data.codec_settings = codec_settings;
+        pipeline_data.total_row_groups = file->row_group_count;
+        pipeline_data.progress_callback = progress_callback;
+        pipeline_data.writer = nullptr;
+        pipeline_data.batch = nullptr;
+        pipeline_data.stream = nullptr;
+        pipeline_data.archive = nullptr;
+        pipeline_data.cancel_token = cancel_token;
+        pipeline_data.seek_frame_size = static_cast<uint64_t>(std::max(options.seek_frame_size, 0));
+        uint64_t total_bytes = addFileChunks(&pipeline_data, 0, file);
+        
+        // Split the CPU budget between concurrent codec workers and the match-finder
+        // thread LZMA can run inside each encoder, so the two never multiply past the cores
+        CpuBudgetGrant grant;
+        uint64_t chunk_count = pipeline_data.chunks.size();
+        cpu_budget_acquire(chunk_count, chunk_count > 0 ? total_bytes / chunk_count : 0,
+                           static_cast<uint32_t>(std::max(options.parallel_tasks, 0)),
+                           options.compression_level, &grant);
+        pipeline_data.codec_settings.threads = grant.codec_threads;
+        
+        if (verbose) {
+            std::cout << "CPU budget: " << grant.task_threads << " codec workers x "
+                      << grant.codec_threads << " LZMA threads" << std::endl;
+        }
+        
+        PipelineConfig pipeline_config = makePipelineConfig(
+            static_cast<int>(grant.task_threads), options.reader_threads,
+            options.analyzer_threads, options.queue_depth);
+        
+        PipelineStages stages;
+        stages.read = readChunkForCompression;
+        stages.analyze = analyzeChunkForCompression;
+        stages.encode = encodeChunk;
+        stages.write = writeCompressedChunk;
+        stages.cleanup = releaseChunk;
+        stages.cancelled = isChunkPipelineCancelled;
+        stages.user_data = &pipeline_data;
+        
+        PipelineError pipeline_error = pipeline_run(&pipeline_config, &stages, pipeline_data.chunks.size());
+        cpu_budget_release(&grant);
+        
+        // Save the checksums, which let verify check the archive without reconstructing
+        // it, the column schema and finally the metadata
+        std::string error_message;
+        FrameworkError error = FrameworkError::OK;
+        if (pipeline_error == PIPELINE_CANCELLED) {
+            error_message = "Compression cancelled";
+            error = FrameworkError::CANCELLED;
+        } else if (pipeline_error != PIPELINE_OK) {
+            error_message = "Failed to process row groups: " + std::string(pipeline_get_error());
+            error = FrameworkError::PARALLEL_PROCESSING_ERROR;
+        } else if (!writeChunkChecksums(pipeline_data.checksums, checksum_path)) {
+            error_message = "Failed to save chunk checksums: " + checksum_path;
+            error = FrameworkError::METADATA_ERROR;
+        } else if (!writeArchiveSchema(file, schema_path)) {
+            error_message = "Failed to save column schema: " + schema_path;
+            error = FrameworkError::METADATA_ERROR;
+        } else if (metadata_generator_save_metadata(file_metadata, metadata_path.c_str()) != METADATA_GEN_OK) {
+            error_message = "Failed to save metadata: " + std::string(metadata_generator_get_error());
+            error = FrameworkError::METADATA_ERROR;
+        }
+        
+        int row_group_count = file->row_group_count;
+        metadata_generator_free_metadata(file_metadata);
+        parquet_file_free(file);
+        parquet_reader_close(reader_context);
+        
+        if (error != FrameworkError::OK) {
+            // Leave no partial archive behind: without its chunks the metadata is useless
+            removeChunkFiles(&pipeline_data);
+            std::error_code ec;
+            fs::remove(checksum_path, ec);
+            fs::remove(schema_path, ec);
+            fs::remove(metadata_path, ec);
+            setError(error_message);
+            return error;
+        }
+        
+        if (progress_callback) {
+            progress_callback("File compression completed", -1, row_group_count, 90);
+        }
+        
+        if (progress_callback) {
+            progress_callback("Compression process completed", -1, row_group_count, 100);
+        }
+        
+        return FrameworkError::OK;
+    }
+    
+    // Compress a parquet file into a single-stream archive ("-" for standard input or output)
+    FrameworkError compressToStream(
+        const std::string& input_path,
+        const std::string& output_path,
+        const CompressionOptions& options,
+        ProgressCallback progress_callback,
+        const CancellationToken* cancel_token = nullptr
+    ) {
+        // Parquet keeps its footer at the end of the file, so standard input has to be
+        // spooled before the first column chunk can be located
+        std::string parquet_path = input_path;
+        std::string spool_path;
+        if (input_path == "-") {
+            spool_path = (fs::temp_directory_path() / ("infparquet-stdin-" +
+                std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".parquet")).string();
+            std::ofstream spool(spool_path, std::ios::binary);
+            if (!spool || !(spool << std::cin.rdbuf())) {
+                std::error_code ec;
+                fs::remove(spool_path, ec);
+                setError("Failed to read the parquet file from standard input");
+                return FrameworkError::FILE_NOT_FOUND;
+            }
+            parquet_path = spool_path;
+        }
+        FrameworkError result = compressFileToStream(parquet_path, output_path, options,
+                                                     progress_callback, cancel_token);
+        if (!spool_path.empty()) {
+            std::error_code ec;
+            fs::remove(spool_path, ec);
+        }
+        return result;
+    }
+    
+    // Compress a parquet file on disk into a single-stream archive
+    FrameworkError compressFileToStream(
+        const std::string& input_path,
+        const std::string& output_path,
+        const CompressionOptions& options,
+        ProgressCallback progress_callback,
+        const CancellationToken* cancel_token
+    ) {
+        ParquetReaderContext* reader_context = parquet_reader_open(input_path.c_str());
+        if (!reader_context) {
+            setError("Failed to open parquet file: " + input_path);
+            return FrameworkError::FILE_NOT_FOUND;
+        }
+        ParquetFile* file = parquet_file_init(input_path.c_str());
+        if (!file) {
+            parquet_reader_close(reader_context);
+            setError("Failed to initialize parquet file structure");
+            return FrameworkError::MEMORY_ERROR;
+        }
+        ParquetReaderError reader_error = parquet_reader_get_structure(reader_context, file);
+        if (reader_error != PARQUET_READER_OK) {
+            setError("Failed to load parquet file structure: " + 
+                     std::string(parquet_reader_get_error(reader_context)));
+            parquet_file_free(file);
+            parquet_reader_close(reader_context);
+            return FrameworkError::PARQUET_ERROR;
+        }
+        parquet_reader_close(reader_context);
+        
+        if (progress_callback) {
+            progress_callback("Parquet file structure loaded", -1, file->row_group_count, 10);
+        }
+        
+        std::ofstream file_out;
+        StreamArchive archive;
+        archive.out = &std::cout;
+        if (output_path != "-") {
+            file_out.open(output_path, std::ios::binary | std::ios::trunc);
+            if (!file_out) {
+                parquet_file_free(file);
+                setError("Failed to create archive: " + output_path);
+                return FrameworkError::PERMISSION_DENIED;
+            }
+            archive.out = &file_out;
+        }
+        
+        if (!writeStreamHeader(&archive, file)) {
+            parquet_file_free(file);
+            setError("Failed to write the archive header");
+            return FrameworkError::COMPRESSION_ERROR;
+        }
+        
+        // Frames leave the ordered write stage as soon as they are encoded, so only the
+        // chunks queued between the stages are ever held in memory
+        ChunkPipelineData pipeline_data;
+        pipeline_data.files.push_back({file, std::string()});
+        pipeline_data.compression_level = options.compression_level;
+        pipeline_data.codec_settings = codec_settings;
+        pipeline_data.total_row_groups = file->row_group_count;
+        pipeline_data.progress_callback = progress_callback;
+        pipeline_data.writer = nullptr;
+        pipeline_data.batch = nullptr;
+        pipeline_data.stream = nullptr;
+        pipeline_data.archive = &archive;
+        pipeline_data.cancel_token = cancel_token;
+        pipeline_data.seek_frame_size = static_cast<uint64_t>(std::max(options.seek_frame_size, 0));
+        uint64_t total_bytes = addFileChunks(&pipeline_data, 0, file);
+        
+        CpuBudgetGrant grant;
+        uint64_t chunk_count = pipeline_data.chunks.size();
+        cpu_budget_acquire(chunk_count, chunk_count > 0 ? total_bytes / chunk_count : 0,
+                           static_cast<uint32_t>(std::max(options.parallel_tasks, 0)),
+                           options.compression_level, &grant);
+        pipeline_data.codec_settings.threads = grant.codec_threads;
+        
+        PipelineConfig pipeline_config = makePipelineConfig(
+            static_cast<int>(grant.task_threads), options.reader_threads,
+            options.analyzer_threads, options.queue_depth);
+        
+        PipelineStages stages;
+        stages.read = readChunkForCompression;
+        stages.analyze = analyzeChunkForCompression;
+        stages.encode = encodeChunk;
+        stages.write = writeStreamFrame;
+        stages.cleanup = releaseChunk;
+        stages.cancelled = isChunkPipelineCancelled;
+        stages.user_data = &pipeline_data;
+        
+        PipelineError pipeline_error = pipeline_run(&pipeline_config, &stages, chunk_count);
+        cpu_budget_release(&grant);
+        
+        int row_group_count = file->row_group_count;
+        parquet_file_free(file);
+        
+        FrameworkError result = FrameworkError::OK;
+        if (pipeline_error == PIPELINE_CANCELLED) {
+            setError("Compression cancelled");
+            result = FrameworkError::CANCELLED;
+        } else if (pipeline_error != PIPELINE_OK) {
+            const char* message = pipeline_get_error();
+            setError("Failed to process row groups: " + std::string(message ? message : ""));
+            result = FrameworkError::PARALLEL_PROCESSING_ERROR;
+        } else if (!writeStreamIndex(&archive)) {
+            setError("Failed to write the archive index");
+            result = FrameworkError::COMPRESSION_ERROR;
+        }
+        
+        // A truncated archive has no trailer; a file on disk is removed so it cannot be mistaken for one
+        if (result != FrameworkError::OK) {
+            if (file_out.is_open()) {
+                file_out.close();
+                std::error_code ec;
+                fs::remove(output_path, ec);
+            }
+            return result;
+        }
+        
+        if (progress_callback) {
+            progress_callback("Compression process completed", -1, row_group_count, 100);
+        }
+        return FrameworkError::OK;
+    }
+    
+    // Match a file name against a glob pattern with '*' and '?' wildcards
+    static bool matchesWildcard(const std::string& pattern, const std::string& name) {
+        size_t p = 0, n = 0;
+        size_t star = std::string::npos, star_match = 0;
+        while (n < name.size()) {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+                p++;
+                n++;
+            } else if (p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                star_match = n;
+            } else if (star != std::string::npos) {
+                p = star + 1;
+                n = ++star_match;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') {
+            p++;
+        }
+        return p == pattern.size();
+    }
+    
+    // Expand a batch input (directory, glob or single file) into sorted file paths
+    FrameworkError expandBatchInput(const std::string& input_pattern, std::vector<std::string>* inputs) {
+        std::error_code ec;
+        fs::path pattern_path(input_pattern);
+        
+        if (fs::is_directory(pattern_path, ec)) {
+            for (const auto& entry : fs::directory_iterator(pattern_path, ec)) {
+                std::string extension = entry.path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(),
+                               [](unsigned char c) { return std::tolower(c); });
+                if (entry.is_regular_file(ec) && extension == ".parquet") {
+                    inputs->push_back(entry.path().string());
+                }
+            }
+        } else if (input_pattern.find_first_of("*?") != std::string::npos) {
+            // Wildcards are only supported in the file name, not in the directories
+            fs::path directory = pattern_path.parent_path();
+            if (directory.empty()) {
+                directory = ".";
+            }
+            std::string name_pattern = pattern_path.filename().string();
+            for (const auto& entry : fs::directory_iterator(directory, ec)) {
+                if (entry.is_regular_file(ec) && matchesWildcard(name_pattern, entry.path().filename().string())) {
+                    inputs->push_back(entry.path().string());
+                }
+            }
+        } else if (fs::is_regular_file(pattern_path, ec)) {
+            inputs->push_back(input_pattern);
+        } else {
+            setError("Batch input not found: " + input_pattern);
+            return FrameworkError::FILE_NOT_FOUND;
+        }
+        
+        if (ec) {
+            setError("Failed to list batch input " + input_pattern + ": " + ec.message());
+            return FrameworkError::FILE_NOT_FOUND;
+        }
+        
+        std::sort(inputs->begin(), inputs->end());
+        return FrameworkError::OK;
+    }
+    
+    // Load the structure of one batch file and generate its metadata
+    static int prepareBatchFile(uint32_t item_index, uint32_t total_items, void* user_data) {
+        (void)total_items;
+        BatchState* batch = static_cast<BatchState*>(user_data);
+        BatchFile& batch_file = batch->files[item_index];
+        if (!batch_file.result.error.empty()) {
+            return 0;  // Already rejected while collecting the inputs
+        }
+        
+        // Failures are recorded per file; returning non-zero would stop the other files
+        ParquetReaderContext* reader_context = parquet_reader_open(batch_file.input_path.c_str());
+        if (!reader_context) {
+            batch_file.result.error = "Failed to open parquet file";
+            return 0;
+        }
+        
+        batch_file.file = parquet_file_init(batch_file.input_path.c_str());
+        if (!batch_file.file) {
+            parquet_reader_close(reader_context);
+            batch_file.result.error = "Failed to initialize parquet file structure";
+            return 0;
+        }
+        
+        if (parquet_reader_get_structure(reader_context, batch_file.file) != PARQUET_READER_OK) {
+            const char* message = parquet_reader_get_error(reader_context);
+            batch_file.result.error = "Failed to load parquet file structure: " +
+                                      std::string(message ? message : "");
+            parquet_reader_close(reader_context);
+            return 0;
+        }
+        
+        const CompressionOptions* options = batch->options;
+        MetadataGeneratorOptions generator_options;
+        metadata_generator_init_options(&generator_options);
+        generator_options.generate_base_metadata = options->generate_base_metadata;
+        generator_options.generate_custom_metadata = options->generate_custom_metadata;
+        if (options->generate_custom_metadata && !options->custom_metadata_config.empty()) {
+            generator_options.custom_metadata_config_path = options->custom_metadata_config.c_str();
+        }
+        std::vector<const char*> bloom_filter_columns;
+        for (const auto& column : options->bloom_filter_columns) {
+            bloom_filter_columns.push_back(column.c_str());
+        }
+        generator_options.bloom_filter_columns = bloom_filter_columns.data();
+        generator_options.bloom_filter_column_count = static_cast<uint32_t>(bloom_filter_columns.size());
+        generator_options.bloom_filter_fpp = options->bloom_filter_fpp;
+        generator_options.use_footer_statistics = options->use_footer_statistics;
+        generator_options.sample_rate = options->metadata_sample_rate;
+        generator_options.thread_count = options->parallel_tasks > 0 ? static_cast<uint32_t>(options->parallel_tasks) : 0;
+        
+        if (metadata_generator_generate(batch_file.file, reader_context, &generator_options,
+                                        &batch_file.metadata) != METADATA_GEN_OK) {
+            const char* message = metadata_generator_get_error();
+            batch_file.result.error = "Failed to generate metadata: " + std::string(message ? message : "");
+        }
+        
+        parquet_reader_close(reader_context);
+        return 0;
+    }
+    
+    // Compress every file of a batch on one shared pipeline
+    FrameworkError compressParquetBatch(
+        const std::string& input_pattern,
+        const std::string& output_directory,
+        const CompressionOptions& options,
+        ProgressCallback progress_callback,
+        BatchCompressionReport* report,
+        const CancellationToken* cancel_token = nullptr
+    ) {
+        BatchCompressionReport local_report;
+        if (!report) {
+            report = &local_report;
+        }
+        *report = BatchCompressionReport();
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        
+        std::vector<std::string> inputs;
+        FrameworkError expand_error = expandBatchInput(input_pattern, &inputs);
+        if (expand_error != FrameworkError::OK) {
+            return expand_error;
+        }
+        if (inputs.empty()) {
+            setError("No parquet files match: " + input_pattern);
+            return FrameworkError::FILE_NOT_FOUND;
+        }
+        
+        // Make sure the output directory exists
+        if (!fs::exists(output_directory)) {
+            try {
+                fs::create_directories(output_directory);
+            } catch (const std::exception& e) {
+                setError("Failed to create output directory: " + std::string(e.what()));
+                return FrameworkError::PERMISSION_DENIED;
+            }
+        }
+        
+        uint32_t file_count = static_cast<uint32_t>(inputs.size());
+        BatchState batch;
+        batch.files.resize(file_count);
+        batch.failed.reset(new std::atomic<bool>[file_count]);
+        batch.options = &options;
+        batch.files_committed = 0;
+        
+        // Chunk and metadata files are named after the input file, so two inputs
+        // with the same name (from different directories) cannot share an output
+        std::unordered_map<std::string, uint32_t> output_names;
+        for (uint32_t i = 0; i < file_count; i++) {
+            BatchFile& batch_file = batch.files[i];
+            std::string name = fs::path(inputs[i]).filename().string();
+            batch_file.input_path = inputs[i];
+            batch_file.file = nullptr;
+            batch_file.metadata = nullptr;
+            batch_file.metadata_path = output_directory + "/" + name + ".meta";
+            batch_file.first_chunk = 0;
+            batch_file.chunk_count = 0;
+            batch_file.committed = false;
+            batch_file.result.input_file = inputs[i];
+            batch.failed[i].store(false, std::memory_order_relaxed);
+            if (!output_names.emplace(name, i).second) {
+                batch_file.result.error = "Output name clashes with " + inputs[output_names[name]];
+            }
+        }
+        
+        // Per-file setup (structure and metadata) runs in parallel across files
+        int prepare_error = parallel_process_items(prepareBatchFile, file_count,
+                                                   static_cast<uint32_t>(std::max(options.parallel_tasks, 0)),
+                                                   nullptr, &batch);
+        if (prepare_error != PARALLEL_PROCESSOR_OK) {
+            for (auto& batch_file : batch.files) {
+                metadata_generator_free_metadata(batch_file.metadata);
+                parquet_file_free(batch_file.file);
+            }
+            const char* message = parallel_processor_get_error();
+            setError("Failed to prepare batch files: " + std::string(message ? message : ""));
             return FrameworkError::PARALLEL_PROCESSING_ERROR;
         }
         
         if (progress_callback) {
-            progress_callback("File compression completed", -1, file->row_group_count, 90);
+            progress_callback("Batch files prepared", -1, static_cast<int>(file_count), 20);
+        }
+        
+        if (isCancelled(cancel_token)) {
+            for (auto& batch_file : batch.files) {
+                metadata_generator_free_metadata(batch_file.metadata);
+                parquet_file_free(batch_file.file);
+            }
+            setError("Batch compression cancelled");
+            return FrameworkError::CANCELLED;
+        }
+        
+        // The chunks of all files form one sequence, grouped by file, so the codec
+        // workers move on to the next file while the writer finishes the previous one
+        ChunkPipelineData pipeline_data;
+        pipeline_data.compression_level = options.compression_level;
+        pipeline_data.codec_settings = codec_settings;
+        pipeline_data.total_row_groups = 0;
+        pipeline_data.progress_callback = progress_callback;
+        pipeline_data.writer = nullptr;
+        pipeline_data.batch = &batch;
+        pipeline_data.stream = nullptr;
+        pipeline_data.archive = nullptr;
+        pipeline_data.cancel_token = cancel_token;
+        pipeline_data.seek_frame_size = static_cast<uint64_t>(std::max(options.seek_frame_size, 0));
+        uint64_t total_bytes = 0;
+        for (uint32_t i = 0; i < file_count; i++) {
+            BatchFile& batch_file = batch.files[i];
+            pipeline_data.files.push_back({batch_file.file, output_directory + "/" +
+                                                            fs::path(batch_file.input_path).filename().string()});
+            batch_file.first_chunk = pipeline_data.chunks.size();
+            if (batch_file.result.error.empty()) {
+                chunk_cache_erase_archive(pipeline_data.files[i].chunk_prefix.c_str());  // Chunks get rewritten
+                total_bytes += addFileChunks(&pipeline_data, i, batch_file.file);
+            }
+            batch_file.chunk_count = pipeline_data.chunks.size() - batch_file.first_chunk;
+        }
+        
+        // Files that failed to prepare, or have no chunks, are committed right away
+        for (uint32_t i = 0; i < file_count; i++) {
+            if (batch.files[i].chunk_count == 0) {
+                commitBatchFile(&pipeline_data, i);
+            }
+        }
+        
+        PipelineError pipeline_error = PIPELINE_OK;
+        uint64_t chunk_count = pipeline_data.chunks.size();
+        if (chunk_count > 0) {
+            CpuBudgetGrant grant;
+            cpu_budget_acquire(chunk_count, total_bytes / chunk_count,
+                               static_cast<uint32_t>(std::max(options.parallel_tasks, 0)),
+                               options.compression_level, &grant);
+            pipeline_data.codec_settings.threads = grant.codec_threads;
+            
+            if (verbose) {
+                std::cout << "CPU budget: " << grant.task_threads << " codec workers x "
+                          << grant.codec_threads << " LZMA threads for " << chunk_count
+                          << " chunks in " << file_count << " files" << std::endl;
+            }
+            
+            PipelineConfig pipeline_config = makePipelineConfig(
+                static_cast<int>(grant.task_threads), options.reader_threads,
+                options.analyzer_threads, options.queue_depth);
+            
+            PipelineStages stages;
+            stages.read = readChunkForCompression;
+            stages.analyze = analyzeChunkForCompression;
+            stages.encode = encodeChunk;
+            stages.write = writeCompressedChunk;
+            stages.cleanup = releaseChunk;
+            stages.cancelled = isChunkPipelineCancelled;
+            stages.user_data = &pipeline_data;
+            
+            pipeline_error = pipeline_run(&pipeline_config, &stages, chunk_count);
+            cpu_budget_release(&grant);
+        }
+        
+        // Stage errors are handled per file, so a pipeline error means the run
+        // itself broke down or was cancelled; roll back every file not committed yet
+        std::string pipeline_message;
+        if (pipeline_error != PIPELINE_OK) {
+            const char* message = pipeline_get_error();
+            pipeline_message = pipeline_error == PIPELINE_CANCELLED ? "cancelled" :
+                               message ? message : "pipeline failed";
+            for (uint32_t i = 0; i < file_count; i++) {
+                if (!batch.files[i].committed) {
+                    batch.files[i].result.error = "Batch aborted: " + pipeline_message;
+                    commitBatchFile(&pipeline_data, i);
+                }
+            }
+        }
+        
+        // Aggregate the per-file results
+        report->chunk_count = chunk_count;
+        const BatchFileResult* first_failure = nullptr;
+        for (const auto& batch_file : batch.files) {
+            report->files.push_back(batch_file.result);
+            report->input_bytes += batch_file.result.input_bytes;
+            report->output_bytes += batch_file.result.output_bytes;
+            if (batch_file.result.success) {
+                report->files_succeeded++;
+            } else {
+                report->files_failed++;
+                if (!first_failure) {
+                    first_failure = &batch_file.result;
+                }
+            }
+        }
+        report->elapsed_seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time).count();
+        
+        if (pipeline_error == PIPELINE_CANCELLED) {
+            setError("Batch compression cancelled after " + std::to_string(report->files_succeeded) +
+                     " of " + std::to_string(file_count) + " files");
+            return FrameworkError::CANCELLED;
+        }
+        if (pipeline_error != PIPELINE_OK) {
+            setError("Failed to process batch: " + pipeline_message);
+            return FrameworkError::PARALLEL_PROCESSING_ERROR;
+        }
+        if (first_failure) {
+            setError(std::to_string(report->files_failed) + " of " + std::to_string(file_count) +
+                     " files failed to compress; first failure: " + first_failure->input_file +
+                     ": " + first_failure->error);
+            return FrameworkError::COMPRESSION_ERROR;
+        }
+        
+        return FrameworkError::OK;
+    }
+    
+    // Archive opened for decompression: its structure, column schema and selection
+    struct DecompressionPlan {
+        Metadata* file_metadata = nullptr;
+        ParquetFile parquet_file;            // Row groups and row counts rebuilt from the metadata
+        std::string chunk_prefix;            // Path prefix of the archive's chunk files
+        std::string output_name;             // File name of the restored parquet file
+        std::vector<ArchiveColumn> schema;
+        std::vector<bool> keep_column;       // Selected columns, indexed like schema
+        std::vector<int> row_groups;         // Selected row groups, ascending
+        
+        DecompressionPlan() { memset(&parquet_file, 0, sizeof(ParquetFile)); }
+        ~DecompressionPlan() {
+            parquet_file_clear(&parquet_file);
+            if (file_metadata) {
+                metadata_release(file_metadata);
+            }
+        }
+        DecompressionPlan(const DecompressionPlan&) = delete;
+        DecompressionPlan& operator=(const DecompressionPlan&) = delete;
+    };
+    
+    // Load an archive's metadata and schema and resolve the column and row group selection
+    FrameworkError openArchive(const std::string& metadata_path,
+                               const std::vector<std::string>& columns,
+                               const std::vector<int>& row_groups,
+                               ProgressCallback progress_callback,
+                               DecompressionPlan& plan) {
+        // Load the metadata file
+        MetadataGeneratorError metadata_error = metadata_generator_load_metadata(
+            metadata_path.c_str(), &plan.file_metadata);
+        Metadata* file_metadata = plan.file_metadata;
+        
+        if (metadata_error != METADATA_GEN_OK) {
+            setError("Failed to load metadata: " + 
+                     std::string(metadata_generator_get_error()));
+            return FrameworkError::METADATA_ERROR;
+        }
+        
+        int childCount = static_cast<int>(file_metadata->row_group_metadata_count);
+        if (progress_callback) {
+            progress_callback("Metadata loaded", -1, childCount, 10);
+        }
+        
+        // The archive's files share the path of the metadata file without its .meta extension
+        std::string input_directory = fs::path(metadata_path).parent_path().string();
+        std::string archive_name = fs::path(metadata_path).stem().string();
+        plan.chunk_prefix = input_directory + "/" + archive_name;
+        plan.output_name = archive_name;
+        
+        // The metadata does not record physical column types, so they come from the schema file
+        if (!readArchiveSchema(schemaFilePath(plan.chunk_prefix), plan.schema)) {
+            setError("Failed to read column schema " + schemaFilePath(plan.chunk_prefix));
+            return FrameworkError::METADATA_ERROR;
+        }
+        
+        // Create a proper ParquetFile structure from the metadata
+        ParquetFile& parquet_file = plan.parquet_file;
+        
+        // Set file path - use the original file path from metadata
+        parquet_file.file_path = strdup(file_metadata->file_path ? file_metadata->file_path : archive_name.c_str());
+        parquet_file.row_group_count = childCount;
+        parquet_file.row_groups = (ParquetRowGroup*)calloc(childCount > 0 ? childCount : 1, sizeof(ParquetRowGroup));
+        if (!parquet_file.file_path || !parquet_file.row_groups) {
+            setError("Failed to allocate memory for row groups");
+            return FrameworkError::MEMORY_ERROR;
+        }
+        
+        // Initialize row groups with data from metadata
+        uint64_t total_rows = 0;
+        for (int i = 0; i < childCount; i++) {
+            ParquetRowGroup* row_group = &parquet_file.row_groups[i];
+            row_group->row_group_index = i;
+            row_group->column_count = static_cast<int>(plan.schema.size());
+            row_group->num_rows = file_metadata->row_group_metadata[i].row_count;
+            total_rows += row_group->num_rows;
+        }
+        parquet_file.total_rows = total_rows;
+        
+        return selectArchiveData(columns, row_groups, plan);
+    }
+    
+    // Resolve the column and row group selection of an opened archive
+    FrameworkError selectArchiveData(const std::vector<std::string>& columns,
+                                     const std::vector<int>& row_groups,
+                                     DecompressionPlan& plan) {
+        const std::vector<ArchiveColumn>& schema = plan.schema;
+        int childCount = plan.parquet_file.row_group_count;
+        
+        // Projection: only the selected columns and row groups are read, decoded and written
+        plan.keep_column.assign(schema.size(), columns.empty());
+        for (const auto& name : columns) {
+            auto it = std::find_if(schema.begin(), schema.end(),
+                                   [&name](const ArchiveColumn& column) { return column.name == name; });
+            if (it == schema.end()) {
+                setError("Unknown column: " + name);
+                return FrameworkError::INVALID_PARAMETER;
+            }
+            plan.keep_column[it - schema.begin()] = true;
+        }
+        
+        std::vector<int>& selected = plan.row_groups;
+        selected = row_groups;
+        if (selected.empty()) {
+            selected.resize(childCount);
+            std::iota(selected.begin(), selected.end(), 0);
+        }
+        std::sort(selected.begin(), selected.end());
+        selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+        if (!selected.empty() && (selected.front() < 0 || selected.back() >= childCount)) {
+            setError("Row group out of range: the archive has " + std::to_string(childCount) + " row groups");
+            return FrameworkError::INVALID_PARAMETER;
         }
         
-        // Free the task results
-        parallel_processor_free_results(task_results, file->row_group_count);
-        
-        // Clean up
-        metadata_generator_free_metadata(file_metadata);
-        parquet_file_free(file);
-        parquet_reader_close(reader_context);
+        return FrameworkError::OK;
+    }
+    
+    // Fill the decompression pipeline with the selected chunks of an opened archive
+    static void initDecompressionPipeline(ChunkPipelineData* data, const DecompressionPlan& plan,
+                                          const LzmaCodecSettings& codec_settings,
+                                          ProgressCallback progress_callback,
+                                          const CancellationToken* cancel_token) {
+        data->files.push_back({&plan.parquet_file, plan.chunk_prefix});
+        data->compression_level = 0;
+        data->codec_settings = codec_settings;
+        data->total_row_groups = plan.parquet_file.row_group_count;
+        data->progress_callback = progress_callback;
+        data->writer = nullptr;
+        data->batch = nullptr;
+        data->stream = nullptr;
+        data->archive = nullptr;
+        data->cancel_token = cancel_token;
+        for (int row_group : plan.row_groups) {
+            uint32_t column_count = std::min<uint32_t>(plan.parquet_file.row_groups[row_group].column_count,
+                                                       static_cast<uint32_t>(plan.schema.size()));
+            for (uint32_t j = 0; j < column_count; j++) {
+                if (plan.keep_column[j]) {
+                    data->chunks.push_back({0, row_group, static_cast<int>(j)});
+                }
+            }
+        }
+    }
+    
+    // Create the parquet writer restoring an archive's selected columns; they keep their archive order
+    FrameworkError createRestoreWriter(const std::string& output_path, const DecompressionOptions& options,
+                                       const DecompressionPlan& plan, ChunkPipelineData* data,
+                                       ParquetWriterContext** writer) {
+        ParquetWriterOptions writer_options;
+        parquet_writer_get_default_options(&writer_options);
+        if (!parseOutputCodec(options.output_codec, &writer_options.compression)) {
+            setError("Unsupported output codec: " + options.output_codec);
+            return FrameworkError::INVALID_PARAMETER;
+        }
+        writer_options.compression_level = options.output_codec_level;
+        writer_options.data_page_size = options.page_size;
         
-        if (progress_callback) {
-            progress_callback("Compression process completed", -1, file->row_group_count, 100);
+        *writer = parquet_writer_create_with_options(output_path.c_str(), &writer_options);
+        if (!*writer) {
+            setError("Failed to create parquet writer for " + output_path);
+            return FrameworkError::WRITER_ERROR;
         }
         
+        data->output_columns.assign(plan.schema.size(), -1);
+        for (size_t j = 0; j < plan.schema.size(); j++) {
+            const ArchiveColumn& column = plan.schema[j];
+            if (!plan.keep_column[j]) {
+                continue;
+            }
+            if (parquet_writer_add_column_with_length(*writer, column.name.c_str(), column.type,
+                                                      column.type_length, &data->output_columns[j]) != PARQUET_WRITER_OK) {
+                parquet_writer_close(*writer);
+                *writer = nullptr;
+                setError("Failed to define output column " + column.name);
+                return FrameworkError::WRITER_ERROR;
+            }
+        }
         return FrameworkError::OK;
     }
     
+    // Set up a batch stream over an archive's selected columns, in archive order
+    static void initBatchStream(BatchStream* stream, const DecompressionPlan& plan, ChunkPipelineData* data) {
+        std::vector<const char*> names;
+        data->output_columns.assign(plan.schema.size(), -1);
+        for (size_t j = 0; j < plan.schema.size(); j++) {
+            if (!plan.keep_column[j]) {
+                continue;
+            }
+            data->output_columns[j] = static_cast<int>(names.size());
+            names.push_back(plan.schema[j].name.c_str());
+            stream->types.push_back(plan.schema[j].type);
+            stream->fixed_lens.push_back(plan.schema[j].type_length);
+        }
+        stream->schema = arrow_make_schema(names.data(), stream->types.data(), stream->fixed_lens.data(),
+                                           static_cast<int>(names.size()));
+        stream->column_data.assign(names.size(), nullptr);
+        stream->column_sizes.assign(names.size(), 0);
+    }
+    
+    // Run the selected chunks of an archive through the read -> analyze -> decode -> write pipeline
+    static PipelineError runDecompressionPipeline(ChunkPipelineData* data, const DecompressionOptions& options,
+                                                  PipelineReadFunction read, PipelineWriteFunction write) {
+        // The writer stage converts each row group's columns on threads of its own
+        // (parallel_process_items, which only takes tokens that are free), so leave
+        // it a share of the pool: up to a quarter, no more than it has columns
+        uint32_t output_columns = static_cast<uint32_t>(
+            std::count_if(data->output_columns.begin(), data->output_columns.end(),
+                          [](int column) { return column >= 0; }));
+        uint32_t pool_tokens = cpu_budget_get_tokens();
+        uint32_t writer_share = output_columns > 1 ? std::min(output_columns, pool_tokens / 4) : 0;
+        uint32_t max_codec_workers = std::max(pool_tokens - writer_share, 1u);
+        if (options.parallel_tasks > 0) {
+            max_codec_workers = std::min(max_codec_workers, static_cast<uint32_t>(options.parallel_tasks));
+        }
+        
+        // LZMA decoding is single-threaded, so every other token becomes a codec worker.
+        // The tokens are taken without waiting, like parallel_process_items does: the
+        // pipeline may block on its consumer, and with no token free it decodes on one
+        // worker rather than wait for tokens a blocked job holds
+        max_codec_workers = static_cast<uint32_t>(std::min<uint64_t>(max_codec_workers, data->chunks.size()));
+        data->cpu_tokens = cpu_budget_try_acquire_threads(max_codec_workers);
+        uint32_t codec_workers = std::max(data->cpu_tokens, 1u);
+        
+        PipelineConfig pipeline_config = makePipelineConfig(
+            static_cast<int>(codec_workers), options.reader_threads,
+            options.analyzer_threads, options.queue_depth);
+        
+        // Chunks are committed row group by row group, so cap the row groups in flight:
+        // enough to keep every codec worker busy while the writer finishes the oldest one
+        size_t chunks_per_row_group = 0;
+        for (size_t i = 0, run = 0; i < data->chunks.size(); i++) {
+            bool same = i > 0 && data->chunks[i].file_index == data->chunks[i - 1].file_index &&
+                        data->chunks[i].row_group_id == data->chunks[i - 1].row_group_id;
+            run = same ? run + 1 : 1;
+            chunks_per_row_group = std::max(chunks_per_row_group, run);
+        }
+        if (chunks_per_row_group > 0) {
+            size_t row_groups_in_flight = codec_workers / chunks_per_row_group + 2;
+            size_t window = std::min<size_t>(row_groups_in_flight * chunks_per_row_group, UINT32_MAX);
+            pipeline_config.reorder_window = static_cast<uint32_t>(window);
+        }
+        
+        PipelineStages stages;
+        stages.read = read;
+        stages.analyze = analyzeChunkForDecompression;
+        stages.encode = decodeChunk;
+        stages.write = write;
+        stages.cleanup = releaseChunk;
+        stages.cancelled = isChunkPipelineCancelled;
+        stages.user_data = data;
+        
+        PipelineError pipeline_error = pipeline_run(&pipeline_config, &stages, data->chunks.size());
+        cpu_budget_release_threads(data->cpu_tokens);
+        data->cpu_tokens = 0;
+        return pipeline_error;
+    }
+    
     // Decompress a previously compressed parquet file
     FrameworkError decompressParquetFile(
         const std::string& metadata_path,
         const std::string& output_directory,
         const DecompressionOptions& options,
-        ProgressCallback progress_callback
+        ProgressCallback progress_callback,
+        const CancellationToken* cancel_token = nullptr
     ) {
         // Make sure the output directory exists
         if (!fs::exists(output_directory)) {
@@ -678,191 +2188,838 @@ public:
             }
         }
         
-        // Load the metadata file
-        Metadata* file_metadata = nullptr;
-        MetadataGeneratorError metadata_error = metadata_generator_load_metadata(
-            metadata_path.c_str(), &file_metadata);
+        DecompressionPlan plan;
+        FrameworkError open_error = openArchive(metadata_path, options.columns, options.row_groups,
+                                                progress_callback, plan);
+        if (open_error != FrameworkError::OK) {
+            return open_error;
+        }
+        int childCount = plan.parquet_file.row_group_count;
         
-        if (metadata_error != METADATA_GEN_OK) {
-            setError("Failed to load metadata: " + 
-                     std::string(metadata_generator_get_error()));
-            return FrameworkError::METADATA_ERROR;
+        // Reconstruct the parquet file from metadata and row group data
+        std::string output_path = output_directory + "/" + plan.output_name;
+        
+        // The writer is fed by the pipeline's ordered write stage, so every chunk is
+        // decoded once, in memory, and each row group is encoded as soon as it is complete
+        ChunkPipelineData pipeline_data;
+        ParquetWriterContext* writer = nullptr;
+        FrameworkError writer_setup = createRestoreWriter(output_path, options, plan, &pipeline_data, &writer);
+        if (writer_setup != FrameworkError::OK) {
+            return writer_setup;
+        }
+        
+        // Every selected column chunk becomes one item of the read -> analyze -> decode -> write pipeline
+        initDecompressionPipeline(&pipeline_data, plan, codec_settings, progress_callback, cancel_token);
+        pipeline_data.writer = writer;
+        
+        PipelineError pipeline_error = runDecompressionPipeline(&pipeline_data, options,
+                                                                readChunkForDecompression, writeDecodedChunk);
+        
+        ParquetWriterError writer_error = parquet_writer_close(writer);
+        
+        if (pipeline_error != PIPELINE_OK) {
+            // Do not leave a truncated parquet file behind
+            std::error_code ec;
+            fs::remove(output_path, ec);
+            if (pipeline_error == PIPELINE_CANCELLED) {
+                setError("Decompression cancelled");
+                return FrameworkError::CANCELLED;
+            }
+            setError("Failed to process row groups: " + 
+                     std::string(pipeline_get_error()));
+            return FrameworkError::PARALLEL_PROCESSING_ERROR;
+        }
+        
+        if (writer_error != PARQUET_WRITER_OK) {
+            std::error_code ec;
+            fs::remove(output_path, ec);
+            setError("Failed to reconstruct parquet file");
+            return FrameworkError::WRITER_ERROR;
         }
         
         if (progress_callback) {
-            progress_callback("Metadata loaded", -1, getMetadataChildCount(file_metadata), 10);
+            progress_callback("Decompression process completed", -1, childCount, 100);
         }
         
-        // Make sure it's a file-level metadata
-        if (getMetadataType(file_metadata) != METADATA_TYPE_FILE) {
-            metadata_generator_free_metadata(file_metadata);
-            setError("Invalid metadata type: expected file-level metadata");
-            return FrameworkError::METADATA_ERROR;
+        return FrameworkError::OK;
+    }
+    
+    // Record batch reader over an archive: a producer thread runs the decompression
+    // pipeline and queues one batch per row group, at most prefetch_depth ahead of the reader
+    class DecompressedBatchReader : public arrow::RecordBatchReader {
+    public:
+        DecompressedBatchReader(std::unique_ptr<DecompressionPlan> plan, const DecompressionOptions& options,
+                                const LzmaCodecSettings& codec_settings,
+                                ProgressCallback progress_callback, int prefetch_depth)
+            : plan_(std::move(plan)) {
+            stream_.prefetch_depth = static_cast<size_t>(std::max(prefetch_depth, 1));
+            initBatchStream(&stream_, *plan_, &pipeline_data_);
+            initDecompressionPipeline(&pipeline_data_, *plan_, codec_settings, progress_callback, &stream_.cancel);
+            pipeline_data_.stream = &stream_;
+            
+            producer_ = std::thread(&DecompressedBatchReader::produce, this, options);
         }
         
-        // Get the input directory (where the compressed files are)
-        std::string input_directory = fs::path(metadata_path).parent_path().string();
+        ~DecompressedBatchReader() override {
+            stop();
+        }
         
-        // Set the maximum number of parallel tasks
-        if (options.parallel_tasks > 0) {
-            parallel_processor_set_max_tasks(options.parallel_tasks);
+        std::shared_ptr<arrow::Schema> schema() const override {
+            return stream_.schema;
         }
         
-        // Set up task data for parallel processing
-        int childCount = getMetadataChildCount(file_metadata);
-        std::vector<DecompressionTaskData> task_data(childCount);
-        std::vector<void*> task_data_ptrs(childCount);
-        std::vector<std::vector<std::string>> column_files(childCount);
+        arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+            std::unique_lock<std::mutex> lock(stream_.mutex);
+            stream_.changed.wait(lock, [this] { return !stream_.batches.empty() || stream_.finished; });
+            if (!stream_.batches.empty()) {
+                *batch = std::move(stream_.batches.front());
+                stream_.batches.pop_front();
+                stream_.changed.notify_all();
+                return arrow::Status::OK();
+            }
+            
+            // The end of the stream; a failed run ends with its error
+            batch->reset();
+            if (!stream_.error.empty()) {
+                return arrow::Status::IOError(stream_.error);
+            }
+            return arrow::Status::OK();
+        }
         
-        for (int i = 0; i < childCount; i++) {
-            task_data[i].file_metadata = file_metadata;
-            task_data[i].row_group_id = i;
-            task_data[i].output_directory = &output_directory;
-            task_data[i].column_files = &column_files[i];
-            task_data_ptrs[i] = &task_data[i];
+        arrow::Status Close() override {
+            stop();
+            return arrow::Status::OK();
         }
         
-        // Process the row groups in parallel
-        void** task_results = nullptr;
+    private:
+        // Cancel the pipeline and wait for the producer thread to finish
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(stream_.mutex);
+                stream_.cancel.cancel();
+            }
+            stream_.changed.notify_all();
+            if (producer_.joinable()) {
+                producer_.join();
+            }
+        }
         
-        // Create a proper ParquetFile structure from the metadata
-        ParquetFile parquet_file;
-        memset(&parquet_file, 0, sizeof(ParquetFile));
+        void produce(DecompressionOptions options) {
+            PipelineError pipeline_error = runDecompressionPipeline(&pipeline_data_, options,
+                                                                    readChunkForDecompression, streamDecodedChunk);
+            
+            std::lock_guard<std::mutex> lock(stream_.mutex);
+            if (pipeline_error != PIPELINE_OK && pipeline_error != PIPELINE_CANCELLED) {
+                const char* message = pipeline_get_error();
+                stream_.error = "Failed to process row groups: " + std::string(message ? message : "");
+            }
+            stream_.finished = true;
+            stream_.changed.notify_all();
+        }
         
-        // Set file path - use the original file path from metadata
-        parquet_file.file_path = file_metadata->file_path ? strdup(file_metadata->file_path) : strdup("unknown.parquet");
+        std::unique_ptr<DecompressionPlan> plan_;
+        ChunkPipelineData pipeline_data_;
+        BatchStream stream_;
+        std::thread producer_;
+    };
+    
+    // Open an archive as a stream of record batches, one per selected row group
+    FrameworkError openDecompressedStream(
+        const std::string& metadata_path,
+        const DecompressionOptions& options,
+        int prefetch_depth,
+        std::shared_ptr<arrow::RecordBatchReader>* reader
+    ) {
+        std::unique_ptr<DecompressionPlan> plan(new DecompressionPlan());
+        FrameworkError open_error = openArchive(metadata_path, options.columns, options.row_groups,
+                                                progress_callback, *plan);
+        if (open_error != FrameworkError::OK) {
+            return open_error;
+        }
         
-        // Set row group count
-        parquet_file.row_group_count = childCount;
+        *reader = std::make_shared<DecompressedBatchReader>(std::move(plan), options, codec_settings,
+                                                            progress_callback, prefetch_depth);
+        return FrameworkError::OK;
+    }
+    
+    // Decode the frames of a chunk file that cover a row range
+    FrameworkError decodeCoveringFrames(const std::string& chunk_path, uint64_t first_row, uint64_t row_count,
+                                        std::vector<uint8_t>& raw, uint64_t& start_row) {
+        std::ifstream in(chunk_path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            setError("Failed to open chunk file " + chunk_path);
+            return FrameworkError::FILE_NOT_FOUND;
+        }
+        uint64_t file_size = static_cast<uint64_t>(in.tellg());
+        std::vector<uint8_t> index(LZMA_SEEKABLE_HEADER_SIZE);
+        in.seekg(0);
+        if (file_size < index.size() || !in.read(reinterpret_cast<char*>(index.data()), index.size())) {
+            setError("Truncated chunk file " + chunk_path);
+            return FrameworkError::DECOMPRESSION_ERROR;
+        }
+        
+        // Frames covering the rows; a plain chunk is one frame holding every row
+        start_row = 0;
+        uint64_t encoded_begin = 0;
+        uint64_t encoded_end = file_size;
+        uint64_t raw_size = lzma_get_decompressed_size(index.data(), index.size());
+        std::vector<LzmaSeekFrame> frames;
+        uint32_t frame_count = lzma_seekable_frame_count(index.data(), index.size());
+        if (frame_count > 0) {
+            index.resize(lzma_seekable_index_size(frame_count));
+            frames.resize(frame_count);
+            if (!in.read(reinterpret_cast<char*>(index.data()) + LZMA_SEEKABLE_HEADER_SIZE,
+                         index.size() - LZMA_SEEKABLE_HEADER_SIZE) ||
+                lzma_seekable_read_index(index.data(), index.size(), frames.data(), frame_count) != 0) {
+                setError("Invalid frame table in " + chunk_path);
+                return FrameworkError::DECOMPRESSION_ERROR;
+            }
+            
+            auto first = std::upper_bound(frames.begin(), frames.end(), first_row,
+                [](uint64_t row, const LzmaSeekFrame& frame) { return row < frame.first_row + frame.row_count; });
+            auto last = std::upper_bound(frames.begin(), frames.end(), first_row + row_count - 1,
+                [](uint64_t row, const LzmaSeekFrame& frame) { return row < frame.first_row + frame.row_count; });
+            if (last == frames.end()) {
+                setError("Rows " + std::to_string(first_row) + "+" + std::to_string(row_count) +
+                         " are outside chunk " + chunk_path);
+                return FrameworkError::INVALID_PARAMETER;
+            }
+            frames = std::vector<LzmaSeekFrame>(first, last + 1);
+            start_row = frames.front().first_row;
+            encoded_begin = frames.front().encoded_offset;
+            encoded_end = frames.back().encoded_offset + frames.back().encoded_size;
+            raw_size = frames.back().raw_offset + frames.back().raw_size - frames.front().raw_offset;
+        }
+        
+        // The covering frames are contiguous, so one read fetches them all
+        std::vector<uint8_t> encoded(encoded_end - encoded_begin);
+        in.seekg(static_cast<std::streamoff>(encoded_begin));
+        if (!in.read(reinterpret_cast<char*>(encoded.data()), encoded.size())) {
+            setError("Failed to read chunk file " + chunk_path);
+            return FrameworkError::DECOMPRESSION_ERROR;
+        }
+        
+        raw.resize(raw_size > 0 ? raw_size : 1);
+        int decode_error = 0;
+        if (frames.empty()) {
+            decode_error = lzma_decompress_buffer(encoded.data(), encoded.size(), raw.data(), &raw_size);
+        }
+        for (const LzmaSeekFrame& frame : frames) {
+            uint64_t frame_size = frame.raw_size;
+            decode_error = lzma_decompress_buffer(encoded.data() + (frame.encoded_offset - encoded_begin),
+                                                  frame.encoded_size,
+                                                  raw.data() + (frame.raw_offset - frames.front().raw_offset),
+                                                  &frame_size);
+            if (decode_error != 0) {
+                break;
+            }
+        }
+        if (decode_error != 0) {
+            setError("Failed to decode " + chunk_path);
+            return FrameworkError::DECOMPRESSION_ERROR;
+        }
+        raw.resize(raw_size);
+        return FrameworkError::OK;
+    }
+    
+    // Read rows of one column, decoding only the frames of its chunk that cover them
+    FrameworkError readRange(
+        const std::string& metadata_path,
+        int row_group,
+        const std::string& column,
+        uint64_t first_row,
+        uint64_t row_count,
+        std::shared_ptr<arrow::RecordBatch>* batch
+    ) {
+        DecompressionPlan plan;
+        FrameworkError open_error = openArchive(metadata_path, {column}, {row_group}, nullptr, plan);
+        if (open_error != FrameworkError::OK) {
+            return open_error;
+        }
+        int column_id = static_cast<int>(std::find(plan.keep_column.begin(), plan.keep_column.end(), true) -
+                                         plan.keep_column.begin());
+        const ArchiveColumn& archive_column = plan.schema[column_id];
+        
+        // Row counts come from the metadata; when it has none the frame table is the only check
+        uint64_t group_rows = plan.parquet_file.row_groups[row_group].num_rows;
+        if (row_count == 0 || (group_rows > 0 && (first_row >= group_rows || row_count > group_rows - first_row))) {
+            setError("Rows " + std::to_string(first_row) + "+" + std::to_string(row_count) +
+                     " are outside row group " + std::to_string(row_group) +
+                     " (" + std::to_string(group_rows) + " rows)");
+            return FrameworkError::INVALID_PARAMETER;
+        }
         
-        // Allocate memory for row groups
-        parquet_file.row_groups = (ParquetRowGroup*)malloc(childCount * sizeof(ParquetRowGroup));
-        if (!parquet_file.row_groups) {
-            metadata_generator_free_metadata(file_metadata);
-            setError("Failed to allocate memory for row groups");
+        // A cached chunk is already decoded whole; otherwise only the covering frames are decoded
+        std::string chunk_path = chunkFilePath(plan.chunk_prefix, row_group, column_id);
+        std::vector<uint8_t> decoded;
+        uint64_t start_row = 0;
+        ChunkCacheEntry* cached = chunk_cache_acquire(plan.chunk_prefix.c_str(), row_group, column_id,
+                                                     chunk_path.c_str());
+        const uint8_t* raw = static_cast<const uint8_t*>(chunk_cache_entry_data(cached));
+        uint64_t raw_size = chunk_cache_entry_size(cached);
+        if (!cached) {
+            FrameworkError decode_error = decodeCoveringFrames(chunk_path, first_row, row_count, decoded, start_row);
+            if (decode_error != FrameworkError::OK) {
+                return decode_error;
+            }
+            raw = decoded.data();
+            raw_size = decoded.size();
+        }
+        
+        // Locate the requested values within the decoded frames
+        uint64_t skip = first_row - start_row;
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        size_t value_size = arrow_column_value_size(archive_column.type, archive_column.type_length);
+        if (value_size > 0) {
+            begin = skip * value_size;
+            end = begin + row_count * value_size;
+        } else {
+            for (uint64_t value = 0; value < skip + row_count && end <= raw_size; value++) {
+                if (value == skip) {
+                    begin = end;
+                }
+                uint32_t length = 0;
+                if (raw_size - end < sizeof(uint32_t)) {
+                    end = raw_size + 1;
+                    break;
+                }
+                memcpy(&length, raw + end, sizeof(uint32_t));
+                end += sizeof(uint32_t) + length;
+            }
+        }
+        if (end > raw_size) {
+            chunk_cache_release(cached);
+            setError("Rows " + std::to_string(first_row) + "+" + std::to_string(row_count) +
+                     " are outside chunk " + chunk_path);
+            return FrameworkError::INVALID_PARAMETER;
+        }
+        
+        void* values = malloc(end > begin ? end - begin : 1);
+        if (!values) {
+            chunk_cache_release(cached);
+            setError("Failed to allocate memory for the requested rows");
             return FrameworkError::MEMORY_ERROR;
         }
+        memcpy(values, raw + begin, end - begin);
+        chunk_cache_release(cached);
+        size_t values_size = end - begin;
         
-        // Initialize row groups with data from metadata
-        memset(parquet_file.row_groups, 0, childCount * sizeof(ParquetRowGroup));
-        uint64_t total_rows = 0;
+        const char* name = archive_column.name.c_str();
+        ParquetValueType type = archive_column.type;
+        int fixed_len = archive_column.type_length;
+        std::shared_ptr<arrow::Schema> schema = arrow_make_schema(&name, &type, &fixed_len, 1);
+        if (arrow_make_record_batch(schema, &type, &fixed_len, &values, &values_size,
+                                    static_cast<int64_t>(row_count), 1, batch) != 0) {
+            setError("Failed to build record batch: " + std::string(arrow_get_last_error()));
+            return FrameworkError::DECOMPRESSION_ERROR;
+        }
+        return FrameworkError::OK;
+    }
+    
+    // Read the header of a single-stream archive into a decompression plan
+    FrameworkError readStreamHeader(std::istream& in, DecompressionPlan& plan) {
+        char magic[8];
+        if (!in.read(magic, 8) || memcmp(magic, STREAM_ARCHIVE_MAGIC, 8) != 0) {
+            setError("Input is not an InfParquet stream archive");
+            return FrameworkError::METADATA_ERROR;
+        }
         
-        for (int i = 0; i < childCount; i++) {
+        uint64_t column_count = 0;
+        if (!getStreamInt(in, 4, &column_count)) {
+            setError("Truncated stream archive header");
+            return FrameworkError::METADATA_ERROR;
+        }
+        for (uint64_t j = 0; j < column_count; j++) {
+            uint64_t type = 0, type_length = 0, name_length = 0;
+            if (!getStreamInt(in, 4, &type) || !getStreamInt(in, 4, &type_length) ||
+                !getStreamInt(in, 4, &name_length) || name_length > 4096) {
+                setError("Truncated stream archive header");
+                return FrameworkError::METADATA_ERROR;
+            }
+            ArchiveColumn column;
+            column.type = static_cast<ParquetValueType>(type);
+            column.type_length = static_cast<int>(type_length);
+            column.name.resize(name_length);
+            if (name_length > 0 && !in.read(&column.name[0], name_length)) {
+                setError("Truncated stream archive header");
+                return FrameworkError::METADATA_ERROR;
+            }
+            plan.schema.push_back(std::move(column));
+        }
+        
+        uint64_t row_group_count = 0;
+        if (!getStreamInt(in, 4, &row_group_count) || row_group_count > INT32_MAX) {
+            setError("Truncated stream archive header");
+            return FrameworkError::METADATA_ERROR;
+        }
+        ParquetFile& parquet_file = plan.parquet_file;
+        parquet_file.row_groups = static_cast<ParquetRowGroup*>(
+            calloc(row_group_count > 0 ? row_group_count : 1, sizeof(ParquetRowGroup)));
+        if (!parquet_file.row_groups) {
+            setError("Failed to allocate memory for row groups");
+            return FrameworkError::MEMORY_ERROR;
+        }
+        parquet_file.row_group_count = static_cast<uint32_t>(row_group_count);
+        for (uint64_t i = 0; i < row_group_count; i++) {
             ParquetRowGroup* row_group = &parquet_file.row_groups[i];
-            row_group->row_group_index = i;
-            
-            // Get row group metadata
-            Metadata* row_group_metadata = getChildMetadata(file_metadata, i);
-            if (row_group_metadata) {
-                // Get number of columns
-                int column_count = getMetadataChildCount(row_group_metadata);
-                row_group->column_count = column_count;
-                
-                // Get row count if available in metadata
-                const MetadataItem* rowCountItem = nullptr;
-                for (uint32_t j = 0; j < row_group_metadata->file_metadata.basic_metadata_count; j++) {
-                    if (strcmp(row_group_metadata->file_metadata.basic_metadata[j].name, "row_count") == 0) {
-                        rowCountItem = &row_group_metadata->file_metadata.basic_metadata[j];
-                        break;
-                    }
+            uint64_t num_rows = 0, columns = 0;
+            if (!getStreamInt(in, 8, &num_rows) || !getStreamInt(in, 4, &columns)) {
+                setError("Truncated stream archive header");
+                return FrameworkError::METADATA_ERROR;
+            }
+            row_group->row_group_index = static_cast<int>(i);
+            row_group->num_rows = num_rows;
+            row_group->column_count = static_cast<uint32_t>(columns);
+            parquet_file.total_rows += num_rows;
+        }
+        return FrameworkError::OK;
+    }
+    
+    // Decompress a single-stream archive into a parquet file or an Arrow IPC stream
+    // ("-" for standard input or output)
+    FrameworkError decompressFromStream(
+        const std::string& input_path,
+        const std::string& output_path,
+        const DecompressionOptions& options,
+        ProgressCallback progress_callback,
+        const CancellationToken* cancel_token = nullptr
+    ) {
+        bool arrow_output = options.output_format == "arrow";
+        if (!arrow_output && options.output_format != "parquet") {
+            setError("Unsupported output format: " + options.output_format);
+            return FrameworkError::INVALID_PARAMETER;
+        }
+        
+        std::ifstream file_in;
+        StreamArchive archive;
+        archive.in = &std::cin;
+        if (input_path != "-") {
+            file_in.open(input_path, std::ios::binary);
+            if (!file_in) {
+                setError("Failed to open archive: " + input_path);
+                return FrameworkError::FILE_NOT_FOUND;
+            }
+            archive.in = &file_in;
+        }
+        
+        DecompressionPlan plan;
+        FrameworkError open_error = readStreamHeader(*archive.in, plan);
+        if (open_error == FrameworkError::OK) {
+            open_error = selectArchiveData(options.columns, options.row_groups, plan);
+        }
+        if (open_error != FrameworkError::OK) {
+            return open_error;
+        }
+        
+        ChunkPipelineData pipeline_data;
+        ParquetWriterContext* writer = nullptr;
+        BatchStream stream;
+        std::shared_ptr<arrow::io::OutputStream> sink;
+        if (arrow_output) {
+            initBatchStream(&stream, plan, &pipeline_data);
+            arrow::Status status;
+            if (output_path == "-") {
+                sink = std::make_shared<arrow::io::StdoutStream>();
+            } else {
+                auto file_sink = arrow::io::FileOutputStream::Open(output_path);
+                status = file_sink.status();
+                if (status.ok()) {
+                    sink = *file_sink;
                 }
-                
-                if (rowCountItem && rowCountItem->type == METADATA_TYPE_NUMERIC) {
-                    row_group->num_rows = static_cast<uint64_t>(rowCountItem->value.numeric.mode_value);
-                    total_rows += row_group->num_rows;
+            }
+            if (status.ok()) {
+                auto batch_writer = arrow::ipc::MakeStreamWriter(sink, stream.schema);
+                status = batch_writer.status();
+                if (status.ok()) {
+                    stream.sink = *batch_writer;
                 }
             }
+            if (!status.ok()) {
+                setError("Failed to create Arrow stream " + output_path + ": " + status.ToString());
+                return FrameworkError::WRITER_ERROR;
+            }
+        } else {
+            FrameworkError writer_setup = createRestoreWriter(output_path, options, plan, &pipeline_data, &writer);
+            if (writer_setup != FrameworkError::OK) {
+                return writer_setup;
+            }
         }
         
-        // Set total rows for the file
-        parquet_file.total_rows = total_rows;
-        
-        ParallelProcessorError parallel_error = parallel_processor_process_row_groups(
-            &parquet_file,
-            decompressRowGroup,
-            task_data_ptrs.data(),
-            nullptr,
-            &task_results
-        );
-        
-        if (parallel_error != PARALLEL_PROCESSOR_OK) {
-            // Clean up allocated resources
-            parquet_file_free(&parquet_file);
-            metadata_generator_free_metadata(file_metadata);
-            setError("Failed to process row groups: " + 
-                     std::string(parallel_processor_get_error()));
-            return FrameworkError::PARALLEL_PROCESSING_ERROR;
+        initDecompressionPipeline(&pipeline_data, plan, codec_settings, progress_callback, cancel_token);
+        pipeline_data.writer = writer;
+        pipeline_data.stream = arrow_output ? &stream : nullptr;
+        pipeline_data.archive = &archive;
+        
+        // Frames arrive in archive order, so there is exactly one reader
+        DecompressionOptions stream_options = options;
+        stream_options.reader_threads = 1;
+        PipelineError pipeline_error = runDecompressionPipeline(
+            &pipeline_data, stream_options, readStreamFrame,
+            arrow_output ? streamDecodedChunk : writeDecodedChunk);
+        
+        bool closed = arrow_output ? stream.sink->Close().ok() && sink->Close().ok()
+                                   : parquet_writer_close(writer) == PARQUET_WRITER_OK;
+        
+        FrameworkError result = FrameworkError::OK;
+        if (pipeline_error == PIPELINE_CANCELLED) {
+            setError("Decompression cancelled");
+            result = FrameworkError::CANCELLED;
+        } else if (pipeline_error != PIPELINE_OK) {
+            const char* message = pipeline_get_error();
+            setError("Failed to process row groups: " + std::string(message ? message : ""));
+            result = FrameworkError::PARALLEL_PROCESSING_ERROR;
+        } else if (!closed) {
+            setError("Failed to finish the output stream");
+            result = FrameworkError::WRITER_ERROR;
+        }
+        
+        if (result != FrameworkError::OK) {
+            if (output_path != "-") {
+                std::error_code ec;
+                fs::remove(output_path, ec);
+            }
+            return result;
         }
         
         if (progress_callback) {
-            progress_callback("Column files decompressed", -1, childCount, 50);
+            progress_callback("Decompression process completed", -1, plan.parquet_file.row_group_count, 100);
         }
+        return FrameworkError::OK;
+    }
+
+    // Shared state of a verification run
+    struct VerifyState {
+        std::string chunk_prefix;
+        std::vector<ChunkChecksum> checksums;
+        bool full_decode;
+        std::vector<std::string> faults;        // Failure reason per checksum entry (empty = intact)
+        std::atomic<uint64_t> bytes_checked{0};
+        std::atomic<uint64_t> bytes_decoded{0};
+    };
+    
+    // Check one chunk file against its recorded checksums
+    static int verifyChunk(uint32_t item_index, uint32_t total_items, void* user_data) {
+        (void)total_items;
+        VerifyState* state = static_cast<VerifyState*>(user_data);
+        const ChunkChecksum& expected = state->checksums[item_index];
+        std::string& fault = state->faults[item_index];
+        
+        // A damaged chunk is a finding, not an error; returning non-zero would stop the other chunks
+        std::ifstream in(chunkFilePath(state->chunk_prefix, expected.row_group_id, expected.column_id),
+                         std::ios::binary | std::ios::ate);
+        if (!in) {
+            fault = "chunk file missing";
+            return 0;
+        }
+        uint64_t file_size = static_cast<uint64_t>(in.tellg());
+        if (file_size != expected.encoded_size) {
+            fault = "size " + std::to_string(file_size) + ", expected " + std::to_string(expected.encoded_size);
+            return 0;
+        }
+        
+        std::vector<char> encoded(file_size);
+        in.seekg(0);
+        if (file_size > 0 && !in.read(encoded.data(), static_cast<std::streamsize>(file_size))) {
+            fault = "read error";
+            return 0;
+        }
+        state->bytes_checked.fetch_add(file_size, std::memory_order_relaxed);
+        if (XXH3_64bits(encoded.data(), encoded.size()) != expected.encoded_checksum) {
+            fault = "compressed checksum mismatch";
+            return 0;
+        }
+        
+        if (!state->full_decode) {
+            return 0;
+        }
+        
+        // The full check also proves the stream decodes back to the original column data
+        std::vector<char> raw(expected.raw_size > 0 ? expected.raw_size : 1);
+        uint64_t raw_size = expected.raw_size;
+        if (lzma_decompress_buffer(encoded.data(), encoded.size(), raw.data(), &raw_size) != 0) {
+            fault = "decode failed";
+            return 0;
+        }
+        state->bytes_decoded.fetch_add(raw_size, std::memory_order_relaxed);
+        if (raw_size != expected.raw_size) {
+            fault = "decoded size " + std::to_string(raw_size) + ", expected " + std::to_string(expected.raw_size);
+        } else if (XXH3_64bits(raw.data(), raw_size) != expected.raw_checksum) {
+            fault = "decoded checksum mismatch";
+        }
+        return 0;
+    }
+    
+    // Check every chunk of an archive against the checksums recorded at compression time
+    FrameworkError verifyArchive(
+        const std::string& metadata_path,
+        const VerifyOptions& options,
+        VerificationReport* report,
+        ProgressCallback progress_callback
+    ) {
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
         
-        // Free the task results
-        parallel_processor_free_results(task_results, childCount);
-        
-        // Reconstruct the parquet file from metadata and row group data
-        std::string output_path = output_directory + "/" + 
-                               fs::path(getMetadataName(file_metadata)).filename().string();
-        
-        // Replace .meta extension with .parquet
-        output_path = output_path.substr(0, output_path.length() - 5) + ".parquet";
+        DecompressionPlan plan;
+        FrameworkError open_error = openArchive(metadata_path, {}, {}, progress_callback, plan);
+        if (open_error != FrameworkError::OK) {
+            return open_error;
+        }
         
-        // Collect all column file paths for reconstruction
-        std::vector<char*> file_paths;
-        for (const auto& group_files : column_files) {
-            for (const auto& file : group_files) {
-                file_paths.push_back(strdup(file.c_str()));
-            }
+        VerifyState state;
+        state.chunk_prefix = plan.chunk_prefix;
+        state.full_decode = options.full_decode;
+        std::string checksum_path = checksumFilePath(plan.chunk_prefix);
+        if (!readChunkChecksums(checksum_path, state.checksums)) {
+            setError("Failed to read chunk checksums " + checksum_path);
+            return FrameworkError::METADATA_ERROR;
         }
+        state.faults.resize(state.checksums.size());
         
-        // Convert vector to array for C API
-        char** column_files_array = nullptr;
-        if (!file_paths.empty()) {
-            column_files_array = file_paths.data();
+        if (progress_callback) {
+            progress_callback("Verifying chunks", -1, static_cast<int>(state.checksums.size()), 20);
         }
         
-        // Use the parquet writer to reconstruct the file
-        ParquetWriterError writer_error = parquet_writer_reconstruct_file(
-            &parquet_file,         // File structure matches the signature
-            output_path.c_str(),   // Output path is correct
-            column_files_array     // Array of column file paths
-        );
+        int verify_error = parallel_process_items(verifyChunk, static_cast<uint32_t>(state.checksums.size()),
+                                                  static_cast<uint32_t>(std::max(options.parallel_tasks, 0)),
+                                                  nullptr, &state);
+        if (verify_error != PARALLEL_PROCESSOR_OK) {
+            const char* message = parallel_processor_get_error();
+            setError("Failed to verify chunks: " + std::string(message ? message : ""));
+            return FrameworkError::PARALLEL_PROCESSING_ERROR;
+        }
         
-        // Free the column file path strings
-        for (char* path : file_paths) {
-            free(path);
+        std::vector<ChunkFault> faults;
+        for (size_t i = 0; i < state.checksums.size(); i++) {
+            if (!state.faults[i].empty()) {
+                faults.push_back({state.checksums[i].row_group_id, state.checksums[i].column_id, state.faults[i]});
+            }
         }
+        std::sort(faults.begin(), faults.end(), [](const ChunkFault& a, const ChunkFault& b) {
+            return a.row_group != b.row_group ? a.row_group < b.row_group : a.column < b.column;
+        });
         
-        // Clean up
-        parquet_file_free(&parquet_file);
+        if (report) {
+            report->chunks_checked = state.checksums.size();
+            report->bytes_checked = state.bytes_checked.load();
+            report->bytes_decoded = state.bytes_decoded.load();
+            report->elapsed_seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start_time).count();
+            report->corrupt_chunks = faults;
+        }
         
-        if (writer_error != PARQUET_WRITER_OK) {
-            metadata_generator_free_metadata(file_metadata);
-            setError("Failed to reconstruct parquet file");
-            return FrameworkError::WRITER_ERROR;
+        if (!faults.empty()) {
+            setError(std::to_string(faults.size()) + " corrupt chunk(s), first at row group " +
+                     std::to_string(faults[0].row_group) + " column " + std::to_string(faults[0].column) +
+                     ": " + faults[0].reason);
+            return FrameworkError::DECOMPRESSION_ERROR;
         }
         
         if (progress_callback) {
-            progress_callback("Parquet file reconstructed", -1, childCount, 90);
+            progress_callback("Verification completed", -1, static_cast<int>(state.checksums.size()), 100);
         }
+        return FrameworkError::OK;
+    }
+    
+    // Function performing the work of an asynchronous job on the job's own Impl
+    using AsyncJobBody = std::function<FrameworkError(Impl& job, const CancellationToken* cancel_token,
+                                                      std::string* output)>;
+    
+    // Run a job on the shared executor and deliver its outcome through a future
+    // and an optional completion callback
+    static std::future<JobResult> runAsync(std::shared_ptr<Impl> job,
+                                           CancellationToken token,
+                                           CompletionCallback on_complete,
+                                           AsyncJobBody body) {
+        auto promise = std::make_shared<std::promise<JobResult>>();
+        std::future<JobResult> future = promise->get_future();
+        
+        JobExecutor::shared().submit([job, token, on_complete, body, promise]() {
+            JobResult result;
+            FrameworkError error = FrameworkError::CANCELLED;
+            
+            // A job cancelled while it was queued never starts
+            if (token.isCancelled()) {
+                job->setError("Operation cancelled");
+            } else {
+                try {
+                    error = body(*job, &token, &result.output);
+                } catch (const std::exception& e) {
+                    job->setError("Unexpected error: " + std::string(e.what()));
+                    error = FrameworkError::UNKNOWN_ERROR;
+                }
+            }
+            
+            result.success = error == FrameworkError::OK;
+            result.cancelled = error == FrameworkError::CANCELLED;
+            result.error_code = error;
+            if (!result.success) {
+                result.error = job->last_error;
+            }
+            
+            if (on_complete) {
+                try {
+                    on_complete(result);
+                } catch (...) {
+                    // The callback's failure must not keep the future from completing
+                }
+            }
+            promise->set_value(std::move(result));
+        });
         
-        // Clean up
-        metadata_generator_free_metadata(file_metadata);
+        return future;
+    }
+    
+    // Statistics a metadata query can filter on: file-level values by field name,
+    // column values as <column name>.<field>
+    static void addMetadataQueryFields(const Metadata* metadata,
+                                       std::vector<std::pair<std::string, std::string>>& fields) {
+        auto addItemFields = [&fields](const std::string& prefix, const MetadataItem& item) {
+            switch (item.type) {
+                case METADATA_TYPE_CATEGORICAL:
+                    fields.emplace_back(prefix + "distinct_count",
+                                        std::to_string(item.value.categorical.distinct_count));
+                    break;
+                    
+                // Percentiles of values known only from footer statistics are unavailable,
+                // so conditions on them fail rather than match a zero
+                case METADATA_TYPE_NUMERIC:
+                    if (item.value.numeric.from_footer) {
+                        break;
+                    }
+                    fields.emplace_back(prefix + "p50", std::to_string(item.value.numeric.p50));
+                    fields.emplace_back(prefix + "p95", std::to_string(item.value.numeric.p95));
+                    fields.emplace_back(prefix + "p99", std::to_string(item.value.numeric.p99));
+                    break;
+                    
+                case METADATA_TYPE_TIMESTAMP:
+                    if (item.value.timestamp.from_footer) {
+                        break;
+                    }
+                    fields.emplace_back(prefix + "p50", std::to_string(item.value.timestamp.p50));
+                    fields.emplace_back(prefix + "p95", std::to_string(item.value.timestamp.p95));
+                    fields.emplace_back(prefix + "p99", std::to_string(item.value.timestamp.p99));
+                    break;
+                    
+                default:
+                    break;
+            }
+        };
         
-        // Clean up temporary column files
-        for (uint32_t i = 0; i < childCount; i++) {
-            for (const auto& column_file : column_files[i]) {
-                std::error_code ec;
-                fs::remove(column_file, ec);
+        for (uint32_t i = 0; i < metadata->file_metadata.basic_metadata_count; i++) {
+            addItemFields("", metadata->file_metadata.basic_metadata[i]);
+        }
+        for (uint32_t i = 0; i < metadata->column_metadata_count; i++) {
+            const ColumnMetadata& column = metadata->column_metadata[i];
+            for (uint32_t j = 0; j < column.metadata_count; j++) {
+                addItemFields(std::string(column.column_name) + ".", column.metadata[j]);
+            }
+        }
+    }
+
+    // Equality conditions answered by the Bloom filters of the row groups: a
+    // condition <column> = <value> gets a field holding the value only when some
+    // row group may contain it, so the file is skipped when every filter rules the
+    // value out. Row groups without a filter for the column may contain anything.
+    // The candidate row groups of the conditions are combined left to right the
+    // way the query evaluates them, intersected across AND and united across OR;
+    // a condition no filter answers keeps every row group. Candidates are only
+    // reported when some filter took part.
+    static void addBloomFilterQueryFields(const Metadata* metadata, const SQLQueryInfo* query_info,
+                                          std::vector<std::pair<std::string, std::string>>& fields,
+                                          std::vector<uint32_t>& candidate_row_groups) {
+        uint32_t row_group_count = metadata->row_group_metadata_count;
+        std::vector<bool> candidates(row_group_count, true);
+        bool any_filtered = false;
+        
+        for (size_t c = 0; c < query_info->condition_count; c++) {
+            const SQLCondition& condition = query_info->conditions[c];
+            std::vector<bool> condition_candidates(row_group_count, true);
+            
+            if (condition.comp_op == SQL_COMP_EQUAL && condition.column && condition.value) {
+                bool filtered = false;
+                bool may_contain = false;
+                for (uint32_t i = 0; i < row_group_count; i++) {
+                    const RowGroupMetadata& row_group = metadata->row_group_metadata[i];
+                    const ColumnBloomFilter* bloom = nullptr;
+                    for (uint32_t j = 0; j < row_group.bloom_filter_count; j++) {
+                        if (strcmp(row_group.bloom_filters[j].column_name, condition.column) == 0) {
+                            bloom = &row_group.bloom_filters[j];
+                            break;
+                        }
+                    }
+                    
+                    uint64_t hash;
+                    if (bloom) {
+                        filtered = true;
+                        if (bloom_filter_hash_literal(condition.value, bloom->value_type, &hash) == 0) {
+                            condition_candidates[i] = bloom_filter_check(&bloom->filter, hash);
+                        }
+                    }
+                    may_contain = may_contain || condition_candidates[i];
+                }
+                
+                if (filtered && may_contain) {
+                    fields.emplace_back(condition.column, condition.value);
+                }
+                any_filtered = any_filtered || filtered;
+            }
+            
+            for (uint32_t i = 0; i < row_group_count; i++) {
+                if (c == 0 || condition.logical_op == SQL_LOGICAL_NONE) {
+                    candidates[i] = condition_candidates[i];
+                } else if (condition.logical_op == SQL_LOGICAL_AND) {
+                    candidates[i] = candidates[i] && condition_candidates[i];
+                } else if (condition.logical_op == SQL_LOGICAL_OR) {
+                    candidates[i] = candidates[i] || condition_candidates[i];
+                }
+            }
+        }
+        
+        if (!any_filtered) {
+            return;
+        }
+        for (uint32_t i = 0; i < row_group_count; i++) {
+            uint32_t row_group_index = metadata->row_group_metadata[i].row_group_index;
+            if (candidates[i] && std::find(candidate_row_groups.begin(), candidate_row_groups.end(),
+                                           row_group_index) == candidate_row_groups.end()) {
+                candidate_row_groups.push_back(row_group_index);
+            }
+        }
+    }
+
+    // Format the results of a metadata query as text
+    static std::string formatQueryResults(const std::string& query, const MetadataQueryResult& results) {
+        std::stringstream ss;
+        ss << "Query results for: " << query << "\n";
+        
+        if (results.matching_files.empty() && 
+            results.matching_row_groups.empty() && 
+            results.matching_columns.empty()) {
+            ss << "No matches found.";
+        } else {
+            if (!results.matching_files.empty()) {
+                ss << "Matching files (" << results.matching_files.size() << "):\n";
+                for (const auto& file : results.matching_files) {
+                    ss << "  - " << file << "\n";
+                }
+            }
+            
+            if (!results.matching_row_groups.empty()) {
+                ss << "Matching row groups (" << results.matching_row_groups.size() << "):\n";
+                for (const auto& rg : results.matching_row_groups) {
+                    ss << "  - " << rg << "\n";
+                }
+            }
+            
+            if (!results.matching_columns.empty()) {
+                ss << "Matching columns (" << results.matching_columns.size() << "):\n";
+                for (const auto& col : results.matching_columns) {
+                    ss << "  - " << col << "\n";
+                }
             }
         }
         
-        if (progress_callback) {
-            progress_callback("Decompression process completed", -1, childCount, 100);
-        }
-        
-        return FrameworkError::OK;
+        return ss.str();
     }
     
     // Query metadata for specific patterns or values
@@ -972,7 +3129,7 @@ public:
             collection.count = 1;
             collection.items = (MetadataContainer*)malloc(sizeof(MetadataContainer));
             if (!collection.items) {
-                metadata_generator_free_metadata(metadata);
+                metadata_release(metadata);
                 continue;
             }
             
@@ -980,31 +3137,13 @@ public:
             MetadataContainer* container = &collection.items[0];
             memset(container, 0, sizeof(MetadataContainer));
             
-            // Add file-level metadata to the container
-            // This is a simplified approach - a more complete implementation would
-            // convert all metadata items to key-value pairs
-            int pair_count = 3; // file_path, file_name, file_size
-            
-            container->count = pair_count;
-            container->keys = (char**)malloc(pair_count * sizeof(char*));
-            container->values = (char**)malloc(pair_count * sizeof(char*));
-            
-            if (!container->keys || !container->values) {
-                if (container->keys) free(container->keys);
-                if (container->values) free(container->values);
-                free(collection.items);
-                metadata_generator_free_metadata(metadata);
-                continue;
-            }
-            
-            // Fill in the metadata key-value pairs
-            container->keys[0] = strdup("file_path");
-            container->values[0] = strdup(metadata->file_path ? metadata->file_path : "");
+            // Add file-level metadata to the container as key-value pairs
+            std::vector<std::pair<std::string, std::string>> fields;
+            fields.emplace_back("file_path", metadata->file_path ? metadata->file_path : "");
             
             // Extract file name from path
             std::string file_name = fs::path(meta_file).stem().string();
-            container->keys[1] = strdup("file_name");
-            container->values[1] = strdup(file_name.c_str());
+            fields.emplace_back("file_name", file_name);
             
             // Get actual file size
             std::error_code ec;
@@ -1019,8 +3158,32 @@ public:
                 }
             }
             
-            container->keys[2] = strdup("file_size");
-            container->values[2] = strdup(std::to_string(file_size).c_str());
+            fields.emplace_back("file_size", std::to_string(file_size));
+            
+            // Statistics of the file and its columns
+            addMetadataQueryFields(metadata, fields);
+            
+            // Equality conditions the row group Bloom filters can answer
+            std::vector<uint32_t> candidate_row_groups;
+            addBloomFilterQueryFields(metadata, query_info, fields, candidate_row_groups);
+            
+            container->count = static_cast<int>(fields.size());
+            container->keys = (char**)malloc(fields.size() * sizeof(char*));
+            container->values = (char**)malloc(fields.size() * sizeof(char*));
+            
+            if (!container->keys || !container->values) {
+                if (container->keys) free(container->keys);
+                if (container->values) free(container->values);
+                free(collection.items);
+                metadata_release(metadata);
+                continue;
+            }
+            
+            // Fill in the metadata key-value pairs
+            for (size_t i = 0; i < fields.size(); i++) {
+                container->keys[i] = strdup(fields[i].first.c_str());
+                container->values[i] = strdup(fields[i].second.c_str());
+            }
             
             // Execute the SQL query against this metadata
             SQLResultSet result_set;
@@ -1033,729 +3196,129 @@ public:
                     std::string file_name = fs::path(meta_file).stem().string();
                     
                     // Add file to matching files if it's not already there
-                    if (std::find(results->matching_files.begin(), 
-                                results->matching_files.end(), 
-                                file_name) == results->matching_files.end()) {
-                        results->matching_files.push_back(file_name);
-                    }
-                    
-                    // Process each row in the result set
-                    for (int i = 0; i < result_set.row_count; i++) {
-                        MetadataRow* row = &result_set.rows[i];
-                        
-                        // Check if this row has row group and column information
-                        std::string row_group_name;
-                        std::string column_name;
-                        
-                        for (int j = 0; j < row->count; j++) {
-                            if (row->columns[j] && row->values[j]) {
-                                if (strcmp(row->columns[j], "row_group") == 0) {
-                                    row_group_name = row->values[j];
-                                } else if (strcmp(row->columns[j], "column") == 0) {
-                                    column_name = row->values[j];
-                                }
-                            }
-                        }
-                        
-                        // Add row group if we have it
-                        if (!row_group_name.empty()) {
-                            std::string row_group_id = file_name + ":" + row_group_name;
-                            if (std::find(results->matching_row_groups.begin(), 
-                                        results->matching_row_groups.end(), 
-                                        row_group_id) == results->matching_row_groups.end()) {
-                                results->matching_row_groups.push_back(row_group_id);
-                            }
-                            
-                            // Add column if we have it
-                            if (!column_name.empty()) {
-                                std::string column_id = row_group_id + ":" + column_name;
-                                if (std::find(results->matching_columns.begin(), 
-                                            results->matching_columns.end(), 
-                                            column_id) == results->matching_columns.end()) {
-                                    results->matching_columns.push_back(column_id);
-                                }
-                            }
-                        }
-                    }
-                }
-                
-                // Free the result set
-                free_sql_result_set(&result_set);
-            }
-            
-            // Free container resources
-            for (int i = 0; i < container->count; i++) {
-                if (container->keys[i]) free(container->keys[i]);
-                if (container->values[i]) free(container->values[i]);
-            }
-            free(container->keys);
-            free(container->values);
-            
-            // Free collection resources
-            free(collection.items);
-            
-            // Free the metadata
-            metadata_generator_free_metadata(metadata);
-        }
-        
-        // Clean up
-        free_sql_query_info(query_info);
-        
-        // Set success flag based on whether we found any matches
-        results->success = !results->matching_files.empty();
-        
-        // Set appropriate message
-        if (results->success) {
-            results->message = "Query executed successfully";
-        } else {
-            results->message = "No matching metadata found";
-        }
-        
-        return FrameworkError::OK;
-    }
-    
-    // List all available metadata in a directory
-    FrameworkError listMetadataFiles(
-        const std::string& metadata_directory,
-        std::vector<std::string>* file_list
-    ) {
-        if (!file_list) {
-            setError("Invalid parameter: file_list cannot be null");
-            return FrameworkError::INVALID_PARAMETER;
-        }
-        
-        // Clear the file list
-        file_list->clear();
-        
-        // Make sure the metadata directory exists
-        if (!fs::exists(metadata_directory)) {
-            setError("Metadata directory not found: " + metadata_directory);
-            return FrameworkError::FILE_NOT_FOUND;
-        }
-        
-        // Scan the directory for metadata files
-        try {
-            for (const auto& entry : fs::directory_iterator(metadata_directory)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".meta") {
-                    file_list->push_back(entry.path().filename().string());
-                }
-            }
-        } catch (const std::exception& e) {
-            setError("Failed to scan metadata directory: " + std::string(e.what()));
-            return FrameworkError::PERMISSION_DENIED;
-        }
-        
-        return FrameworkError::OK;
-    }
-
-    /**
-     * generateColumnMetadata method implementation
-     * 
-     * This function analyzes column data and generates appropriate metadata based on the column type.
-     */
-    bool generateColumnMetadata(const ParquetColumn* column, 
-                               const void* column_data, 
-                               size_t column_size,
-                               int column_index,
-                               Metadata* metadata) {
-        if (!column || !column_data || column_size == 0 || !metadata) {
-            setError("Invalid parameters for metadata generation");
-            return false;
-        }
-        
-        // Add a metadata item for this column to the metadata structure
-        ColumnMetadata* col_metadata = nullptr;
-        
-        // Check if column metadata already exists
-        for (uint32_t i = 0; i < metadata->column_metadata_count; i++) {
-            if (metadata->column_metadata[i].column_index == column_index) {
-                col_metadata = &metadata->column_metadata[i];
-                break;
-            }
-        }
-        
-        // If not found, create new column metadata
-        if (!col_metadata) {
-            // Allocate or reallocate array of column metadata
-            uint32_t new_count = metadata->column_metadata_count + 1;
-            ColumnMetadata* new_array = (ColumnMetadata*)realloc(
-                metadata->column_metadata, 
-                new_count * sizeof(ColumnMetadata)
-            );
-            
-            if (!new_array) {
-                setError("Failed to allocate memory for column metadata");
-                return false;
-            }
-            
-            metadata->column_metadata = new_array;
-            col_metadata = &metadata->column_metadata[metadata->column_metadata_count];
-            metadata->column_metadata_count = new_count;
-            
-            // Initialize the new column metadata
-            memset(col_metadata, 0, sizeof(ColumnMetadata));
-            col_metadata->column_index = column_index;
-            strncpy(col_metadata->column_name, column->name, MAX_METADATA_ITEM_NAME_LENGTH - 1);
-            col_metadata->column_name[MAX_METADATA_ITEM_NAME_LENGTH - 1] = '\0';
-        }
-        
-        // Generate metadata based on column type
-        bool success = false;
-        
-        switch (column->type) {
-            case PARQUET_TIMESTAMP:
-                success = generateTimestampMetadata(column, column_data, column_size, col_metadata);
-                break;
-                
-            case PARQUET_STRING:
-            case PARQUET_BYTE_ARRAY:
-                success = generateStringMetadata(column, column_data, column_size, col_metadata);
-                break;
-                
-            case PARQUET_INT32:
-            case PARQUET_INT64:
-            case PARQUET_FLOAT:
-            case PARQUET_DOUBLE:
-                success = generateNumericMetadata(column, column_data, column_size, col_metadata);
-                break;
-                
-            case PARQUET_BOOLEAN:
-            case PARQUET_INT96:
-            case PARQUET_FIXED_LEN_BYTE_ARRAY:
-                success = generateCategoricalMetadata(column, column_data, column_size, col_metadata);
-                break;
-                
-            default:
-                // Unknown type, skip metadata generation
-                setError("Unknown column type for metadata generation");
-                return false;
-        }
-        
-        return success;
-    }
-
-    /**
-     * generateTimestampMetadata method implementation
-     * 
-     * This function generates timestamp metadata for a column.
-     */
-    bool generateTimestampMetadata(const ParquetColumn* column, 
-                                  const void* column_data, 
-                                  size_t column_size,
-                                  ColumnMetadata* metadata) {
-        if (!column || !column_data || column_size == 0 || !metadata) {
-            setError("Invalid parameters for timestamp metadata generation");
-            return false;
-        }
-        
-        // Create a new metadata item for timestamp
-        MetadataItem* item = addColumnMetadataItem(metadata, "timestamp", METADATA_TYPE_TIMESTAMP);
-        if (!item) {
-            setError("Failed to add timestamp metadata item");
-            return false;
-        }
-        
-        // Initialize timestamp metadata with defaults
-        TimestampMetadata* ts_metadata = &item->value.timestamp;
-        ts_metadata->min_timestamp = 0;
-        ts_metadata->max_timestamp = 0;
-        ts_metadata->count = 0;
-        
-        // Parse timestamp data
-        const time_t* timestamps = (const time_t*)column_data;
-        size_t count = column_size / sizeof(time_t);
-        
-        if (count == 0) {
-            // No data, keep default values
-            return true;
-        }
-        
-        // Set initial min/max values from the first timestamp
-        ts_metadata->min_timestamp = timestamps[0];
-        ts_metadata->max_timestamp = timestamps[0];
-        ts_metadata->count = count;
-        
-        // Process the rest of the timestamps
-        for (size_t i = 1; i < count; i++) {
-            if (timestamps[i] < ts_metadata->min_timestamp) {
-                ts_metadata->min_timestamp = timestamps[i];
-            }
-            
-            if (timestamps[i] > ts_metadata->max_timestamp) {
-                ts_metadata->max_timestamp = timestamps[i];
-            }
-        }
-        
-        return true;
-    }
-
-    /**
-     * generateStringMetadata method implementation
-     * 
-     * This function generates string metadata for a column.
-     */
-    bool generateStringMetadata(const ParquetColumn* column, 
-                               const void* column_data, 
-                               size_t column_size,
-                               ColumnMetadata* metadata) {
-        if (!column || !column_data || column_size == 0 || !metadata) {
-            setError("Invalid parameters for string metadata generation");
-            return false;
-        }
-        
-        // Create a new metadata item for string
-        MetadataItem* item = addColumnMetadataItem(metadata, "string", METADATA_TYPE_STRING);
-        if (!item) {
-            setError("Failed to add string metadata item");
-            return false;
-        }
-        
-        // Initialize string metadata with defaults
-        StringMetadata* str_metadata = &item->value.string;
-        memset(str_metadata, 0, sizeof(StringMetadata));
-        
-        // Parse string data
-        // For simplicity, assume data is in the format:
-        // uint32_t length1, char[length1], uint32_t length2, char[length2], ...
-        
-        const uint8_t* data = (const uint8_t*)column_data;
-        size_t offset = 0;
-        
-        // Structure to track string frequency
-        struct StringCount {
-            char value[MAX_STRING_LENGTH];
-            uint32_t count;
-        };
-        
-        // Map to store string frequencies
-        std::unordered_map<std::string, uint32_t> string_counts;
-        
-        // Special strings to look for (error-related)
-        const char* special_strings[] = {
-            "error", "exception", "fail", "bug", "crash",
-            "invalid", "fatal", "critical", "warning", "issue"
-        };
-        std::unordered_map<std::string, uint32_t> special_counts;
-        
-        // Process all strings
-        uint64_t total_length = 0;
-        uint64_t string_count = 0;
-        
-        while (offset + sizeof(uint32_t) <= column_size) {
-            // Get string length
-            uint32_t length = 0;
-            memcpy(&length, data + offset, sizeof(uint32_t));
-            offset += sizeof(uint32_t);
-            
-            // Check if we have enough data for the string
-            if (offset + length > column_size) {
-                break;
-            }
-            
-            // Get the string
-            char* str = new char[length + 1];
-            memcpy(str, data + offset, length);
-            str[length] = '\0';
-            offset += length;
-            
-            // Convert to std::string for easier handling
-            std::string s(str);
-            delete[] str;
-            
-            // Update total length and count
-            total_length += length;
-            string_count++;
-            
-            // Update frequency map
-            string_counts[s]++;
-            
-            // Check for special strings
-            std::string lower_s = s;
-            std::transform(lower_s.begin(), lower_s.end(), lower_s.begin(), ::tolower);
-            
-            for (const char* special : special_strings) {
-                if (lower_s.find(special) != std::string::npos) {
-                    special_counts[s]++;
-                    break;
-                }
-            }
-        }
-        
-        // Calculate average string length
-        str_metadata->avg_string_length = (string_count > 0) ? 
-                                          total_length / string_count : 0;
-        str_metadata->total_string_count = string_count;
-        
-        // Get top N frequent strings
-        std::vector<std::pair<std::string, uint32_t>> sorted_strings;
-        for (const auto& entry : string_counts) {
-            sorted_strings.push_back(entry);
-        }
-        
-        // Sort by frequency (descending)
-        std::sort(sorted_strings.begin(), sorted_strings.end(),
-                 [](const std::pair<std::string, uint32_t>& a, 
-                    const std::pair<std::string, uint32_t>& b) {
-                     return a.second > b.second;
-                 });
-        
-        // Store top N most frequent strings
-        str_metadata->high_freq_count = std::min((uint32_t)sorted_strings.size(), 
-                                               (uint32_t)MAX_HIGH_FREQ_STRINGS);
-        
-        for (uint32_t i = 0; i < str_metadata->high_freq_count; i++) {
-            strncpy(str_metadata->high_freq_strings[i].string, 
-                   sorted_strings[i].first.c_str(), 
-                   MAX_STRING_LENGTH - 1);
-            str_metadata->high_freq_strings[i].string[MAX_STRING_LENGTH - 1] = '\0';
-            str_metadata->high_freq_strings[i].count = sorted_strings[i].second;
-            str_metadata->high_freq_counts[i] = sorted_strings[i].second;  // Update both for backward compatibility
-        }
-        
-        // Get special strings
-        std::vector<std::pair<std::string, uint32_t>> sorted_special;
-        for (const auto& entry : special_counts) {
-            sorted_special.push_back(entry);
-        }
-        
-        // Sort by frequency (descending)
-        std::sort(sorted_special.begin(), sorted_special.end(),
-                 [](const std::pair<std::string, uint32_t>& a, 
-                    const std::pair<std::string, uint32_t>& b) {
-                     return a.second > b.second;
-                 });
-        
-        // Store special strings
-        str_metadata->special_string_count = std::min((uint32_t)sorted_special.size(), 
-                                                    (uint32_t)MAX_SPECIAL_STRINGS);
-        
-        for (uint32_t i = 0; i < str_metadata->special_string_count; i++) {
-            strncpy(str_metadata->special_strings[i], 
-                   sorted_special[i].first.c_str(), 
-                   MAX_STRING_LENGTH - 1);
-            str_metadata->special_strings[i][MAX_STRING_LENGTH - 1] = '\0';
-            str_metadata->special_string_counts[i] = sorted_special[i].second;
-        }
-        
-        return true;
-    }
-
-    /**
-     * generateNumericMetadata method implementation
-     * 
-     * This function generates numeric metadata for a column.
-     */
-    bool generateNumericMetadata(const ParquetColumn* column, 
-                                const void* column_data, 
-                                size_t column_size,
-                                ColumnMetadata* metadata) {
-        if (!column || !column_data || column_size == 0 || !metadata) {
-            setError("Invalid parameters for numeric metadata generation");
-            return false;
-        }
-        
-        // Create a new metadata item for numeric
-        MetadataItem* item = addColumnMetadataItem(metadata, "numeric", METADATA_TYPE_NUMERIC);
-        if (!item) {
-            setError("Failed to add numeric metadata item");
-            return false;
-        }
-        
-        // Initialize numeric metadata with defaults
-        NumericMetadata* num_metadata = &item->value.numeric;
-        memset(num_metadata, 0, sizeof(NumericMetadata));
-        
-        // Process data based on column type
-        std::vector<double> values;
-        uint32_t null_count = 0;
-        
-        switch (column->type) {
-            case PARQUET_INT32: {
-                const int32_t* data = (const int32_t*)column_data;
-                size_t count = column_size / sizeof(int32_t);
-                
-                for (size_t i = 0; i < count; i++) {
-                    if (data[i] == INT32_MIN) {
-                        // Assume INT32_MIN represents null
-                        null_count++;
-                    } else {
-                        values.push_back(static_cast<double>(data[i]));
-                    }
-                }
-                break;
-            }
-            
-            case PARQUET_INT64: {
-                const int64_t* data = (const int64_t*)column_data;
-                size_t count = column_size / sizeof(int64_t);
-                
-                for (size_t i = 0; i < count; i++) {
-                    if (data[i] == INT64_MIN) {
-                        // Assume INT64_MIN represents null
-                        null_count++;
-                    } else {
-                        values.push_back(static_cast<double>(data[i]));
+                    if (std::find(results->matching_files.begin(), 
+                                results->matching_files.end(), 
+                                file_name) == results->matching_files.end()) {
+                        results->matching_files.push_back(file_name);
                     }
-                }
-                break;
-            }
-            
-            case PARQUET_FLOAT: {
-                const float* data = (const float*)column_data;
-                size_t count = column_size / sizeof(float);
-                
-                for (size_t i = 0; i < count; i++) {
-                    if (std::isnan(data[i])) {
-                        // NaN represents null
-                        null_count++;
-                    } else {
-                        values.push_back(static_cast<double>(data[i]));
+                    
+                    // Row groups whose Bloom filters may contain the queried values
+                    for (uint32_t row_group_index : candidate_row_groups) {
+                        std::string row_group_id = file_name + ":" + std::to_string(row_group_index);
+                        if (std::find(results->matching_row_groups.begin(),
+                                    results->matching_row_groups.end(),
+                                    row_group_id) == results->matching_row_groups.end()) {
+                            results->matching_row_groups.push_back(row_group_id);
+                        }
                     }
-                }
-                break;
-            }
-            
-            case PARQUET_DOUBLE: {
-                const double* data = (const double*)column_data;
-                size_t count = column_size / sizeof(double);
-                
-                for (size_t i = 0; i < count; i++) {
-                    if (std::isnan(data[i])) {
-                        // NaN represents null
-                        null_count++;
-                    } else {
-                        values.push_back(data[i]);
+                    
+                    // Process each row in the result set
+                    for (int i = 0; i < result_set.row_count; i++) {
+                        MetadataRow* row = &result_set.rows[i];
+                        
+                        // Check if this row has row group and column information
+                        std::string row_group_name;
+                        std::string column_name;
+                        
+                        for (int j = 0; j < row->count; j++) {
+                            if (row->columns[j] && row->values[j]) {
+                                if (strcmp(row->columns[j], "row_group") == 0) {
+                                    row_group_name = row->values[j];
+                                } else if (strcmp(row->columns[j], "column") == 0) {
+                                    column_name = row->values[j];
+                                }
+                            }
+                        }
+                        
+                        // Add row group if we have it
+                        if (!row_group_name.empty()) {
+                            std::string row_group_id = file_name + ":" + row_group_name;
+                            if (std::find(results->matching_row_groups.begin(), 
+                                        results->matching_row_groups.end(), 
+                                        row_group_id) == results->matching_row_groups.end()) {
+                                results->matching_row_groups.push_back(row_group_id);
+                            }
+                            
+                            // Add column if we have it
+                            if (!column_name.empty()) {
+                                std::string column_id = row_group_id + ":" + column_name;
+                                if (std::find(results->matching_columns.begin(), 
+                                            results->matching_columns.end(), 
+                                            column_id) == results->matching_columns.end()) {
+                                    results->matching_columns.push_back(column_id);
+                                }
+                            }
+                        }
                     }
                 }
-                break;
-            }
-            
-            default:
-                setError("Unsupported column type for numeric metadata");
-                return false;
-        }
-        
-        // Set null count
-        num_metadata->null_count = null_count;
-        
-        // Set total count
-        num_metadata->total_count = values.size() + null_count;
-        
-        // If no values, return with defaults
-        if (values.empty()) {
-            return true;
-        }
-        
-        // Calculate min and max
-        num_metadata->min_value = *std::min_element(values.begin(), values.end());
-        num_metadata->max_value = *std::max_element(values.begin(), values.end());
-        
-        // Calculate average
-        double sum = std::accumulate(values.begin(), values.end(), 0.0);
-        num_metadata->avg_value = sum / values.size();
-        
-        // Calculate mode
-        std::unordered_map<double, uint64_t> value_counts;
-        for (double value : values) {
-            value_counts[value]++;
-        }
-        
-        double mode_value = 0.0;
-        uint64_t mode_count = 0;
-        
-        for (const auto& entry : value_counts) {
-            if (entry.second > mode_count) {
-                mode_value = entry.first;
-                mode_count = entry.second;
-            }
-        }
-        
-        num_metadata->mode_value = mode_value;
-        num_metadata->mode_count = mode_count;
-        
-        return true;
-    }
-
-    /**
-     * generateCategoricalMetadata method implementation
-     * 
-     * This function generates categorical metadata for a column.
-     */
-    bool generateCategoricalMetadata(const ParquetColumn* column, 
-                                    const void* column_data, 
-                                    size_t column_size,
-                                    ColumnMetadata* metadata) {
-        if (!column || !column_data || column_size == 0 || !metadata) {
-            setError("Invalid parameters for categorical metadata generation");
-            return false;
-        }
-        
-        // Create a new metadata item for categorical
-        MetadataItem* item = addColumnMetadataItem(metadata, "categorical", METADATA_TYPE_CATEGORICAL);
-        if (!item) {
-            setError("Failed to add categorical metadata item");
-            return false;
-        }
-        
-        // Initialize categorical metadata with defaults
-        CategoricalMetadata* cat_metadata = &item->value.categorical;
-        memset(cat_metadata, 0, sizeof(CategoricalMetadata));
-        
-        // Map to store category frequencies
-        std::unordered_map<std::string, uint32_t> category_counts;
-        
-        // Process data based on column type
-        switch (column->type) {
-            case PARQUET_BOOLEAN: {
-                const bool* data = (const bool*)column_data;
-                size_t count = column_size / sizeof(bool);
                 
-                for (size_t i = 0; i < count; i++) {
-                    std::string category = data[i] ? "true" : "false";
-                    category_counts[category]++;
-                }
-                break;
+                // Free the result set
+                free_sql_result_set(&result_set);
             }
             
-            case PARQUET_INT96: {
-                // Int96 is typically used for timestamps in older Parquet files
-                // We'll treat each unique value as a category
-                const uint8_t* data = (const uint8_t*)column_data;
-                size_t count = column_size / 12; // Int96 is 12 bytes
-                
-                for (size_t i = 0; i < count; i++) {
-                    // Convert Int96 to hex string for categorization
-                    std::stringstream ss;
-                    ss << std::hex;
-                    for (size_t j = 0; j < 12; j++) {
-                        ss << std::setw(2) << std::setfill('0') 
-                           << static_cast<int>(data[i * 12 + j]);
-                    }
-                    category_counts[ss.str()]++;
-                }
-                break;
+            // Free container resources
+            for (int i = 0; i < container->count; i++) {
+                if (container->keys[i]) free(container->keys[i]);
+                if (container->values[i]) free(container->values[i]);
             }
+            free(container->keys);
+            free(container->values);
             
-            case PARQUET_FIXED_LEN_BYTE_ARRAY: {
-                // For fixed-length byte arrays, we need to know the length
-                // For simplicity, let's assume each element is 16 bytes (e.g., UUID)
-                const int fixed_len = 16;
-                const uint8_t* data = (const uint8_t*)column_data;
-                size_t count = column_size / fixed_len;
-                
-                for (size_t i = 0; i < count; i++) {
-                    // Convert to hex string for categorization
-                    std::stringstream ss;
-                    ss << std::hex;
-                    for (size_t j = 0; j < fixed_len; j++) {
-                        ss << std::setw(2) << std::setfill('0') 
-                           << static_cast<int>(data[i * fixed_len + j]);
-                    }
-                    category_counts[ss.str()]++;
-                }
-                break;
-            }
+            // Free collection resources
+            free(collection.items);
             
-            default:
-                setError("Unsupported column type for categorical metadata");
-                return false;
-        }
-        
-        // Set total category count
-        cat_metadata->total_category_count = category_counts.size();
-        
-        // Set total value count
-        uint64_t total_values = 0;
-        for (const auto& entry : category_counts) {
-            total_values += entry.second;
-        }
-        cat_metadata->total_value_count = total_values;
-        
-        // Sort categories by frequency
-        std::vector<std::pair<std::string, uint32_t>> sorted_categories;
-        for (const auto& entry : category_counts) {
-            sorted_categories.push_back(entry);
+            // Free the metadata
+            metadata_release(metadata);
         }
         
-        // Sort by frequency (descending)
-        std::sort(sorted_categories.begin(), sorted_categories.end(),
-                 [](const std::pair<std::string, uint32_t>& a, 
-                    const std::pair<std::string, uint32_t>& b) {
-                     return a.second > b.second;
-                 });
+        // Clean up
+        free_sql_query_info(query_info);
         
-        // Store top N categories
-        cat_metadata->high_freq_category_count = std::min((uint32_t)sorted_categories.size(), 
-                                                        (uint32_t)MAX_HIGH_FREQ_CATEGORIES);
+        // Set success flag based on whether we found any matches
+        results->success = !results->matching_files.empty();
         
-        for (uint32_t i = 0; i < cat_metadata->high_freq_category_count; i++) {
-            strncpy(cat_metadata->categories[i], 
-                   sorted_categories[i].first.c_str(), 
-                   MAX_STRING_LENGTH - 1);
-            cat_metadata->categories[i][MAX_STRING_LENGTH - 1] = '\0';
-            cat_metadata->category_counts[i] = sorted_categories[i].second;
+        // Set appropriate message
+        if (results->success) {
+            results->message = "Query executed successfully";
+        } else {
+            results->message = "No matching metadata found";
         }
         
-        return true;
+        return FrameworkError::OK;
     }
-
-    /**
-     * addColumnMetadataItem helper method
-     * 
-     * This function adds a metadata item to a column's metadata list.
-     */
-    MetadataItem* addColumnMetadataItem(ColumnMetadata* column_metadata, 
-                                       const char* name, 
-                                       MetadataType type) {
-        if (!column_metadata || !name) {
-            return nullptr;
+    
+    // List all available metadata in a directory
+    FrameworkError listMetadataFiles(
+        const std::string& metadata_directory,
+        std::vector<std::string>* file_list
+    ) {
+        if (!file_list) {
+            setError("Invalid parameter: file_list cannot be null");
+            return FrameworkError::INVALID_PARAMETER;
         }
         
-        // Allocate or reallocate array of metadata items
-        uint32_t new_count = column_metadata->metadata_count + 1;
-        MetadataItem* new_array = (MetadataItem*)realloc(
-            column_metadata->metadata, 
-            new_count * sizeof(MetadataItem)
-        );
+        // Clear the file list
+        file_list->clear();
         
-        if (!new_array) {
-            return nullptr;
+        // Make sure the metadata directory exists
+        if (!fs::exists(metadata_directory)) {
+            setError("Metadata directory not found: " + metadata_directory);
+            return FrameworkError::FILE_NOT_FOUND;
         }
         
-        column_metadata->metadata = new_array;
-        MetadataItem* item = &column_metadata->metadata[column_metadata->metadata_count];
-        column_metadata->metadata_count = new_count;
-        
-        // Initialize the new metadata item
-        memset(item, 0, sizeof(MetadataItem));
-        strncpy(item->name, name, MAX_METADATA_ITEM_NAME_LENGTH - 1);
-        item->name[MAX_METADATA_ITEM_NAME_LENGTH - 1] = '\0';
-        item->type = type;
+        // Scan the directory for metadata files
+        try {
+            for (const auto& entry : fs::directory_iterator(metadata_directory)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".meta") {
+                    file_list->push_back(entry.path().filename().string());
+                }
+            }
+        } catch (const std::exception& e) {
+            setError("Failed to scan metadata directory: " + std::string(e.what()));
+            return FrameworkError::PERMISSION_DENIED;
+        }
         
-        return item;
-    }
-
-    // Helper methods for Metadata access
-    int getMetadataChildCount(const Metadata* metadata) {
-        if (!metadata) return 0;
-        return reinterpret_cast<const MetadataFields*>(metadata)->child_count;
-    }
-    
-    const char* getMetadataName(const Metadata* metadata) {
-        if (!metadata) return "";
-        return reinterpret_cast<const MetadataFields*>(metadata)->name;
-    }
-    
-    int getMetadataType(const Metadata* metadata) {
-        if (!metadata) return 0;
-        return reinterpret_cast<const MetadataFields*>(metadata)->type;
-    }
-    
-    Metadata* getChildMetadata(const Metadata* metadata, int index) {
-        if (!metadata) return nullptr;
-        const MetadataFields* fields = reinterpret_cast<const MetadataFields*>(metadata);
-        if (index < 0 || index >= fields->child_count) return nullptr;
-        return reinterpret_cast<Metadata*>(fields->child_metadata[index]);
+        return FrameworkError::OK;
     }
 };
 
@@ -1781,12 +3344,31 @@ bool InfParquet::compressParquetFile(
     options.parallel_tasks = threads;
     options.generate_base_metadata = use_basic_metadata;
     
+    return compressParquetFile(input_file, output_dir, options);
+}
+
+// Compress a parquet file with explicit options
+bool InfParquet::compressParquetFile(
+    const std::string& input_file,
+    const std::string& output_dir,
+    const CompressionOptions& options
+) {
     FrameworkError result = pImpl->compressParquetFile(
-        input_file, output_dir, options, 
-        [this](const std::string& op, int rg, int total, int percent) -> bool {
-            // Handle progress callback if needed
-            return true;
-        }
+        input_file, output_dir, options, pImpl->progress_callback
+    );
+    
+    return result == FrameworkError::OK;
+}
+
+// Compress every parquet file matched by a directory or glob
+bool InfParquet::compressParquetBatch(
+    const std::string& input_pattern,
+    const std::string& output_dir,
+    const CompressionOptions& options,
+    BatchCompressionReport* report
+) {
+    FrameworkError result = pImpl->compressParquetBatch(
+        input_pattern, output_dir, options, pImpl->progress_callback, report
     );
     
     return result == FrameworkError::OK;
@@ -1802,17 +3384,167 @@ bool InfParquet::decompressParquetFile(
     options.output_directory = output_file;
     options.parallel_tasks = threads;
     
+    return decompressParquetFile(input_dir, output_file, options);
+}
+
+// Decompress a previously compressed parquet file with explicit options
+bool InfParquet::decompressParquetFile(
+    const std::string& input_dir,
+    const std::string& output_file,
+    const DecompressionOptions& options
+) {
     FrameworkError result = pImpl->decompressParquetFile(
-        input_dir, output_file, options, 
-        [this](const std::string& op, int rg, int total, int percent) -> bool {
-            // Handle progress callback if needed
-            return true;
-        }
+        input_dir, output_file, options, pImpl->progress_callback
+    );
+    
+    return result == FrameworkError::OK;
+}
+
+// Open a previously compressed parquet file as a stream of record batches
+std::shared_ptr<arrow::RecordBatchReader> InfParquet::openDecompressedStream(
+    const std::string& input_dir,
+    const DecompressionOptions& options,
+    int prefetch_depth
+) {
+    std::shared_ptr<arrow::RecordBatchReader> reader;
+    FrameworkError result = pImpl->openDecompressedStream(input_dir, options, prefetch_depth, &reader);
+    
+    return result == FrameworkError::OK ? reader : nullptr;
+}
+
+// Read a range of rows of one column
+std::shared_ptr<arrow::RecordBatch> InfParquet::readRange(
+    const std::string& input_dir,
+    int row_group,
+    const std::string& column,
+    uint64_t first_row,
+    uint64_t row_count
+) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+    FrameworkError result = pImpl->readRange(input_dir, row_group, column, first_row, row_count, &batch);
+    
+    return result == FrameworkError::OK ? batch : nullptr;
+}
+
+// Compress a parquet file into a single-stream archive
+bool InfParquet::compressToStream(
+    const std::string& input_file,
+    const std::string& output_file,
+    const CompressionOptions& options
+) {
+    FrameworkError result = pImpl->compressToStream(
+        input_file, output_file, options, pImpl->progress_callback
+    );
+    
+    return result == FrameworkError::OK;
+}
+
+// Decompress a single-stream archive
+bool InfParquet::decompressFromStream(
+    const std::string& input_file,
+    const std::string& output_file,
+    const DecompressionOptions& options
+) {
+    FrameworkError result = pImpl->decompressFromStream(
+        input_file, output_file, options, pImpl->progress_callback
+    );
+    
+    return result == FrameworkError::OK;
+}
+
+// Verify an archive against its chunk checksums
+bool InfParquet::verifyArchive(
+    const std::string& input_dir,
+    const VerifyOptions& options,
+    VerificationReport* report
+) {
+    FrameworkError result = pImpl->verifyArchive(
+        input_dir, options, report, pImpl->progress_callback
     );
     
     return result == FrameworkError::OK;
 }
 
+// Compress a parquet file on the shared executor
+std::future<JobResult> InfParquet::compressParquetFileAsync(
+    const std::string& input_file,
+    const std::string& output_dir,
+    const CompressionOptions& options,
+    CancellationToken token,
+    CompletionCallback on_complete
+) {
+    // The job works on a snapshot of this instance, so concurrent jobs do not
+    // race on the last error and the instance may go away before they finish
+    std::shared_ptr<Impl> job = std::make_shared<Impl>(*pImpl);
+    return Impl::runAsync(job, token, on_complete,
+        [input_file, output_dir, options](Impl& impl, const CancellationToken* cancel_token, std::string*) {
+            return impl.compressParquetFile(input_file, output_dir, options,
+                                            impl.progress_callback, cancel_token);
+        });
+}
+
+// Decompress a previously compressed parquet file on the shared executor
+std::future<JobResult> InfParquet::decompressParquetFileAsync(
+    const std::string& input_dir,
+    const std::string& output_file,
+    const DecompressionOptions& options,
+    CancellationToken token,
+    CompletionCallback on_complete
+) {
+    std::shared_ptr<Impl> job = std::make_shared<Impl>(*pImpl);
+    return Impl::runAsync(job, token, on_complete,
+        [input_dir, output_file, options](Impl& impl, const CancellationToken* cancel_token, std::string*) {
+            return impl.decompressParquetFile(input_dir, output_file, options,
+                                              impl.progress_callback, cancel_token);
+        });
+}
+
+// Query metadata on the shared executor
+std::future<JobResult> InfParquet::queryMetadataAsync(
+    const std::string& input_dir,
+    const std::string& query,
+    CancellationToken token,
+    CompletionCallback on_complete
+) {
+    std::shared_ptr<Impl> job = std::make_shared<Impl>(*pImpl);
+    return Impl::runAsync(job, token, on_complete,
+        [input_dir, query](Impl& impl, const CancellationToken*, std::string* output) {
+            MetadataQueryResult results;
+            FrameworkError result = impl.queryMetadata(input_dir, query, &results);
+            if (result == FrameworkError::OK) {
+                *output = Impl::formatQueryResults(query, results);
+            }
+            return result;
+        });
+}
+
+// Set the number of threads of the shared executor
+void InfParquet::setAsyncThreads(int threads) {
+    JobExecutor::shared().setThreadLimit(static_cast<unsigned int>(std::max(threads, 0)));
+}
+
+// Set the capacity of the shared chunk cache
+void InfParquet::setChunkCacheCapacity(uint64_t bytes) {
+    chunk_cache_set_capacity(bytes);
+}
+
+// Get the counters of the shared chunk cache
+ChunkCacheStatistics InfParquet::getChunkCacheStatistics() {
+    ChunkCacheStats stats;
+    chunk_cache_get_stats(&stats);
+    
+    ChunkCacheStatistics result;
+    result.hits = stats.hits;
+    result.misses = stats.misses;
+    result.insertions = stats.insertions;
+    result.evictions = stats.evictions;
+    result.invalidations = stats.invalidations;
+    result.entries = stats.entries;
+    result.bytes = stats.bytes;
+    result.capacity = stats.capacity;
+    return result;
+}
+
 // Query metadata for specific patterns or values - match header signature
 std::string InfParquet::queryMetadata(
     const std::string& input_dir,
@@ -1826,38 +3558,7 @@ std::string InfParquet::queryMetadata(
         return "Query failed: " + pImpl->last_error;
     }
     
-    // Convert results to string
-    std::stringstream ss;
-    ss << "Query results for: " << query << "\n";
-    
-    if (results.matching_files.empty() && 
-        results.matching_row_groups.empty() && 
-        results.matching_columns.empty()) {
-        ss << "No matches found.";
-    } else {
-        if (!results.matching_files.empty()) {
-            ss << "Matching files (" << results.matching_files.size() << "):\n";
-            for (const auto& file : results.matching_files) {
-                ss << "  - " << file << "\n";
-            }
-        }
-        
-        if (!results.matching_row_groups.empty()) {
-            ss << "Matching row groups (" << results.matching_row_groups.size() << "):\n";
-            for (const auto& rg : results.matching_row_groups) {
-                ss << "  - " << rg << "\n";
-            }
-        }
-        
-        if (!results.matching_columns.empty()) {
-            ss << "Matching columns (" << results.matching_columns.size() << "):\n";
-            for (const auto& col : results.matching_columns) {
-                ss << "  - " << col << "\n";
-            }
-        }
-    }
-    
-    return ss.str();
+    return Impl::formatQueryResults(query, results);
 }
 
 // Rename listMetadataFiles to match header file
@@ -1955,4 +3656,9 @@ void InfParquet::setVerbose(bool verbose) {
     pImpl->verbose = verbose;
 }
 
+// Set the memory limit of this instance's LZMA codec
+void InfParquet::setCodecMemoryLimit(uint64_t bytes) {
+    pImpl->codec_settings.memory_limit = bytes;
+}
+
 } // namespace infparquet 
\ No newline at end of file
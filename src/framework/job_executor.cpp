@@ -0,0 +1,115 @@
+#include "framework/job_executor.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+namespace infparquet {
+
+// Private implementation (Pimpl pattern)
+struct JobExecutor::Impl {
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> workers;
+    unsigned int thread_limit = 0;
+    unsigned int idle_workers = 0;
+    bool stopping = false;
+    
+    static unsigned int defaultThreadLimit() {
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 1;
+    }
+    
+    // Take jobs from the queue until the executor shuts down
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            idle_workers++;
+            work_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+            idle_workers--;
+            if (stopping) {
+                return;
+            }
+            
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            
+            lock.unlock();
+            job();
+            job = nullptr;  // Release captured state before waiting again
+            lock.lock();
+        }
+    }
+};
+
+// Get the shared executor
+JobExecutor& JobExecutor::shared() {
+    static JobExecutor executor;
+    return executor;
+}
+
+// Constructor
+JobExecutor::JobExecutor()
+    : pImpl(std::make_unique<Impl>()) {
+    pImpl->thread_limit = Impl::defaultThreadLimit();
+}
+
+// Destructor
+JobExecutor::~JobExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        pImpl->stopping = true;
+        pImpl->jobs.clear();
+    }
+    pImpl->work_available.notify_all();
+    
+    for (auto& worker : pImpl->workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+// Queue a job, starting a worker if none is idle and the limit allows it
+void JobExecutor::submit(std::function<void()> job) {
+    if (!job) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        if (pImpl->stopping) {
+            return;
+        }
+        pImpl->jobs.push_back(std::move(job));
+        
+        if (pImpl->idle_workers < pImpl->jobs.size() &&
+            pImpl->workers.size() < pImpl->thread_limit) {
+            Impl* impl = pImpl.get();
+            pImpl->workers.emplace_back([impl] { impl->workerLoop(); });
+        }
+    }
+    pImpl->work_available.notify_one();
+}
+
+// Set the maximum number of worker threads
+void JobExecutor::setThreadLimit(unsigned int threads) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->thread_limit = threads > 0 ? threads : Impl::defaultThreadLimit();
+}
+
+// Get the maximum number of worker threads
+unsigned int JobExecutor::getThreadLimit() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->thread_limit;
+}
+
+// Get the number of jobs waiting for a worker
+size_t JobExecutor::getPendingJobs() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->jobs.size();
+}
+
+} // namespace infparquet
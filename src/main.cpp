@@ -23,24 +23,25 @@ using namespace infparquet;
  * 
  * percent: Progress percentage (0-100)
  * message: Progress message
+ * out: Stream the progress bar is drawn on
  * 
  * Returns: true to continue, false to abort
  */
-bool progressCallback(int percent, const std::string& message) {
+bool progressCallback(int percent, const std::string& message, std::ostream& out) {
     const int barWidth = 50;
     int pos = barWidth * percent / 100;
     
-    std::cout << "[";
+    out << "[";
     for (int i = 0; i < barWidth; ++i) {
-        if (i < pos) std::cout << "=";
-        else if (i == pos) std::cout << ">";
-        else std::cout << " ";
+        if (i < pos) out << "=";
+        else if (i == pos) out << ">";
+        else out << " ";
     }
-    std::cout << "] " << percent << "% " << message << "\r";
-    std::cout.flush();
+    out << "] " << percent << "% " << message << "\r";
+    out.flush();
     
     if (percent >= 100) {
-        std::cout << std::endl;
+        out << std::endl;
     }
     
     return true;
@@ -113,20 +114,25 @@ int main(int argc, char* argv[]) {
         infparquet.setVerbose(true);
     }
     
+    // Standard output may carry the data in stream mode, so messages go to stderr there
+    std::ostream& console = args.stream ? std::cerr : std::cout;
+    
     // Set progress callback
-    infparquet.setProgressCallback([](const std::string& operation, int row_group_index, 
+    infparquet.setProgressCallback([&console](const std::string& operation, int row_group_index, 
                                   int total_row_groups, int percent_complete) {
         std::string message = operation;
         if (row_group_index >= 0) {
             message += " [RowGroup " + std::to_string(row_group_index + 1) + "/" + 
                       std::to_string(total_row_groups) + "]";
         }
-        return progressCallback(percent_complete, message);
+        return progressCallback(percent_complete, message, console);
     });
     
-    // Normalize all paths
-    if (!args.input_path.empty()) args.input_path = normalizePath(args.input_path);
-    if (!args.output_path.empty()) args.output_path = normalizePath(args.output_path);
+    // Normalize all paths (a batch input may be a glob and stream paths may be "-", so both are left as given)
+    if (!args.input_path.empty() && args.command != CommandType::CompressBatch && !args.stream) {
+        args.input_path = normalizePath(args.input_path);
+    }
+    if (!args.output_path.empty() && !args.stream) args.output_path = normalizePath(args.output_path);
     if (!args.custom_metadata_file.empty()) args.custom_metadata_file = normalizePath(args.custom_metadata_file);
     
     // Process command
@@ -140,6 +146,13 @@ int main(int argc, char* argv[]) {
             options.generate_custom_metadata = !args.custom_metadata_file.empty();
             options.custom_metadata_config = args.custom_metadata_file;
             options.parallel_tasks = args.threads;
+            options.reader_threads = args.reader_threads;
+            options.analyzer_threads = args.analyzer_threads;
+            options.queue_depth = args.queue_depth;
+            options.bloom_filter_columns = args.bloom_filter_columns;
+            options.bloom_filter_fpp = args.bloom_filter_fpp;
+            options.use_footer_statistics = args.use_footer_statistics;
+            options.metadata_sample_rate = args.metadata_sample_rate;
             
             // Load custom metadata from config file if specified
             if (!args.custom_metadata_file.empty()) {
@@ -150,6 +163,13 @@ int main(int argc, char* argv[]) {
                 }
             }
             
+            // A single-stream archive is one file (or stdout) rather than a directory
+            if (args.stream) {
+                console << "Compressing " << args.input_path << " to stream archive " << args.output_path << std::endl;
+                success = infparquet.compressToStream(args.input_path, args.output_path, options);
+                break;
+            }
+            
             // Ensure output directory exists - now compatible with std::string parameter
             if (!ensureDirectoryExists(args.output_path)) {
                 std::cerr << "Error: Failed to create output directory: " << args.output_path << std::endl;
@@ -158,9 +178,62 @@ int main(int argc, char* argv[]) {
             
             // Compress the file
             std::cout << "Compressing " << args.input_path << " to " << args.output_path << std::endl;
-            success = infparquet.compressParquetFile(args.input_path, args.output_path, 
-                                                   args.compression_level, args.threads, 
-                                                   args.use_basic_metadata);
+            success = infparquet.compressParquetFile(args.input_path, args.output_path, options);
+            break;
+        }
+        
+        case CommandType::CompressBatch: {
+            // Configure compression options shared by every file of the batch
+            CompressionOptions options;
+            options.compression_level = args.compression_level;
+            options.generate_base_metadata = args.use_basic_metadata;
+            options.generate_custom_metadata = !args.custom_metadata_file.empty();
+            options.custom_metadata_config = args.custom_metadata_file;
+            options.parallel_tasks = args.threads;
+            options.reader_threads = args.reader_threads;
+            options.analyzer_threads = args.analyzer_threads;
+            options.queue_depth = args.queue_depth;
+            options.bloom_filter_columns = args.bloom_filter_columns;
+            options.bloom_filter_fpp = args.bloom_filter_fpp;
+            options.use_footer_statistics = args.use_footer_statistics;
+            options.metadata_sample_rate = args.metadata_sample_rate;
+            
+            if (!args.custom_metadata_file.empty()) {
+                if (!infparquet.loadCustomMetadataFromJson(args.custom_metadata_file)) {
+                    std::cerr << "Error: Failed to load custom metadata configuration: " 
+                              << infparquet.getLastError() << std::endl;
+                    return 1;
+                }
+            }
+            
+            if (!ensureDirectoryExists(args.output_path)) {
+                std::cerr << "Error: Failed to create output directory: " << args.output_path << std::endl;
+                return 1;
+            }
+            
+            std::cout << "Compressing batch " << args.input_path << " to " << args.output_path << std::endl;
+            BatchCompressionReport report;
+            success = infparquet.compressParquetBatch(args.input_path, args.output_path, options, &report);
+            
+            // Aggregate throughput report
+            double input_mb = report.input_bytes / (1024.0 * 1024.0);
+            double output_mb = report.output_bytes / (1024.0 * 1024.0);
+            std::cout << "Files: " << report.files_succeeded << " compressed, "
+                      << report.files_failed << " failed, " << report.chunk_count << " column chunks" << std::endl;
+            std::cout << "Data: " << input_mb << " MB -> " << output_mb << " MB";
+            if (report.output_bytes > 0) {
+                std::cout << " (ratio " << static_cast<double>(report.input_bytes) / report.output_bytes << ")";
+            }
+            std::cout << std::endl;
+            if (report.elapsed_seconds > 0) {
+                std::cout << "Time: " << report.elapsed_seconds << " s, throughput "
+                          << input_mb / report.elapsed_seconds << " MB/s" << std::endl;
+            }
+            for (const auto& file : report.files) {
+                if (!file.success) {
+                    std::cerr << "Failed: " << file.input_file << ": " << file.error << std::endl;
+                }
+            }
             break;
         }
         
@@ -169,6 +242,21 @@ int main(int argc, char* argv[]) {
             DecompressionOptions options;
             options.output_directory = args.output_path;
             options.parallel_tasks = args.threads;
+            options.reader_threads = args.reader_threads;
+            options.analyzer_threads = args.analyzer_threads;
+            options.queue_depth = args.queue_depth;
+            options.output_codec = args.output_codec;
+            options.output_codec_level = args.output_codec_level;
+            options.page_size = args.page_size;
+            options.columns = args.columns;
+            options.row_groups = args.row_groups;
+            options.output_format = args.output_format;
+            
+            if (args.stream) {
+                console << "Decompressing stream archive " << args.input_path << " to " << args.output_path << std::endl;
+                success = infparquet.decompressFromStream(args.input_path, args.output_path, options);
+                break;
+            }
             
             // Ensure output directory exists - now compatible with std::string parameter
             if (!ensureDirectoryExists(args.output_path)) {
@@ -178,7 +266,35 @@ int main(int argc, char* argv[]) {
             
             // Decompress the file
             std::cout << "Decompressing from " << args.input_path << " to " << args.output_path << std::endl;
-            success = infparquet.decompressParquetFile(args.input_path, args.output_path, args.threads);
+            success = infparquet.decompressParquetFile(args.input_path, args.output_path, options);
+            break;
+        }
+        
+        case CommandType::Verify: {
+            VerifyOptions options;
+            options.full_decode = args.full_verify;
+            options.parallel_tasks = args.threads;
+            
+            std::cout << "Verifying " << args.input_path << (args.full_verify ? " (full decode)" : "") << std::endl;
+            VerificationReport report;
+            success = infparquet.verifyArchive(args.input_path, options, &report);
+            
+            double checked_mb = report.bytes_checked / (1024.0 * 1024.0);
+            std::cout << "Chunks: " << report.chunks_checked << " checked, "
+                      << report.corrupt_chunks.size() << " corrupt" << std::endl;
+            std::cout << "Data: " << checked_mb << " MB hashed";
+            if (args.full_verify) {
+                std::cout << ", " << report.bytes_decoded / (1024.0 * 1024.0) << " MB decoded";
+            }
+            std::cout << std::endl;
+            if (report.elapsed_seconds > 0) {
+                std::cout << "Time: " << report.elapsed_seconds << " s, throughput "
+                          << checked_mb / report.elapsed_seconds << " MB/s" << std::endl;
+            }
+            for (const auto& fault : report.corrupt_chunks) {
+                std::cerr << "Corrupt: row group " << fault.row_group << ", column " << fault.column
+                          << ": " << fault.reason << std::endl;
+            }
             break;
         }
         
@@ -0,0 +1,407 @@
+/**
+ * bloom_filter.c
+ *
+ * This file implements the split-block Bloom filter declared in
+ * bloom_filter.h, bit for bit as in the Parquet specification, so filters
+ * agree with those of other Parquet writers given the same size.
+ *
+ * Inserting and probing multiply the low 32 bits of the hash by eight odd
+ * salts and keep the top five bits of each product as a bit index, one per
+ * word of the block. The scalar loops are written over the eight words so
+ * compilers can vectorize them; on x86 an AVX2 version computes the eight
+ * masks with one multiply and one variable shift, chosen at run time.
+ */
+
+#include "metadata/bloom_filter.h"
+#include "core/platform.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/xxhash_inline.h"
+
+#ifdef INFPARQUET_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/* Hashes computed before they are inserted at once */
+#define HASH_BATCH 1024
+
+/* Salts of the Parquet specification, one per word of a block */
+static const uint32_t SALT[BLOOM_FILTER_BLOCK_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Block of a hash: the upper 32 bits scaled to the block count */
+static uint32_t block_index(const BloomFilter* filter, uint64_t hash) {
+    return (uint32_t)(((hash >> 32) * filter->block_count) >> 32);
+}
+
+static void scalar_insert(BloomFilter* filter, const uint64_t* hashes, uint32_t count) {
+    for (uint32_t h = 0; h < count; h++) {
+        uint32_t key = (uint32_t)hashes[h];
+        uint32_t* words = filter->blocks[block_index(filter, hashes[h])].words;
+        for (int i = 0; i < BLOOM_FILTER_BLOCK_WORDS; i++) {
+            words[i] |= (uint32_t)1 << ((key * SALT[i]) >> 27);
+        }
+    }
+}
+
+static bool scalar_check(const BloomFilter* filter, uint64_t hash) {
+    uint32_t key = (uint32_t)hash;
+    const uint32_t* words = filter->blocks[block_index(filter, hash)].words;
+    uint32_t missing = 0;
+    for (int i = 0; i < BLOOM_FILTER_BLOCK_WORDS; i++) {
+        missing |= ~words[i] & ((uint32_t)1 << ((key * SALT[i]) >> 27));
+    }
+    return missing == 0;
+}
+
+#ifdef INFPARQUET_X86_DISPATCH
+
+INFPARQUET_TARGET(avx2)
+static __m256i avx2_mask(uint32_t key) {
+    const __m256i salt = _mm256_setr_epi32((int)SALT[0], (int)SALT[1], (int)SALT[2], (int)SALT[3],
+                                           (int)SALT[4], (int)SALT[5], (int)SALT[6], (int)SALT[7]);
+    __m256i bit = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)key), salt), 27);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+}
+
+INFPARQUET_TARGET(avx2)
+static void avx2_insert(BloomFilter* filter, const uint64_t* hashes, uint32_t count) {
+    for (uint32_t h = 0; h < count; h++) {
+        __m256i* block = (__m256i*)filter->blocks[block_index(filter, hashes[h])].words;
+        _mm256_storeu_si256(block, _mm256_or_si256(_mm256_loadu_si256(block), avx2_mask((uint32_t)hashes[h])));
+    }
+}
+
+INFPARQUET_TARGET(avx2)
+static bool avx2_check(const BloomFilter* filter, uint64_t hash) {
+    const __m256i* block = (const __m256i*)filter->blocks[block_index(filter, hash)].words;
+    return _mm256_testc_si256(_mm256_loadu_si256(block), avx2_mask((uint32_t)hash)) != 0;
+}
+
+#endif
+
+static void insert_hashes(BloomFilter* filter, const uint64_t* hashes, uint32_t count) {
+#ifdef INFPARQUET_X86_DISPATCH
+    if (INFPARQUET_CPU_SUPPORTS(avx2)) {
+        avx2_insert(filter, hashes, count);
+        return;
+    }
+#endif
+    scalar_insert(filter, hashes, count);
+}
+
+/* Hash of a floating-point value, with -0.0 folded into 0.0 */
+static uint64_t hash_float(float value) {
+    value = value == 0.0f ? 0.0f : value;
+    return XXH64(&value, sizeof(value), 0);
+}
+
+static uint64_t hash_double(double value) {
+    value = value == 0.0 ? 0.0 : value;
+    return XXH64(&value, sizeof(value), 0);
+}
+
+static int decode_digit(char c) {
+    const char* position = c != '\0' ? strchr(BASE64, c) : NULL;
+    return position ? (int)(position - BASE64) : -1;
+}
+
+/**
+ * Get the size of a filter holding a number of distinct values
+ *
+ * With k = 8 bits per value set in a block, a filter of m bits holding n
+ * values has a false-positive rate of about (1 - e^(-8n/m))^8, which gives
+ * m = -8n / ln(1 - fpp^(1/8)).
+ */
+size_t bloom_filter_optimal_bytes(uint64_t distinct_count, double fpp, size_t max_bytes) {
+    if (max_bytes == 0) {
+        max_bytes = BLOOM_FILTER_DEFAULT_MAX_BYTES;
+    }
+    max_bytes -= max_bytes % BLOOM_FILTER_BLOCK_BYTES;
+    if (max_bytes < BLOOM_FILTER_BLOCK_BYTES) {
+        max_bytes = BLOOM_FILTER_BLOCK_BYTES;
+    }
+    if (!(fpp > 0.0 && fpp < 1.0)) {
+        fpp = BLOOM_FILTER_DEFAULT_FPP;
+    }
+
+    double bits = -8.0 * (double)distinct_count / log(1.0 - pow(fpp, 1.0 / 8.0));
+    if (!(bits < (double)max_bytes * 8.0)) {
+        return max_bytes;
+    }
+    size_t blocks = (size_t)ceil(bits / (8.0 * BLOOM_FILTER_BLOCK_BYTES));
+    return (blocks > 0 ? blocks : 1) * BLOOM_FILTER_BLOCK_BYTES;
+}
+
+/**
+ * Create an empty filter
+ */
+int bloom_filter_init(BloomFilter* filter, size_t bytes) {
+    if (!filter || bytes == 0) {
+        return 1;
+    }
+    size_t block_count = (bytes + BLOOM_FILTER_BLOCK_BYTES - 1) / BLOOM_FILTER_BLOCK_BYTES;
+    if (block_count > UINT32_MAX) {
+        return 1;
+    }
+    filter->blocks = (BloomFilterBlock*)calloc(block_count, sizeof(BloomFilterBlock));
+    if (!filter->blocks) {
+        filter->block_count = 0;
+        return 2;
+    }
+    filter->block_count = (uint32_t)block_count;
+    return 0;
+}
+
+/**
+ * Release the blocks of a filter
+ */
+void bloom_filter_free(BloomFilter* filter) {
+    if (filter) {
+        free(filter->blocks);
+        filter->blocks = NULL;
+        filter->block_count = 0;
+    }
+}
+
+/**
+ * Hash a value given as bytes
+ */
+uint64_t bloom_filter_hash(const void* value, size_t length) {
+    return XXH64(value, length, 0);
+}
+
+/**
+ * Hash a query literal as a value of a column type
+ */
+int bloom_filter_hash_literal(const char* literal, ParquetValueType type, uint64_t* hash) {
+    if (!literal || !hash) {
+        return 1;
+    }
+
+    char* end = NULL;
+    errno = 0;
+    switch (type) {
+        case PARQUET_INT32: {
+            long long value = strtoll(literal, &end, 10);
+            if (end == literal || *end != '\0' || errno != 0 || value < INT32_MIN || value > INT32_MAX) {
+                return 1;
+            }
+            int32_t plain = (int32_t)value;
+            *hash = XXH64(&plain, sizeof(plain), 0);
+            return 0;
+        }
+        case PARQUET_INT64: {
+            long long value = strtoll(literal, &end, 10);
+            if (end == literal || *end != '\0' || errno != 0) {
+                return 1;
+            }
+            int64_t plain = (int64_t)value;
+            *hash = XXH64(&plain, sizeof(plain), 0);
+            return 0;
+        }
+        case PARQUET_FLOAT: {
+            float value = strtof(literal, &end);
+            if (end == literal || *end != '\0' || isnan(value)) {
+                return 1;
+            }
+            *hash = hash_float(value);
+            return 0;
+        }
+        case PARQUET_DOUBLE: {
+            double value = strtod(literal, &end);
+            if (end == literal || *end != '\0' || isnan(value)) {
+                return 1;
+            }
+            *hash = hash_double(value);
+            return 0;
+        }
+        case PARQUET_BYTE_ARRAY:
+        case PARQUET_FIXED_LEN_BYTE_ARRAY:
+        case PARQUET_STRING:
+        case PARQUET_BINARY:
+            *hash = XXH64(literal, strlen(literal), 0);
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Insert a hash
+ */
+void bloom_filter_insert(BloomFilter* filter, uint64_t hash) {
+    if (filter && filter->block_count > 0) {
+        insert_hashes(filter, &hash, 1);
+    }
+}
+
+/**
+ * Check whether a hash may have been inserted
+ */
+bool bloom_filter_check(const BloomFilter* filter, uint64_t hash) {
+    if (!filter || filter->block_count == 0) {
+        return true;
+    }
+#ifdef INFPARQUET_X86_DISPATCH
+    if (INFPARQUET_CPU_SUPPORTS(avx2)) {
+        return avx2_check(filter, hash);
+    }
+#endif
+    return scalar_check(filter, hash);
+}
+
+/**
+ * Insert an array of fixed-width values
+ */
+int bloom_filter_add_values(BloomFilter* filter, const void* values, uint64_t value_count,
+                            ParquetValueType type) {
+    if (!filter || filter->block_count == 0 || (!values && value_count > 0)) {
+        return 1;
+    }
+    if (type != PARQUET_INT32 && type != PARQUET_INT64 && type != PARQUET_FLOAT && type != PARQUET_DOUBLE) {
+        return 1;
+    }
+
+    uint64_t hashes[HASH_BATCH];
+    uint32_t pending = 0;
+    for (uint64_t i = 0; i < value_count; i++) {
+        switch (type) {
+            case PARQUET_INT32:
+                hashes[pending++] = XXH64((const int32_t*)values + i, sizeof(int32_t), 0);
+                break;
+            case PARQUET_INT64:
+                hashes[pending++] = XXH64((const int64_t*)values + i, sizeof(int64_t), 0);
+                break;
+            case PARQUET_FLOAT: {
+                float value = ((const float*)values)[i];
+                if (!isnan(value)) {
+                    hashes[pending++] = hash_float(value);
+                }
+                break;
+            }
+            default: {
+                double value = ((const double*)values)[i];
+                if (!isnan(value)) {
+                    hashes[pending++] = hash_double(value);
+                }
+                break;
+            }
+        }
+        if (pending == HASH_BATCH) {
+            insert_hashes(filter, hashes, pending);
+            pending = 0;
+        }
+    }
+    insert_hashes(filter, hashes, pending);
+    return 0;
+}
+
+/**
+ * Get the buffer size bloom_filter_encode needs for a filter
+ */
+size_t bloom_filter_encoded_size(const BloomFilter* filter) {
+    size_t bytes = filter ? (size_t)filter->block_count * BLOOM_FILTER_BLOCK_BYTES : 0;
+    return (bytes + 2) / 3 * 4 + 1;
+}
+
+/**
+ * Encode a filter as base64 text
+ *
+ * Words are written little-endian, as in a Parquet file.
+ */
+size_t bloom_filter_encode(const BloomFilter* filter, char* text, size_t capacity) {
+    if (!filter || !text || capacity < bloom_filter_encoded_size(filter)) {
+        if (text && capacity > 0) {
+            text[0] = '\0';
+        }
+        return 0;
+    }
+
+    size_t byte_count = (size_t)filter->block_count * BLOOM_FILTER_BLOCK_BYTES;
+    size_t length = 0;
+    uint32_t group = 0;
+    int group_bytes = 0;
+    for (size_t i = 0; i < byte_count; i++) {
+        uint32_t word = filter->blocks[i / BLOOM_FILTER_BLOCK_BYTES].words[(i / 4) % BLOOM_FILTER_BLOCK_WORDS];
+        group = (group << 8) | ((word >> (8 * (i % 4))) & 0xff);
+        if (++group_bytes == 3) {
+            text[length++] = BASE64[(group >> 18) & 63];
+            text[length++] = BASE64[(group >> 12) & 63];
+            text[length++] = BASE64[(group >> 6) & 63];
+            text[length++] = BASE64[group & 63];
+            group = 0;
+            group_bytes = 0;
+        }
+    }
+    if (group_bytes > 0) {
+        group <<= 8 * (3 - group_bytes);
+        text[length++] = BASE64[(group >> 18) & 63];
+        text[length++] = BASE64[(group >> 12) & 63];
+        text[length++] = group_bytes == 2 ? BASE64[(group >> 6) & 63] : '=';
+        text[length++] = '=';
+    }
+    text[length] = '\0';
+    return length;
+}
+
+/**
+ * Decode a filter encoded by bloom_filter_encode
+ */
+int bloom_filter_decode(BloomFilter* filter, const char* text) {
+    if (!filter || !text) {
+        return 1;
+    }
+    bloom_filter_free(filter);
+
+    size_t length = strlen(text);
+    if (length == 0 || length % 4 != 0) {
+        return 1;
+    }
+    size_t padding = text[length - 1] == '=' ? (text[length - 2] == '=' ? 2 : 1) : 0;
+    size_t byte_count = length / 4 * 3 - padding;
+    if (byte_count % BLOOM_FILTER_BLOCK_BYTES != 0) {
+        return 1;
+    }
+
+    BloomFilter decoded;
+    int error = bloom_filter_init(&decoded, byte_count);
+    if (error != 0) {
+        return error;
+    }
+    uint8_t* bytes = (uint8_t*)decoded.blocks;
+    for (size_t i = 0, out = 0; i < length; i += 4) {
+        int digits[4];
+        for (int d = 0; d < 4; d++) {
+            digits[d] = text[i + d] == '=' && i + 4 == length && d >= 4 - (int)padding ? 0 : decode_digit(text[i + d]);
+            if (digits[d] < 0) {
+                bloom_filter_free(&decoded);
+                return 1;
+            }
+        }
+        uint32_t group = ((uint32_t)digits[0] << 18) | ((uint32_t)digits[1] << 12) |
+                         ((uint32_t)digits[2] << 6) | (uint32_t)digits[3];
+        for (int b = 0; b < 3 && out < byte_count; b++) {
+            bytes[out++] = (uint8_t)(group >> (16 - 8 * b));
+        }
+    }
+
+    // Little-endian words to host order
+    for (uint32_t b = 0; b < decoded.block_count; b++) {
+        for (int i = 0; i < BLOOM_FILTER_BLOCK_WORDS; i++) {
+            const uint8_t* word = (const uint8_t*)&decoded.blocks[b].words[i];
+            decoded.blocks[b].words[i] = (uint32_t)word[0] | ((uint32_t)word[1] << 8) |
+                                         ((uint32_t)word[2] << 16) | ((uint32_t)word[3] << 24);
+        }
+    }
+
+    *filter = decoded;
+    return 0;
+}
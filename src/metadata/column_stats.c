@@ -0,0 +1,502 @@
+/**
+ * column_stats.c
+ *
+ * This file implements the statistics kernels declared in column_stats.h.
+ * Every kernel updates the same accumulator: integer columns keep exact
+ * minimum, maximum and sum, while floating-point columns keep eight lanes of
+ * minimum, maximum and sum, value i going to lane i % 8. The vector kernels
+ * hold the lanes in registers (two of four doubles for AVX2, one of eight for
+ * AVX-512) and the scalar kernel in an array, so each lane sees the same
+ * values in the same order whatever the kernel.
+ *
+ * Null values are skipped with the validity bitmap, 64 values at a time:
+ * runs of fully valid blocks go to the kernel, other blocks are walked bit
+ * by bit with the scalar kernel.
+ */
+
+#include "metadata/column_stats.h"
+#include "core/platform.h"
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef INFPARQUET_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/* Lanes of the floating-point accumulators */
+#define STATS_LANES 8
+
+/* Values per validity block */
+#define VALIDITY_BLOCK 64
+
+/* Values whose integer sums are folded into the total at a time; keeps the exact sums from overflowing */
+#define SUM_BLOCK ((uint64_t)1 << 30)
+
+/**
+ * Running statistics shared by every kernel
+ */
+typedef struct {
+    double lane_sum[STATS_LANES];
+    double lane_min[STATS_LANES];   /* Comparisons keep the accumulator on ties and NaN, as minpd does */
+    double lane_max[STATS_LANES];
+    int64_t int_min;
+    int64_t int_max;
+    int64_t int_sum;                /* Sum of the current block of BOOLEAN and INT32 values */
+    uint64_t sum_low;               /* Low 32 bits of the current block of INT64 values, summed */
+    uint64_t sum_high;              /* High 32 bits, summed as unsigned */
+    uint64_t sum_negative;          /* Negative values, each short by 2^64 in the two sums above */
+    double total;                   /* Integer sums of the finished blocks */
+    uint64_t count;
+    uint64_t null_count;
+} Accumulator;
+
+typedef void (*StatsKernel)(const void* values, uint64_t first, uint64_t count,
+                            ParquetValueType type, Accumulator* acc);
+
+static void accumulator_init(Accumulator* acc) {
+    memset(acc, 0, sizeof(Accumulator));
+    for (int lane = 0; lane < STATS_LANES; lane++) {
+        acc->lane_min[lane] = INFINITY;
+        acc->lane_max[lane] = -INFINITY;
+    }
+    acc->int_min = INT64_MAX;
+    acc->int_max = INT64_MIN;
+}
+
+/* Fold the exact integer sums of a block into the total */
+static void accumulator_flush(Accumulator* acc) {
+    // sum = sum_low + sum_high * 2^32 - sum_negative * 2^64, carried so only the last step rounds
+    uint64_t high = acc->sum_high + (acc->sum_low >> 32);
+    int64_t upper = (int64_t)high - (int64_t)(acc->sum_negative << 32);
+    acc->total += (double)acc->int_sum + ldexp((double)upper, 32) + (double)(acc->sum_low & 0xffffffffu);
+    acc->int_sum = 0;
+    acc->sum_low = 0;
+    acc->sum_high = 0;
+    acc->sum_negative = 0;
+}
+
+static void update_int(Accumulator* acc, int64_t value) {
+    if (value < acc->int_min) acc->int_min = value;
+    if (value > acc->int_max) acc->int_max = value;
+}
+
+static void update_double(Accumulator* acc, uint64_t index, double value) {
+    int lane = (int)(index % STATS_LANES);
+    bool valid = value == value;
+    acc->lane_sum[lane] += valid ? value : 0.0;
+    acc->lane_min[lane] = value < acc->lane_min[lane] ? value : acc->lane_min[lane];
+    acc->lane_max[lane] = value > acc->lane_max[lane] ? value : acc->lane_max[lane];
+    acc->count += valid;
+    acc->null_count += !valid;
+}
+
+/**
+ * Scalar kernel
+ */
+static void scalar_kernel(const void* values, uint64_t first, uint64_t count,
+                          ParquetValueType type, Accumulator* acc) {
+    uint64_t end = first + count;
+    switch (type) {
+        case PARQUET_BOOLEAN: {
+            const uint8_t* data = (const uint8_t*)values;
+            for (uint64_t i = first; i < end; i++) {
+                int64_t value = data[i] != 0;
+                update_int(acc, value);
+                acc->int_sum += value;
+            }
+            acc->count += count;
+            break;
+        }
+        case PARQUET_INT32: {
+            const int32_t* data = (const int32_t*)values;
+            for (uint64_t i = first; i < end; i++) {
+                update_int(acc, data[i]);
+                acc->int_sum += data[i];
+            }
+            acc->count += count;
+            break;
+        }
+        case PARQUET_INT64: {
+            const int64_t* data = (const int64_t*)values;
+            for (uint64_t i = first; i < end; i++) {
+                update_int(acc, data[i]);
+                acc->sum_low += (uint64_t)data[i] & 0xffffffffu;
+                acc->sum_high += (uint64_t)data[i] >> 32;
+                acc->sum_negative += data[i] < 0;
+            }
+            acc->count += count;
+            break;
+        }
+        case PARQUET_FLOAT: {
+            const float* data = (const float*)values;
+            for (uint64_t i = first; i < end; i++) {
+                update_double(acc, i, (double)data[i]);
+            }
+            break;
+        }
+        case PARQUET_DOUBLE: {
+            const double* data = (const double*)values;
+            for (uint64_t i = first; i < end; i++) {
+                update_double(acc, i, data[i]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+#ifdef INFPARQUET_X86_DISPATCH
+
+/**
+ * AVX2 kernel
+ *
+ * first must be a multiple of the lane count; the tail goes to the scalar kernel.
+ */
+INFPARQUET_TARGET(avx2)
+static void avx2_kernel(const void* values, uint64_t first, uint64_t count,
+                        ParquetValueType type, Accumulator* acc) {
+    uint64_t vector_count = count & ~(uint64_t)(STATS_LANES - 1);
+    uint64_t end = first + vector_count;
+
+    switch (type) {
+        case PARQUET_INT32: {
+            const int32_t* data = (const int32_t*)values;
+            __m256i min = _mm256_set1_epi32(INT32_MAX);
+            __m256i max = _mm256_set1_epi32(INT32_MIN);
+            __m256i sum_lo = _mm256_setzero_si256();
+            __m256i sum_hi = _mm256_setzero_si256();
+            for (uint64_t i = first; i < end; i += 8) {
+                __m256i x = _mm256_loadu_si256((const __m256i*)(data + i));
+                min = _mm256_min_epi32(min, x);
+                max = _mm256_max_epi32(max, x);
+                sum_lo = _mm256_add_epi64(sum_lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+                sum_hi = _mm256_add_epi64(sum_hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+            }
+            if (vector_count > 0) {
+                int32_t mins[8], maxs[8];
+                int64_t sums[4];
+                _mm256_storeu_si256((__m256i*)mins, min);
+                _mm256_storeu_si256((__m256i*)maxs, max);
+                _mm256_storeu_si256((__m256i*)sums, _mm256_add_epi64(sum_lo, sum_hi));
+                for (int lane = 0; lane < 8; lane++) {
+                    update_int(acc, mins[lane]);
+                    update_int(acc, maxs[lane]);
+                }
+                acc->int_sum += sums[0] + sums[1] + sums[2] + sums[3];
+                acc->count += vector_count;
+            }
+            break;
+        }
+        case PARQUET_INT64: {
+            const int64_t* data = (const int64_t*)values;
+            const __m256i low_mask = _mm256_set1_epi64x(0xffffffff);
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i min = _mm256_set1_epi64x(INT64_MAX);
+            __m256i max = _mm256_set1_epi64x(INT64_MIN);
+            __m256i sum_low = zero, sum_high = zero, negative = zero;
+            for (uint64_t i = first; i < end; i += 4) {
+                __m256i x = _mm256_loadu_si256((const __m256i*)(data + i));
+                min = _mm256_blendv_epi8(min, x, _mm256_cmpgt_epi64(min, x));
+                max = _mm256_blendv_epi8(max, x, _mm256_cmpgt_epi64(x, max));
+                sum_low = _mm256_add_epi64(sum_low, _mm256_and_si256(x, low_mask));
+                sum_high = _mm256_add_epi64(sum_high, _mm256_srli_epi64(x, 32));
+                negative = _mm256_sub_epi64(negative, _mm256_cmpgt_epi64(zero, x));
+            }
+            if (vector_count > 0) {
+                int64_t mins[4], maxs[4];
+                uint64_t lows[4], highs[4], negatives[4];
+                _mm256_storeu_si256((__m256i*)mins, min);
+                _mm256_storeu_si256((__m256i*)maxs, max);
+                _mm256_storeu_si256((__m256i*)lows, sum_low);
+                _mm256_storeu_si256((__m256i*)highs, sum_high);
+                _mm256_storeu_si256((__m256i*)negatives, negative);
+                for (int lane = 0; lane < 4; lane++) {
+                    update_int(acc, mins[lane]);
+                    update_int(acc, maxs[lane]);
+                    acc->sum_low += lows[lane];
+                    acc->sum_high += highs[lane];
+                    acc->sum_negative += negatives[lane];
+                }
+                acc->count += vector_count;
+            }
+            break;
+        }
+        case PARQUET_FLOAT:
+        case PARQUET_DOUBLE: {
+            __m256d sum[2], min[2], max[2];
+            for (int half = 0; half < 2; half++) {
+                sum[half] = _mm256_loadu_pd(acc->lane_sum + half * 4);
+                min[half] = _mm256_loadu_pd(acc->lane_min + half * 4);
+                max[half] = _mm256_loadu_pd(acc->lane_max + half * 4);
+            }
+            uint64_t nulls = 0;
+            for (uint64_t i = first; i < end; i += 8) {
+                __m256d x[2];
+                if (type == PARQUET_FLOAT) {
+                    __m256 f = _mm256_loadu_ps((const float*)values + i);
+                    x[0] = _mm256_cvtps_pd(_mm256_castps256_ps128(f));
+                    x[1] = _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1));
+                } else {
+                    x[0] = _mm256_loadu_pd((const double*)values + i);
+                    x[1] = _mm256_loadu_pd((const double*)values + i + 4);
+                }
+                for (int half = 0; half < 2; half++) {
+                    __m256d ordered = _mm256_cmp_pd(x[half], x[half], _CMP_ORD_Q);
+                    sum[half] = _mm256_add_pd(sum[half], _mm256_and_pd(x[half], ordered));
+                    min[half] = _mm256_min_pd(x[half], min[half]);
+                    max[half] = _mm256_max_pd(x[half], max[half]);
+                    nulls += 4 - INFPARQUET_POPCOUNT(_mm256_movemask_pd(ordered));
+                }
+            }
+            for (int half = 0; half < 2; half++) {
+                _mm256_storeu_pd(acc->lane_sum + half * 4, sum[half]);
+                _mm256_storeu_pd(acc->lane_min + half * 4, min[half]);
+                _mm256_storeu_pd(acc->lane_max + half * 4, max[half]);
+            }
+            acc->count += vector_count - nulls;
+            acc->null_count += nulls;
+            break;
+        }
+        default:
+            end = first;
+            break;
+    }
+
+    scalar_kernel(values, end, first + count - end, type, acc);
+}
+
+/**
+ * AVX-512 kernel
+ *
+ * first must be a multiple of the lane count; the tail goes to the scalar kernel.
+ */
+INFPARQUET_TARGET(avx512f)
+static void avx512_kernel(const void* values, uint64_t first, uint64_t count,
+                          ParquetValueType type, Accumulator* acc) {
+    uint64_t end;
+
+    switch (type) {
+        case PARQUET_INT32: {
+            const int32_t* data = (const int32_t*)values;
+            uint64_t vector_count = count & ~(uint64_t)15;
+            end = first + vector_count;
+            __m512i min = _mm512_set1_epi32(INT32_MAX);
+            __m512i max = _mm512_set1_epi32(INT32_MIN);
+            __m512i sum = _mm512_setzero_si512();
+            for (uint64_t i = first; i < end; i += 16) {
+                __m512i x = _mm512_loadu_si512((const void*)(data + i));
+                min = _mm512_min_epi32(min, x);
+                max = _mm512_max_epi32(max, x);
+                sum = _mm512_add_epi64(sum, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x)));
+                sum = _mm512_add_epi64(sum, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1)));
+            }
+            if (vector_count > 0) {
+                update_int(acc, _mm512_reduce_min_epi32(min));
+                update_int(acc, _mm512_reduce_max_epi32(max));
+                acc->int_sum += _mm512_reduce_add_epi64(sum);
+                acc->count += vector_count;
+            }
+            break;
+        }
+        case PARQUET_INT64: {
+            const int64_t* data = (const int64_t*)values;
+            uint64_t vector_count = count & ~(uint64_t)7;
+            end = first + vector_count;
+            const __m512i low_mask = _mm512_set1_epi64(0xffffffff);
+            __m512i min = _mm512_set1_epi64(INT64_MAX);
+            __m512i max = _mm512_set1_epi64(INT64_MIN);
+            __m512i sum_low = _mm512_setzero_si512();
+            __m512i sum_high = _mm512_setzero_si512();
+            uint64_t negative = 0;
+            for (uint64_t i = first; i < end; i += 8) {
+                __m512i x = _mm512_loadu_si512((const void*)(data + i));
+                min = _mm512_min_epi64(min, x);
+                max = _mm512_max_epi64(max, x);
+                sum_low = _mm512_add_epi64(sum_low, _mm512_and_si512(x, low_mask));
+                sum_high = _mm512_add_epi64(sum_high, _mm512_srli_epi64(x, 32));
+                negative += INFPARQUET_POPCOUNT(_mm512_cmplt_epi64_mask(x, _mm512_setzero_si512()));
+            }
+            if (vector_count > 0) {
+                update_int(acc, _mm512_reduce_min_epi64(min));
+                update_int(acc, _mm512_reduce_max_epi64(max));
+                acc->sum_low += (uint64_t)_mm512_reduce_add_epi64(sum_low);
+                acc->sum_high += (uint64_t)_mm512_reduce_add_epi64(sum_high);
+                acc->sum_negative += negative;
+                acc->count += vector_count;
+            }
+            break;
+        }
+        case PARQUET_FLOAT:
+        case PARQUET_DOUBLE: {
+            uint64_t vector_count = count & ~(uint64_t)(STATS_LANES - 1);
+            end = first + vector_count;
+            __m512d sum = _mm512_loadu_pd(acc->lane_sum);
+            __m512d min = _mm512_loadu_pd(acc->lane_min);
+            __m512d max = _mm512_loadu_pd(acc->lane_max);
+            uint64_t valid = 0;
+            for (uint64_t i = first; i < end; i += 8) {
+                __m512d x = type == PARQUET_FLOAT
+                    ? _mm512_cvtps_pd(_mm256_loadu_ps((const float*)values + i))
+                    : _mm512_loadu_pd((const double*)values + i);
+                __mmask8 ordered = _mm512_cmp_pd_mask(x, x, _CMP_ORD_Q);
+                sum = _mm512_add_pd(sum, _mm512_maskz_mov_pd(ordered, x));
+                min = _mm512_min_pd(x, min);
+                max = _mm512_max_pd(x, max);
+                valid += INFPARQUET_POPCOUNT(ordered);
+            }
+            _mm512_storeu_pd(acc->lane_sum, sum);
+            _mm512_storeu_pd(acc->lane_min, min);
+            _mm512_storeu_pd(acc->lane_max, max);
+            acc->count += valid;
+            acc->null_count += vector_count - valid;
+            break;
+        }
+        default:
+            end = first;
+            break;
+    }
+
+    scalar_kernel(values, end, first + count - end, type, acc);
+}
+
+#endif /* INFPARQUET_X86_DISPATCH */
+
+/* Validity bits of the block of values starting at first (a multiple of 64); bits past end are clear */
+static uint64_t validity_block(const uint8_t* validity, uint64_t first, uint64_t end) {
+    uint64_t bits = end - first < VALIDITY_BLOCK ? end - first : VALIDITY_BLOCK;
+    const uint8_t* bytes = validity + first / 8;
+    uint64_t block = 0;
+    for (uint64_t byte = 0; byte * 8 < bits; byte++) {
+        block |= (uint64_t)bytes[byte] << (byte * 8);
+    }
+    return bits == VALIDITY_BLOCK ? block : block & (((uint64_t)1 << bits) - 1);
+}
+
+/* Accumulate values [first, end), skipping the null ones */
+static void accumulate_range(StatsKernel kernel, const void* values, uint64_t first, uint64_t end,
+                             ParquetValueType type, const uint8_t* validity, Accumulator* acc) {
+    if (!validity) {
+        kernel(values, first, end - first, type, acc);
+        return;
+    }
+
+    uint64_t index = first;
+    while (index < end) {
+        // Hand a run of fully valid blocks to the kernel
+        uint64_t run_start = index;
+        while (index < end) {
+            uint64_t bits = end - index < VALIDITY_BLOCK ? end - index : VALIDITY_BLOCK;
+            uint64_t full = bits == VALIDITY_BLOCK ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+            if (validity_block(validity, index, end) != full) {
+                break;
+            }
+            index += bits;
+        }
+        if (index > run_start) {
+            kernel(values, run_start, index - run_start, type, acc);
+        }
+        if (index >= end) {
+            break;
+        }
+
+        // Walk a block with nulls bit by bit
+        uint64_t block = validity_block(validity, index, end);
+        uint64_t block_end = end - index < VALIDITY_BLOCK ? end : index + VALIDITY_BLOCK;
+        for (uint64_t i = index; i < block_end; i++) {
+            if (block & ((uint64_t)1 << (i - index))) {
+                scalar_kernel(values, i, 1, type, acc);
+            } else {
+                acc->null_count++;
+            }
+        }
+        index = block_end;
+    }
+}
+
+/**
+ * Get the kernel family column_stats_compute uses on this CPU
+ */
+ColumnStatsKernel column_stats_best_kernel(void) {
+#ifdef INFPARQUET_X86_DISPATCH
+    if (INFPARQUET_CPU_SUPPORTS(avx512f)) {
+        return COLUMN_STATS_AVX512;
+    }
+    if (INFPARQUET_CPU_SUPPORTS(avx2)) {
+        return COLUMN_STATS_AVX2;
+    }
+#endif
+    return COLUMN_STATS_SCALAR;
+}
+
+/**
+ * Compute the statistics of a column with a given kernel
+ */
+int column_stats_compute_with_kernel(ColumnStatsKernel kernel, const void* values, uint64_t value_count,
+                                     ParquetValueType type, const uint8_t* validity, ColumnStats* stats) {
+    if (!stats || (!values && value_count > 0)) {
+        return 1;
+    }
+    memset(stats, 0, sizeof(ColumnStats));
+    if (type != PARQUET_BOOLEAN && type != PARQUET_INT32 && type != PARQUET_INT64 &&
+        type != PARQUET_FLOAT && type != PARQUET_DOUBLE) {
+        return 1;
+    }
+
+    // Never use a kernel the CPU cannot run
+    ColumnStatsKernel best = column_stats_best_kernel();
+    if (kernel == COLUMN_STATS_AUTO || kernel > best) {
+        kernel = best;
+    }
+    StatsKernel run = scalar_kernel;
+#ifdef INFPARQUET_X86_DISPATCH
+    if (kernel == COLUMN_STATS_AVX512) {
+        run = avx512_kernel;
+    } else if (kernel == COLUMN_STATS_AVX2) {
+        run = avx2_kernel;
+    }
+#endif
+
+    Accumulator acc;
+    accumulator_init(&acc);
+    for (uint64_t first = 0; first < value_count; first += SUM_BLOCK) {
+        uint64_t end = value_count - first < SUM_BLOCK ? value_count : first + SUM_BLOCK;
+        accumulate_range(run, values, first, end, type, validity, &acc);
+        accumulator_flush(&acc);
+    }
+
+    stats->count = acc.count;
+    stats->null_count = acc.null_count;
+    if (acc.count == 0) {
+        return 0;
+    }
+
+    if (type == PARQUET_FLOAT || type == PARQUET_DOUBLE) {
+        double min = acc.lane_min[0];
+        double max = acc.lane_max[0];
+        for (int lane = 1; lane < STATS_LANES; lane++) {
+            min = acc.lane_min[lane] < min ? acc.lane_min[lane] : min;
+            max = acc.lane_max[lane] > max ? acc.lane_max[lane] : max;
+        }
+        const double* sum = acc.lane_sum;
+        stats->min = min;
+        stats->max = max;
+        stats->sum = ((sum[0] + sum[1]) + (sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+    } else {
+        stats->int_min = acc.int_min;
+        stats->int_max = acc.int_max;
+        stats->min = (double)acc.int_min;
+        stats->max = (double)acc.int_max;
+        stats->sum = acc.total;
+    }
+    return 0;
+}
+
+/**
+ * Compute the statistics of a column
+ */
+int column_stats_compute(const void* values, uint64_t value_count, ParquetValueType type,
+                         const uint8_t* validity, ColumnStats* stats) {
+    return column_stats_compute_with_kernel(COLUMN_STATS_AUTO, values, value_count, type, validity, stats);
+}
@@ -2,6 +2,7 @@
 #include "metadata/metadata_types.h"
 #include "core/parquet_structure.h"
 #include "core/parquet_reader.h"
+#include "core/platform.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -9,7 +10,7 @@
 #include <stdbool.h>
 
 /* Static global for error messages */
-static char s_error_message[256];
+static INFPARQUET_THREAD_LOCAL char s_error_message[256];
 
 /**
  * Helper function to find a JSON field in a JSON string.
@@ -0,0 +1,463 @@
+/**
+ * heavy_hitters.c
+ *
+ * This file implements the Space-Saving sketch declared in heavy_hitters.h.
+ * Monitored strings are found through a chained hash table of their hashes
+ * and kept in a stream summary: a list of buckets in increasing count order,
+ * each holding the entries with that count. Counting an occurrence moves an
+ * entry to the next bucket and replacing the least frequent entry takes the
+ * first entry of the first bucket, so both cost O(1).
+ *
+ * Merging follows Agarwal et al., "Mergeable Summaries": each string gets its
+ * count in both sketches, with the minimum count of a full sketch standing in
+ * where a string is not monitored, and the largest counts are kept.
+ */
+
+#include "metadata/heavy_hitters.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Marks the end of entry and bucket lists */
+#define NONE UINT32_MAX
+
+/**
+ * A monitored string
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t error;
+    uint32_t bucket;       /* Bucket holding the entry */
+    uint32_t prev;         /* Neighbours in the bucket */
+    uint32_t next;
+    uint32_t chain;        /* Next entry in the hash chain */
+    char value[HEAVY_HITTERS_MAX_VALUE_LENGTH + 1];
+} Entry;
+
+/**
+ * Entries sharing a count
+ */
+typedef struct {
+    uint64_t count;
+    uint32_t first;        /* First entry */
+    uint32_t prev;         /* Neighbouring buckets, by increasing count */
+    uint32_t next;
+} Bucket;
+
+struct HeavyHitterSketch {
+    Entry* entries;
+    Bucket* buckets;       /* As many as entries, since every bucket holds one */
+    uint32_t* heads;       /* First entry of each hash chain */
+    uint32_t head_mask;    /* Chains - 1; the chain count is a power of two */
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t min_bucket;   /* Bucket with the lowest count */
+    uint32_t free_bucket;  /* Unused buckets, chained through next */
+    uint64_t total;
+};
+
+/**
+ * Entry copied out while merging
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t count;
+    uint64_t error;
+    const char* value;
+} MergedEntry;
+
+static uint64_t mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+/* Hash of a string, read eight bytes at a time */
+static uint64_t hash_string(const char* value, size_t length) {
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ ((uint64_t)length * 0xc2b2ae3d27d4eb4full);
+    size_t offset = 0;
+    for (; offset + 8 <= length; offset += 8) {
+        uint64_t word;
+        memcpy(&word, value + offset, 8);
+        hash = (hash ^ mix64(word)) * 0x9fb21c651e98df25ull;
+    }
+    uint64_t tail = 0;
+    if (offset < length) {
+        memcpy(&tail, value + offset, length - offset);
+    }
+    return mix64(hash ^ tail);
+}
+
+static uint32_t find_entry(const HeavyHitterSketch* sketch, uint64_t hash) {
+    uint32_t index = sketch->heads[hash & sketch->head_mask];
+    while (index != NONE && sketch->entries[index].hash != hash) {
+        index = sketch->entries[index].chain;
+    }
+    return index;
+}
+
+static void link_hash(HeavyHitterSketch* sketch, uint32_t index) {
+    uint32_t* head = &sketch->heads[sketch->entries[index].hash & sketch->head_mask];
+    sketch->entries[index].chain = *head;
+    *head = index;
+}
+
+static void unlink_hash(HeavyHitterSketch* sketch, uint32_t index) {
+    uint32_t* link = &sketch->heads[sketch->entries[index].hash & sketch->head_mask];
+    while (*link != index) {
+        link = &sketch->entries[*link].chain;
+    }
+    *link = sketch->entries[index].chain;
+}
+
+/* Take an unused bucket with the given count and put it after prev (NONE for first) */
+static uint32_t insert_bucket(HeavyHitterSketch* sketch, uint32_t prev, uint64_t count) {
+    uint32_t index = sketch->free_bucket;
+    Bucket* bucket = &sketch->buckets[index];
+    sketch->free_bucket = bucket->next;
+
+    bucket->count = count;
+    bucket->first = NONE;
+    bucket->prev = prev;
+    bucket->next = prev == NONE ? sketch->min_bucket : sketch->buckets[prev].next;
+    if (bucket->next != NONE) {
+        sketch->buckets[bucket->next].prev = index;
+    }
+    if (prev == NONE) {
+        sketch->min_bucket = index;
+    } else {
+        sketch->buckets[prev].next = index;
+    }
+    return index;
+}
+
+static void remove_bucket(HeavyHitterSketch* sketch, uint32_t index) {
+    Bucket* bucket = &sketch->buckets[index];
+    if (bucket->prev == NONE) {
+        sketch->min_bucket = bucket->next;
+    } else {
+        sketch->buckets[bucket->prev].next = bucket->next;
+    }
+    if (bucket->next != NONE) {
+        sketch->buckets[bucket->next].prev = bucket->prev;
+    }
+    bucket->next = sketch->free_bucket;
+    sketch->free_bucket = index;
+}
+
+static void attach_entry(HeavyHitterSketch* sketch, uint32_t index, uint32_t bucket_index) {
+    Entry* entry = &sketch->entries[index];
+    Bucket* bucket = &sketch->buckets[bucket_index];
+    entry->bucket = bucket_index;
+    entry->prev = NONE;
+    entry->next = bucket->first;
+    if (bucket->first != NONE) {
+        sketch->entries[bucket->first].prev = index;
+    }
+    bucket->first = index;
+}
+
+static void detach_entry(HeavyHitterSketch* sketch, uint32_t index) {
+    Entry* entry = &sketch->entries[index];
+    Bucket* bucket = &sketch->buckets[entry->bucket];
+    if (entry->prev == NONE) {
+        bucket->first = entry->next;
+    } else {
+        sketch->entries[entry->prev].next = entry->next;
+    }
+    if (entry->next != NONE) {
+        sketch->entries[entry->next].prev = entry->prev;
+    }
+}
+
+/* Move an entry to the bucket of the next count */
+static void increment_entry(HeavyHitterSketch* sketch, uint32_t index) {
+    uint32_t current = sketch->entries[index].bucket;
+    uint64_t count = sketch->buckets[current].count + 1;
+    uint32_t next = sketch->buckets[current].next;
+    bool next_matches = next != NONE && sketch->buckets[next].count == count;
+
+    // Alone in its bucket with no bucket to join: the bucket itself moves up
+    Entry* entry = &sketch->entries[index];
+    if (entry->prev == NONE && entry->next == NONE && !next_matches) {
+        sketch->buckets[current].count = count;
+        return;
+    }
+
+    detach_entry(sketch, index);
+    uint32_t target = next_matches ? next : insert_bucket(sketch, current, count);
+    if (sketch->buckets[current].first == NONE) {
+        remove_bucket(sketch, current);
+    }
+    attach_entry(sketch, index, target);
+}
+
+static void set_value(Entry* entry, const char* value, size_t length) {
+    size_t kept = length < HEAVY_HITTERS_MAX_VALUE_LENGTH ? length : HEAVY_HITTERS_MAX_VALUE_LENGTH;
+    if (kept > 0) {
+        memcpy(entry->value, value, kept);
+    }
+    entry->value[kept] = '\0';
+}
+
+/* Forget every entry */
+static void reset_sketch(HeavyHitterSketch* sketch) {
+    for (uint32_t i = 0; i <= sketch->head_mask; i++) {
+        sketch->heads[i] = NONE;
+    }
+    for (uint32_t i = 0; i < sketch->capacity; i++) {
+        sketch->buckets[i].next = i + 1 < sketch->capacity ? i + 1 : NONE;
+    }
+    sketch->free_bucket = 0;
+    sketch->min_bucket = NONE;
+    sketch->used = 0;
+}
+
+/**
+ * Create a sketch
+ */
+HeavyHitterSketch* heavy_hitters_create(uint32_t counters) {
+    if (counters == 0) {
+        counters = HEAVY_HITTERS_DEFAULT_COUNTERS;
+    }
+    uint32_t chains = 1;
+    while (chains < counters && chains < (UINT32_MAX >> 1)) {
+        chains <<= 1;
+    }
+
+    HeavyHitterSketch* sketch = (HeavyHitterSketch*)calloc(1, sizeof(HeavyHitterSketch));
+    if (!sketch) {
+        return NULL;
+    }
+    sketch->entries = (Entry*)malloc((size_t)counters * sizeof(Entry));
+    sketch->buckets = (Bucket*)malloc((size_t)counters * sizeof(Bucket));
+    sketch->heads = (uint32_t*)malloc((size_t)chains * sizeof(uint32_t));
+    if (!sketch->entries || !sketch->buckets || !sketch->heads) {
+        heavy_hitters_free(sketch);
+        return NULL;
+    }
+    sketch->head_mask = chains - 1;
+    sketch->capacity = counters;
+    reset_sketch(sketch);
+    return sketch;
+}
+
+/**
+ * Free a sketch
+ */
+void heavy_hitters_free(HeavyHitterSketch* sketch) {
+    if (!sketch) {
+        return;
+    }
+    free(sketch->entries);
+    free(sketch->buckets);
+    free(sketch->heads);
+    free(sketch);
+}
+
+/**
+ * Empty a sketch for reuse
+ */
+void heavy_hitters_reset(HeavyHitterSketch* sketch) {
+    if (!sketch) {
+        return;
+    }
+    reset_sketch(sketch);
+    sketch->total = 0;
+}
+
+/**
+ * Count one occurrence of a string
+ */
+void heavy_hitters_add(HeavyHitterSketch* sketch, const char* value, size_t length) {
+    if (!sketch || (!value && length > 0)) {
+        return;
+    }
+    sketch->total++;
+
+    uint64_t hash = hash_string(value, length);
+    uint32_t index = find_entry(sketch, hash);
+    if (index != NONE) {
+        increment_entry(sketch, index);
+        return;
+    }
+
+    if (sketch->used < sketch->capacity) {
+        // A free counter: start it at 1
+        index = sketch->used++;
+        Entry* entry = &sketch->entries[index];
+        entry->hash = hash;
+        entry->error = 0;
+        set_value(entry, value, length);
+        link_hash(sketch, index);
+        uint32_t bucket = sketch->min_bucket;
+        if (bucket == NONE || sketch->buckets[bucket].count != 1) {
+            bucket = insert_bucket(sketch, NONE, 1);
+        }
+        attach_entry(sketch, index, bucket);
+        return;
+    }
+
+    // Replace a least frequent string; its count becomes the newcomer's error
+    index = sketch->buckets[sketch->min_bucket].first;
+    Entry* entry = &sketch->entries[index];
+    unlink_hash(sketch, index);
+    entry->hash = hash;
+    entry->error = sketch->buckets[sketch->min_bucket].count;
+    set_value(entry, value, length);
+    link_hash(sketch, index);
+    increment_entry(sketch, index);
+}
+
+/* Lowest count a string not monitored by a sketch may have */
+static uint64_t missing_count(const HeavyHitterSketch* sketch) {
+    return sketch->used < sketch->capacity || sketch->min_bucket == NONE
+        ? 0 : sketch->buckets[sketch->min_bucket].count;
+}
+
+static int compare_merged(const void* a, const void* b) {
+    const MergedEntry* left = (const MergedEntry*)a;
+    const MergedEntry* right = (const MergedEntry*)b;
+    if (left->count != right->count) {
+        return left->count > right->count ? -1 : 1;
+    }
+    if (left->error != right->error) {
+        return left->error < right->error ? -1 : 1;
+    }
+    return left->hash < right->hash ? -1 : left->hash > right->hash;
+}
+
+/**
+ * Merge another sketch into a sketch
+ */
+int heavy_hitters_merge(HeavyHitterSketch* sketch, const HeavyHitterSketch* other) {
+    if (!sketch || !other || sketch == other) {
+        return 1;
+    }
+    if (other->total == 0) {
+        return 0;
+    }
+
+    uint32_t merged_count = 0;
+    MergedEntry* merged = (MergedEntry*)malloc(((size_t)sketch->used + other->used) * sizeof(MergedEntry));
+    Entry* saved = (Entry*)malloc((size_t)sketch->used * sizeof(Entry) + 1);
+    if (!merged || !saved) {
+        free(merged);
+        free(saved);
+        return 2;
+    }
+
+    // The entries are rebuilt below, so work from a copy of this sketch's
+    uint64_t own_missing = missing_count(sketch);
+    uint64_t other_missing = missing_count(other);
+    uint32_t own_used = sketch->used;
+    memcpy(saved, sketch->entries, (size_t)own_used * sizeof(Entry));
+    for (uint32_t i = 0; i < own_used; i++) {
+        const Entry* entry = &saved[i];
+        uint64_t count = sketch->buckets[entry->bucket].count;
+        uint32_t match = find_entry(other, entry->hash);
+        MergedEntry* item = &merged[merged_count++];
+        item->hash = entry->hash;
+        item->value = entry->value;
+        if (match != NONE) {
+            item->count = count + other->buckets[other->entries[match].bucket].count;
+            item->error = entry->error + other->entries[match].error;
+        } else {
+            item->count = count + other_missing;
+            item->error = entry->error + other_missing;
+        }
+    }
+    for (uint32_t i = 0; i < other->used; i++) {
+        const Entry* entry = &other->entries[i];
+        if (find_entry(sketch, entry->hash) != NONE) {
+            continue;
+        }
+        MergedEntry* item = &merged[merged_count++];
+        item->hash = entry->hash;
+        item->value = entry->value;
+        item->count = other->buckets[entry->bucket].count + own_missing;
+        item->error = entry->error + own_missing;
+    }
+
+    // Keep the largest counts, then rebuild the buckets from the smallest up
+    qsort(merged, merged_count, sizeof(MergedEntry), compare_merged);
+    uint32_t kept = merged_count < sketch->capacity ? merged_count : sketch->capacity;
+    reset_sketch(sketch);
+    uint32_t last_bucket = NONE;
+    for (uint32_t i = kept; i-- > 0;) {
+        const MergedEntry* item = &merged[i];
+        uint32_t index = sketch->used++;
+        Entry* entry = &sketch->entries[index];
+        entry->hash = item->hash;
+        entry->error = item->error;
+        memcpy(entry->value, item->value, sizeof(entry->value));
+        link_hash(sketch, index);
+        if (last_bucket == NONE || sketch->buckets[last_bucket].count != item->count) {
+            last_bucket = insert_bucket(sketch, last_bucket, item->count);
+        }
+        attach_entry(sketch, index, last_bucket);
+    }
+    sketch->total += other->total;
+
+    free(merged);
+    free(saved);
+    return 0;
+}
+
+/**
+ * Get the number of strings counted by a sketch
+ */
+uint64_t heavy_hitters_total(const HeavyHitterSketch* sketch) {
+    return sketch ? sketch->total : 0;
+}
+
+static int compare_hitters(const void* a, const void* b) {
+    const HeavyHitter* left = (const HeavyHitter*)a;
+    const HeavyHitter* right = (const HeavyHitter*)b;
+    if (left->count != right->count) {
+        return left->count > right->count ? -1 : 1;
+    }
+    if (left->error != right->error) {
+        return left->error < right->error ? -1 : 1;
+    }
+    return strcmp(left->value, right->value);
+}
+
+/**
+ * Get the most frequent strings of a sketch
+ */
+uint32_t heavy_hitters_top(const HeavyHitterSketch* sketch, HeavyHitter* items, uint32_t max_items) {
+    if (!sketch || !items || max_items == 0) {
+        return 0;
+    }
+
+    // Walk the buckets from the highest count down, keeping the window sorted
+    uint32_t written = 0;
+    uint32_t bucket = sketch->min_bucket;
+    while (bucket != NONE && sketch->buckets[bucket].next != NONE) {
+        bucket = sketch->buckets[bucket].next;
+    }
+    for (; bucket != NONE && written < max_items; bucket = sketch->buckets[bucket].prev) {
+        for (uint32_t index = sketch->buckets[bucket].first; index != NONE; index = sketch->entries[index].next) {
+            const Entry* entry = &sketch->entries[index];
+            HeavyHitter candidate = {entry->value, sketch->buckets[bucket].count, entry->error};
+            uint32_t position = written;
+            while (position > 0 && compare_hitters(&candidate, &items[position - 1]) < 0) {
+                position--;
+            }
+            if (position >= max_items) {
+                continue;
+            }
+            uint32_t moved = (written < max_items ? written : max_items - 1) - position;
+            memmove(items + position + 1, items + position, (size_t)moved * sizeof(HeavyHitter));
+            items[position] = candidate;
+            if (written < max_items) {
+                written++;
+            }
+        }
+    }
+    return written;
+}
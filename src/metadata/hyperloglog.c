@@ -0,0 +1,328 @@
+/**
+ * hyperloglog.c
+ *
+ * This file implements the HyperLogLog sketch declared in hyperloglog.h.
+ * The top HYPERLOGLOG_PRECISION bits of a value's 64-bit hash select a
+ * register, which keeps the largest rank (leading zeros plus one) seen in
+ * the remaining bits.
+ *
+ * The estimate follows Ertl, "New cardinality estimation algorithms for
+ * HyperLogLog sketches": it is computed from the histogram of register
+ * values and stays unbiased from empty sketches up to billions of distinct
+ * values, without the bias tables and linear-counting switch of the
+ * original estimator.
+ */
+
+#include "metadata/hyperloglog.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Hash bits left after the register index, and the largest register value */
+#define HASH_BITS (64 - HYPERLOGLOG_PRECISION)
+#define MAX_RANK (HASH_BITS + 1)
+
+/* Register values as text; every value up to MAX_RANK is one character */
+static const char ENCODING[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/* Marks a run of equal registers in the text */
+#define RUN_MARK '*'
+
+/* Runs shorter than this are written out register by register */
+#define MIN_RUN 4
+
+static uint64_t mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+/* Hash of a byte string, read eight bytes at a time */
+static uint64_t hash_bytes(const uint8_t* value, size_t length) {
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ ((uint64_t)length * 0xc2b2ae3d27d4eb4full);
+    size_t offset = 0;
+    for (; offset + 8 <= length; offset += 8) {
+        uint64_t word;
+        memcpy(&word, value + offset, 8);
+        hash = (hash ^ mix64(word)) * 0x9fb21c651e98df25ull;
+    }
+    uint64_t tail = 0;
+    if (offset < length) {
+        memcpy(&tail, value + offset, length - offset);
+    }
+    return mix64(hash ^ tail);
+}
+
+/* Hash of a fixed-width value's key; the constant keeps key 0 away from hash 0 */
+static uint64_t hash_key(uint64_t key) {
+    return mix64(key ^ 0x9e3779b97f4a7c15ull);
+}
+
+static void add_hash(HyperLogLog* sketch, uint64_t hash) {
+    uint32_t index = (uint32_t)(hash >> HASH_BITS);
+    uint64_t rest = hash << HYPERLOGLOG_PRECISION;
+    uint8_t rank;
+    if (rest == 0) {
+        rank = MAX_RANK;
+    } else {
+#if defined(__GNUC__) || defined(__clang__)
+        rank = (uint8_t)(__builtin_clzll(rest) + 1);
+#else
+        rank = 1;
+        while (!(rest & (1ull << 63))) {
+            rest <<= 1;
+            rank++;
+        }
+#endif
+    }
+    if (sketch->registers[index] < rank) {
+        sketch->registers[index] = rank;
+    }
+}
+
+/* Key of a floating-point value: the bits of the double, with -0.0 folded into 0.0 */
+static uint64_t double_key(double value) {
+    uint64_t key;
+    value = value == 0.0 ? 0.0 : value;
+    memcpy(&key, &value, sizeof(key));
+    return key;
+}
+
+static double sigma(double x) {
+    if (x == 1.0) {
+        return INFINITY;
+    }
+    double y = 1.0;
+    double z = x;
+    double previous;
+    do {
+        x *= x;
+        previous = z;
+        z += x * y;
+        y += y;
+    } while (z != previous);
+    return z;
+}
+
+static double tau(double x) {
+    if (x == 0.0 || x == 1.0) {
+        return 0.0;
+    }
+    double y = 1.0;
+    double z = 1.0 - x;
+    double previous;
+    do {
+        x = sqrt(x);
+        previous = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != previous);
+    return z / 3.0;
+}
+
+static int decode_digit(char c) {
+    const char* position = c != '\0' ? strchr(ENCODING, c) : NULL;
+    return position ? (int)(position - ENCODING) : -1;
+}
+
+/**
+ * Initialize an empty sketch
+ */
+void hyperloglog_init(HyperLogLog* sketch) {
+    if (sketch) {
+        memset(sketch->registers, 0, sizeof(sketch->registers));
+    }
+}
+
+/**
+ * Add a value given as bytes
+ */
+void hyperloglog_add(HyperLogLog* sketch, const void* value, size_t length) {
+    if (!sketch || (!value && length > 0)) {
+        return;
+    }
+    add_hash(sketch, hash_bytes((const uint8_t*)value, length));
+}
+
+/**
+ * Add an array of fixed-width values
+ */
+int hyperloglog_add_values(HyperLogLog* sketch, const void* values, uint64_t value_count,
+                           ParquetValueType type) {
+    if (!sketch || (!values && value_count > 0)) {
+        return 1;
+    }
+
+    switch (type) {
+        case PARQUET_BOOLEAN: {
+            const bool* data = (const bool*)values;
+            for (uint64_t i = 0; i < value_count; i++) {
+                add_hash(sketch, hash_key(data[i] ? 1 : 0));
+            }
+            return 0;
+        }
+        case PARQUET_INT32: {
+            const int32_t* data = (const int32_t*)values;
+            for (uint64_t i = 0; i < value_count; i++) {
+                add_hash(sketch, hash_key((uint64_t)(int64_t)data[i]));
+            }
+            return 0;
+        }
+        case PARQUET_INT64: {
+            const int64_t* data = (const int64_t*)values;
+            for (uint64_t i = 0; i < value_count; i++) {
+                add_hash(sketch, hash_key((uint64_t)data[i]));
+            }
+            return 0;
+        }
+        case PARQUET_FLOAT: {
+            const float* data = (const float*)values;
+            for (uint64_t i = 0; i < value_count; i++) {
+                if (!isnan(data[i])) {
+                    add_hash(sketch, hash_key(double_key(data[i])));
+                }
+            }
+            return 0;
+        }
+        case PARQUET_DOUBLE: {
+            const double* data = (const double*)values;
+            for (uint64_t i = 0; i < value_count; i++) {
+                if (!isnan(data[i])) {
+                    add_hash(sketch, hash_key(double_key(data[i])));
+                }
+            }
+            return 0;
+        }
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Merge another sketch into a sketch
+ */
+void hyperloglog_merge(HyperLogLog* sketch, const HyperLogLog* other) {
+    if (!sketch || !other) {
+        return;
+    }
+    for (uint32_t i = 0; i < HYPERLOGLOG_REGISTERS; i++) {
+        if (sketch->registers[i] < other->registers[i]) {
+            sketch->registers[i] = other->registers[i];
+        }
+    }
+}
+
+/**
+ * Estimate the number of distinct values added to a sketch
+ */
+uint64_t hyperloglog_estimate(const HyperLogLog* sketch) {
+    if (!sketch) {
+        return 0;
+    }
+
+    uint32_t histogram[MAX_RANK + 1] = {0};
+    for (uint32_t i = 0; i < HYPERLOGLOG_REGISTERS; i++) {
+        uint8_t value = sketch->registers[i] <= MAX_RANK ? sketch->registers[i] : MAX_RANK;
+        histogram[value]++;
+    }
+    if (histogram[0] == HYPERLOGLOG_REGISTERS) {
+        return 0;
+    }
+
+    const double m = (double)HYPERLOGLOG_REGISTERS;
+    double z = m * tau(1.0 - histogram[MAX_RANK] / m);
+    for (int k = HASH_BITS; k >= 1; k--) {
+        z = 0.5 * (z + histogram[k]);
+    }
+    z += m * sigma(histogram[0] / m);
+
+    // alpha_inf * m^2 / z, with alpha_inf = 1 / (2 ln 2)
+    double estimate = m * m / (2.0 * log(2.0) * z);
+    if (!(estimate < 18446744073709551615.0)) {
+        return UINT64_MAX;
+    }
+    return (uint64_t)llround(estimate);
+}
+
+/**
+ * Encode a sketch as text
+ */
+size_t hyperloglog_encode(const HyperLogLog* sketch, char* text, size_t capacity) {
+    if (!sketch || !text || capacity == 0) {
+        return 0;
+    }
+
+    size_t length = 0;
+    uint32_t i = 0;
+    while (i < HYPERLOGLOG_REGISTERS) {
+        uint8_t value = sketch->registers[i] <= MAX_RANK ? sketch->registers[i] : MAX_RANK;
+        uint32_t run = 1;
+        while (i + run < HYPERLOGLOG_REGISTERS && sketch->registers[i + run] == sketch->registers[i]) {
+            run++;
+        }
+
+        if (run >= MIN_RUN) {
+            // Character, mark and run length - 1 in two digits (runs never exceed 64 * 64 registers)
+            if (length + 4 >= capacity) {
+                text[0] = '\0';
+                return 0;
+            }
+            text[length++] = ENCODING[value];
+            text[length++] = RUN_MARK;
+            text[length++] = ENCODING[(run - 1) / 64];
+            text[length++] = ENCODING[(run - 1) % 64];
+            i += run;
+        } else {
+            if (length + 1 >= capacity) {
+                text[0] = '\0';
+                return 0;
+            }
+            text[length++] = ENCODING[value];
+            i++;
+        }
+    }
+    text[length] = '\0';
+    return length;
+}
+
+/**
+ * Decode a sketch encoded by hyperloglog_encode
+ */
+int hyperloglog_decode(HyperLogLog* sketch, const char* text) {
+    if (!sketch || !text) {
+        return 1;
+    }
+
+    HyperLogLog decoded;
+    uint32_t count = 0;
+    while (*text) {
+        int value = decode_digit(*text++);
+        if (value < 0 || value > MAX_RANK) {
+            return 1;
+        }
+        uint32_t run = 1;
+        if (*text == RUN_MARK) {
+            int high = decode_digit(text[1]);
+            int low = high >= 0 ? decode_digit(text[2]) : -1;
+            if (low < 0) {
+                return 1;
+            }
+            run = (uint32_t)(high * 64 + low) + 1;
+            text += 3;
+        }
+        if (run > HYPERLOGLOG_REGISTERS - count) {
+            return 1;
+        }
+        memset(decoded.registers + count, value, run);
+        count += run;
+    }
+    if (count != HYPERLOGLOG_REGISTERS) {
+        return 1;
+    }
+
+    *sketch = decoded;
+    return 0;
+}
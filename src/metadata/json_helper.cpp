@@ -11,23 +11,68 @@
 using json = nlohmann::json;
 
 // Static error message buffer
-static char s_error_message[1024] = {0};
+static thread_local char s_error_message[1024] = {0};
 
 // Set the error message
-static void set_error(const char* format, ...) {
+static void set_helper_error(const char* format, ...) {
     va_list args;
     va_start(args, format);
     vsnprintf(s_error_message, sizeof(s_error_message), format, args);
     va_end(args);
 }
 
+// Convert a quantile digest to JSON
+static json quantile_sketch_to_json(const QuantileSketch& sketch) {
+    json centroids = json::array();
+    for (uint32_t i = 0; i < sketch.centroid_count; i++) {
+        centroids.push_back(json::array({sketch.centroids[i].mean, sketch.centroids[i].weight}));
+    }
+    return {
+        {"count", sketch.count},
+        {"min", sketch.min},
+        {"max", sketch.max},
+        {"centroids", centroids}
+    };
+}
+
+// Convert JSON to a quantile digest; a missing or malformed one leaves the digest empty
+static void json_to_quantile_sketch(const json& j, QuantileSketch& sketch) {
+    quantile_sketch_init(&sketch);
+    const json& centroids = j.value("centroids", json::array());
+    if (!centroids.is_array() || centroids.size() > QUANTILE_SKETCH_MAX_CENTROIDS) {
+        return;
+    }
+    for (size_t i = 0; i < centroids.size(); i++) {
+        if (!centroids[i].is_array() || centroids[i].size() != 2) {
+            quantile_sketch_init(&sketch);
+            return;
+        }
+        sketch.centroids[i].mean = centroids[i][0].get<double>();
+        sketch.centroids[i].weight = centroids[i][1].get<uint64_t>();
+    }
+    sketch.centroid_count = static_cast<uint32_t>(centroids.size());
+    sketch.count = j.value("count", (uint64_t)0);
+    sketch.min = j.value("min", 0.0);
+    sketch.max = j.value("max", 0.0);
+}
+
 // Convert timestamp metadata to JSON
 static void timestamp_to_json(json& j, const TimestampMetadata& metadata) {
     j = {
         {"min_timestamp", metadata.min_timestamp},
         {"max_timestamp", metadata.max_timestamp},
-        {"count", metadata.count}
+        {"count", metadata.count},
+        {"quantile_sketch", quantile_sketch_to_json(metadata.quantiles)}
     };
+
+    // Percentiles of timestamps known only from footer statistics are unavailable
+    if (metadata.from_footer) {
+        j["from_footer"] = true;
+    } else {
+        j["p50"] = metadata.p50;
+        j["p95"] = metadata.p95;
+        j["p99"] = metadata.p99;
+    }
 }
 
 // Convert string metadata to JSON
@@ -43,11 +88,21 @@ static void string_to_json(json& j, const StringMetadata& metadata) {
         {"avg_string_length", metadata.avg_string_length}
     };
 
+    // Counts estimated from a row sample are marked with the rate
+    if (metadata.is_sampled) {
+        j["sampled"] = true;
+        j["sample_rate"] = metadata.sample_rate;
+        j["special_string_errors"] = json::array();
+    }
+
     // Add high frequency strings
     for (uint32_t i = 0; i < metadata.high_freq_count; i++) {
         json str_item;
         str_item["string"] = metadata.high_freq_strings[i].string;
         str_item["count"] = metadata.high_freq_strings[i].count;
+        if (metadata.is_sampled) {
+            str_item["count_error"] = metadata.sample_errors[i];
+        }
         j["high_freq_strings"].push_back(str_item);
         j["high_freq_counts"].push_back(metadata.high_freq_strings[i].count);
     }
@@ -56,6 +111,9 @@ static void string_to_json(json& j, const StringMetadata& metadata) {
     for (uint32_t i = 0; i < metadata.special_string_count; i++) {
         j["special_strings"].push_back(metadata.special_strings[i]);
         j["special_string_counts"].push_back(metadata.special_string_counts[i]);
+        if (metadata.is_sampled) {
+            j["special_string_errors"].push_back(metadata.special_string_errors[i]);
+        }
     }
 }
 
@@ -64,12 +122,29 @@ static void numeric_to_json(json& j, const NumericMetadata& metadata) {
     j = {
         {"min_value", metadata.min_value},
         {"max_value", metadata.max_value},
-        {"avg_value", metadata.avg_value},
-        {"mode_value", metadata.mode_value},
-        {"mode_count", metadata.mode_count},
         {"total_count", metadata.total_count},
-        {"null_count", metadata.null_count}
+        {"null_count", metadata.null_count},
+        {"quantile_sketch", quantile_sketch_to_json(metadata.quantiles)}
     };
+
+    // Values known only from footer statistics leave mean, mode and percentiles unavailable
+    if (metadata.from_footer) {
+        j["from_footer"] = true;
+        return;
+    }
+    j["avg_value"] = metadata.avg_value;
+    j["mode_value"] = metadata.mode_value;
+    j["mode_count"] = metadata.mode_count;
+    j["p50"] = metadata.p50;
+    j["p95"] = metadata.p95;
+    j["p99"] = metadata.p99;
+
+    // A mode estimated from a row sample is marked with the rate and its error bound
+    if (metadata.mode_is_sampled) {
+        j["mode_sampled"] = true;
+        j["mode_sample_rate"] = metadata.mode_sample_rate;
+        j["mode_count_error"] = metadata.mode_count_error;
+    }
 }
 
 // Convert categorical metadata to JSON
@@ -79,9 +154,15 @@ static void categorical_to_json(json& j, const CategoricalMetadata& metadata) {
         {"category_counts", json::array()},
         {"high_freq_category_count", metadata.high_freq_category_count},
         {"total_category_count", metadata.total_category_count},
-        {"total_value_count", metadata.total_value_count}
+        {"total_value_count", metadata.total_value_count},
+        {"distinct_count", metadata.distinct_count}
     };
 
+    // Add the distinct-value sketch
+    char sketch_text[HYPERLOGLOG_ENCODED_SIZE];
+    hyperloglog_encode(&metadata.distinct_sketch, sketch_text, sizeof(sketch_text));
+    j["distinct_sketch"] = sketch_text;
+
     // Add categories
     for (uint32_t i = 0; i < metadata.high_freq_category_count; i++) {
         j["categories"].push_back(metadata.categories[i]);
@@ -89,6 +170,47 @@ static void categorical_to_json(json& j, const CategoricalMetadata& metadata) {
     }
 }
 
+// Convert the Bloom filters of a row group to JSON
+static json bloom_filters_to_json(const RowGroupMetadata& metadata) {
+    json filters = json::array();
+    for (uint32_t i = 0; i < metadata.bloom_filter_count; i++) {
+        const ColumnBloomFilter& bloom = metadata.bloom_filters[i];
+        std::string blocks(bloom_filter_encoded_size(&bloom.filter), '\0');
+        blocks.resize(bloom_filter_encode(&bloom.filter, &blocks[0], blocks.size()));
+        filters.push_back({
+            {"column_index", bloom.column_index},
+            {"column_name", bloom.column_name},
+            {"value_type", static_cast<int>(bloom.value_type)},
+            {"blocks", blocks}
+        });
+    }
+    return filters;
+}
+
+// Convert JSON to the Bloom filters of a row group; invalid filters are dropped
+static void json_to_bloom_filters(const json& j, RowGroupMetadata& metadata) {
+    metadata.bloom_filter_count = 0;
+    metadata.bloom_filters = nullptr;
+    if (!j.is_array() || j.empty()) {
+        return;
+    }
+    metadata.bloom_filters = (ColumnBloomFilter*)calloc(j.size(), sizeof(ColumnBloomFilter));
+    if (!metadata.bloom_filters) {
+        return;
+    }
+    for (const json& filter_json : j) {
+        ColumnBloomFilter& bloom = metadata.bloom_filters[metadata.bloom_filter_count];
+        if (bloom_filter_decode(&bloom.filter, filter_json.value("blocks", std::string()).c_str()) != 0) {
+            continue;
+        }
+        bloom.column_index = filter_json.value("column_index", 0u);
+        strncpy(bloom.column_name, filter_json.value("column_name", std::string()).c_str(),
+                MAX_METADATA_ITEM_NAME_LENGTH - 1);
+        bloom.value_type = static_cast<ParquetValueType>(filter_json.value("value_type", 0));
+        metadata.bloom_filter_count++;
+    }
+}
+
 // Convert custom metadata to JSON
 static void custom_metadata_to_json(json& j, const CustomMetadataItem& metadata) {
     j = {
@@ -105,6 +227,11 @@ static void json_to_timestamp(const json& j, TimestampMetadata& metadata) {
     metadata.min_timestamp = j.value("min_timestamp", 0);
     metadata.max_timestamp = j.value("max_timestamp", 0);
     metadata.count = j.value("count", (uint64_t)0);
+    metadata.from_footer = j.value("from_footer", false);
+    metadata.p50 = j.value("p50", (time_t)0);
+    metadata.p95 = j.value("p95", (time_t)0);
+    metadata.p99 = j.value("p99", (time_t)0);
+    json_to_quantile_sketch(j.value("quantile_sketch", json::object()), metadata.quantiles);
 }
 
 // Convert JSON to string metadata
@@ -113,6 +240,8 @@ static void json_to_string(const json& j, StringMetadata& metadata) {
     metadata.special_string_count = j.value("special_string_count", 0u);
     metadata.total_string_count = j.value("total_string_count", (uint64_t)0);
     metadata.avg_string_length = j.value("avg_string_length", 0u);
+    metadata.is_sampled = j.value("sampled", false);
+    metadata.sample_rate = j.value("sample_rate", 1.0);
 
     // Get high frequency strings
     const json& high_freq_strings = j.value("high_freq_strings", json::array());
@@ -129,6 +258,7 @@ static void json_to_string(const json& j, StringMetadata& metadata) {
                    MAX_STRING_LENGTH - 1);
             metadata.high_freq_strings[i].string[MAX_STRING_LENGTH - 1] = '\0';
             metadata.high_freq_strings[i].count = high_freq_strings[i].value("count", 0u);
+            metadata.sample_errors[i] = high_freq_strings[i].value("count_error", (uint64_t)0);
             metadata.high_freq_counts[i] = metadata.high_freq_strings[i].count;
         } else {
             // Old format with separate arrays
@@ -147,6 +277,7 @@ static void json_to_string(const json& j, StringMetadata& metadata) {
     // Get special strings
     const json& special_strings = j.value("special_strings", json::array());
     const json& special_string_counts = j.value("special_string_counts", json::array());
+    const json& special_string_errors = j.value("special_string_errors", json::array());
     
     count = std::min(special_strings.size(), 
                     static_cast<size_t>(MAX_SPECIAL_STRINGS));
@@ -159,6 +290,9 @@ static void json_to_string(const json& j, StringMetadata& metadata) {
         if (i < special_string_counts.size()) {
             metadata.special_string_counts[i] = special_string_counts[i].get<uint32_t>();
         }
+        if (i < special_string_errors.size()) {
+            metadata.special_string_errors[i] = special_string_errors[i].get<uint32_t>();
+        }
     }
 }
 
@@ -171,6 +305,14 @@ static void json_to_numeric(const json& j, NumericMetadata& metadata) {
     metadata.mode_count = j.value("mode_count", (uint64_t)0);
     metadata.total_count = j.value("total_count", (uint64_t)0);
     metadata.null_count = j.value("null_count", 0u);
+    metadata.from_footer = j.value("from_footer", false);
+    metadata.p50 = j.value("p50", 0.0);
+    metadata.p95 = j.value("p95", 0.0);
+    metadata.p99 = j.value("p99", 0.0);
+    json_to_quantile_sketch(j.value("quantile_sketch", json::object()), metadata.quantiles);
+    metadata.mode_is_sampled = j.value("mode_sampled", false);
+    metadata.mode_sample_rate = j.value("mode_sample_rate", 1.0);
+    metadata.mode_count_error = j.value("mode_count_error", (uint64_t)0);
 }
 
 // Convert JSON to categorical metadata
@@ -179,6 +321,12 @@ static void json_to_categorical(const json& j, CategoricalMetadata& metadata) {
     metadata.total_category_count = j.value("total_category_count", 0u);
     metadata.total_value_count = j.value("total_value_count", (uint64_t)0);
 
+    // Get the distinct-value sketch; a missing or invalid one leaves the sketch empty
+    if (hyperloglog_decode(&metadata.distinct_sketch, j.value("distinct_sketch", std::string()).c_str()) != 0) {
+        hyperloglog_init(&metadata.distinct_sketch);
+    }
+    metadata.distinct_count = j.value("distinct_count", hyperloglog_estimate(&metadata.distinct_sketch));
+
     // Get categories
     const json& categories = j.value("categories", json::array());
     const json& category_counts = j.value("category_counts", json::array());
@@ -335,6 +483,7 @@ static json metadata_to_json(const Metadata* metadata) {
             metadata_item_to_json(item_json, metadata->row_group_metadata[i].metadata[j]);
             rg_json["metadata_items"].push_back(item_json);
         }
+        rg_json["bloom_filters"] = bloom_filters_to_json(metadata->row_group_metadata[i]);
         
         j["row_group_metadata"].push_back(rg_json);
     }
@@ -452,6 +601,7 @@ static Metadata* json_to_metadata(const json& j) {
             RowGroupMetadata* rg = &metadata->row_group_metadata[i];
             
             rg->row_group_index = rg_json.value("row_group_index", 0u);
+            json_to_bloom_filters(rg_json.value("bloom_filters", json::array()), *rg);
             
             // Get metadata items
             const json& metadata_items = rg_json.value("metadata_items", json::array());
@@ -532,7 +682,7 @@ static Metadata* json_to_metadata(const json& j) {
 // Public API functions
 JsonHelperError json_serialize_metadata(const Metadata* metadata, char** json_string) {
     if (!metadata || !json_string) {
-        set_error("Invalid parameters");
+        set_helper_error("Invalid parameters");
         return JSON_HELPER_INVALID_PARAMETER;
     }
     
@@ -546,20 +696,20 @@ JsonHelperError json_serialize_metadata(const Metadata* metadata, char** json_st
         // Allocate memory for the result
         *json_string = strdup(str.c_str());
         if (!*json_string) {
-            set_error("Failed to allocate memory for JSON string");
+            set_helper_error("Failed to allocate memory for JSON string");
             return JSON_HELPER_MEMORY_ERROR;
         }
         
         return JSON_HELPER_OK;
     } catch (const std::exception& e) {
-        set_error("JSON error: %s", e.what());
+        set_helper_error("JSON error: %s", e.what());
         return JSON_HELPER_UNKNOWN_ERROR;
     }
 }
 
 JsonHelperError json_deserialize_metadata(const char* json_string, Metadata** metadata) {
     if (!json_string || !metadata) {
-        set_error("Invalid parameters");
+        set_helper_error("Invalid parameters");
         return JSON_HELPER_INVALID_PARAMETER;
     }
     
@@ -570,23 +720,23 @@ JsonHelperError json_deserialize_metadata(const char* json_string, Metadata** me
         // Convert JSON to metadata
         *metadata = json_to_metadata(j);
         if (!*metadata) {
-            set_error("Failed to allocate memory for metadata");
+            set_helper_error("Failed to allocate memory for metadata");
             return JSON_HELPER_MEMORY_ERROR;
         }
         
         return JSON_HELPER_OK;
     } catch (const json::parse_error& e) {
-        set_error("JSON parse error: %s", e.what());
+        set_helper_error("JSON parse error: %s", e.what());
         return JSON_HELPER_PARSE_ERROR;
     } catch (const std::exception& e) {
-        set_error("JSON error: %s", e.what());
+        set_helper_error("JSON error: %s", e.what());
         return JSON_HELPER_UNKNOWN_ERROR;
     }
 }
 
 JsonHelperError json_save_metadata_to_file(const Metadata* metadata, const char* file_path) {
     if (!metadata || !file_path) {
-        set_error("Invalid parameters");
+        set_helper_error("Invalid parameters");
         return JSON_HELPER_INVALID_PARAMETER;
     }
     
@@ -597,7 +747,7 @@ JsonHelperError json_save_metadata_to_file(const Metadata* metadata, const char*
         // Open file for writing
         std::ofstream file(file_path, std::ios::binary);
         if (!file) {
-            set_error("Failed to open file for writing: %s", file_path);
+            set_helper_error("Failed to open file for writing: %s", file_path);
             return JSON_HELPER_FILE_ERROR;
         }
         
@@ -606,20 +756,20 @@ JsonHelperError json_save_metadata_to_file(const Metadata* metadata, const char*
         file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
         
         if (!file) {
-            set_error("Failed to write to file: %s", file_path);
+            set_helper_error("Failed to write to file: %s", file_path);
             return JSON_HELPER_FILE_ERROR;
         }
         
         return JSON_HELPER_OK;
     } catch (const std::exception& e) {
-        set_error("JSON error: %s", e.what());
+        set_helper_error("JSON error: %s", e.what());
         return JSON_HELPER_UNKNOWN_ERROR;
     }
 }
 
 JsonHelperError json_load_metadata_from_file(const char* file_path, Metadata** metadata) {
     if (!file_path || !metadata) {
-        set_error("Invalid parameters");
+        set_helper_error("Invalid parameters");
         return JSON_HELPER_INVALID_PARAMETER;
     }
     
@@ -627,7 +777,7 @@ JsonHelperError json_load_metadata_from_file(const char* file_path, Metadata** m
         // Open file for reading
         std::ifstream file(file_path, std::ios::binary);
         if (!file) {
-            set_error("Failed to open file for reading: %s", file_path);
+            set_helper_error("Failed to open file for reading: %s", file_path);
             return JSON_HELPER_FILE_ERROR;
         }
         
@@ -638,7 +788,7 @@ JsonHelperError json_load_metadata_from_file(const char* file_path, Metadata** m
         );
         
         if (binary.empty()) {
-            set_error("Empty file: %s", file_path);
+            set_helper_error("Empty file: %s", file_path);
             return JSON_HELPER_FILE_ERROR;
         }
         
@@ -648,16 +798,16 @@ JsonHelperError json_load_metadata_from_file(const char* file_path, Metadata** m
         // Convert JSON to metadata
         *metadata = json_to_metadata(j);
         if (!*metadata) {
-            set_error("Failed to allocate memory for metadata");
+            set_helper_error("Failed to allocate memory for metadata");
             return JSON_HELPER_MEMORY_ERROR;
         }
         
         return JSON_HELPER_OK;
     } catch (const json::parse_error& e) {
-        set_error("JSON parse error: %s", e.what());
+        set_helper_error("JSON parse error: %s", e.what());
         return JSON_HELPER_PARSE_ERROR;
     } catch (const std::exception& e) {
-        set_error("JSON error: %s", e.what());
+        set_helper_error("JSON error: %s", e.what());
         return JSON_HELPER_UNKNOWN_ERROR;
     }
 }
@@ -666,7 +816,7 @@ JsonHelperError json_parse_custom_metadata_config(const char* file_path,
                                                std::vector<std::string>& names,
                                                std::vector<std::string>& queries) {
     if (!file_path) {
-        set_error("Invalid parameters");
+        set_helper_error("Invalid parameters");
         return JSON_HELPER_INVALID_PARAMETER;
     }
     
@@ -678,7 +828,7 @@ JsonHelperError json_parse_custom_metadata_config(const char* file_path,
         // Open and read the file
         std::ifstream file(file_path);
         if (!file) {
-            set_error("Failed to open file for reading: %s", file_path);
+            set_helper_error("Failed to open file for reading: %s", file_path);
             return JSON_HELPER_FILE_ERROR;
         }
         
@@ -688,7 +838,7 @@ JsonHelperError json_parse_custom_metadata_config(const char* file_path,
         
         // Check if the file contains custom_metadata array
         if (!j.contains("custom_metadata") || !j["custom_metadata"].is_array()) {
-            set_error("Invalid custom metadata config: missing or invalid 'custom_metadata' array");
+            set_helper_error("Invalid custom metadata config: missing or invalid 'custom_metadata' array");
             return JSON_HELPER_PARSE_ERROR;
         }
         
@@ -714,10 +864,10 @@ JsonHelperError json_parse_custom_metadata_config(const char* file_path,
         
         return JSON_HELPER_OK;
     } catch (const json::parse_error& e) {
-        set_error("JSON parse error: %s", e.what());
+        set_helper_error("JSON parse error: %s", e.what());
         return JSON_HELPER_PARSE_ERROR;
     } catch (const std::exception& e) {
-        set_error("JSON error: %s", e.what());
+        set_helper_error("JSON error: %s", e.what());
         return JSON_HELPER_UNKNOWN_ERROR;
     }
 }
@@ -1,232 +1,327 @@
+/* strdup and strptime are POSIX, hidden by the strict C11 mode the library builds in */
+#define _XOPEN_SOURCE 700
+
 #include "metadata/json_serialization.h"
+#include "metadata/json_helper.h"
 #include "metadata/metadata_types.h"
+#include "core/platform.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <time.h>
 #include <ctype.h>
 #include <stdbool.h>
 
 /* Constants */
-#define MAX_METADATA_JSON_SIZE (64 * 1024)  // 64 KB max size for JSON
-#define MAX_FILE_PATH_LENGTH 256
+#define JSON_INITIAL_BUFFER_SIZE (64 * 1024)  // Grown as needed
+#define MAX_FILE_PATH_LENGTH 4096
 
 /* Static global for error messages */
-static char s_error_message[256];
+static INFPARQUET_THREAD_LOCAL char s_error_message[256];
 
 /**
  * Structure for JSON serialization context
  */
 typedef struct {
-    char* buffer;         // Buffer for JSON data
+    char* buffer;         // Buffer for JSON data, NULL once an allocation failed
     size_t buffer_size;   // Size of the buffer
     size_t position;      // Current position in the buffer
 } JSONContext;
 
+/**
+ * Append formatted text to a JSON context, growing its buffer as needed
+ *
+ * context: The context; left without a buffer if memory runs out
+ * format: printf-style format of the text
+ */
+static void json_append(JSONContext* context, const char* format, ...) {
+    while (context->buffer) {
+        size_t available = context->buffer_size - context->position;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(context->buffer + context->position, available, format, args);
+        va_end(args);
+
+        if (written >= 0 && (size_t)written < available) {
+            context->position += (size_t)written;
+            return;
+        }
+
+        size_t buffer_size = context->buffer_size * 2;
+        while (written >= 0 && buffer_size - context->position <= (size_t)written) {
+            buffer_size *= 2;
+        }
+        char* buffer = written >= 0 ? (char*)realloc(context->buffer, buffer_size) : NULL;
+        if (!buffer) {
+            free(context->buffer);
+            context->buffer = NULL;
+            return;
+        }
+        context->buffer = buffer;
+        context->buffer_size = buffer_size;
+    }
+}
+
+/**
+ * Append a string to a JSON context as a quoted, escaped JSON string
+ *
+ * context: The context
+ * value: The string (NULL is written as an empty string)
+ */
+static void json_append_string(JSONContext* context, const char* value) {
+    json_append(context, "\"");
+    for (const char* c = value ? value : ""; *c; c++) {
+        switch (*c) {
+            case '"':  json_append(context, "\\\""); break;
+            case '\\': json_append(context, "\\\\"); break;
+            case '\b': json_append(context, "\\b"); break;
+            case '\f': json_append(context, "\\f"); break;
+            case '\n': json_append(context, "\\n"); break;
+            case '\r': json_append(context, "\\r"); break;
+            case '\t': json_append(context, "\\t"); break;
+            default:
+                // Other control characters are not allowed raw inside a JSON string
+                if ((unsigned char)*c < 0x20) {
+                    json_append(context, "\\u%04x", (unsigned)(unsigned char)*c);
+                } else {
+                    json_append(context, "%c", *c);
+                }
+                break;
+        }
+    }
+    json_append(context, "\"");
+}
+
+/**
+ * Append an array of {"<key>": "...", "count": N} objects to a JSON context
+ *
+ * context: The context
+ * indent: Indentation of the enclosing object
+ * key: Name of the string field of each object
+ * strings: The strings
+ * counts: Count of each string
+ * count: Number of strings
+ */
+static void json_append_counted_strings(JSONContext* context, const char* indent, const char* key,
+                                        const char (*strings)[MAX_STRING_LENGTH], const uint32_t* counts,
+                                        uint32_t count) {
+    json_append(context, "[");
+    for (uint32_t i = 0; i < count; i++) {
+        json_append(context, "%s\n%s    {\n%s      \"%s\": ", i == 0 ? "" : ",", indent, indent, key);
+        json_append_string(context, strings[i]);
+        json_append(context, ",\n%s      \"count\": %u\n%s    }", indent, counts[i], indent);
+    }
+    json_append(context, "\n%s  ]", indent);
+}
+
 /**
  * Internal helper function to serialize a single metadata item to JSON
  */
-static char* serialize_metadata_item(const MetadataItem* item, int indent_level) {
+static void serialize_metadata_item(JSONContext* context, const MetadataItem* item, int indent_level) {
     if (!item) {
-        return strdup("null");
+        json_append(context, "null");
+        return;
     }
-    
-    char* buffer = (char*)malloc(MAX_METADATA_JSON_SIZE);
-    if (!buffer) {
-        return NULL;
-    }
-    
+
     // Create indentation
     char indent[32] = "";
     for (int i = 0; i < indent_level && i < 15; i++) {
         strcat(indent, "  ");
     }
-    
+
+    json_append(context, "%s{\n%s  \"name\": ", indent, indent);
+    json_append_string(context, item->name);
+    json_append(context, ",\n");
+
     // Format depends on type
     switch (item->type) {
         case METADATA_TYPE_TIMESTAMP: {
             // Format the timestamps as ISO 8601 strings
             char min_time_str[32], max_time_str[32];
             struct tm* tm_info;
-            
+
             tm_info = localtime(&item->value.timestamp.min_timestamp);
             strftime(min_time_str, sizeof(min_time_str), "%Y-%m-%dT%H:%M:%S", tm_info);
-            
+
             tm_info = localtime(&item->value.timestamp.max_timestamp);
             strftime(max_time_str, sizeof(max_time_str), "%Y-%m-%dT%H:%M:%S", tm_info);
-            
-            snprintf(buffer, MAX_METADATA_JSON_SIZE,
-                    "%s{\n"
-                    "%s  \"name\": \"%s\",\n"
+
+            json_append(context,
                     "%s  \"type\": \"timestamp\",\n"
                     "%s  \"min_timestamp\": \"%s\",\n"
-                    "%s  \"max_timestamp\": \"%s\",\n"
-                    "%s  \"count\": %llu\n"
-                    "%s}",
-                    indent,
-                    indent, item->name,
+                    "%s  \"max_timestamp\": \"%s\",\n",
                     indent,
                     indent, min_time_str,
-                    indent, max_time_str,
+                    indent, max_time_str);
+
+            // Percentiles of timestamps known only from footer statistics are unavailable
+            if (item->value.timestamp.from_footer) {
+                json_append(context, "%s  \"from_footer\": true,\n", indent);
+            } else {
+                char p50_str[32], p95_str[32], p99_str[32];
+                tm_info = localtime(&item->value.timestamp.p50);
+                strftime(p50_str, sizeof(p50_str), "%Y-%m-%dT%H:%M:%S", tm_info);
+                tm_info = localtime(&item->value.timestamp.p95);
+                strftime(p95_str, sizeof(p95_str), "%Y-%m-%dT%H:%M:%S", tm_info);
+                tm_info = localtime(&item->value.timestamp.p99);
+                strftime(p99_str, sizeof(p99_str), "%Y-%m-%dT%H:%M:%S", tm_info);
+                json_append(context,
+                        "%s  \"p50\": \"%s\",\n"
+                        "%s  \"p95\": \"%s\",\n"
+                        "%s  \"p99\": \"%s\",\n",
+                        indent, p50_str,
+                        indent, p95_str,
+                        indent, p99_str);
+            }
+
+            json_append(context,
+                    "%s  \"count\": %llu\n"
+                    "%s}",
                     indent, (unsigned long long)item->value.timestamp.count,
                     indent);
             break;
         }
-        
+
         case METADATA_TYPE_STRING: {
-            // Start building the JSON object
-            int pos = snprintf(buffer, MAX_METADATA_JSON_SIZE,
-                    "%s{\n"
-                    "%s  \"name\": \"%s\",\n"
+            const StringMetadata* string = &item->value.string;
+            json_append(context,
                     "%s  \"type\": \"string\",\n"
                     "%s  \"total_count\": %llu,\n"
-                    "%s  \"avg_length\": %u,\n"
-                    "%s  \"high_freq_strings\": [",
-                    indent,
-                    indent, item->name,
+                    "%s  \"avg_length\": %u,\n",
                     indent,
-                    indent, (unsigned long long)item->value.string.total_string_count,
-                    indent, item->value.string.avg_string_length,
-                    indent);
-            
-            // Add high frequency strings
-            for (uint32_t i = 0; i < item->value.string.high_freq_count; i++) {
-                pos += snprintf(buffer + pos, MAX_METADATA_JSON_SIZE - pos,
-                        "%s\n%s    {\n"
-                        "%s      \"string\": \"%s\",\n"
-                        "%s      \"count\": %u\n"
-                        "%s    }%s",
-                        i == 0 ? "" : ",",
-                        indent,
-                        indent, item->value.string.high_freq_strings[i],
-                        indent, item->value.string.high_freq_counts[i],
+                    indent, (unsigned long long)string->total_string_count,
+                    indent, string->avg_string_length);
+
+            // Counts estimated from a row sample are marked with the rate
+            if (string->is_sampled) {
+                json_append(context,
+                        "%s  \"sampled\": true,\n"
+                        "%s  \"sample_rate\": %.9g,\n",
                         indent,
-                        i == item->value.string.high_freq_count - 1 ? "" : ",");
+                        indent, string->sample_rate);
             }
-            
+
+            // Add high frequency strings
+            json_append(context, "%s  \"high_freq_strings\": ", indent);
+            json_append_counted_strings(context, indent, "string", string->high_frequency_strings,
+                                        string->high_freq_counts, string->high_freq_count);
+
             // Add special strings
-            pos += snprintf(buffer + pos, MAX_METADATA_JSON_SIZE - pos,
-                    "\n%s  ],\n"
-                    "%s  \"special_strings\": [",
-                    indent,
-                    indent);
-            
-            for (uint32_t i = 0; i < item->value.string.special_string_count; i++) {
-                pos += snprintf(buffer + pos, MAX_METADATA_JSON_SIZE - pos,
-                        "%s\n%s    {\n"
-                        "%s      \"string\": \"%s\",\n"
-                        "%s      \"count\": %u\n"
-                        "%s    }%s",
-                        i == 0 ? "" : ",",
-                        indent,
-                        indent, item->value.string.special_strings[i],
-                        indent, item->value.string.special_string_counts[i],
-                        indent,
-                        i == item->value.string.special_string_count - 1 ? "" : ",");
+            json_append(context, ",\n%s  \"special_strings\": ", indent);
+            json_append_counted_strings(context, indent, "string", string->special_strings,
+                                        string->special_string_counts, string->special_string_count);
+
+            // Add the error bounds of sampled counts, in the order of their strings
+            if (string->is_sampled) {
+                json_append(context, ",\n%s  \"count_errors\": [", indent);
+                for (uint32_t i = 0; i < string->high_freq_count; i++) {
+                    json_append(context, "%s%llu", i == 0 ? "" : ", ",
+                            (unsigned long long)string->sample_errors[i]);
+                }
+                json_append(context, "],\n%s  \"special_count_errors\": [", indent);
+                for (uint32_t i = 0; i < string->special_string_count; i++) {
+                    json_append(context, "%s%u", i == 0 ? "" : ", ", string->special_string_errors[i]);
+                }
+                json_append(context, "]");
             }
-            
+
             // Close the JSON object
-            snprintf(buffer + pos, MAX_METADATA_JSON_SIZE - pos,
-                    "\n%s  ]\n"
-                    "%s}",
-                    indent,
-                    indent);
+            json_append(context, "\n%s}", indent);
             break;
         }
-        
+
         case METADATA_TYPE_NUMERIC: {
-            snprintf(buffer, MAX_METADATA_JSON_SIZE,
-                    "%s{\n"
-                    "%s  \"name\": \"%s\",\n"
+            const NumericMetadata* numeric = &item->value.numeric;
+            json_append(context,
                     "%s  \"type\": \"numeric\",\n"
                     "%s  \"min\": %.6f,\n"
-                    "%s  \"max\": %.6f,\n"
-                    "%s  \"avg\": %.6f,\n"
-                    "%s  \"mode\": %.6f,\n"
-                    "%s  \"mode_count\": %llu,\n"
+                    "%s  \"max\": %.6f,\n",
+                    indent,
+                    indent, numeric->min_value,
+                    indent, numeric->max_value);
+
+            // Values known only from footer statistics leave mean, mode and percentiles unavailable
+            if (numeric->from_footer) {
+                json_append(context, "%s  \"from_footer\": true,\n", indent);
+            } else {
+                json_append(context,
+                        "%s  \"avg\": %.6f,\n"
+                        "%s  \"mode\": %.6f,\n"
+                        "%s  \"mode_count\": %llu,\n",
+                        indent, numeric->avg_value,
+                        indent, numeric->mode_value,
+                        indent, (unsigned long long)numeric->mode_count);
+
+                // A mode estimated from a row sample is marked with the rate and its error bound
+                if (numeric->mode_is_sampled) {
+                    json_append(context,
+                            "%s  \"mode_sampled\": true,\n"
+                            "%s  \"mode_sample_rate\": %.9g,\n"
+                            "%s  \"mode_count_error\": %llu,\n",
+                            indent,
+                            indent, numeric->mode_sample_rate,
+                            indent, (unsigned long long)numeric->mode_count_error);
+                }
+
+                json_append(context,
+                        "%s  \"p50\": %.6f,\n"
+                        "%s  \"p95\": %.6f,\n"
+                        "%s  \"p99\": %.6f,\n",
+                        indent, numeric->p50,
+                        indent, numeric->p95,
+                        indent, numeric->p99);
+            }
+
+            json_append(context,
                     "%s  \"total_count\": %llu,\n"
                     "%s  \"null_count\": %u\n"
                     "%s}",
-                    indent,
-                    indent, item->name,
-                    indent,
-                    indent, item->value.numeric.min_value,
-                    indent, item->value.numeric.max_value,
-                    indent, item->value.numeric.avg_value,
-                    indent, item->value.numeric.mode_value,
-                    indent, (unsigned long long)item->value.numeric.mode_count,
-                    indent, (unsigned long long)item->value.numeric.total_count,
-                    indent, item->value.numeric.null_count,
+                    indent, (unsigned long long)numeric->total_count,
+                    indent, numeric->null_count,
                     indent);
             break;
         }
-        
+
         case METADATA_TYPE_CATEGORICAL: {
-            // Start building the JSON object
-            int pos = snprintf(buffer, MAX_METADATA_JSON_SIZE,
-                    "%s{\n"
-                    "%s  \"name\": \"%s\",\n"
+            const CategoricalMetadata* categorical = &item->value.categorical;
+            json_append(context,
                     "%s  \"type\": \"categorical\",\n"
                     "%s  \"total_count\": %llu,\n"
                     "%s  \"total_categories\": %u,\n"
-                    "%s  \"categories\": [",
+                    "%s  \"distinct_count\": %llu,\n"
+                    "%s  \"categories\": ",
                     indent,
-                    indent, item->name,
-                    indent,
-                    indent, (unsigned long long)item->value.categorical.total_value_count,
-                    indent, item->value.categorical.total_category_count,
+                    indent, (unsigned long long)categorical->total_value_count,
+                    indent, categorical->total_category_count,
+                    indent, (unsigned long long)categorical->distinct_count,
                     indent);
-            
+
             // Add categories
-            for (uint32_t i = 0; i < item->value.categorical.high_freq_category_count; i++) {
-                pos += snprintf(buffer + pos, MAX_METADATA_JSON_SIZE - pos,
-                        "%s\n%s    {\n"
-                        "%s      \"category\": \"%s\",\n"
-                        "%s      \"count\": %u\n"
-                        "%s    }%s",
-                        i == 0 ? "" : ",",
-                        indent,
-                        indent, item->value.categorical.categories[i],
-                        indent, item->value.categorical.category_counts[i],
-                        indent,
-                        i == item->value.categorical.high_freq_category_count - 1 ? "" : ",");
-            }
-            
+            json_append_counted_strings(context, indent, "category", categorical->categories,
+                                        categorical->category_counts, categorical->high_freq_category_count);
+
             // Close the JSON object
-            snprintf(buffer + pos, MAX_METADATA_JSON_SIZE - pos,
-                    "\n%s  ]\n"
-                    "%s}",
-                    indent,
-                    indent);
+            json_append(context, "\n%s}", indent);
             break;
         }
-        
+
         case METADATA_TYPE_CUSTOM:
         default:
             // For unsupported or custom types, just output a simple JSON object
-            snprintf(buffer, MAX_METADATA_JSON_SIZE,
-                    "%s{\n"
-                    "%s  \"name\": \"%s\",\n"
-                    "%s  \"type\": \"custom\"\n"
-                    "%s}",
-                    indent,
-                    indent, item->name,
-                    indent,
-                    indent);
+            json_append(context, "%s  \"type\": \"custom\"\n%s}", indent, indent);
             break;
     }
-    
-    return buffer;
 }
 
 /**
  * Serializes metadata to a JSON string
- * 
+ *
  * This function converts the metadata structure to a JSON string.
  * The caller is responsible for freeing the returned string.
- * 
+ *
  * metadata: Pointer to the metadata structure to serialize
- * 
+ *
  * Return: A newly allocated string containing the JSON representation,
  *         or NULL if serialization fails
  */
@@ -234,142 +329,503 @@ char* metadata_to_json(const Metadata* metadata) {
     if (!metadata) {
         return NULL;
     }
-    
-    // Allocate a buffer for the JSON string
-    char* json = (char*)malloc(MAX_METADATA_JSON_SIZE);
-    if (!json) {
+
+    // Allocate a buffer for the JSON string; it grows with the document
+    JSONContext context;
+    context.buffer = (char*)malloc(JSON_INITIAL_BUFFER_SIZE);
+    context.buffer_size = JSON_INITIAL_BUFFER_SIZE;
+    context.position = 0;
+    if (!context.buffer) {
         return NULL;
     }
-    
+
     // Start building the JSON object
-    int pos = snprintf(json, MAX_METADATA_JSON_SIZE,
-            "{\n"
-            "  \"file_path\": \"%s\",\n"
+    json_append(&context, "{\n  \"file_path\": ");
+    json_append_string(&context, metadata->file_path);
+    json_append(&context,
+            ",\n"
             "  \"file_metadata\": {\n"
             "    \"basic_metadata_count\": %u,\n"
             "    \"custom_metadata_count\": %u,\n"
             "    \"use_basic_metadata\": %s,\n"
             "    \"basic_metadata\": [",
-            metadata->file_path ? metadata->file_path : "",
             metadata->file_metadata.basic_metadata_count,
             metadata->file_metadata.custom_metadata_count,
             metadata->file_metadata.use_basic_metadata ? "true" : "false");
-    
+
     // Add basic metadata items
     for (uint32_t i = 0; i < metadata->file_metadata.basic_metadata_count; i++) {
-        char* item_json = serialize_metadata_item(&metadata->file_metadata.basic_metadata[i], 3);
-        if (item_json) {
-            pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
-                    "%s\n%s",
-                    i == 0 ? "" : ",",
-                    item_json);
-            free(item_json);
-        }
+        json_append(&context, "%s\n", i == 0 ? "" : ",");
+        serialize_metadata_item(&context, &metadata->file_metadata.basic_metadata[i], 3);
     }
-    
+
     // Add custom metadata items
-    pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+    json_append(&context,
             "\n    ],\n"
             "    \"custom_metadata\": [");
-    
+
     for (uint32_t i = 0; i < metadata->file_metadata.custom_metadata_count; i++) {
         const CustomMetadataItem* item = &metadata->file_metadata.custom_metadata[i];
-        pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
-                "%s\n      {\n"
-                "        \"name\": \"%s\",\n"
-                "        \"sql_query\": \"%s\",\n"
+        json_append(&context, "%s\n      {\n        \"name\": ", i == 0 ? "" : ",");
+        json_append_string(&context, item->name);
+        json_append(&context, ",\n        \"sql_query\": ");
+        json_append_string(&context, item->sql_query);
+        if (item->result_matrix) {
+            json_append(&context, ",\n        \"result_matrix\": ");
+            json_append_string(&context, item->result_matrix);
+        }
+        json_append(&context,
+                ",\n"
                 "        \"row_group_count\": %u,\n"
                 "        \"column_count\": %u\n"
-                "      }%s",
-                i == 0 ? "" : ",",
-                item->name,
-                item->sql_query,
+                "      }",
                 item->row_group_count,
-                item->column_count,
-                i == metadata->file_metadata.custom_metadata_count - 1 ? "" : ",");
+                item->column_count);
     }
-    
+
     // Add row group metadata
-    pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+    json_append(&context,
             "\n    ]\n"
             "  },\n"
             "  \"row_group_metadata_count\": %u,\n"
             "  \"row_group_metadata\": [",
             metadata->row_group_metadata_count);
-    
+
     for (uint32_t i = 0; i < metadata->row_group_metadata_count; i++) {
         const RowGroupMetadata* row_group = &metadata->row_group_metadata[i];
-        pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+        json_append(&context,
                 "%s\n    {\n"
                 "      \"row_group_index\": %u,\n"
+                "      \"row_count\": %llu,\n"
                 "      \"metadata_count\": %u,\n"
                 "      \"metadata\": [",
                 i == 0 ? "" : ",",
                 row_group->row_group_index,
+                (unsigned long long)row_group->row_count,
                 row_group->metadata_count);
-        
+
         // Add row group metadata items
         for (uint32_t j = 0; j < row_group->metadata_count; j++) {
-            char* item_json = serialize_metadata_item(&row_group->metadata[j], 4);
-            if (item_json) {
-                pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
-                        "%s\n%s",
-                        j == 0 ? "" : ",",
-                        item_json);
-                free(item_json);
+            json_append(&context, "%s\n", j == 0 ? "" : ",");
+            serialize_metadata_item(&context, &row_group->metadata[j], 4);
+        }
+
+        json_append(&context,
+                "\n      ],\n"
+                "      \"bloom_filters\": [");
+
+        // Add Bloom filters; a filter that cannot be encoded is left out,
+        // which only costs pruning, never correctness
+        int filters_written = 0;
+        for (uint32_t j = 0; j < row_group->bloom_filter_count; j++) {
+            const ColumnBloomFilter* bloom = &row_group->bloom_filters[j];
+            size_t encoded_size = bloom_filter_encoded_size(&bloom->filter);
+            char* blocks = (char*)malloc(encoded_size);
+            if (!blocks) {
+                continue;
+            }
+            if (bloom_filter_encode(&bloom->filter, blocks, encoded_size) > 0) {
+                json_append(&context,
+                        "%s\n        {\n"
+                        "          \"column_index\": %u,\n"
+                        "          \"column_name\": ",
+                        filters_written == 0 ? "" : ",",
+                        bloom->column_index);
+                json_append_string(&context, bloom->column_name);
+                json_append(&context,
+                        ",\n"
+                        "          \"value_type\": %u,\n"
+                        "          \"blocks\": \"%s\"\n"
+                        "        }",
+                        (uint32_t)bloom->value_type,
+                        blocks);
+                filters_written++;
             }
+            free(blocks);
         }
-        
+
         // Close the row group
-        pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+        json_append(&context,
                 "\n      ]\n"
                 "    }");
     }
-    
+
     // Add column metadata
-    pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+    json_append(&context,
             "\n  ],\n"
             "  \"column_metadata_count\": %u,\n"
             "  \"column_metadata\": [",
             metadata->column_metadata_count);
-    
+
     for (uint32_t i = 0; i < metadata->column_metadata_count; i++) {
         const ColumnMetadata* column = &metadata->column_metadata[i];
-        pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+        json_append(&context,
                 "%s\n    {\n"
                 "      \"column_index\": %u,\n"
-                "      \"column_name\": \"%s\",\n"
+                "      \"column_name\": ",
+                i == 0 ? "" : ",",
+                column->column_index);
+        json_append_string(&context, column->column_name);
+        json_append(&context,
+                ",\n"
                 "      \"metadata_count\": %u,\n"
                 "      \"metadata\": [",
-                i == 0 ? "" : ",",
-                column->column_index,
-                column->column_name,
                 column->metadata_count);
-        
+
         // Add column metadata items
         for (uint32_t j = 0; j < column->metadata_count; j++) {
-            char* item_json = serialize_metadata_item(&column->metadata[j], 4);
-            if (item_json) {
-                pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
-                        "%s\n%s",
-                        j == 0 ? "" : ",",
-                        item_json);
-                free(item_json);
-            }
+            json_append(&context, "%s\n", j == 0 ? "" : ",");
+            serialize_metadata_item(&context, &column->metadata[j], 4);
         }
-        
+
         // Close the column
-        pos += snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+        json_append(&context,
                 "\n      ]\n"
                 "    }");
     }
-    
+
     // Close the main JSON object
-    snprintf(json + pos, MAX_METADATA_JSON_SIZE - pos,
+    json_append(&context,
             "\n  ]\n"
             "}");
-    
-    return json;
+
+    return context.buffer;
+}
+
+/**
+ * Serialize metadata to a JSON string
+ *
+ * metadata: Pointer to the metadata structure to serialize
+ * json_string: Pointer to store the allocated JSON string
+ * returns: Error code (JSON_SERIALIZATION_OK on success)
+ */
+JsonSerializationError json_serialization_metadata_to_json(
+    const Metadata* metadata,
+    char** json_string
+) {
+    if (!metadata || !json_string) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid parameters: metadata or json_string is NULL");
+        return JSON_SERIALIZATION_INVALID_PARAMETER;
+    }
+
+    *json_string = metadata_to_json(metadata);
+    if (!*json_string) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate memory for the metadata JSON");
+        return JSON_SERIALIZATION_MEMORY_ERROR;
+    }
+
+    return JSON_SERIALIZATION_OK;
+}
+
+/**
+ * Parse an array of {"<key>": "...", "count": N} objects
+ *
+ * json: JSON positioned at the array
+ * key: Name of the string field of each object
+ * strings: Receives the strings
+ * counts: Receives the count of each string
+ * max_count: Capacity of strings and counts
+ * returns: Number of objects parsed
+ */
+static uint32_t parse_counted_strings(const char* json, const char* key, char (*strings)[MAX_STRING_LENGTH],
+                                      uint32_t* counts, uint32_t max_count) {
+    const char* array_end = json && *json == '[' ? find_matching_bracket(json, '[', ']') : NULL;
+    if (!array_end) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    const char* p = json + 1;
+    while (count < max_count) {
+        const char* object = strchr(p, '{');
+        if (!object || object > array_end) break;
+
+        const char* object_end = find_matching_bracket(object, '{', '}');
+        if (!object_end) break;
+
+        size_t object_len = object_end - object + 1;
+        char* object_json = (char*)malloc(object_len + 1);
+        if (!object_json) break;
+        memcpy(object_json, object, object_len);
+        object_json[object_len] = '\0';
+
+        const char* string_field = find_json_field(object_json, key);
+        const char* count_field = find_json_field(object_json, "count");
+        if (string_field && count_field &&
+            extract_json_string(string_field, strings[count], MAX_STRING_LENGTH) &&
+            extract_json_uint32(count_field, &counts[count])) {
+            count++;
+        }
+
+        free(object_json);
+        p = object_end + 1;
+    }
+    return count;
+}
+
+/**
+ * Parse a metadata item serialized by serialize_metadata_item
+ *
+ * item_json: JSON of the item object
+ * item: Item to fill (cleared first)
+ */
+static void deserialize_metadata_item(const char* item_json, MetadataItem* item) {
+    memset(item, 0, sizeof(MetadataItem));
+
+    // Parse name
+    const char* name_field = find_json_field(item_json, "name");
+    if (name_field) {
+        extract_json_string(name_field, item->name, MAX_METADATA_ITEM_NAME_LENGTH);
+    }
+
+    // Parse type
+    const char* type_field = find_json_field(item_json, "type");
+    char type_str[32];
+    if (!type_field || !extract_json_string(type_field, type_str, sizeof(type_str))) {
+        return;
+    }
+
+    if (strcmp(type_str, "timestamp") == 0) {
+        item->type = METADATA_TYPE_TIMESTAMP;
+
+        // Parse timestamp values
+        const char* min_field = find_json_field(item_json, "min_timestamp");
+        const char* max_field = find_json_field(item_json, "max_timestamp");
+        const char* count_field = find_json_field(item_json, "count");
+
+        if (min_field) {
+            char min_str[32];
+            if (extract_json_string(min_field, min_str, sizeof(min_str))) {
+                // Convert string to time_t (simplified)
+                struct tm tm = {0};
+                tm.tm_isdst = -1;
+                if (strptime(min_str, "%Y-%m-%dT%H:%M:%S", &tm)) {
+                    item->value.timestamp.min_timestamp = mktime(&tm);
+                }
+            }
+        }
+
+        if (max_field) {
+            char max_str[32];
+            if (extract_json_string(max_field, max_str, sizeof(max_str))) {
+                // Convert string to time_t (simplified)
+                struct tm tm = {0};
+                tm.tm_isdst = -1;
+                if (strptime(max_str, "%Y-%m-%dT%H:%M:%S", &tm)) {
+                    item->value.timestamp.max_timestamp = mktime(&tm);
+                }
+            }
+        }
+
+        if (count_field) {
+            uint64_t count;
+            if (extract_json_uint64(count_field, &count)) {
+                item->value.timestamp.count = count;
+            }
+        }
+        item->value.timestamp.has_timestamps = true;
+
+        // Timestamps known only from footer statistics come without percentiles
+        const char* from_footer_field = find_json_field(item_json, "from_footer");
+        if (from_footer_field) {
+            extract_json_bool(from_footer_field, &item->value.timestamp.from_footer);
+        }
+
+        // Parse percentiles (absent from metadata written before they existed)
+        const char* percentile_names[3] = {"p50", "p95", "p99"};
+        time_t* percentiles[3] = {&item->value.timestamp.p50,
+                                  &item->value.timestamp.p95,
+                                  &item->value.timestamp.p99};
+        for (int p = 0; p < 3; p++) {
+            const char* percentile_field = find_json_field(item_json, percentile_names[p]);
+            char percentile_str[32];
+            if (percentile_field &&
+                extract_json_string(percentile_field, percentile_str, sizeof(percentile_str))) {
+                struct tm tm = {0};
+                tm.tm_isdst = -1;
+                if (strptime(percentile_str, "%Y-%m-%dT%H:%M:%S", &tm)) {
+                    *percentiles[p] = mktime(&tm);
+                }
+            }
+        }
+    } else if (strcmp(type_str, "string") == 0) {
+        item->type = METADATA_TYPE_STRING;
+        StringMetadata* string = &item->value.string;
+
+        // Parse string values
+        const char* total_count_field = find_json_field(item_json, "total_count");
+        const char* avg_length_field = find_json_field(item_json, "avg_length");
+
+        if (total_count_field) {
+            uint64_t count;
+            if (extract_json_uint64(total_count_field, &count)) {
+                string->total_string_count = count;
+            }
+        }
+
+        if (avg_length_field) {
+            uint32_t avg_length;
+            if (extract_json_uint32(avg_length_field, &avg_length)) {
+                string->avg_string_length = avg_length;
+            }
+        }
+        string->has_string_data = true;
+
+        // Parse high frequency strings
+        const char* high_freq_field = find_json_field(item_json, "high_freq_strings");
+        if (high_freq_field) {
+            string->high_freq_count = parse_counted_strings(high_freq_field, "string",
+                                                            string->high_frequency_strings,
+                                                            string->high_freq_counts, MAX_HIGH_FREQ_STRINGS);
+        }
+
+        // Parse special strings
+        const char* special_field = find_json_field(item_json, "special_strings");
+        if (special_field) {
+            string->special_string_count = parse_counted_strings(special_field, "string",
+                                                                 string->special_strings,
+                                                                 string->special_string_counts,
+                                                                 MAX_SPECIAL_STRINGS);
+        }
+
+        // Parse the sampling marks (present only when the counts were estimated from a row sample)
+        const char* sampled_field = find_json_field(item_json, "sampled");
+        bool is_sampled = false;
+        if (sampled_field && extract_json_bool(sampled_field, &is_sampled) && is_sampled) {
+            string->is_sampled = true;
+
+            const char* sample_rate_field = find_json_field(item_json, "sample_rate");
+            const char* count_errors_field = find_json_field(item_json, "count_errors");
+            const char* special_errors_field = find_json_field(item_json, "special_count_errors");
+            if (sample_rate_field) {
+                extract_json_double(sample_rate_field, &string->sample_rate);
+            }
+            if (count_errors_field) {
+                parse_uint64_array(count_errors_field, string->sample_errors, MAX_HIGH_FREQ_STRINGS);
+            }
+            if (special_errors_field) {
+                uint64_t errors[MAX_SPECIAL_STRINGS];
+                int error_count = parse_uint64_array(special_errors_field, errors, MAX_SPECIAL_STRINGS);
+                for (int e = 0; e < error_count; e++) {
+                    string->special_string_errors[e] = errors[e] > UINT32_MAX ? UINT32_MAX : (uint32_t)errors[e];
+                }
+            }
+        }
+    } else if (strcmp(type_str, "numeric") == 0) {
+        item->type = METADATA_TYPE_NUMERIC;
+        NumericMetadata* numeric = &item->value.numeric;
+
+        // Parse numeric values
+        const char* min_field = find_json_field(item_json, "min");
+        const char* max_field = find_json_field(item_json, "max");
+        const char* avg_field = find_json_field(item_json, "avg");
+        const char* mode_field = find_json_field(item_json, "mode");
+        const char* mode_count_field = find_json_field(item_json, "mode_count");
+        const char* total_count_field = find_json_field(item_json, "total_count");
+        const char* null_count_field = find_json_field(item_json, "null_count");
+        const char* p50_field = find_json_field(item_json, "p50");
+        const char* p95_field = find_json_field(item_json, "p95");
+        const char* p99_field = find_json_field(item_json, "p99");
+
+        if (min_field) extract_json_double(min_field, &numeric->min_value);
+        if (max_field) extract_json_double(max_field, &numeric->max_value);
+        if (avg_field) extract_json_double(avg_field, &numeric->avg_value);
+        if (mode_field) extract_json_double(mode_field, &numeric->mode_value);
+        if (p50_field) extract_json_double(p50_field, &numeric->p50);
+        if (p95_field) extract_json_double(p95_field, &numeric->p95);
+        if (p99_field) extract_json_double(p99_field, &numeric->p99);
+        numeric->mean_value = numeric->avg_value;
+        numeric->has_numeric_data = true;
+
+        if (mode_count_field) {
+            uint64_t count;
+            if (extract_json_uint64(mode_count_field, &count)) {
+                numeric->mode_count = count;
+            }
+        }
+
+        if (total_count_field) {
+            uint64_t count;
+            if (extract_json_uint64(total_count_field, &count)) {
+                numeric->total_count = count;
+            }
+        }
+
+        if (null_count_field) {
+            uint32_t count;
+            if (extract_json_uint32(null_count_field, &count)) {
+                numeric->null_count = count;
+            }
+        }
+
+        // Values known only from footer statistics come without mean, mode and percentiles
+        const char* from_footer_field = find_json_field(item_json, "from_footer");
+        if (from_footer_field) {
+            extract_json_bool(from_footer_field, &numeric->from_footer);
+        }
+
+        // Parse the sampling marks (present only when the mode was estimated from a row sample)
+        const char* mode_sampled_field = find_json_field(item_json, "mode_sampled");
+        bool mode_is_sampled = false;
+        if (mode_sampled_field && extract_json_bool(mode_sampled_field, &mode_is_sampled) && mode_is_sampled) {
+            const char* mode_sample_rate_field = find_json_field(item_json, "mode_sample_rate");
+            const char* mode_count_error_field = find_json_field(item_json, "mode_count_error");
+            numeric->mode_is_sampled = true;
+            if (mode_sample_rate_field) {
+                extract_json_double(mode_sample_rate_field, &numeric->mode_sample_rate);
+            }
+            if (mode_count_error_field) {
+                uint64_t error;
+                if (extract_json_uint64(mode_count_error_field, &error)) {
+                    numeric->mode_count_error = error;
+                }
+            }
+        }
+    } else if (strcmp(type_str, "categorical") == 0) {
+        item->type = METADATA_TYPE_CATEGORICAL;
+        CategoricalMetadata* categorical = &item->value.categorical;
+
+        // Parse categorical values
+        const char* total_count_field = find_json_field(item_json, "total_count");
+        const char* total_categories_field = find_json_field(item_json, "total_categories");
+        const char* distinct_count_field = find_json_field(item_json, "distinct_count");
+
+        if (total_count_field) {
+            uint64_t count;
+            if (extract_json_uint64(total_count_field, &count)) {
+                categorical->total_value_count = count;
+            }
+        }
+
+        if (total_categories_field) {
+            uint32_t count;
+            if (extract_json_uint32(total_categories_field, &count)) {
+                categorical->total_category_count = count;
+            }
+        }
+
+        if (distinct_count_field) {
+            uint64_t count;
+            if (extract_json_uint64(distinct_count_field, &count)) {
+                categorical->distinct_count = count;
+            }
+        }
+        categorical->has_categorical_data = true;
+
+        // Parse categories
+        const char* categories_field = find_json_field(item_json, "categories");
+        if (categories_field) {
+            categorical->high_freq_category_count = parse_counted_strings(categories_field, "category",
+                                                                          categorical->categories,
+                                                                          categorical->category_counts,
+                                                                          MAX_HIGH_FREQ_CATEGORIES);
+        }
+    } else if (strcmp(type_str, "custom") == 0) {
+        item->type = METADATA_TYPE_CUSTOM;
+        // Custom metadata is handled separately
+    }
 }
 
 /**
@@ -377,7 +833,7 @@ char* metadata_to_json(const Metadata* metadata) {
  * 
  * This function parses a JSON string into a metadata structure.
  * The caller is responsible for freeing the returned metadata using
- * metadata_generator_free_metadata.
+ * metadata_release.
  * 
  * json_string: JSON string to parse
  * metadata: Pointer to store the parsed metadata structure
@@ -411,7 +867,7 @@ JsonSerializationError json_serialization_json_to_metadata(
         if (extract_json_string(file_path_field, file_path, sizeof(file_path))) {
             (*metadata)->file_path = strdup(file_path);
             if (!(*metadata)->file_path) {
-                metadata_generator_free_metadata(*metadata);
+                metadata_release(*metadata);
                 *metadata = NULL;
                 snprintf(s_error_message, sizeof(s_error_message),
                         "Failed to allocate memory for file path");
@@ -461,7 +917,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                 (*metadata)->file_metadata.basic_metadata_count * sizeof(MetadataItem));
             
             if (!(*metadata)->file_metadata.basic_metadata) {
-                metadata_generator_free_metadata(*metadata);
+                metadata_release(*metadata);
                 *metadata = NULL;
                 snprintf(s_error_message, sizeof(s_error_message),
                         "Failed to allocate memory for basic metadata items");
@@ -474,7 +930,7 @@ JsonSerializationError json_serialization_json_to_metadata(
             
             // Parse each basic metadata item
             const char* p = basic_metadata_field;
-            int item_count = 0;
+            uint32_t item_count = 0;
             
             while (item_count < (*metadata)->file_metadata.basic_metadata_count) {
                 // Find the start of the item
@@ -482,14 +938,14 @@ JsonSerializationError json_serialization_json_to_metadata(
                 if (!p) break;
                 
                 // Find the end of this item
-                const char* item_end = find_matching_bracket(p);
+                const char* item_end = find_matching_bracket(p, '{', '}');
                 if (!item_end) break;
                 
                 // Extract the item JSON
                 size_t item_len = item_end - p + 1;
                 char* item_json = (char*)malloc(item_len + 1);
                 if (!item_json) {
-                    metadata_generator_free_metadata(*metadata);
+                    metadata_release(*metadata);
                     *metadata = NULL;
                     snprintf(s_error_message, sizeof(s_error_message),
                             "Failed to allocate memory for item JSON");
@@ -501,163 +957,8 @@ JsonSerializationError json_serialization_json_to_metadata(
                 
                 MetadataItem* item = &(*metadata)->file_metadata.basic_metadata[item_count];
                 
-                // Parse name
-                const char* name_field = find_json_field(item_json, "name");
-                if (name_field) {
-                    extract_json_string(name_field, item->name, MAX_METADATA_ITEM_NAME_LENGTH);
-                }
-                
-                // Parse type
-                const char* type_field = find_json_field(item_json, "type");
-                if (type_field) {
-                    char type_str[32];
-                    if (extract_json_string(type_field, type_str, sizeof(type_str))) {
-                        if (strcmp(type_str, "timestamp") == 0) {
-                            item->type = METADATA_TYPE_TIMESTAMP;
-                            
-                            // Parse timestamp values
-                            const char* min_field = find_json_field(item_json, "min_timestamp");
-                            const char* max_field = find_json_field(item_json, "max_timestamp");
-                            const char* count_field = find_json_field(item_json, "count");
-                            
-                            if (min_field) {
-                                char min_str[32];
-                                if (extract_json_string(min_field, min_str, sizeof(min_str))) {
-                                    // Convert string to time_t (simplified)
-                                    struct tm tm = {0};
-                                    if (strptime(min_str, "%Y-%m-%dT%H:%M:%S", &tm)) {
-                                        item->value.timestamp.min_timestamp = mktime(&tm);
-                                    }
-                                }
-                            }
-                            
-                            if (max_field) {
-                                char max_str[32];
-                                if (extract_json_string(max_field, max_str, sizeof(max_str))) {
-                                    // Convert string to time_t (simplified)
-                                    struct tm tm = {0};
-                                    if (strptime(max_str, "%Y-%m-%dT%H:%M:%S", &tm)) {
-                                        item->value.timestamp.max_timestamp = mktime(&tm);
-                                    }
-                                }
-                            }
-                            
-                            if (count_field) {
-                                uint64_t count;
-                                if (extract_json_uint64(count_field, &count)) {
-                                    item->value.timestamp.count = count;
-                                }
-                            }
-                        } else if (strcmp(type_str, "string") == 0) {
-                            item->type = METADATA_TYPE_STRING;
-                            
-                            // Parse string values
-                            const char* total_count_field = find_json_field(item_json, "total_count");
-                            const char* avg_length_field = find_json_field(item_json, "avg_length");
-                            
-                            if (total_count_field) {
-                                uint64_t count;
-                                if (extract_json_uint64(total_count_field, &count)) {
-                                    item->value.string.total_string_count = count;
-                                }
-                            }
-                            
-                            if (avg_length_field) {
-                                uint32_t avg_length;
-                                if (extract_json_uint32(avg_length_field, &avg_length)) {
-                                    item->value.string.avg_string_length = avg_length;
-                                }
-                            }
-                            
-                            // Parse high frequency strings
-                            const char* high_freq_field = find_json_field(item_json, "high_freq_strings");
-                            if (high_freq_field) {
-                                parse_string_array(high_freq_field, item->value.string.high_freq_strings, 
-                                                 item->value.string.high_freq_counts, 
-                                                 MAX_HIGH_FREQ_STRINGS, MAX_STRING_LENGTH,
-                                                 &item->value.string.high_freq_count);
-                            }
-                            
-                            // Parse special strings
-                            const char* special_field = find_json_field(item_json, "special_strings");
-                            if (special_field) {
-                                parse_string_array(special_field, item->value.string.special_strings,
-                                                 item->value.string.special_string_counts,
-                                                 MAX_SPECIAL_STRINGS, MAX_STRING_LENGTH,
-                                                 &item->value.string.special_string_count);
-                            }
-                        } else if (strcmp(type_str, "numeric") == 0) {
-                            item->type = METADATA_TYPE_NUMERIC;
-                            
-                            // Parse numeric values
-                            const char* min_field = find_json_field(item_json, "min");
-                            const char* max_field = find_json_field(item_json, "max");
-                            const char* avg_field = find_json_field(item_json, "avg");
-                            const char* mode_field = find_json_field(item_json, "mode");
-                            const char* mode_count_field = find_json_field(item_json, "mode_count");
-                            const char* total_count_field = find_json_field(item_json, "total_count");
-                            const char* null_count_field = find_json_field(item_json, "null_count");
-                            
-                            if (min_field) extract_json_double(min_field, &item->value.numeric.min_value);
-                            if (max_field) extract_json_double(max_field, &item->value.numeric.max_value);
-                            if (avg_field) extract_json_double(avg_field, &item->value.numeric.avg_value);
-                            if (mode_field) extract_json_double(mode_field, &item->value.numeric.mode_value);
-                            
-                            if (mode_count_field) {
-                                uint64_t count;
-                                if (extract_json_uint64(mode_count_field, &count)) {
-                                    item->value.numeric.mode_count = count;
-                                }
-                            }
-                            
-                            if (total_count_field) {
-                                uint64_t count;
-                                if (extract_json_uint64(total_count_field, &count)) {
-                                    item->value.numeric.total_count = count;
-                                }
-                            }
-                            
-                            if (null_count_field) {
-                                uint32_t count;
-                                if (extract_json_uint32(null_count_field, &count)) {
-                                    item->value.numeric.null_count = count;
-                                }
-                            }
-                        } else if (strcmp(type_str, "categorical") == 0) {
-                            item->type = METADATA_TYPE_CATEGORICAL;
-                            
-                            // Parse categorical values
-                            const char* total_count_field = find_json_field(item_json, "total_count");
-                            const char* total_categories_field = find_json_field(item_json, "total_categories");
-                            
-                            if (total_count_field) {
-                                uint64_t count;
-                                if (extract_json_uint64(total_count_field, &count)) {
-                                    item->value.categorical.total_value_count = count;
-                                }
-                            }
-                            
-                            if (total_categories_field) {
-                                uint32_t count;
-                                if (extract_json_uint32(total_categories_field, &count)) {
-                                    item->value.categorical.total_category_count = count;
-                                }
-                            }
-                            
-                            // Parse categories
-                            const char* categories_field = find_json_field(item_json, "categories");
-                            if (categories_field) {
-                                parse_string_array(categories_field, item->value.categorical.categories,
-                                                 item->value.categorical.category_counts,
-                                                 MAX_HIGH_FREQ_CATEGORIES, MAX_STRING_LENGTH,
-                                                 &item->value.categorical.high_freq_category_count);
-                            }
-                        } else if (strcmp(type_str, "custom") == 0) {
-                            item->type = METADATA_TYPE_CUSTOM;
-                            // Custom metadata is handled separately
-                        }
-                    }
-                }
+                // Parse the item
+                deserialize_metadata_item(item_json, item);
                 
                 free(item_json);
                 item_count++;
@@ -673,7 +974,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                 (*metadata)->file_metadata.custom_metadata_count * sizeof(CustomMetadataItem));
             
             if (!(*metadata)->file_metadata.custom_metadata) {
-                metadata_generator_free_metadata(*metadata);
+                metadata_release(*metadata);
                 *metadata = NULL;
                 snprintf(s_error_message, sizeof(s_error_message),
                         "Failed to allocate memory for custom metadata items");
@@ -686,7 +987,7 @@ JsonSerializationError json_serialization_json_to_metadata(
             
             // Parse each custom metadata item
             const char* p = custom_metadata_field;
-            int item_count = 0;
+            uint32_t item_count = 0;
             
             while (item_count < (*metadata)->file_metadata.custom_metadata_count) {
                 // Find the start of the item
@@ -694,14 +995,14 @@ JsonSerializationError json_serialization_json_to_metadata(
                 if (!p) break;
                 
                 // Find the end of this item
-                const char* item_end = find_matching_bracket(p);
+                const char* item_end = find_matching_bracket(p, '{', '}');
                 if (!item_end) break;
                 
                 // Extract the item JSON
                 size_t item_len = item_end - p + 1;
                 char* item_json = (char*)malloc(item_len + 1);
                 if (!item_json) {
-                    metadata_generator_free_metadata(*metadata);
+                    metadata_release(*metadata);
                     *metadata = NULL;
                     snprintf(s_error_message, sizeof(s_error_message),
                             "Failed to allocate memory for item JSON");
@@ -746,17 +1047,12 @@ JsonSerializationError json_serialization_json_to_metadata(
                 // Parse result matrix if present
                 const char* matrix_field = find_json_field(item_json, "result_matrix");
                 if (matrix_field) {
-                    char matrix_str[MAX_METADATA_JSON_SIZE];
-                    if (extract_json_string(matrix_field, matrix_str, sizeof(matrix_str))) {
-                        // Allocate memory for the result matrix
-                        size_t matrix_size = item->row_group_count * item->column_count;
-                        if (matrix_size > 0) {
-                            item->result_matrix = (char*)malloc(matrix_size + 1);
-                            if (item->result_matrix) {
-                                strncpy(item->result_matrix, matrix_str, matrix_size);
-                                item->result_matrix[matrix_size] = '\0';
-                            }
-                        }
+                    // The matrix is never longer than the item's JSON
+                    item->result_matrix = (char*)malloc(item_len + 1);
+                    if (item->result_matrix &&
+                        !extract_json_string(matrix_field, item->result_matrix, item_len + 1)) {
+                        free(item->result_matrix);
+                        item->result_matrix = NULL;
                     }
                 }
                 
@@ -783,7 +1079,7 @@ JsonSerializationError json_serialization_json_to_metadata(
             (*metadata)->row_group_metadata_count * sizeof(RowGroupMetadata));
         
         if (!(*metadata)->row_group_metadata) {
-            metadata_generator_free_metadata(*metadata);
+            metadata_release(*metadata);
             *metadata = NULL;
             snprintf(s_error_message, sizeof(s_error_message),
                     "Failed to allocate memory for row group metadata");
@@ -796,7 +1092,7 @@ JsonSerializationError json_serialization_json_to_metadata(
         
         // Parse each row group
         const char* p = row_group_metadata_field;
-        int group_count = 0;
+        uint32_t group_count = 0;
         
         while (group_count < (*metadata)->row_group_metadata_count) {
             // Find the start of the row group
@@ -804,14 +1100,14 @@ JsonSerializationError json_serialization_json_to_metadata(
             if (!p) break;
             
             // Find the end of this row group
-            const char* group_end = find_matching_bracket(p);
+            const char* group_end = find_matching_bracket(p, '{', '}');
             if (!group_end) break;
             
             // Extract the row group JSON
             size_t group_len = group_end - p + 1;
             char* group_json = (char*)malloc(group_len + 1);
             if (!group_json) {
-                metadata_generator_free_metadata(*metadata);
+                metadata_release(*metadata);
                 *metadata = NULL;
                 snprintf(s_error_message, sizeof(s_error_message),
                         "Failed to allocate memory for row group JSON");
@@ -832,6 +1128,12 @@ JsonSerializationError json_serialization_json_to_metadata(
                 }
             }
             
+            // Parse row count
+            const char* row_count_field = find_json_field(group_json, "row_count");
+            if (row_count_field) {
+                extract_json_uint64(row_count_field, &row_group->row_count);
+            }
+            
             // Parse metadata count
             const char* count_field = find_json_field(group_json, "metadata_count");
             if (count_field) {
@@ -849,7 +1151,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                 
                 if (!row_group->metadata) {
                     free(group_json);
-                    metadata_generator_free_metadata(*metadata);
+                    metadata_release(*metadata);
                     *metadata = NULL;
                     snprintf(s_error_message, sizeof(s_error_message),
                             "Failed to allocate memory for row group metadata items");
@@ -865,7 +1167,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                 if (metadata_field) {
                     // Parse metadata items
                     const char* q = metadata_field;
-                    int item_count = 0;
+                    uint32_t item_count = 0;
                     
                     while (item_count < row_group->metadata_count) {
                         // Find the start of the item
@@ -873,7 +1175,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                         if (!q) break;
                         
                         // Find the end of this item
-                        const char* item_end = find_matching_bracket(q);
+                        const char* item_end = find_matching_bracket(q, '{', '}');
                         if (!item_end) break;
                         
                         // Extract the item JSON
@@ -881,7 +1183,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                         char* item_json = (char*)malloc(item_len + 1);
                         if (!item_json) {
                             free(group_json);
-                            metadata_generator_free_metadata(*metadata);
+                            metadata_release(*metadata);
                             *metadata = NULL;
                             snprintf(s_error_message, sizeof(s_error_message),
                                     "Failed to allocate memory for metadata item JSON");
@@ -893,8 +1195,8 @@ JsonSerializationError json_serialization_json_to_metadata(
                         
                         MetadataItem* item = &row_group->metadata[item_count];
                         
-                        // Parse item (name and type)
-                        parse_metadata_item(item_json, item);
+                        // Parse the item
+                        deserialize_metadata_item(item_json, item);
                         
                         free(item_json);
                         item_count++;
@@ -902,7 +1204,82 @@ JsonSerializationError json_serialization_json_to_metadata(
                     }
                 }
             }
-            
+
+            // Parse Bloom filters; a filter that cannot be read is dropped
+            const char* bloom_field = find_json_field(group_json, "bloom_filters");
+            const char* bloom_end = bloom_field && *bloom_field == '[' ?
+                find_matching_bracket(bloom_field, '[', ']') : NULL;
+            if (bloom_end) {
+                uint32_t bloom_capacity = 0;
+                for (const char* c = bloom_field; c < bloom_end; c++) {
+                    if (*c == '{') {
+                        bloom_capacity++;
+                    }
+                }
+
+                if (bloom_capacity > 0) {
+                    row_group->bloom_filters = (ColumnBloomFilter*)calloc(
+                        bloom_capacity, sizeof(ColumnBloomFilter));
+                    if (!row_group->bloom_filters) {
+                        free(group_json);
+                        metadata_release(*metadata);
+                        *metadata = NULL;
+                        snprintf(s_error_message, sizeof(s_error_message),
+                                "Failed to allocate memory for row group Bloom filters");
+                        return JSON_SERIALIZATION_MEMORY_ERROR;
+                    }
+                }
+
+                const char* q = bloom_field;
+                while (row_group->bloom_filter_count < bloom_capacity) {
+                    q = strchr(q, '{');
+                    if (!q || q > bloom_end) break;
+
+                    const char* item_end = find_matching_bracket(q, '{', '}');
+                    if (!item_end) break;
+
+                    size_t item_len = item_end - q + 1;
+                    char* item_json = (char*)malloc(item_len + 1);
+                    char* blocks = (char*)malloc(item_len + 1);
+                    if (!item_json || !blocks) {
+                        free(item_json);
+                        free(blocks);
+                        free(group_json);
+                        metadata_release(*metadata);
+                        *metadata = NULL;
+                        snprintf(s_error_message, sizeof(s_error_message),
+                                "Failed to allocate memory for Bloom filter JSON");
+                        return JSON_SERIALIZATION_MEMORY_ERROR;
+                    }
+
+                    strncpy(item_json, q, item_len);
+                    item_json[item_len] = '\0';
+
+                    ColumnBloomFilter* bloom = &row_group->bloom_filters[row_group->bloom_filter_count];
+                    uint32_t value_type = 0;
+                    const char* column_index_field = find_json_field(item_json, "column_index");
+                    const char* column_name_field = find_json_field(item_json, "column_name");
+                    const char* value_type_field = find_json_field(item_json, "value_type");
+                    const char* blocks_field = find_json_field(item_json, "blocks");
+                    if (column_index_field && column_name_field && value_type_field && blocks_field &&
+                        extract_json_uint32(column_index_field, &bloom->column_index) &&
+                        extract_json_string(column_name_field, bloom->column_name, MAX_METADATA_ITEM_NAME_LENGTH) &&
+                        extract_json_uint32(value_type_field, &value_type) &&
+                        extract_json_string(blocks_field, blocks, item_len + 1) &&
+                        bloom_filter_decode(&bloom->filter, blocks) == 0) {
+                        bloom->value_type = (ParquetValueType)value_type;
+                        row_group->bloom_filter_count++;
+                    } else {
+                        bloom_filter_free(&bloom->filter);
+                        memset(bloom, 0, sizeof(ColumnBloomFilter));
+                    }
+
+                    free(item_json);
+                    free(blocks);
+                    q = item_end + 1;
+                }
+            }
+
             free(group_json);
             group_count++;
             p = group_end + 1;
@@ -925,7 +1302,7 @@ JsonSerializationError json_serialization_json_to_metadata(
             (*metadata)->column_metadata_count * sizeof(ColumnMetadata));
         
         if (!(*metadata)->column_metadata) {
-            metadata_generator_free_metadata(*metadata);
+            metadata_release(*metadata);
             *metadata = NULL;
             snprintf(s_error_message, sizeof(s_error_message),
                     "Failed to allocate memory for column metadata");
@@ -938,7 +1315,7 @@ JsonSerializationError json_serialization_json_to_metadata(
         
         // Parse each column
         const char* p = column_metadata_field;
-        int column_count = 0;
+        uint32_t column_count = 0;
         
         while (column_count < (*metadata)->column_metadata_count) {
             // Find the start of the column
@@ -946,14 +1323,14 @@ JsonSerializationError json_serialization_json_to_metadata(
             if (!p) break;
             
             // Find the end of this column
-            const char* column_end = find_matching_bracket(p);
+            const char* column_end = find_matching_bracket(p, '{', '}');
             if (!column_end) break;
             
             // Extract the column JSON
             size_t column_len = column_end - p + 1;
             char* column_json = (char*)malloc(column_len + 1);
             if (!column_json) {
-                metadata_generator_free_metadata(*metadata);
+                metadata_release(*metadata);
                 *metadata = NULL;
                 snprintf(s_error_message, sizeof(s_error_message),
                         "Failed to allocate memory for column JSON");
@@ -997,7 +1374,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                 
                 if (!column->metadata) {
                     free(column_json);
-                    metadata_generator_free_metadata(*metadata);
+                    metadata_release(*metadata);
                     *metadata = NULL;
                     snprintf(s_error_message, sizeof(s_error_message),
                             "Failed to allocate memory for column metadata items");
@@ -1013,7 +1390,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                 if (metadata_field) {
                     // Parse metadata items
                     const char* q = metadata_field;
-                    int item_count = 0;
+                    uint32_t item_count = 0;
                     
                     while (item_count < column->metadata_count) {
                         // Find the start of the item
@@ -1021,7 +1398,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                         if (!q) break;
                         
                         // Find the end of this item
-                        const char* item_end = find_matching_bracket(q);
+                        const char* item_end = find_matching_bracket(q, '{', '}');
                         if (!item_end) break;
                         
                         // Extract the item JSON
@@ -1029,7 +1406,7 @@ JsonSerializationError json_serialization_json_to_metadata(
                         char* item_json = (char*)malloc(item_len + 1);
                         if (!item_json) {
                             free(column_json);
-                            metadata_generator_free_metadata(*metadata);
+                            metadata_release(*metadata);
                             *metadata = NULL;
                             snprintf(s_error_message, sizeof(s_error_message),
                                     "Failed to allocate memory for metadata item JSON");
@@ -1041,8 +1418,8 @@ JsonSerializationError json_serialization_json_to_metadata(
                         
                         MetadataItem* item = &column->metadata[item_count];
                         
-                        // Parse item (name and type)
-                        parse_metadata_item(item_json, item);
+                        // Parse the item
+                        deserialize_metadata_item(item_json, item);
                         
                         free(item_json);
                         item_count++;
@@ -1118,7 +1495,7 @@ JsonSerializationError json_serialization_save_to_binary(
  * 
  * This function reads a binary file created with json_serialization_save_to_binary
  * and parses it into a metadata structure. The caller is responsible for
- * freeing the returned metadata using metadata_generator_free_metadata.
+ * freeing the returned metadata using metadata_release.
  * 
  * file_path: Path to the binary file
  * metadata: Pointer to store the parsed metadata structure
@@ -1194,7 +1571,8 @@ void json_serialization_free_string(char* json_string) {
  * Get the last error message from JSON serialization operations
  * 
  * This function returns a string describing the last error that occurred.
- * The returned string is valid until the next call to any JSON serialization function.
+ * The returned string is valid until the next call to any JSON serialization function
+ * on the same thread.
  * 
  * returns: A string describing the last error, or NULL if no error occurred
  */
@@ -1211,7 +1589,7 @@ const char* json_serialization_get_error(void) {
  */
 char* json_serialize_metadata(const Metadata* metadata) {
     if (!metadata) {
-        set_error("Invalid metadata pointer");
+        snprintf(s_error_message, sizeof(s_error_message), "Invalid metadata pointer");
         return NULL;
     }
     
@@ -6,6 +6,7 @@
 
 #include "metadata/json_helper.h"
 #include "metadata/metadata_types.h"
+#include "core/platform.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -21,7 +22,7 @@
 #define MAX_CATEGORIES 20
 
 /* Static global for error messages */
-static char s_error_message[MAX_JSON_ERROR_LENGTH];
+static INFPARQUET_THREAD_LOCAL char s_error_message[MAX_JSON_ERROR_LENGTH];
 
 /**
  * Find a field in a JSON string
@@ -170,6 +171,37 @@ bool extract_json_string(const char* json, char* result, size_t max_length) {
                 case 'n': result[i++] = '\n'; break;
                 case 'r': result[i++] = '\r'; break;
                 case 't': result[i++] = '\t'; break;
+                case 'u': {
+                    // \uXXXX, written back as UTF-8 when it fits
+                    unsigned code = 0;
+                    int digits = 0;
+                    while (digits < 4 && isxdigit((unsigned char)json[1 + digits])) {
+                        char digit = json[1 + digits];
+                        code = code * 16 + (unsigned)(isdigit((unsigned char)digit) ? digit - '0' :
+                                                      tolower((unsigned char)digit) - 'a' + 10);
+                        digits++;
+                    }
+                    if (digits < 4) {
+                        result[i++] = *json;  // Malformed, copied like an unknown escape
+                        break;
+                    }
+                    json += 4;
+                    size_t bytes = code < 0x80 ? 1 : code < 0x800 ? 2 : 3;
+                    if (i + bytes > max_length - 1) {
+                        break;
+                    }
+                    if (bytes == 1) {
+                        result[i++] = (char)code;
+                    } else if (bytes == 2) {
+                        result[i++] = (char)(0xC0 | (code >> 6));
+                        result[i++] = (char)(0x80 | (code & 0x3F));
+                    } else {
+                        result[i++] = (char)(0xE0 | (code >> 12));
+                        result[i++] = (char)(0x80 | ((code >> 6) & 0x3F));
+                        result[i++] = (char)(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
                 default:
                     // Unknown escape sequence, just copy it
                     result[i++] = *json;
@@ -565,6 +597,51 @@ int parse_string_array(const char* json, char** strings, uint32_t* counts, int m
     return count;
 }
 
+/**
+ * Parse an array of unsigned integers from a JSON string
+ * 
+ * json: The JSON string containing the array
+ * values: Array to store the values
+ * max_count: Maximum number of values to parse
+ * 
+ * Return: Number of values parsed, or -1 on error
+ */
+int parse_uint64_array(const char* json, uint64_t* values, int max_count) {
+    if (!json || !values || max_count <= 0) {
+        return -1;
+    }
+    
+    // Skip to the array start
+    while (*json && *json != '[') {
+        json++;
+    }
+    if (*json != '[') {
+        return -1;
+    }
+    json++;
+    
+    // Parse array elements
+    int count = 0;
+    while (count < max_count) {
+        while (*json && (isspace((unsigned char)*json) || *json == ',')) {
+            json++;
+        }
+        if (!*json || *json == ']') {
+            break;
+        }
+        
+        char* end = NULL;
+        unsigned long long value = strtoull(json, &end, 10);
+        if (end == json) {
+            return -1;
+        }
+        values[count++] = (uint64_t)value;
+        json = end;
+    }
+    
+    return count;
+}
+
 /**
  * Set an error message
  * 
@@ -591,16 +668,6 @@ const char* json_helper_get_error() {
     return s_error_message[0] ? s_error_message : NULL;
 }
 
-/**
- * Serialize metadata to JSON
- * 
- * This function is a wrapper for the actual implementation in json_serialization.c
- */
-char* json_serialization_metadata_to_json(const Metadata* metadata) {
-    // This is implemented in json_serialization.c, we're just providing a linking stub
-    return NULL;
-}
-
 /**
  * Parse a metadata item from a JSON string
  */
@@ -653,6 +720,26 @@ bool parse_metadata_item(const char* json, MetadataItem* item) {
             if (count) {
                 extract_json_uint64(count, &item->value.timestamp.count);
             }
+            
+            // Timestamps known only from footer statistics come without percentiles
+            const char* from_footer = find_json_field(json, "from_footer");
+            if (from_footer) extract_json_bool(from_footer, &item->value.timestamp.from_footer);
+            
+            // Parse percentiles (absent from metadata written before they existed)
+            const char* percentile_names[3] = {"p50", "p95", "p99"};
+            time_t* percentiles[3] = {&item->value.timestamp.p50,
+                                      &item->value.timestamp.p95,
+                                      &item->value.timestamp.p99};
+            for (int p = 0; p < 3; p++) {
+                const char* percentile = find_json_field(json, percentile_names[p]);
+                if (percentile) {
+                    char percentile_str[32];
+                    extract_json_string(percentile, percentile_str, sizeof(percentile_str));
+                    struct tm tm = {0};
+                    strptime(percentile_str, "%Y-%m-%dT%H:%M:%S", &tm);
+                    *percentiles[p] = mktime(&tm);
+                }
+            }
         } else if (strcmp(type_str, "string") == 0) {
             item->type = METADATA_TYPE_STRING;
             
@@ -758,6 +845,29 @@ bool parse_metadata_item(const char* json, MetadataItem* item) {
                     }
                 }
             }
+            
+            // Parse the sampling marks, present only when the counts were estimated from a row sample
+            const char* sampled = find_json_field(json, "sampled");
+            bool is_sampled = false;
+            if (sampled && extract_json_bool(sampled, &is_sampled) && is_sampled) {
+                item->value.string.is_sampled = true;
+                
+                const char* sample_rate = find_json_field(json, "sample_rate");
+                const char* count_errors = find_json_field(json, "count_errors");
+                const char* special_count_errors = find_json_field(json, "special_count_errors");
+                if (sample_rate) extract_json_double(sample_rate, &item->value.string.sample_rate);
+                if (count_errors) {
+                    parse_uint64_array(count_errors, item->value.string.sample_errors, MAX_HIGH_FREQ_STRINGS);
+                }
+                if (special_count_errors) {
+                    uint64_t errors[MAX_SPECIAL_STRINGS];
+                    int error_count = parse_uint64_array(special_count_errors, errors, MAX_SPECIAL_STRINGS);
+                    for (int i = 0; i < error_count; i++) {
+                        item->value.string.special_string_errors[i] =
+                            errors[i] > UINT32_MAX ? UINT32_MAX : (uint32_t)errors[i];
+                    }
+                }
+            }
         } else if (strcmp(type_str, "numeric") == 0) {
             item->type = METADATA_TYPE_NUMERIC;
             
@@ -777,12 +887,36 @@ bool parse_metadata_item(const char* json, MetadataItem* item) {
             if (mode_count) extract_json_uint64(mode_count, &item->value.numeric.mode_count);
             if (total_count) extract_json_uint64(total_count, &item->value.numeric.total_count);
             if (null_count) extract_json_uint32(null_count, &item->value.numeric.null_count);
+            
+            const char* p50 = find_json_field(json, "p50");
+            const char* p95 = find_json_field(json, "p95");
+            const char* p99 = find_json_field(json, "p99");
+            if (p50) extract_json_double(p50, &item->value.numeric.p50);
+            if (p95) extract_json_double(p95, &item->value.numeric.p95);
+            if (p99) extract_json_double(p99, &item->value.numeric.p99);
+            
+            // Values known only from footer statistics come without mean, mode and percentiles
+            const char* from_footer = find_json_field(json, "from_footer");
+            if (from_footer) extract_json_bool(from_footer, &item->value.numeric.from_footer);
+            
+            // Parse the sampling marks, present only when the mode was estimated from a row sample
+            const char* mode_sampled = find_json_field(json, "mode_sampled");
+            bool mode_is_sampled = false;
+            if (mode_sampled && extract_json_bool(mode_sampled, &mode_is_sampled) && mode_is_sampled) {
+                item->value.numeric.mode_is_sampled = true;
+                
+                const char* mode_sample_rate = find_json_field(json, "mode_sample_rate");
+                const char* mode_count_error = find_json_field(json, "mode_count_error");
+                if (mode_sample_rate) extract_json_double(mode_sample_rate, &item->value.numeric.mode_sample_rate);
+                if (mode_count_error) extract_json_uint64(mode_count_error, &item->value.numeric.mode_count_error);
+            }
         } else if (strcmp(type_str, "categorical") == 0) {
             item->type = METADATA_TYPE_CATEGORICAL;
             
             // Parse categorical-specific fields
             const char* total_value_count = find_json_field(json, "total_count");
             const char* total_category_count = find_json_field(json, "total_categories");
+            const char* distinct_count = find_json_field(json, "distinct_count");
             
             if (total_value_count) {
                 extract_json_uint64(total_value_count, &item->value.categorical.total_value_count);
@@ -792,6 +926,10 @@ bool parse_metadata_item(const char* json, MetadataItem* item) {
                 extract_json_uint32(total_category_count, &item->value.categorical.total_category_count);
             }
             
+            if (distinct_count) {
+                extract_json_uint64(distinct_count, &item->value.categorical.distinct_count);
+            }
+            
             // Parse categories
             const char* categories = find_json_field(json, "categories");
             if (categories) {
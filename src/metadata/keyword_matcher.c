@@ -0,0 +1,375 @@
+/**
+ * keyword_matcher.c
+ *
+ * This file implements the keyword matcher declared in keyword_matcher.h.
+ * Bytes are first mapped to classes: one per letter or other byte occurring
+ * in a keyword, with both cases of a letter sharing a class, and one for
+ * every other byte. The trie of the keywords over these classes is turned
+ * into a complete transition table by following failure links while it is
+ * built breadth first, so scanning never backtracks. States where a keyword
+ * ends, directly or through their failure chain, point to the deepest such
+ * state; keywords ending in the same state are chained.
+ *
+ * Transitions hold the offset of the target's row rather than its number,
+ * and flag targets that report keywords, so the scan loop is a single
+ * dependent load per byte. When every keyword has at least three bytes, a
+ * prefilter runs first: a bitmap indexed by the raw bytes of each pair,
+ * with every case variant of the keywords' leading pairs set, and on a hit
+ * a bitmap of the keywords' leading class trigrams. Its lookups do not
+ * depend on each other, so strings without a candidate are rejected several
+ * times faster than the automaton could walk them, and the automaton starts
+ * at the first candidate.
+ */
+
+#include "metadata/keyword_matcher.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Marks the end of state and keyword chains */
+#define NONE UINT32_MAX
+
+/* Set in a transition whose target state reports keywords */
+#define REPORT_FLAG 0x80000000u
+
+/* Largest class field of a trigram index, in bits */
+#define MAX_TRIGRAM_SHIFT 6
+
+struct KeywordMatcher {
+    uint8_t byte_class[256];
+    uint8_t* bigrams;          /* Bit per byte pair, loaded as a uint16_t, that may start a keyword */
+    uint8_t* trigrams;         /* Bit per class trigram starting a keyword (NULL: no prefilter) */
+    uint32_t trigram_shift;    /* Bits per class in a trigram index */
+    uint32_t class_count;
+    uint32_t state_count;
+    uint32_t* transitions;     /* state_count x class_count; each holds the target's row offset and REPORT_FLAG */
+    uint32_t* report;          /* Deepest state on the failure chain where a keyword ends, or NONE */
+    uint32_t* report_next;     /* For states where a keyword ends: the next such state down the failure chain */
+    uint32_t* state_keyword;   /* First keyword ending in each state, or NONE */
+    uint32_t* keyword_next;    /* Next keyword ending in the same state, or NONE */
+    char** keywords;
+    uint32_t keyword_count;
+};
+
+static uint8_t fold_case(uint8_t byte) {
+    return byte >= 'A' && byte <= 'Z' ? (uint8_t)(byte - 'A' + 'a') : byte;
+}
+
+/* Give every byte of the keywords its own class, case folded */
+static void assign_classes(KeywordMatcher* matcher) {
+    memset(matcher->byte_class, 0, sizeof(matcher->byte_class));
+    matcher->class_count = 1;
+    for (uint32_t k = 0; k < matcher->keyword_count; k++) {
+        for (const char* p = matcher->keywords[k]; p && *p; p++) {
+            uint8_t byte = fold_case((uint8_t)*p);
+            if (matcher->byte_class[byte] == 0) {
+                matcher->byte_class[byte] = (uint8_t)matcher->class_count++;
+            }
+        }
+    }
+    for (int byte = 'A'; byte <= 'Z'; byte++) {
+        matcher->byte_class[byte] = matcher->byte_class[byte - 'A' + 'a'];
+    }
+}
+
+/* Build the trie, then complete the transitions breadth first */
+static int build_automaton(KeywordMatcher* matcher, uint32_t max_states) {
+    uint32_t classes = matcher->class_count;
+    matcher->transitions = (uint32_t*)malloc((size_t)max_states * classes * sizeof(uint32_t));
+    matcher->report = (uint32_t*)malloc((size_t)max_states * sizeof(uint32_t));
+    matcher->report_next = (uint32_t*)malloc((size_t)max_states * sizeof(uint32_t));
+    matcher->state_keyword = (uint32_t*)malloc((size_t)max_states * sizeof(uint32_t));
+    matcher->keyword_next = (uint32_t*)malloc(((size_t)matcher->keyword_count + 1) * sizeof(uint32_t));
+    uint32_t* fail = (uint32_t*)malloc((size_t)max_states * sizeof(uint32_t));
+    uint32_t* queue = (uint32_t*)malloc((size_t)max_states * sizeof(uint32_t));
+    if (!matcher->transitions || !matcher->report || !matcher->report_next ||
+        !matcher->state_keyword || !matcher->keyword_next || !fail || !queue) {
+        free(fail);
+        free(queue);
+        return 2;
+    }
+
+    for (size_t i = 0; i < (size_t)max_states * classes; i++) {
+        matcher->transitions[i] = NONE;
+    }
+    for (uint32_t i = 0; i < max_states; i++) {
+        matcher->state_keyword[i] = NONE;
+    }
+
+    // Trie of the case-folded keywords
+    matcher->state_count = 1;
+    for (uint32_t k = 0; k < matcher->keyword_count; k++) {
+        const char* keyword = matcher->keywords[k];
+        matcher->keyword_next[k] = NONE;
+        if (!keyword || !*keyword) {
+            continue;
+        }
+        uint32_t state = 0;
+        for (const char* p = keyword; *p; p++) {
+            uint32_t* next = &matcher->transitions[(size_t)state * classes + matcher->byte_class[(uint8_t)*p]];
+            if (*next == NONE) {
+                *next = matcher->state_count++;
+            }
+            state = *next;
+        }
+        matcher->keyword_next[k] = matcher->state_keyword[state];
+        matcher->state_keyword[state] = k;
+    }
+
+    // Breadth first, so the failure state of a state is complete before the state itself
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    fail[0] = 0;
+    matcher->report[0] = NONE;
+    matcher->report_next[0] = NONE;
+    queue[tail++] = 0;
+    while (head < tail) {
+        uint32_t state = queue[head++];
+        uint32_t* row = &matcher->transitions[(size_t)state * classes];
+        const uint32_t* fail_row = &matcher->transitions[(size_t)fail[state] * classes];
+        for (uint32_t c = 0; c < classes; c++) {
+            if (row[c] == NONE) {
+                row[c] = state == 0 ? 0 : fail_row[c];
+                continue;
+            }
+            uint32_t child = row[c];
+            uint32_t child_fail = state == 0 ? 0 : fail_row[c];
+            fail[child] = child_fail;
+            matcher->report_next[child] = matcher->report[child_fail];
+            matcher->report[child] = matcher->state_keyword[child] != NONE ? child : matcher->report[child_fail];
+            queue[tail++] = child;
+        }
+    }
+
+    // Store row offsets instead of state numbers
+    for (size_t i = 0; i < (size_t)matcher->state_count * classes; i++) {
+        uint32_t target = matcher->transitions[i];
+        matcher->transitions[i] = target * classes | (matcher->report[target] != NONE ? REPORT_FLAG : 0);
+    }
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+/* Bitmap of the leading class trigrams of the keywords, if every keyword has one */
+static int build_trigrams(KeywordMatcher* matcher) {
+    uint32_t shift = 1;
+    while ((1u << shift) < matcher->class_count) {
+        shift++;
+    }
+    bool usable = shift <= MAX_TRIGRAM_SHIFT && matcher->state_count > 1;
+    for (uint32_t k = 0; k < matcher->keyword_count && usable; k++) {
+        const char* keyword = matcher->keywords[k];
+        usable = !keyword || !*keyword || (keyword[1] && keyword[2]);
+    }
+    if (!usable) {
+        return 0;
+    }
+
+    matcher->trigram_shift = shift;
+    matcher->bigrams = (uint8_t*)calloc(65536 / 8, 1);
+    matcher->trigrams = (uint8_t*)calloc(((size_t)1 << (3 * shift)) / 8 + 1, 1);
+    if (!matcher->bigrams || !matcher->trigrams) {
+        return 2;
+    }
+    for (uint32_t k = 0; k < matcher->keyword_count; k++) {
+        const uint8_t* keyword = (const uint8_t*)matcher->keywords[k];
+        if (!keyword || !*keyword) {
+            continue;
+        }
+        for (int variant = 0; variant < 4; variant++) {
+            uint8_t pair_bytes[2];
+            for (int j = 0; j < 2; j++) {
+                uint8_t byte = fold_case(keyword[j]);
+                bool upper = (variant >> j) & 1;
+                pair_bytes[j] = upper && byte >= 'a' && byte <= 'z' ? (uint8_t)(byte - 'a' + 'A') : byte;
+            }
+            uint16_t pair;
+            memcpy(&pair, pair_bytes, sizeof(pair));
+            matcher->bigrams[pair / 8] |= (uint8_t)(1u << (pair % 8));
+        }
+        uint32_t index = ((uint32_t)matcher->byte_class[keyword[0]] << (2 * shift)) |
+                         ((uint32_t)matcher->byte_class[keyword[1]] << shift) |
+                         matcher->byte_class[keyword[2]];
+        matcher->trigrams[index / 8] |= (uint8_t)(1u << (index % 8));
+    }
+    return 0;
+}
+
+/**
+ * Compile a keyword list
+ */
+KeywordMatcher* keyword_matcher_create(const char* const* keywords, uint32_t keyword_count) {
+    if (!keywords && keyword_count > 0) {
+        return NULL;
+    }
+
+    KeywordMatcher* matcher = (KeywordMatcher*)calloc(1, sizeof(KeywordMatcher));
+    if (!matcher) {
+        return NULL;
+    }
+    matcher->keywords = (char**)calloc(keyword_count + 1, sizeof(char*));
+    if (!matcher->keywords) {
+        free(matcher);
+        return NULL;
+    }
+    matcher->keyword_count = keyword_count;
+
+    uint32_t max_states = 1;
+    for (uint32_t k = 0; k < keyword_count; k++) {
+        if (!keywords[k]) {
+            continue;
+        }
+        size_t length = strlen(keywords[k]);
+        matcher->keywords[k] = (char*)malloc(length + 1);
+        if (!matcher->keywords[k]) {
+            keyword_matcher_free(matcher);
+            return NULL;
+        }
+        memcpy(matcher->keywords[k], keywords[k], length + 1);
+        max_states += (uint32_t)length;
+    }
+
+    // Row offsets must leave REPORT_FLAG free
+    assign_classes(matcher);
+    if ((uint64_t)max_states * matcher->class_count >= REPORT_FLAG ||
+        build_automaton(matcher, max_states) != 0 ||
+        build_trigrams(matcher) != 0) {
+        keyword_matcher_free(matcher);
+        return NULL;
+    }
+    return matcher;
+}
+
+/**
+ * Free a matcher
+ */
+void keyword_matcher_free(KeywordMatcher* matcher) {
+    if (!matcher) {
+        return;
+    }
+    for (uint32_t k = 0; k < matcher->keyword_count; k++) {
+        free(matcher->keywords[k]);
+    }
+    free(matcher->keywords);
+    free(matcher->bigrams);
+    free(matcher->trigrams);
+    free(matcher->transitions);
+    free(matcher->report);
+    free(matcher->report_next);
+    free(matcher->state_keyword);
+    free(matcher->keyword_next);
+    free(matcher);
+}
+
+/**
+ * Get the number of keywords of a matcher
+ */
+uint32_t keyword_matcher_keyword_count(const KeywordMatcher* matcher) {
+    return matcher ? matcher->keyword_count : 0;
+}
+
+/**
+ * Get a keyword of a matcher
+ */
+const char* keyword_matcher_keyword(const KeywordMatcher* matcher, uint32_t index) {
+    return matcher && index < matcher->keyword_count ? matcher->keywords[index] : NULL;
+}
+
+/**
+ * Scan a string for keywords
+ */
+uint32_t keyword_matcher_scan(const KeywordMatcher* matcher, const char* text, size_t length,
+                              KeywordCounts* counts) {
+    if (!matcher || !text || matcher->state_count <= 1) {
+        return 0;
+    }
+
+    const uint8_t* bytes = (const uint8_t*)text;
+    const uint32_t* transitions = matcher->transitions;
+    uint32_t found = 0;
+    uint32_t offset = 0;
+    if (counts) {
+        counts->serial++;
+    }
+
+    // No keyword starts before the first trigram that starts one
+    size_t i = 0;
+    if (matcher->trigrams) {
+        const uint8_t* byte_class = matcher->byte_class;
+        const uint8_t* trigrams = matcher->trigrams;
+        const uint8_t* bigrams = matcher->bigrams;
+        uint32_t shift = matcher->trigram_shift;
+        for (; i + 2 < length; i++) {
+            uint16_t pair;
+            memcpy(&pair, bytes + i, sizeof(pair));
+            if (!(bigrams[pair / 8] & (1u << (pair % 8)))) {
+                continue;
+            }
+            uint32_t index = ((uint32_t)byte_class[bytes[i]] << (2 * shift)) |
+                             ((uint32_t)byte_class[bytes[i + 1]] << shift) | byte_class[bytes[i + 2]];
+            if (trigrams[index / 8] & (1u << (index % 8))) {
+                break;
+            }
+        }
+        if (i + 2 >= length) {
+            return 0;
+        }
+    }
+
+    while (i < length) {
+        uint32_t next = transitions[offset + matcher->byte_class[bytes[i++]]];
+        offset = next & ~REPORT_FLAG;
+        if (!(next & REPORT_FLAG)) {
+            continue;
+        }
+        if (!counts) {
+            return 1;
+        }
+
+        // Every keyword ending here, from the longest down
+        uint32_t state = offset / matcher->class_count;
+        for (uint32_t hit = matcher->report[state]; hit != NONE; hit = matcher->report_next[hit]) {
+            for (uint32_t k = matcher->state_keyword[hit]; k != NONE; k = matcher->keyword_next[k]) {
+                if (counts->last_seen[k] != counts->serial) {
+                    counts->last_seen[k] = counts->serial;
+                    counts->counts[k]++;
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * Allocate zeroed counts for the keywords of a matcher
+ */
+int keyword_counts_init(KeywordCounts* counts, const KeywordMatcher* matcher) {
+    if (!counts || !matcher) {
+        return 1;
+    }
+    memset(counts, 0, sizeof(KeywordCounts));
+    counts->counts = (uint64_t*)calloc((size_t)matcher->keyword_count + 1, sizeof(uint64_t));
+    counts->last_seen = (uint64_t*)calloc((size_t)matcher->keyword_count + 1, sizeof(uint64_t));
+    if (!counts->counts || !counts->last_seen) {
+        keyword_counts_free(counts);
+        return 2;
+    }
+    counts->keyword_count = matcher->keyword_count;
+    return 0;
+}
+
+/**
+ * Free counts
+ */
+void keyword_counts_free(KeywordCounts* counts) {
+    if (!counts) {
+        return;
+    }
+    free(counts->counts);
+    free(counts->last_seen);
+    counts->counts = NULL;
+    counts->last_seen = NULL;
+    counts->keyword_count = 0;
+}
@@ -10,8 +10,17 @@
 #include "metadata/metadata_types.h"
 #include "metadata/custom_metadata.h"
 #include "metadata/json_serialization.h"
+#include "metadata/value_frequency.h"
+#include "metadata/column_stats.h"
+#include "metadata/heavy_hitters.h"
+#include "metadata/keyword_matcher.h"
+#include "metadata/hyperloglog.h"
+#include "metadata/quantile_sketch.h"
+#include "metadata/bloom_filter.h"
+#include "compression/parallel_processor.h"
 #include "core/parquet_structure.h"
 #include "core/parquet_reader.h"
+#include "core/platform.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -27,10 +36,42 @@ extern Metadata* metadataFromJson(const char* json_str);
 
 /* Constants */
 #define MAX_METADATA_STRING_LENGTH 256
-#define MAX_SPECIAL_STRING_ARRAY 64
+
+/* Timestamps converted to seconds at once for the quantile digest */
+#define TIMESTAMP_SECONDS_BLOCK 65536
+
+/* Column chunks analyzed per worker thread in each wave of row groups */
+#define COLUMN_TASKS_PER_THREAD 4
+
+/* Standard deviations spanned by the error bound of a sampled count (about 95% confidence) */
+#define SAMPLE_ERROR_STDDEVS 2.0
+
+/**
+ * Stratified row sample of a row group
+ * 
+ * The rows are cut into strata of stride consecutive rows and one row is
+ * drawn from each, at an offset hashed from the row group and the stratum.
+ * Every row is sampled with probability 1 / stride, the sample is spread
+ * evenly over the row group, and all columns of a row group sample the
+ * same rows.
+ */
+typedef struct {
+    uint32_t stride;    /* Rows per stratum (1 = every row) */
+    uint64_t seed;      /* Seed of the row group */
+} RowSample;
+
+const char* const METADATA_DEFAULT_SPECIAL_KEYWORDS[METADATA_DEFAULT_SPECIAL_KEYWORD_COUNT] = {
+    "error", "warning", "exception", "fail", "critical", "bug",
+    "crash", "fatal", "issue", "problem", "invalid"
+};
 
 /* Static global for error messages */
-static char s_error_message[256];
+static INFPARQUET_THREAD_LOCAL char s_error_message[256];
+
+/* Forward declarations */
+static MetadataGeneratorError generate_custom_metadata(struct ExtendedMetadata* metadata,
+                                                       const ParquetFile* file,
+                                                       const char* config_path);
 
 /* Metadata types for internal use */
 #define METADATA_TYPE_FILE 1
@@ -70,6 +111,240 @@ void metadata_generator_init_options(MetadataGeneratorOptions* options) {
     options->max_high_freq_strings = MAX_HIGH_FREQ_STRINGS;
     options->max_special_strings = MAX_SPECIAL_STRINGS;
     options->max_high_freq_categories = MAX_HIGH_FREQ_CATEGORIES;
+    options->mode_exact_limit = VALUE_MODE_EXACT_LIMIT;
+    options->mode_sketch_counters = VALUE_MODE_SKETCH_COUNTERS;
+    options->string_sketch_counters = HEAVY_HITTERS_DEFAULT_COUNTERS;
+    options->special_keywords = METADATA_DEFAULT_SPECIAL_KEYWORDS;
+    options->special_keyword_count = METADATA_DEFAULT_SPECIAL_KEYWORD_COUNT;
+    options->bloom_filter_columns = NULL;  // Bloom filters are opted into per column
+    options->bloom_filter_column_count = 0;
+    options->bloom_filter_fpp = BLOOM_FILTER_DEFAULT_FPP;
+    options->bloom_filter_max_bytes = BLOOM_FILTER_DEFAULT_MAX_BYTES;
+    options->thread_count = 0;  // As many threads as the CPU budget allows
+    options->use_footer_statistics = 0;  // Scan every value by default
+    options->sample_rate = 1.0;  // Count string and mode statistics over every row
+}
+
+static uint64_t mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * Get the stride of a row sample: one row drawn out of every stride rows
+ * 
+ * sample_rate: Fraction of the rows to sample; 1 or more (or not positive) samples every row
+ * returns: The stride, at least 1
+ */
+static uint32_t row_sample_stride(double sample_rate) {
+    if (sample_rate > 0.0 && sample_rate < 1.0) {
+        double stride = floor(1.0 / sample_rate + 0.5);
+        return stride >= (double)UINT32_MAX ? UINT32_MAX : (stride < 1.0 ? 1 : (uint32_t)stride);
+    }
+    return 1;
+}
+
+/**
+ * Get the fraction of the rows a sample rate actually draws
+ * 
+ * The rate is rounded to a whole stride, as every row sample rounds it, so
+ * counts merged across row groups scale back up like the chunks' counts.
+ * 
+ * sample_rate: Requested fraction of the rows
+ * returns: 1 / stride
+ */
+static double row_sample_rate_of(double sample_rate) {
+    return 1.0 / (double)row_sample_stride(sample_rate);
+}
+
+/**
+ * Set up the row sample of a row group
+ * 
+ * sample: Sample to initialize
+ * sample_rate: Fraction of the rows to sample; 1 or more (or not positive) samples every row
+ * row_group_id: ID of the row group
+ */
+static void row_sample_init(RowSample* sample, double sample_rate, int row_group_id) {
+    sample->stride = row_sample_stride(sample_rate);
+    sample->seed = mix64(0x9e3779b97f4a7c15ull ^ (uint64_t)(uint32_t)row_group_id);
+}
+
+/**
+ * Get the fraction of the rows a sample draws
+ * 
+ * sample: The sample
+ * returns: 1 / stride
+ */
+static double row_sample_rate(const RowSample* sample) {
+    return 1.0 / (double)sample->stride;
+}
+
+/**
+ * Get the row a sample draws from a stratum
+ * 
+ * sample: The sample
+ * stratum: Index of the stratum
+ * returns: Index of the sampled row (may lie past the last row of the last stratum)
+ */
+static uint64_t row_sample_row(const RowSample* sample, uint64_t stratum) {
+    if (sample->stride <= 1) {
+        return stratum;
+    }
+    return stratum * sample->stride + mix64(sample->seed + stratum) % sample->stride;
+}
+
+/**
+ * Scale a count taken over a row sample up to the whole population
+ * 
+ * count: Count in the sample
+ * sample_rate: Fraction of the rows sampled
+ * returns: Estimated count over every row
+ */
+static uint64_t scale_sampled_count(uint64_t count, double sample_rate) {
+    if (sample_rate >= 1.0) {
+        return count;
+    }
+    double scaled = floor((double)count / sample_rate + 0.5);
+    return scaled >= 18446744073709551615.0 ? UINT64_MAX : (uint64_t)scaled;
+}
+
+/**
+ * Get the error bound of a count estimated from a row sample
+ * 
+ * Each occurrence of a value is sampled with probability sample_rate, so the
+ * scaled count has variance count * (1 - rate) / rate^2 in terms of the
+ * sampled count; the bound spans SAMPLE_ERROR_STDDEVS standard deviations.
+ * Stratification only lowers the variance, so the bound is conservative.
+ * 
+ * count: Count in the sample
+ * sample_rate: Fraction of the rows sampled
+ * returns: Bound on the difference between the scaled and the true count (0 if exact)
+ */
+static uint64_t sampled_count_error(uint64_t count, double sample_rate) {
+    if (sample_rate >= 1.0) {
+        return 0;
+    }
+    double error = ceil(SAMPLE_ERROR_STDDEVS * sqrt((double)count * (1.0 - sample_rate)) / sample_rate);
+    return error >= 18446744073709551615.0 ? UINT64_MAX : (uint64_t)error;
+}
+
+/**
+ * Copy the sampled rows of a chunk of fixed-width values
+ * 
+ * values: Values of the chunk
+ * value_count: Number of values
+ * value_size: Bytes per value
+ * sample: Rows to copy
+ * sampled_count: Receives the number of values copied
+ * returns: Copied values, freed by the caller, or NULL if out of memory
+ */
+static void* gather_sampled_values(const void* values, uint64_t value_count, size_t value_size,
+                                   const RowSample* sample, uint64_t* sampled_count) {
+    uint64_t strata = (value_count + sample->stride - 1) / sample->stride;
+    unsigned char* sampled = (unsigned char*)malloc((size_t)(strata > 0 ? strata : 1) * value_size);
+    if (!sampled) {
+        return NULL;
+    }
+    
+    uint64_t count = 0;
+    for (uint64_t stratum = 0; stratum < strata; stratum++) {
+        uint64_t row = row_sample_row(sample, stratum);
+        if (row < value_count) {
+            memcpy(sampled + count * value_size, (const unsigned char*)values + row * value_size, value_size);
+            count++;
+        }
+    }
+    
+    *sampled_count = count;
+    return sampled;
+}
+
+/**
+ * Get the size of one value in the buffer the reader returns for a column
+ * 
+ * type: Type of the column
+ * returns: Bytes per value, or 0 for types read as variable-length strings
+ */
+static size_t column_value_size(ParquetValueType type) {
+    switch (type) {
+        case PARQUET_TYPE_BOOLEAN:
+            return sizeof(bool);
+        case PARQUET_TYPE_INT32:
+        case PARQUET_TYPE_FLOAT:
+            return sizeof(int32_t);
+        case PARQUET_TYPE_INT64:
+        case PARQUET_TYPE_DOUBLE:
+        case PARQUET_TYPE_INT96:  // Read as 64-bit timestamps
+            return sizeof(int64_t);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Copy the non-null rows of a chunk of fixed-width values
+ * 
+ * Null rows hold 0 in the reader's buffer, so the sketches and the Bloom
+ * filter are fed the copy rather than the buffer.
+ * 
+ * values: Values of the chunk
+ * value_count: Number of values
+ * value_size: Bytes per value
+ * validity: Validity bitmap of the values, least significant bit first
+ * valid_count: Receives the number of values copied
+ * returns: Copied values, freed by the caller, or NULL if out of memory
+ */
+static void* gather_valid_values(const void* values, uint64_t value_count, size_t value_size,
+                                 const uint8_t* validity, uint64_t* valid_count) {
+    unsigned char* valid = (unsigned char*)malloc((size_t)(value_count > 0 ? value_count : 1) * value_size);
+    if (!valid) {
+        return NULL;
+    }
+    
+    uint64_t count = 0;
+    for (uint64_t row = 0; row < value_count; row++) {
+        if (validity[row >> 3] & (1u << (row & 7))) {
+            memcpy(valid + count * value_size, (const unsigned char*)values + row * value_size, value_size);
+            count++;
+        }
+    }
+    
+    *valid_count = count;
+    return valid;
+}
+
+/**
+ * Store the percentiles of a digest in timestamp metadata
+ * 
+ * metadata: Timestamp metadata holding the digest
+ */
+static void store_timestamp_percentiles(TimestampMetadata* metadata) {
+    if (metadata->quantiles.count == 0) {
+        metadata->p50 = metadata->p95 = metadata->p99 = 0;
+        return;
+    }
+    metadata->p50 = (time_t)quantile_sketch_quantile(&metadata->quantiles, 0.50);
+    metadata->p95 = (time_t)quantile_sketch_quantile(&metadata->quantiles, 0.95);
+    metadata->p99 = (time_t)quantile_sketch_quantile(&metadata->quantiles, 0.99);
+}
+
+/**
+ * Store the percentiles of a digest in numeric metadata
+ * 
+ * metadata: Numeric metadata holding the digest
+ */
+static void store_numeric_percentiles(NumericMetadata* metadata) {
+    if (metadata->quantiles.count == 0) {
+        metadata->p50 = metadata->p95 = metadata->p99 = 0.0;
+        return;
+    }
+    metadata->p50 = quantile_sketch_quantile(&metadata->quantiles, 0.50);
+    metadata->p95 = quantile_sketch_quantile(&metadata->quantiles, 0.95);
+    metadata->p99 = quantile_sketch_quantile(&metadata->quantiles, 0.99);
 }
 
 /**
@@ -78,9 +353,14 @@ void metadata_generator_init_options(MetadataGeneratorOptions* options) {
  * buffer: Buffer containing timestamp data
  * size: Size of the buffer
  * value_count: Number of values in the buffer
+ * validity: Validity bitmap of the values (NULL if none is null)
+ * valid_values: The non-null values of the buffer (the buffer itself if none is null)
+ * valid_count: Number of non-null values
  * metadata: Metadata structure to fill
  */
-static void process_timestamp_data(const void* buffer, size_t size, uint64_t value_count, BaseMetadata* metadata) {
+static void process_timestamp_data(const void* buffer, size_t size, uint64_t value_count,
+                                   const uint8_t* validity, const void* valid_values, uint64_t valid_count,
+                                   BaseMetadata* metadata) {
     if (!buffer || size == 0 || !metadata || value_count == 0) {
         return;
     }
@@ -91,26 +371,33 @@ static void process_timestamp_data(const void* buffer, size_t size, uint64_t val
     // Note: This is a simplified implementation - real code would need
     // to handle the specific timestamp encoding used in your Parquet files
     if (size >= sizeof(int64_t) * value_count) {
-        const int64_t* timestamps = (const int64_t*)buffer;
-        
-        // Initialize with first value
-        int64_t min_ts = timestamps[0];
-        int64_t max_ts = timestamps[0];
-        
-        // Find min and max timestamps
-        for (uint64_t i = 1; i < value_count; i++) {
-            if (timestamps[i] < min_ts) {
-                min_ts = timestamps[i];
-            }
-            if (timestamps[i] > max_ts) {
-                max_ts = timestamps[i];
-            }
+        ColumnStats stats;
+        if (column_stats_compute(buffer, value_count, PARQUET_INT64, validity, &stats) != 0) {
+            return;
         }
+        int64_t min_ts = stats.int_min;
+        int64_t max_ts = stats.int_max;
         
         // Convert to time_t (Unix timestamp in seconds)
         // This depends on your specific timestamp encoding
         metadata->timestamp_metadata.min_timestamp = (time_t)(min_ts / 1000000000); // nanoseconds to seconds
         metadata->timestamp_metadata.max_timestamp = (time_t)(max_ts / 1000000000);
+        
+        // Quantile digest of the non-null timestamps in seconds, merged into the row group's and the file's
+        double* seconds = (double*)malloc(TIMESTAMP_SECONDS_BLOCK * sizeof(double));
+        if (seconds) {
+            const int64_t* timestamps = (const int64_t*)valid_values;
+            for (uint64_t first = 0; first < valid_count; first += TIMESTAMP_SECONDS_BLOCK) {
+                uint64_t count = valid_count - first < TIMESTAMP_SECONDS_BLOCK ?
+                                 valid_count - first : TIMESTAMP_SECONDS_BLOCK;
+                for (uint64_t i = 0; i < count; i++) {
+                    seconds[i] = (double)timestamps[first + i] / 1000000000.0;
+                }
+                quantile_sketch_add_values(&metadata->timestamp_metadata.quantiles, seconds, count, PARQUET_DOUBLE);
+            }
+            free(seconds);
+        }
+        store_timestamp_percentiles(&metadata->timestamp_metadata);
     }
 }
 
@@ -121,276 +408,158 @@ static void process_timestamp_data(const void* buffer, size_t size, uint64_t val
  * size: Size of the buffer
  * type: Parquet type of the data
  * value_count: Number of values in the buffer
+ * validity: Validity bitmap of the values (NULL if none is null)
+ * valid_values: The non-null values of the buffer (the buffer itself if none is null)
+ * valid_count: Number of non-null values
+ * mode_options: Options of the mode computation
+ * sample: Rows the mode is estimated from
  * metadata: Metadata structure to fill
  */
-static void process_numeric_data(const void* buffer, size_t size, ParquetValueType type, uint64_t value_count, BaseMetadata* metadata) {
+static void process_numeric_data(const void* buffer, size_t size, ParquetValueType type, uint64_t value_count,
+                                 const uint8_t* validity, const void* valid_values, uint64_t valid_count,
+                                 const ValueModeOptions* mode_options, const RowSample* sample,
+                                 BaseMetadata* metadata) {
     if (!buffer || size == 0 || !metadata || value_count == 0) {
         return;
     }
     
     metadata->numeric_metadata.has_numeric_data = 1;
     
-    // Variables for statistical calculations
-    double min_val = 0;
-    double max_val = 0;
-    double sum = 0;
+    // Never read past the buffer, whatever the column header claims
+    size_t value_size = column_value_size(type);
+    if (value_count > size / value_size) {
+        value_count = size / value_size;
+        if (value_count == 0) {
+            return;
+        }
+    }
     
-    // For tracking mode (most frequent value)
-    struct {
-        double value;
-        int count;
-    } mode = {0, 0};
+    // Minimum, maximum and sum with the widest vector kernel the CPU supports;
+    // null rows (stored as 0) and NaN values are skipped
+    ColumnStats stats;
+    if (column_stats_compute(buffer, value_count, type, validity, &stats) != 0) {
+        memset(&stats, 0, sizeof(stats));
+    }
     
-    // Different handling based on data type
-    switch (type) {
-        case PARQUET_TYPE_BOOLEAN: {
-            const bool* bool_data = (const bool*)buffer;
-            if (value_count > 0) {
-                min_val = max_val = bool_data[0] ? 1.0 : 0.0;
-                sum = min_val;
-                mode.value = min_val;
-                mode.count = 1;
-                
-                int true_count = bool_data[0] ? 1 : 0;
-                int false_count = bool_data[0] ? 0 : 1;
-                
-                for (uint64_t i = 1; i < value_count; i++) {
-                    double val = bool_data[i] ? 1.0 : 0.0;
-                    if (val < min_val) min_val = val;
-                    if (val > max_val) max_val = val;
-                    sum += val;
-                    
-                    if (bool_data[i]) true_count++; else false_count++;
-                }
-                
-                // Determine mode (most frequent value)
-                if (true_count > false_count) {
-                    mode.value = 1.0;
-                    mode.count = true_count;
-                } else {
-                    mode.value = 0.0;
-                    mode.count = false_count;
-                }
-            }
-            break;
-        }
-        case PARQUET_TYPE_INT32: {
-            const int32_t* int_data = (const int32_t*)buffer;
-            if (value_count > 0) {
-                min_val = max_val = (double)int_data[0];
-                sum = min_val;
-                
-                // Simple frequency tracking for mode
-                // In a real implementation, you would use a more efficient algorithm
-                // or data structure for large datasets
-                int* frequency = (int*)calloc(value_count, sizeof(int));
-                if (frequency) {
-                    frequency[0] = 1;
-                    mode.value = min_val;
-                    mode.count = 1;
-                    
-                    for (uint64_t i = 1; i < value_count; i++) {
-                        double val = (double)int_data[i];
-                        if (val < min_val) min_val = val;
-                        if (val > max_val) max_val = val;
-                        sum += val;
-                        
-                        // Update frequency count
-                        bool found = false;
-                        for (uint64_t j = 0; j < i; j++) {
-                            if (int_data[j] == int_data[i]) {
-                                frequency[j]++;
-                                if (frequency[j] > mode.count) {
-                                    mode.value = (double)int_data[j];
-                                    mode.count = frequency[j];
-                                }
-                                found = true;
-                                break;
-                            }
-                        }
-                        
-                        if (!found) {
-                            frequency[i] = 1;
-                        }
-                    }
-                    
-                    free(frequency);
-                }
-            }
-            break;
-        }
-        case PARQUET_TYPE_INT64: {
-            const int64_t* int_data = (const int64_t*)buffer;
-            if (value_count > 0) {
-                min_val = max_val = (double)int_data[0];
-                sum = min_val;
-                
-                // For mode calculation
-                int64_t mode_val = int_data[0];
-                int mode_count = 1;
-                int current_count = 1;
-                
-                // Sort-based mode calculation
-                // For large datasets, consider using a more efficient algorithm
-                int64_t* sorted_data = (int64_t*)malloc(value_count * sizeof(int64_t));
-                if (sorted_data) {
-                    memcpy(sorted_data, int_data, value_count * sizeof(int64_t));
-                    // Simple bubble sort - use a more efficient sort for large datasets
-                    for (uint64_t i = 0; i < value_count - 1; i++) {
-                        for (uint64_t j = 0; j < value_count - i - 1; j++) {
-                            if (sorted_data[j] > sorted_data[j + 1]) {
-                                int64_t temp = sorted_data[j];
-                                sorted_data[j] = sorted_data[j + 1];
-                                sorted_data[j + 1] = temp;
-                            }
-                        }
-                    }
-                    
-                    // Find mode from sorted array
-                    for (uint64_t i = 1; i < value_count; i++) {
-                        if (sorted_data[i] == sorted_data[i - 1]) {
-                            current_count++;
-                        } else {
-                            if (current_count > mode_count) {
-                                mode_count = current_count;
-                                mode_val = sorted_data[i - 1];
-                            }
-                            current_count = 1;
-                        }
-                    }
-                    
-                    // Check the last run
-                    if (current_count > mode_count) {
-                        mode_val = sorted_data[value_count - 1];
-                        mode_count = current_count;
-                    }
-                    
-                    free(sorted_data);
-                    
-                    mode.value = (double)mode_val;
-                    mode.count = mode_count;
-                }
-                
-                // Find min, max, sum
-                for (uint64_t i = 1; i < value_count; i++) {
-                    double val = (double)int_data[i];
-                    if (val < min_val) min_val = val;
-                    if (val > max_val) max_val = val;
-                    sum += val;
-                }
-            }
-            break;
+    // Mode (most frequent value) of the non-null values: counted exactly in linear
+    // time, or estimated with bounded memory once the column has too many distinct
+    // values; with row sampling it is counted over the sampled values only
+    double mode_rate = 1.0;
+    uint64_t mode_value_count = valid_count;
+    void* mode_values = NULL;
+    if (sample->stride > 1) {
+        mode_values = gather_sampled_values(valid_values, valid_count, value_size, sample, &mode_value_count);
+        if (mode_values && mode_value_count > 0) {
+            mode_rate = row_sample_rate(sample);
+        } else {
+            // Too few rows to sample, or no memory for the sample: count every row
+            free(mode_values);
+            mode_values = NULL;
+            mode_value_count = valid_count;
         }
-        case PARQUET_TYPE_FLOAT: {
-            const float* float_data = (const float*)buffer;
-            if (value_count > 0) {
-                min_val = max_val = (double)float_data[0];
-                sum = min_val;
-                
-                // Simple approximation for mode - most accurate approach would
-                // depend on the specific data distribution
-                double bucket_size = 0.01;  // Adjust based on data range
-                int max_buckets = 1000;
-                int* buckets = (int*)calloc(max_buckets, sizeof(int));
-                
-                if (buckets) {
-                    for (uint64_t i = 0; i < value_count; i++) {
-                        double val = (double)float_data[i];
-                        if (val < min_val) min_val = val;
-                        if (val > max_val) max_val = val;
-                        sum += val;
-                        
-                        // Place in a bucket for mode approximation
-                        int bucket = (int)((val - min_val) / bucket_size);
-                        if (bucket >= 0 && bucket < max_buckets) {
-                            buckets[bucket]++;
-                        }
-                    }
-                    
-                    // Find most frequent bucket
-                    int max_bucket = 0;
-                    for (int i = 1; i < max_buckets; i++) {
-                        if (buckets[i] > buckets[max_bucket]) {
-                            max_bucket = i;
-                        }
-                    }
-                    
-                    mode.value = min_val + (max_bucket * bucket_size);
-                    mode.count = buckets[max_bucket];
-                    
-                    free(buckets);
-                } else {
-                    // Fallback if memory allocation fails
-                    for (uint64_t i = 1; i < value_count; i++) {
-                        double val = (double)float_data[i];
-                        if (val < min_val) min_val = val;
-                        if (val > max_val) max_val = val;
-                        sum += val;
-                    }
-                }
+    }
+    
+    ValueMode mode;
+    if (mode_value_count == 0 ||
+        value_mode_compute(mode_values ? mode_values : valid_values, mode_value_count, type, mode_options, &mode) != 0) {
+        memset(&mode, 0, sizeof(mode));
+    }
+    free(mode_values);
+    
+    // Quantile digest of the non-null values, merged into the row group's and the file's
+    quantile_sketch_init(&metadata->numeric_metadata.quantiles);
+    if (quantile_sketch_add_values(&metadata->numeric_metadata.quantiles, valid_values, valid_count, type) != 0) {
+        quantile_sketch_init(&metadata->numeric_metadata.quantiles);
+    }
+    
+    // Set the metadata values
+    metadata->numeric_metadata.min_value = stats.min;
+    metadata->numeric_metadata.max_value = stats.max;
+    metadata->numeric_metadata.mean_value = (stats.count > 0) ? (stats.sum / stats.count) : 0.0;
+    metadata->numeric_metadata.count = stats.count;
+    metadata->numeric_metadata.avg_value = metadata->numeric_metadata.mean_value;
+    metadata->numeric_metadata.mode_value = mode.value;
+    metadata->numeric_metadata.mode_count = scale_sampled_count(mode.count, mode_rate);
+    if (mode_rate < 1.0) {
+        metadata->numeric_metadata.mode_is_sampled = 1;
+        metadata->numeric_metadata.mode_sample_rate = mode_rate;
+        metadata->numeric_metadata.mode_count_error = sampled_count_error(mode.count, mode_rate) +
+                                                      scale_sampled_count(mode.max_error, mode_rate);
+    }
+    metadata->numeric_metadata.total_count = value_count;
+    metadata->numeric_metadata.null_count = stats.null_count > UINT32_MAX ? UINT32_MAX : (uint32_t)stats.null_count;
+    store_numeric_percentiles(&metadata->numeric_metadata);
+}
+
+/**
+ * Store the most frequent strings of a sketch in string metadata
+ * 
+ * strings: Sketch of the strings
+ * max_strings: Maximum number of strings to store
+ * sample_rate: Fraction of the rows the sketch counted (1 = every row)
+ * metadata: String metadata to fill
+ */
+static void store_high_freq_strings(const HeavyHitterSketch* strings, uint32_t max_strings, double sample_rate,
+                                    StringMetadata* metadata) {
+    HeavyHitter top[MAX_HIGH_FREQ_STRINGS];
+    if (max_strings > MAX_HIGH_FREQ_STRINGS) {
+        max_strings = MAX_HIGH_FREQ_STRINGS;
+    }
+    
+    uint32_t count = heavy_hitters_top(strings, top, max_strings);
+    metadata->count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        strncpy(metadata->high_frequency_strings[i], top[i].value, MAX_STRING_LENGTH - 1);
+        metadata->high_frequency_strings[i][MAX_STRING_LENGTH - 1] = '\0';
+        uint64_t estimate = scale_sampled_count(top[i].count, sample_rate);
+        metadata->frequencies[i] = (int)(estimate < INT32_MAX ? estimate : INT32_MAX);
+        metadata->frequency_errors[i] = scale_sampled_count(top[i].error, sample_rate);
+        metadata->sample_errors[i] = sampled_count_error(top[i].count, sample_rate);
+    }
+    metadata->is_sampled = sample_rate < 1.0;
+    metadata->sample_rate = sample_rate;
+}
+
+/**
+ * Store the keywords found in the most strings in string metadata
+ * 
+ * counts: Strings containing each keyword (consumed: the stored counts are cleared)
+ * keywords: Matcher the counts belong to
+ * max_keywords: Maximum number of keywords to store
+ * sample_rate: Fraction of the rows the keywords were counted in (1 = every row)
+ * metadata: String metadata to fill
+ */
+static void store_special_strings(KeywordCounts* counts, const KeywordMatcher* keywords,
+                                  uint32_t max_keywords, double sample_rate, StringMetadata* metadata) {
+    if (max_keywords > MAX_SPECIAL_STRINGS) {
+        max_keywords = MAX_SPECIAL_STRINGS;
+    }
+    
+    // Select the most frequent keywords, keeping the configured order among ties
+    uint32_t special_count = 0;
+    while (special_count < max_keywords) {
+        uint32_t best = 0;
+        for (uint32_t i = 1; i < counts->keyword_count; i++) {
+            if (counts->counts[i] > counts->counts[best]) {
+                best = i;
             }
-            break;
         }
-        case PARQUET_TYPE_DOUBLE: {
-            const double* double_data = (const double*)buffer;
-            if (value_count > 0) {
-                min_val = max_val = double_data[0];
-                sum = min_val;
-                
-                // For large datasets, consider a more efficient algorithm
-                int* frequency = (int*)calloc(value_count, sizeof(int));
-                if (frequency) {
-                    frequency[0] = 1;
-                    mode.value = min_val;
-                    mode.count = 1;
-                    
-                    for (uint64_t i = 1; i < value_count; i++) {
-                        double val = double_data[i];
-                        if (val < min_val) min_val = val;
-                        if (val > max_val) max_val = val;
-                        sum += val;
-                        
-                        // Simple frequency counting
-                        bool found = false;
-                        for (uint64_t j = 0; j < i; j++) {
-                            if (double_data[j] == double_data[i]) {
-                                frequency[j]++;
-                                if (frequency[j] > mode.count) {
-                                    mode.value = double_data[j];
-                                    mode.count = frequency[j];
-                                }
-                                found = true;
-                                break;
-                            }
-                        }
-                        
-                        if (!found) {
-                            frequency[i] = 1;
-                        }
-                    }
-                    
-                    free(frequency);
-                } else {
-                    // Fallback if memory allocation fails
-                    for (uint64_t i = 1; i < value_count; i++) {
-                        double val = double_data[i];
-                        if (val < min_val) min_val = val;
-                        if (val > max_val) max_val = val;
-                        sum += val;
-                    }
-                }
-            }
+        if (counts->keyword_count == 0 || counts->counts[best] == 0) {
             break;
         }
-        default:
-            break;
+        
+        strncpy(metadata->special_strings[special_count], keyword_matcher_keyword(keywords, best),
+                MAX_STRING_LENGTH - 1);
+        metadata->special_strings[special_count][MAX_STRING_LENGTH - 1] = '\0';
+        uint64_t estimate = scale_sampled_count(counts->counts[best], sample_rate);
+        uint64_t error = sampled_count_error(counts->counts[best], sample_rate);
+        metadata->special_string_counts[special_count] = estimate > UINT32_MAX ? UINT32_MAX : (uint32_t)estimate;
+        metadata->special_string_errors[special_count] = error > UINT32_MAX ? UINT32_MAX : (uint32_t)error;
+        counts->counts[best] = 0;
+        special_count++;
     }
     
-    // Set the metadata values
-    metadata->numeric_metadata.min_value = min_val;
-    metadata->numeric_metadata.max_value = max_val;
-    metadata->numeric_metadata.mean_value = (value_count > 0) ? (sum / value_count) : 0.0;
-    metadata->numeric_metadata.mode_value = mode.value;
+    metadata->special_string_count = special_count;
 }
 
 /**
@@ -399,10 +568,18 @@ static void process_numeric_data(const void* buffer, size_t size, ParquetValueTy
  * buffer: Buffer containing string data
  * size: Size of the buffer
  * value_count: Number of values in the buffer
+ * strings: Sketch receiving every non-empty string
+ * max_strings: Maximum number of high-frequency strings to store
+ * keywords: Keywords marking special strings
+ * max_special_strings: Maximum number of special strings to store
+ * sample: Rows the frequencies and special strings are counted in
  * metadata: Metadata structure to fill
  */
-static void process_string_data(const void* buffer, size_t size, uint64_t value_count, BaseMetadata* metadata) {
-    if (!buffer || size == 0 || !metadata || value_count == 0) {
+static void process_string_data(const void* buffer, size_t size, uint64_t value_count,
+                                HeavyHitterSketch* strings, uint32_t max_strings,
+                                const KeywordMatcher* keywords, uint32_t max_special_strings,
+                                const RowSample* sample, BaseMetadata* metadata) {
+    if (!buffer || size == 0 || !strings || !keywords || !metadata || value_count == 0) {
         return;
     }
     
@@ -412,81 +589,41 @@ static void process_string_data(const void* buffer, size_t size, uint64_t value_
     // For simplicity, we'll assume the buffer contains a series of null-terminated strings
     // In a real implementation, you would parse the actual Parquet data format
     
-    // Define special strings to look for
-    const char* special_strings[] = {
-        "error", "warning", "exception", "fail", "critical",
-        "bug", "crash", "fatal", "issue", "problem"
-    };
-    const int num_special_strings = sizeof(special_strings) / sizeof(special_strings[0]);
-    
-    // For tracking string frequencies
-    typedef struct {
-        char string[MAX_STRING_LENGTH];
-        int count;
-    } StringFreq;
-    
-    StringFreq* string_freqs = (StringFreq*)malloc(MAX_HIGH_FREQ_STRINGS * sizeof(StringFreq));
-    if (!string_freqs) {
-        return;
-    }
-    
-    memset(string_freqs, 0, MAX_HIGH_FREQ_STRINGS * sizeof(StringFreq));
-    
-    // For tracking special string occurrences
-    int* special_counts = (int*)calloc(num_special_strings, sizeof(int));
-    if (!special_counts) {
-        free(string_freqs);
+    // Strings containing each special keyword
+    KeywordCounts special_counts;
+    if (keyword_counts_init(&special_counts, keywords) != 0) {
         return;
     }
     
     // Process the string data
     const char* str_data = (const char*)buffer;
     size_t pos = 0;
-    int str_count = 0;
+    uint64_t str_count = 0;
     uint64_t total_length = 0;
+    uint64_t stratum = 0;
+    uint64_t next_sampled = row_sample_row(sample, 0);
     
-    // Process up to value_count strings or until end of buffer
+    // Process up to value_count strings or until end of buffer. Rows are
+    // NUL-delimited, so every byte is walked even when sampling: the rows
+    // between two sampled ones only add their length, and sampling saves the
+    // keyword scan and the sketch update, which cost far more than the walk
     while (pos < size && str_count < value_count) {
-        // Assume each string is null-terminated
         const char* current_str = &str_data[pos];
-        size_t str_len = strlen(current_str);
+        const char* end = (const char*)memchr(current_str, '\0', size - pos);
+        size_t str_len = end ? (size_t)(end - current_str) : size - pos;
         
-        if (str_len > 0) {
-            // Update string length statistics
-            total_length += str_len;
-            
-            // Check for special strings
-            for (int i = 0; i < num_special_strings; i++) {
-                if (strstr(current_str, special_strings[i]) != NULL) {
-                    special_counts[i]++;
-                }
-            }
-            
-            // Update frequency count
-            bool found = false;
-            for (int i = 0; i < MAX_HIGH_FREQ_STRINGS && string_freqs[i].count > 0; i++) {
-                if (strcmp(string_freqs[i].string, current_str) == 0) {
-                    string_freqs[i].count++;
-                    found = true;
-                    break;
-                }
-            }
-            
-            if (!found) {
-                // Find the least frequent string to replace
-                int min_idx = 0;
-                for (int i = 1; i < MAX_HIGH_FREQ_STRINGS; i++) {
-                    if (string_freqs[i].count < string_freqs[min_idx].count) {
-                        min_idx = i;
-                    }
-                }
+        // Update string length statistics
+        total_length += str_len;
+        
+        // Only the sampled rows are counted
+        if (str_count == next_sampled) {
+            next_sampled = row_sample_row(sample, ++stratum);
+            if (str_len > 0) {
+                // Count every special keyword in one pass over the string
+                keyword_matcher_scan(keywords, current_str, str_len, &special_counts);
                 
-                // Replace if this string has been seen more times than the least frequent
-                if (string_freqs[min_idx].count < 1) {
-                    strncpy(string_freqs[min_idx].string, current_str, MAX_STRING_LENGTH - 1);
-                    string_freqs[min_idx].string[MAX_STRING_LENGTH - 1] = '\0';
-                    string_freqs[min_idx].count = 1;
-                }
+                // Update frequency count
+                heavy_hitters_add(strings, current_str, str_len);
             }
         }
         
@@ -495,67 +632,231 @@ static void process_string_data(const void* buffer, size_t size, uint64_t value_
         str_count++;
     }
     
-    // Sort string frequencies (bubble sort for simplicity)
-    for (int i = 0; i < MAX_HIGH_FREQ_STRINGS - 1; i++) {
-        for (int j = 0; j < MAX_HIGH_FREQ_STRINGS - i - 1; j++) {
-            if (string_freqs[j].count < string_freqs[j + 1].count) {
-                StringFreq temp = string_freqs[j];
-                string_freqs[j] = string_freqs[j + 1];
-                string_freqs[j + 1] = temp;
+    // Lengths cover every row, sampled or not
+    metadata->string_metadata.total_length = total_length;
+    metadata->string_metadata.total_count = str_count;
+    metadata->string_metadata.avg_length = str_count > 0 ? (float)total_length / (float)str_count : 0.0f;
+    
+    // Store the most frequent strings
+    double sample_rate = row_sample_rate(sample);
+    store_high_freq_strings(strings, max_strings, sample_rate, &metadata->string_metadata);
+    
+    // Store the most frequent special strings
+    store_special_strings(&special_counts, keywords, max_special_strings, sample_rate, &metadata->string_metadata);
+    
+    // Clean up
+    keyword_counts_free(&special_counts);
+}
+
+/**
+ * Sketch the distinct values of a column chunk
+ * 
+ * buffer: Buffer containing the column data
+ * size: Size of the buffer
+ * type: Parquet type of the data
+ * value_count: Number of values in the buffer
+ * metadata: Categorical metadata receiving the sketch and its estimate
+ */
+static void sketch_distinct_values(const void* buffer, size_t size, ParquetValueType type,
+                                   uint64_t value_count, CategoricalMetadata* metadata) {
+    hyperloglog_init(&metadata->distinct_sketch);
+    
+    if (buffer && size > 0) {
+        switch (type) {
+            case PARQUET_TYPE_BYTE_ARRAY:
+            case PARQUET_TYPE_FIXED_LEN_BYTE_ARRAY: {
+                // Null-terminated strings, as read by process_string_data
+                const char* str_data = (const char*)buffer;
+                size_t pos = 0;
+                uint64_t str_count = 0;
+                while (pos < size && str_count < value_count) {
+                    const char* end = (const char*)memchr(str_data + pos, '\0', size - pos);
+                    size_t str_len = end ? (size_t)(end - (str_data + pos)) : size - pos;
+                    if (str_len > 0) {
+                        hyperloglog_add(&metadata->distinct_sketch, str_data + pos, str_len);
+                    }
+                    pos += str_len + 1;
+                    str_count++;
+                }
+                break;
             }
+            
+            case PARQUET_TYPE_INT96:  // Read as 64-bit timestamps, as by process_timestamp_data
+            case PARQUET_TYPE_INT64:
+            case PARQUET_TYPE_DOUBLE:
+                if (value_count > size / sizeof(int64_t)) {
+                    value_count = size / sizeof(int64_t);
+                }
+                hyperloglog_add_values(&metadata->distinct_sketch, buffer, value_count,
+                                       type == PARQUET_TYPE_DOUBLE ? PARQUET_DOUBLE : PARQUET_INT64);
+                break;
+                
+            case PARQUET_TYPE_INT32:
+            case PARQUET_TYPE_FLOAT:
+                if (value_count > size / sizeof(int32_t)) {
+                    value_count = size / sizeof(int32_t);
+                }
+                hyperloglog_add_values(&metadata->distinct_sketch, buffer, value_count, type);
+                break;
+                
+            case PARQUET_TYPE_BOOLEAN:
+                if (value_count > size / sizeof(bool)) {
+                    value_count = size / sizeof(bool);
+                }
+                hyperloglog_add_values(&metadata->distinct_sketch, buffer, value_count, type);
+                break;
+                
+            default:
+                break;
         }
     }
     
-    // Count non-empty frequencies
-    int freq_count = 0;
-    for (int i = 0; i < MAX_HIGH_FREQ_STRINGS; i++) {
-        if (string_freqs[i].count > 0) {
-            freq_count++;
-        } else {
-            break;
+    metadata->distinct_count = hyperloglog_estimate(&metadata->distinct_sketch);
+    metadata->total_category_count = metadata->distinct_count > UINT32_MAX ?
+                                     UINT32_MAX : (uint32_t)metadata->distinct_count;
+}
+
+/**
+ * Check whether a column opted into Bloom filters
+ * 
+ * options: Generator options
+ * column_name: Name of the column
+ * returns: true if the column is one of the options' Bloom filter columns
+ */
+static bool wants_bloom_filter(const MetadataGeneratorOptions* options, const char* column_name) {
+    if (!options->bloom_filter_columns || !column_name) {
+        return false;
+    }
+    for (uint32_t i = 0; i < options->bloom_filter_column_count; i++) {
+        if (options->bloom_filter_columns[i] && strcmp(options->bloom_filter_columns[i], column_name) == 0) {
+            return true;
         }
     }
-    
-    // Store in metadata
-    metadata->string_metadata.count = freq_count;
-    for (int i = 0; i < freq_count; i++) {
-        strncpy(metadata->string_metadata.high_frequency_strings[i], string_freqs[i].string, MAX_STRING_LENGTH - 1);
-        metadata->string_metadata.high_frequency_strings[i][MAX_STRING_LENGTH - 1] = '\0';
-        metadata->string_metadata.frequencies[i] = string_freqs[i].count;
+    return false;
+}
+
+/**
+ * Build the Bloom filter of a column chunk
+ * 
+ * The filter is sized from the chunk's distinct count, so it must run after
+ * sketch_distinct_values. INT32, INT64, FLOAT, DOUBLE, BYTE_ARRAY and
+ * FIXED_LEN_BYTE_ARRAY chunks get a filter; every other type gets none,
+ * BOOLEAN and the INT96 and PARQUET_TIMESTAMP timestamp types included.
+ * 
+ * buffer: Column data
+ * size: Size of the data in bytes
+ * type: Type of the column
+ * value_count: Number of values
+ * distinct_count: Estimated number of distinct values
+ * options: Generator options (false-positive rate and size limit)
+ * bloom_filter: Receives the filter; its block count stays 0 without one
+ * returns: Error code (METADATA_GEN_OK on success, with or without a filter)
+ */
+static MetadataGeneratorError build_bloom_filter(const void* buffer, size_t size, ParquetValueType type,
+                                                 uint64_t value_count, uint64_t distinct_count,
+                                                 const MetadataGeneratorOptions* options,
+                                                 ColumnBloomFilter* bloom_filter) {
+    memset(&bloom_filter->filter, 0, sizeof(BloomFilter));
+    if (!buffer || size == 0 || distinct_count == 0) {
+        return METADATA_GEN_OK;
     }
     
-    // Sort special string counts - using a constant size array
-    int special_indices[MAX_SPECIAL_STRING_ARRAY];
-    for (int i = 0; i < num_special_strings && i < MAX_SPECIAL_STRING_ARRAY; i++) {
-        special_indices[i] = i;
+    size_t value_size;
+    switch (type) {
+        case PARQUET_TYPE_INT32:
+        case PARQUET_TYPE_FLOAT:
+            value_size = sizeof(int32_t);
+            break;
+        case PARQUET_TYPE_INT64:
+        case PARQUET_TYPE_DOUBLE:
+            value_size = sizeof(int64_t);
+            break;
+        case PARQUET_TYPE_BYTE_ARRAY:
+        case PARQUET_TYPE_FIXED_LEN_BYTE_ARRAY:
+            value_size = 0;
+            break;
+        default:
+            return METADATA_GEN_OK;
     }
     
-    for (int i = 0; i < num_special_strings - 1 && i < MAX_SPECIAL_STRING_ARRAY - 1; i++) {
-        for (int j = 0; j < num_special_strings - i - 1 && j < MAX_SPECIAL_STRING_ARRAY - i - 1; j++) {
-            if (special_counts[special_indices[j]] < special_counts[special_indices[j + 1]]) {
-                int temp = special_indices[j];
-                special_indices[j] = special_indices[j + 1];
-                special_indices[j + 1] = temp;
-            }
-        }
+    size_t bytes = bloom_filter_optimal_bytes(distinct_count, options->bloom_filter_fpp,
+                                              options->bloom_filter_max_bytes);
+    if (bloom_filter_init(&bloom_filter->filter, bytes) != 0) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate a Bloom filter of %zu bytes", bytes);
+        return METADATA_GEN_MEMORY_ERROR;
     }
+    bloom_filter->value_type = type;
     
-    // Store special strings in metadata
-    int special_count = 0;
-    for (int i = 0; i < num_special_strings && special_count < MAX_SPECIAL_STRINGS && i < MAX_SPECIAL_STRING_ARRAY; i++) {
-        int idx = special_indices[i];
-        if (special_counts[idx] > 0) {
-            strncpy(metadata->string_metadata.special_strings[special_count], special_strings[idx], MAX_STRING_LENGTH - 1);
-            metadata->string_metadata.special_strings[special_count][MAX_STRING_LENGTH - 1] = '\0';
-            special_count++;
+    if (value_size > 0) {
+        if (value_count > size / value_size) {
+            value_count = size / value_size;
+        }
+        bloom_filter_add_values(&bloom_filter->filter, buffer, value_count, type);
+    } else {
+        // Null-terminated strings, as read by process_string_data
+        const char* str_data = (const char*)buffer;
+        size_t pos = 0;
+        uint64_t str_count = 0;
+        while (pos < size && str_count < value_count) {
+            const char* end = (const char*)memchr(str_data + pos, '\0', size - pos);
+            size_t str_len = end ? (size_t)(end - (str_data + pos)) : size - pos;
+            bloom_filter_insert(&bloom_filter->filter, bloom_filter_hash(str_data + pos, str_len));
+            pos += str_len + 1;
+            str_count++;
         }
     }
+    return METADATA_GEN_OK;
+}
+
+/**
+ * Fill the metadata of a column chunk from its footer statistics
+ * 
+ * Minimum, maximum and counts are all the footer holds. The chunk is marked
+ * from_footer: its mean, mode and percentiles are unavailable rather than
+ * zero, and so are those of every row group and file it is merged into. Its
+ * digests and distinct-value sketch stay empty, so merging the sketches of
+ * its column fails instead of undercounting.
+ * 
+ * column: Column chunk with its footer statistics
+ * metadata: Metadata structure to fill, cleared
+ * returns: true if the statistics answered the chunk, false if it must be scanned
+ */
+static bool fill_from_footer_statistics(const ParquetColumn* column, BaseMetadata* metadata) {
+    const ParquetColumnStatistics* statistics = &column->statistics;
+    if (!statistics->has_min_max || !statistics->has_null_count ||
+        statistics->null_count > column->total_values) {
+        return false;
+    }
     
-    metadata->string_metadata.special_string_count = special_count;
-    
-    // Clean up
-    free(string_freqs);
-    free(special_counts);
+    uint32_t null_count = statistics->null_count > UINT32_MAX ? UINT32_MAX : (uint32_t)statistics->null_count;
+    switch (column->type) {
+        case PARQUET_TYPE_INT96:
+            metadata->timestamp_metadata.has_timestamps = 1;
+            metadata->timestamp_metadata.min_timestamp = (time_t)statistics->min_value;
+            metadata->timestamp_metadata.max_timestamp = (time_t)statistics->max_value;
+            metadata->timestamp_metadata.count = column->total_values - statistics->null_count;
+            metadata->timestamp_metadata.null_count = null_count;
+            metadata->timestamp_metadata.from_footer = 1;
+            return true;
+            
+        case PARQUET_TYPE_BOOLEAN:
+        case PARQUET_TYPE_INT32:
+        case PARQUET_TYPE_INT64:
+        case PARQUET_TYPE_FLOAT:
+        case PARQUET_TYPE_DOUBLE:
+            metadata->numeric_metadata.has_numeric_data = 1;
+            metadata->numeric_metadata.min_value = statistics->min_value;
+            metadata->numeric_metadata.max_value = statistics->max_value;
+            metadata->numeric_metadata.total_count = column->total_values;
+            metadata->numeric_metadata.null_count = null_count;
+            metadata->numeric_metadata.from_footer = 1;
+            return true;
+            
+        default:
+            // Nothing in the footer stands in for string metadata
+            return false;
+    }
 }
 
 /**
@@ -567,6 +868,10 @@ static void process_string_data(const void* buffer, size_t size, uint64_t value_
  * file: Parquet file structure
  * row_group_id: ID of the row group containing the column
  * column_id: ID of the column to analyze
+ * options: Options controlling metadata generation
+ * keywords: Keywords marking special strings
+ * column_strings: Empty sketch receiving a string column's strings (NULL skips the string statistics)
+ * bloom_filter: Receives the column chunk's Bloom filter (NULL if the column has none)
  * base_metadata: Pointer to store the generated base metadata
  * returns: Error code (METADATA_GEN_OK on success)
  */
@@ -575,6 +880,10 @@ static MetadataGeneratorError generate_column_base_metadata(
     const ParquetFile* file,
     int row_group_id,
     int column_id,
+    const MetadataGeneratorOptions* options,
+    const KeywordMatcher* keywords,
+    HeavyHitterSketch* column_strings,
+    ColumnBloomFilter* bloom_filter,
     BaseMetadata* base_metadata
 ) {
     if (!reader_context || !file || !base_metadata) {
@@ -598,12 +907,22 @@ static MetadataGeneratorError generate_column_base_metadata(
     
     const ParquetColumn* column = &row_group->columns[column_id];
     
+    // Clear the base metadata structure
+    memset(base_metadata, 0, sizeof(BaseMetadata));
+    
+    // A chunk its footer statistics answer is not read at all, unless it needs a Bloom filter
+    if (options->use_footer_statistics && !bloom_filter &&
+        fill_from_footer_statistics(column, base_metadata)) {
+        return METADATA_GEN_OK;
+    }
+    
     // Read the column data using parquet reader
     void* buffer = NULL;
     size_t buffer_size = 0;
+    uint8_t* validity = NULL;
     
-    ParquetReaderError read_error = parquet_reader_read_column(
-        reader_context, row_group_id, column_id, &buffer, &buffer_size);
+    ParquetReaderError read_error = parquet_reader_read_column_with_validity(
+        reader_context, row_group_id, column_id, &buffer, &buffer_size, &validity);
     
     if (read_error != PARQUET_READER_OK) {
         snprintf(s_error_message, sizeof(s_error_message),
@@ -612,26 +931,58 @@ static MetadataGeneratorError generate_column_base_metadata(
         return METADATA_GEN_PARQUET_ERROR;
     }
     
-    // Clear the base metadata structure
-    memset(base_metadata, 0, sizeof(BaseMetadata));
+    // Null rows hold 0 in the buffer, so the sketches and the Bloom filter of a
+    // fixed-width chunk with nulls see a copy of its non-null values
+    const void* values = buffer;
+    size_t values_size = buffer_size;
+    uint64_t value_count = column->total_values;
+    void* valid_values = NULL;
+    size_t value_size = column_value_size(column->type);
+    if (buffer && validity && value_size > 0) {
+        uint64_t row_count = column->total_values < buffer_size / value_size ?
+                             column->total_values : buffer_size / value_size;
+        valid_values = gather_valid_values(buffer, row_count, value_size, validity, &value_count);
+        if (!valid_values) {
+            parquet_reader_free_buffer(buffer);
+            parquet_reader_free_buffer(validity);
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Failed to allocate memory for the non-null values");
+            return METADATA_GEN_MEMORY_ERROR;
+        }
+        values = valid_values;
+        values_size = (size_t)value_count * value_size;
+    }
+    
+    // Rows the string and mode statistics are estimated from
+    RowSample sample;
+    row_sample_init(&sample, options->sample_rate, row_group_id);
     
     // Process data based on column type
     switch (column->type) {
         case PARQUET_TYPE_INT96:  // Timestamp
-            process_timestamp_data(buffer, buffer_size, column->total_values, base_metadata);
+            process_timestamp_data(buffer, buffer_size, column->total_values, validity,
+                                   values, value_count, base_metadata);
             break;
             
         case PARQUET_TYPE_BOOLEAN:
         case PARQUET_TYPE_INT32:
         case PARQUET_TYPE_INT64:
         case PARQUET_TYPE_FLOAT:
-        case PARQUET_TYPE_DOUBLE:
-            process_numeric_data(buffer, buffer_size, column->type, column->total_values, base_metadata);
+        case PARQUET_TYPE_DOUBLE: {
+            ValueModeOptions mode_options;
+            mode_options.exact_limit = options->mode_exact_limit;
+            mode_options.sketch_counters = options->mode_sketch_counters;
+            process_numeric_data(buffer, buffer_size, column->type, column->total_values, validity,
+                                 values, value_count, &mode_options, &sample, base_metadata);
             break;
+        }
             
         case PARQUET_TYPE_BYTE_ARRAY:
         case PARQUET_TYPE_FIXED_LEN_BYTE_ARRAY:
-            process_string_data(buffer, buffer_size, column->total_values, base_metadata);
+            // The row group's high-frequency strings come from the merged column sketches
+            process_string_data(buffer, buffer_size, column->total_values,
+                                column_strings, options->max_high_freq_strings,
+                                keywords, options->max_special_strings, &sample, base_metadata);
             break;
             
         default:
@@ -639,10 +990,25 @@ static MetadataGeneratorError generate_column_base_metadata(
             break;
     }
     
-    // Free the buffer
+    // Sketch the distinct values; the sketches of the chunks merge into file and multi-file counts.
+    // They always see every row: a sketch costs one hash per value, while a distinct
+    // count extrapolated from a sample has no useful error bound and would not merge
+    sketch_distinct_values(values, values_size, column->type, value_count,
+                           &base_metadata->categorical_metadata);
+    
+    // Bloom filter for equality pruning, sized from the distinct count
+    MetadataGeneratorError error = METADATA_GEN_OK;
+    if (bloom_filter) {
+        error = build_bloom_filter(values, values_size, column->type, value_count,
+                                   base_metadata->categorical_metadata.distinct_count, options, bloom_filter);
+    }
+    
+    // Free the buffer, the validity bitmap and the non-null values
+    free(valid_values);
     parquet_reader_free_buffer(buffer);
+    parquet_reader_free_buffer(validity);
     
-    return METADATA_GEN_OK;
+    return error;
 }
 
 /**
@@ -655,6 +1021,9 @@ static MetadataGeneratorError generate_column_base_metadata(
  * row_group_id: ID of the row group containing the column
  * column_id: ID of the column to analyze
  * options: Options controlling metadata generation
+ * keywords: Keywords marking special strings
+ * column_strings: Empty sketch receiving a string column's strings (NULL skips the string statistics)
+ * bloom_filter: Receives the column chunk's Bloom filter (NULL if the column has none)
  * column_metadata: Pointer to store the generated column metadata
  * returns: Error code (METADATA_GEN_OK on success)
  */
@@ -664,6 +1033,9 @@ static MetadataGeneratorError generate_column_metadata(
     int row_group_id,
     int column_id,
     const MetadataGeneratorOptions* options,
+    const KeywordMatcher* keywords,
+    HeavyHitterSketch* column_strings,
+    ColumnBloomFilter* bloom_filter,
     ColumnMetadata** column_metadata
 ) {
     if (!reader_context || !file || !options || !column_metadata) {
@@ -699,8 +1071,7 @@ static MetadataGeneratorError generate_column_metadata(
     
     // Set basic metadata properties
     metadata->column_index = column_id;
-    strncpy(metadata->column_name, column->name, MAX_METADATA_ITEM_NAME_LENGTH - 1);
-    metadata->column_name[MAX_METADATA_ITEM_NAME_LENGTH - 1] = '\0';  // Ensure null-termination
+    snprintf(metadata->column_name, MAX_METADATA_ITEM_NAME_LENGTH, "%s", column->name);
     
     // Allocate base_metadata memory
     metadata->base_metadata = (BaseMetadata*)malloc(sizeof(BaseMetadata));
@@ -716,7 +1087,8 @@ static MetadataGeneratorError generate_column_metadata(
     if (options->generate_base_metadata) {
         // Generate the base metadata
         MetadataGeneratorError error = generate_column_base_metadata(
-            reader_context, file, row_group_id, column_id, metadata->base_metadata
+            reader_context, file, row_group_id, column_id, options, keywords, column_strings, bloom_filter,
+            metadata->base_metadata
         );
         
         if (error != METADATA_GEN_OK) {
@@ -731,25 +1103,234 @@ static MetadataGeneratorError generate_column_metadata(
 }
 
 /**
- * Generate metadata for a row group
+ * What the column chunks of one metadata_generator_generate call share
  * 
- * This function analyzes row group data and generates metadata.
+ * The keyword matcher is compiled once and only read by the worker threads.
+ * String sketches are handed out on the calling thread and come back emptied
+ * once their row group has merged them, so a call allocates about one wave
+ * of sketches however many row groups the file has. Each worker opens its
+ * own reader on its first column chunk and keeps it for the whole call, so
+ * the footer is parsed once per worker rather than once per chunk.
+ */
+typedef struct {
+    KeywordMatcher* keywords;               /* Keywords marking special strings */
+    uint32_t sketch_counters;               /* Counters of every string sketch */
+    HeavyHitterSketch** sketches;           /* Empty sketches ready to be handed out */
+    uint32_t sketch_count;                  /* Number of sketches ready */
+    uint32_t sketch_capacity;               /* Capacity of the sketches array */
+    ParquetReaderContext** worker_readers;  /* Reader of each worker (NULL until its first chunk) */
+    uint32_t worker_reader_count;           /* Number of worker slots */
+} ColumnAnalysis;
+
+/**
+ * Prepare the shared state of a metadata_generator_generate call
+ * 
+ * analysis: State to initialize
+ * options: Generator options
+ * returns: Error code (METADATA_GEN_OK on success)
+ */
+static MetadataGeneratorError column_analysis_init(ColumnAnalysis* analysis,
+                                                   const MetadataGeneratorOptions* options) {
+    memset(analysis, 0, sizeof(ColumnAnalysis));
+    analysis->sketch_counters = options->string_sketch_counters;
+    analysis->keywords = keyword_matcher_create(options->special_keywords,
+                                                options->special_keywords ? options->special_keyword_count : 0);
+    if (!analysis->keywords) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to compile special string keywords");
+        return METADATA_GEN_MEMORY_ERROR;
+    }
+    return METADATA_GEN_OK;
+}
+
+/**
+ * Release the shared state of a metadata_generator_generate call
+ */
+static void column_analysis_free(ColumnAnalysis* analysis) {
+    for (uint32_t i = 0; i < analysis->sketch_count; i++) {
+        heavy_hitters_free(analysis->sketches[i]);
+    }
+    free(analysis->sketches);
+    for (uint32_t i = 0; i < analysis->worker_reader_count; i++) {
+        parquet_reader_close(analysis->worker_readers[i]);
+    }
+    free(analysis->worker_readers);
+    keyword_matcher_free(analysis->keywords);
+    memset(analysis, 0, sizeof(ColumnAnalysis));
+}
+
+/**
+ * Hand out an empty string sketch, reusing a returned one when there is one
+ * 
+ * returns: The sketch, or NULL if out of memory
+ */
+static HeavyHitterSketch* column_analysis_take_sketch(ColumnAnalysis* analysis) {
+    if (analysis->sketch_count > 0) {
+        return analysis->sketches[--analysis->sketch_count];
+    }
+    return heavy_hitters_create(analysis->sketch_counters);
+}
+
+/**
+ * Take back a sketch handed out by column_analysis_take_sketch
+ * 
+ * sketch: Sketch to empty and keep for reuse (may be NULL)
+ */
+static void column_analysis_return_sketch(ColumnAnalysis* analysis, HeavyHitterSketch* sketch) {
+    if (!sketch) {
+        return;
+    }
+    if (analysis->sketch_count == analysis->sketch_capacity) {
+        uint32_t capacity = analysis->sketch_capacity > 0 ? analysis->sketch_capacity * 2 : 16;
+        HeavyHitterSketch** sketches = (HeavyHitterSketch**)realloc(analysis->sketches,
+                                                                     capacity * sizeof(HeavyHitterSketch*));
+        if (!sketches) {
+            heavy_hitters_free(sketch);
+            return;
+        }
+        analysis->sketches = sketches;
+        analysis->sketch_capacity = capacity;
+    }
+    heavy_hitters_reset(sketch);
+    analysis->sketches[analysis->sketch_count++] = sketch;
+}
+
+/**
+ * Make room for the readers of up to worker_count workers
+ * 
+ * returns: true on success, false if out of memory
+ */
+static bool column_analysis_reserve_readers(ColumnAnalysis* analysis, uint32_t worker_count) {
+    if (worker_count <= analysis->worker_reader_count) {
+        return true;
+    }
+    ParquetReaderContext** readers = (ParquetReaderContext**)realloc(analysis->worker_readers,
+                                                                     worker_count * sizeof(ParquetReaderContext*));
+    if (!readers) {
+        return false;
+    }
+    memset(readers + analysis->worker_reader_count, 0,
+           (worker_count - analysis->worker_reader_count) * sizeof(ParquetReaderContext*));
+    analysis->worker_readers = readers;
+    analysis->worker_reader_count = worker_count;
+    return true;
+}
+
+/**
+ * Analysis of one column chunk
+ * 
+ * Column chunks are analyzed on worker threads, each task into its own
+ * slot; the slots are then merged into their row groups in column order,
+ * so the metadata does not depend on how the tasks were scheduled.
+ */
+typedef struct {
+    int row_group_id;                       /* Row group of the column chunk */
+    int column_id;                          /* Column of the column chunk */
+    bool wants_bloom_filter;                /* Whether the column opted into Bloom filters */
+    ColumnMetadata* metadata;               /* Generated column metadata (NULL until analyzed) */
+    HeavyHitterSketch* strings;             /* Sketch of a string column's strings (NULL otherwise) */
+    ColumnBloomFilter bloom_filter;         /* Bloom filter of the column chunk, if any */
+    MetadataGeneratorError error;           /* Result of the analysis */
+    char error_message[256];                /* Error message of a failed analysis */
+} ColumnTask;
+
+/**
+ * Column chunks analyzed together by the worker threads
+ */
+typedef struct {
+    ParquetReaderContext* reader_context;   /* Context used when the file has no path */
+    ParquetReaderContext** worker_readers;  /* Reader of each worker (NULL when the file has no path) */
+    const ParquetFile* file;                /* Parquet file structure */
+    const MetadataGeneratorOptions* options;
+    const KeywordMatcher* keywords;         /* Shared special string keywords */
+    ColumnTask* tasks;                      /* One task per column chunk */
+} ColumnTaskBatch;
+
+/**
+ * Release what a task still owns
+ */
+static void free_column_task(ColumnTask* task) {
+    if (task->metadata) {
+        free(task->metadata->base_metadata);
+        free(task->metadata);
+        task->metadata = NULL;
+    }
+    heavy_hitters_free(task->strings);
+    task->strings = NULL;
+    bloom_filter_free(&task->bloom_filter.filter);
+}
+
+/**
+ * Analyze the column chunk of a task (WorkerItemProcessor)
+ * 
+ * worker_index: Worker analyzing the task
+ * item_index: Index of the task in the batch
+ * total_items: Number of tasks in the batch
+ * user_data: The ColumnTaskBatch
+ * returns: 0 on success, the task's error code on failure
+ */
+static int analyze_column_task(uint32_t worker_index, uint32_t item_index, uint32_t total_items, void* user_data) {
+    (void)total_items;
+    ColumnTaskBatch* batch = (ColumnTaskBatch*)user_data;
+    ColumnTask* task = &batch->tasks[item_index];
+    s_error_message[0] = '\0';
+    
+    // A reader per worker, like the pipeline's readers, so workers never share one;
+    // without a path the caller's context is the only reader and a single worker runs
+    ParquetReaderContext* reader_context = batch->reader_context;
+    if (batch->worker_readers) {
+        if (!batch->worker_readers[worker_index]) {
+            batch->worker_readers[worker_index] = parquet_reader_open(batch->file->file_path);
+        }
+        reader_context = batch->worker_readers[worker_index];
+    }
+    
+    if (!reader_context) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to open %s for analysis", batch->file->file_path);
+        task->error = METADATA_GEN_PARQUET_ERROR;
+    } else {
+        task->error = generate_column_metadata(reader_context, batch->file, task->row_group_id, task->column_id,
+                                               batch->options, batch->keywords, task->strings,
+                                               task->wants_bloom_filter ? &task->bloom_filter : NULL,
+                                               &task->metadata);
+    }
+    
+    if (task->error != METADATA_GEN_OK) {
+        // The error message is thread-local; keep it for the calling thread
+        snprintf(task->error_message, sizeof(task->error_message), "%s", s_error_message);
+        return (int)task->error;
+    }
+    return 0;
+}
+
+/**
+ * Generate metadata for a row group from its analyzed column chunks
+ * 
+ * This function merges the column chunks of a row group, in column order,
+ * into the row group's metadata. What the tasks own is moved into the row
+ * group, and their string sketches go back to the shared state; on failure
+ * the tasks keep everything.
  * 
- * reader_context: Context for reading the parquet file
  * file: Parquet file structure
- * row_group_id: ID of the row group to analyze
+ * row_group_id: ID of the row group
  * options: Generator options
+ * analysis: State shared by the column chunks of the call
+ * tasks: Analyzed column chunks of the row group, one per column in column order
+ * file_strings: Sketch receiving the strings of the row group (can be NULL)
  * out_metadata: Pointer to store the generated metadata
  * returns: Error code (METADATA_GEN_OK on success)
  */
 static MetadataGeneratorError generate_row_group_metadata(
-    ParquetReaderContext* reader_context,
     const ParquetFile* file,
     int row_group_id,
     const MetadataGeneratorOptions* options,
+    ColumnAnalysis* analysis,
+    ColumnTask* tasks,
+    HeavyHitterSketch* file_strings,
     RowGroupMetadata** out_metadata
 ) {
-    if (!reader_context || !file || !options || !out_metadata) {
+    if (!file || !options || !analysis || !out_metadata) {
         return METADATA_GEN_INVALID_PARAMETER;
     }
     
@@ -772,6 +1353,9 @@ static MetadataGeneratorError generate_row_group_metadata(
     
     // Initialize the row group metadata
     metadata->row_group_index = row_group_id;
+    metadata->row_count = row_group->num_rows;
+    metadata->metadata_count = 0;
+    metadata->metadata = NULL;
     
     // Allocate base_metadata memory
     metadata->base_metadata = (BaseMetadata*)malloc(sizeof(BaseMetadata));
@@ -786,6 +1370,20 @@ static MetadataGeneratorError generate_row_group_metadata(
     // Set column count
     metadata->column_count = row_group->column_count;
     
+    // Bloom filters of the columns that opted in, at most one per column
+    metadata->bloom_filter_count = 0;
+    metadata->bloom_filters = NULL;
+    if (options->bloom_filter_column_count > 0 && options->generate_base_metadata && metadata->column_count > 0) {
+        metadata->bloom_filters = (ColumnBloomFilter*)calloc(metadata->column_count, sizeof(ColumnBloomFilter));
+        if (!metadata->bloom_filters) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Failed to allocate memory for Bloom filters");
+            free(metadata->base_metadata);
+            free(metadata);
+            return METADATA_GEN_MEMORY_ERROR;
+        }
+    }
+    
     // Allocate memory for column metadata
     metadata->columns = NULL;
     if (metadata->column_count > 0) {
@@ -793,6 +1391,8 @@ static MetadataGeneratorError generate_row_group_metadata(
         if (!metadata->columns) {
             snprintf(s_error_message, sizeof(s_error_message),
                     "Failed to allocate memory for column metadata array");
+            free(metadata->bloom_filters);
+            free(metadata->base_metadata);
             free(metadata);
             return METADATA_GEN_MEMORY_ERROR;
         }
@@ -801,56 +1401,76 @@ static MetadataGeneratorError generate_row_group_metadata(
     
     // Aggregate timestamps across columns
     bool has_timestamps = false;
+    bool timestamps_from_footer = false;
     time_t min_timestamp = 0;
     time_t max_timestamp = 0;
     
-    // Aggregate numeric data across columns
+    // Aggregate numeric data across columns; the mean is weighted by the values each column's
+    // mean covers, so columns answered from footer statistics carry no weight
     double global_min = 0;
     double global_max = 0;
-    double sum_of_means = 0;
+    double weighted_sum = 0;
+    uint64_t mean_count = 0;
+    uint64_t total_count = 0;
+    uint64_t null_count = 0;
     int numeric_columns = 0;
+    bool numeric_from_footer = false;
+    BaseMetadata* aggregate = metadata->base_metadata;
     
-    // Aggregate string data across columns
-    typedef struct {
-        char string[MAX_STRING_LENGTH];
-        int count;
-    } GlobalStringFreq;
-    
-    GlobalStringFreq* global_strings = (GlobalStringFreq*)calloc(
-        options->max_high_freq_strings * 2, sizeof(GlobalStringFreq));
-    
-    if (!global_strings && row_group->column_count > 0) {
+    // Aggregate string data across columns by merging their sketches
+    HeavyHitterSketch* row_group_strings = column_analysis_take_sketch(analysis);
+    if (!row_group_strings) {
         snprintf(s_error_message, sizeof(s_error_message),
                 "Failed to allocate memory for global string tracking");
-        for (int i = 0; i < metadata->column_count; i++) {
-            if (metadata->columns[i]) {
-                free(metadata->columns[i]);
-            }
-        }
+        free(metadata->bloom_filters);
         free(metadata->columns);
+        free(metadata->base_metadata);
         free(metadata);
-        free(global_strings);
         return METADATA_GEN_MEMORY_ERROR;
     }
     
-    // Initialize global string tracking
-    int global_string_count = 0;
-    
-    // Generate metadata for each column
-    MetadataGeneratorError error = METADATA_GEN_OK;
-    for (int i = 0; i < row_group->column_count; i++) {
-        error = generate_column_metadata(reader_context, file, row_group_id, i, options, &metadata->columns[i]);
-        if (error != METADATA_GEN_OK) {
-            // Clean up
-            for (int j = 0; j < i; j++) {
-                if (metadata->columns[j]) {
-                    free(metadata->columns[j]);
-                }
-            }
+    // Merge the string sketches first, while the tasks still own everything
+    for (uint32_t i = 0; i < row_group->column_count; i++) {
+        if (tasks[i].strings && heavy_hitters_merge(row_group_strings, tasks[i].strings) != 0) {
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Failed to merge string frequencies of column %u", i);
+            column_analysis_return_sketch(analysis, row_group_strings);
+            free(metadata->bloom_filters);
             free(metadata->columns);
+            free(metadata->base_metadata);
             free(metadata);
-            free(global_strings);
-            return error;
+            return METADATA_GEN_MEMORY_ERROR;
+        }
+    }
+    
+    // Pass the row group's strings on to the file
+    if (file_strings && heavy_hitters_merge(file_strings, row_group_strings) != 0) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to merge string frequencies of row group %d", row_group_id);
+        column_analysis_return_sketch(analysis, row_group_strings);
+        free(metadata->bloom_filters);
+        free(metadata->columns);
+        free(metadata->base_metadata);
+        free(metadata);
+        return METADATA_GEN_MEMORY_ERROR;
+    }
+    
+    // Take over the metadata of each column
+    for (uint32_t i = 0; i < row_group->column_count; i++) {
+        ColumnTask* task = &tasks[i];
+        metadata->columns[i] = task->metadata;
+        task->metadata = NULL;
+        column_analysis_return_sketch(analysis, task->strings);
+        task->strings = NULL;
+        
+        // Keep the column's Bloom filter, if its type has one
+        if (metadata->bloom_filters && task->bloom_filter.filter.block_count > 0) {
+            ColumnBloomFilter* bloom_filter = &metadata->bloom_filters[metadata->bloom_filter_count++];
+            *bloom_filter = task->bloom_filter;
+            bloom_filter->column_index = (uint32_t)i;
+            strncpy(bloom_filter->column_name, row_group->columns[i].name, MAX_METADATA_ITEM_NAME_LENGTH - 1);
+            bloom_filter->column_name[MAX_METADATA_ITEM_NAME_LENGTH - 1] = '\0';
+            memset(&task->bloom_filter, 0, sizeof(ColumnBloomFilter));
         }
         
         // Aggregate timestamp metadata
@@ -869,6 +1489,9 @@ static MetadataGeneratorError generate_row_group_metadata(
                     max_timestamp = metadata->columns[i]->base_metadata->timestamp_metadata.max_timestamp;
                 }
             }
+            quantile_sketch_merge(&aggregate->timestamp_metadata.quantiles,
+                                  &metadata->columns[i]->base_metadata->timestamp_metadata.quantiles);
+            timestamps_from_footer |= metadata->columns[i]->base_metadata->timestamp_metadata.from_footer;
         }
         
         // Aggregate numeric metadata
@@ -876,6 +1499,8 @@ static MetadataGeneratorError generate_row_group_metadata(
             double col_min = metadata->columns[i]->base_metadata->numeric_metadata.min_value;
             double col_max = metadata->columns[i]->base_metadata->numeric_metadata.max_value;
             double col_mean = metadata->columns[i]->base_metadata->numeric_metadata.mean_value;
+            uint64_t col_count = metadata->columns[i]->base_metadata->numeric_metadata.total_count;
+            uint64_t col_nulls = metadata->columns[i]->base_metadata->numeric_metadata.null_count;
             
             if (numeric_columns == 0) {
                 // First numeric column
@@ -887,33 +1512,16 @@ static MetadataGeneratorError generate_row_group_metadata(
                 if (col_max > global_max) global_max = col_max;
             }
             
-            sum_of_means += col_mean;
+            uint64_t col_mean_count = metadata->columns[i]->base_metadata->numeric_metadata.count;
+            weighted_sum += col_mean * (double)col_mean_count;
+            mean_count += col_mean_count;
+            total_count += col_count;
+            null_count += col_nulls;
+            quantile_sketch_merge(&aggregate->numeric_metadata.quantiles,
+                                  &metadata->columns[i]->base_metadata->numeric_metadata.quantiles);
+            numeric_from_footer |= metadata->columns[i]->base_metadata->numeric_metadata.from_footer;
             numeric_columns++;
         }
-        
-        // Aggregate string metadata
-        for (int j = 0; j < metadata->columns[i]->base_metadata->string_metadata.count; j++) {
-            const char* str = metadata->columns[i]->base_metadata->string_metadata.high_frequency_strings[j];
-            int freq = metadata->columns[i]->base_metadata->string_metadata.frequencies[j];
-            
-            // Check if this string is already in our global list
-            bool found = false;
-            for (int k = 0; k < global_string_count; k++) {
-                if (strcmp(global_strings[k].string, str) == 0) {
-                    global_strings[k].count += freq;
-                    found = true;
-                    break;
-                }
-            }
-            
-            // Add to global list if not found and we have space
-            if (!found && global_string_count < options->max_high_freq_strings * 2) {
-                strncpy(global_strings[global_string_count].string, str, MAX_STRING_LENGTH - 1);
-                global_strings[global_string_count].string[MAX_STRING_LENGTH - 1] = '\0';
-                global_strings[global_string_count].count = freq;
-                global_string_count++;
-            }
-        }
     }
     
     // Set aggregated timestamp metadata
@@ -921,6 +1529,8 @@ static MetadataGeneratorError generate_row_group_metadata(
     if (has_timestamps) {
         metadata->base_metadata->timestamp_metadata.min_timestamp = min_timestamp;
         metadata->base_metadata->timestamp_metadata.max_timestamp = max_timestamp;
+        metadata->base_metadata->timestamp_metadata.from_footer = timestamps_from_footer;
+        store_timestamp_percentiles(&metadata->base_metadata->timestamp_metadata);
     }
     
     // Set aggregated numeric metadata
@@ -928,43 +1538,118 @@ static MetadataGeneratorError generate_row_group_metadata(
     if (numeric_columns > 0) {
         metadata->base_metadata->numeric_metadata.min_value = global_min;
         metadata->base_metadata->numeric_metadata.max_value = global_max;
-        metadata->base_metadata->numeric_metadata.mean_value = sum_of_means / numeric_columns;
+        metadata->base_metadata->numeric_metadata.mean_value =
+            (mean_count > 0) ? weighted_sum / (double)mean_count : 0.0;
+        metadata->base_metadata->numeric_metadata.avg_value = metadata->base_metadata->numeric_metadata.mean_value;
+        metadata->base_metadata->numeric_metadata.count = mean_count;
+        metadata->base_metadata->numeric_metadata.total_count = total_count;
+        metadata->base_metadata->numeric_metadata.null_count =
+            null_count > UINT32_MAX ? UINT32_MAX : (uint32_t)null_count;
         // We don't aggregate mode as it doesn't make sense to average
         metadata->base_metadata->numeric_metadata.mode_value = 0;
+        metadata->base_metadata->numeric_metadata.from_footer = numeric_from_footer;
+        store_numeric_percentiles(&metadata->base_metadata->numeric_metadata);
     }
     
-    // Sort global strings by frequency
-    for (int i = 0; i < global_string_count - 1; i++) {
-        for (int j = 0; j < global_string_count - i - 1; j++) {
-            if (global_strings[j].count < global_strings[j + 1].count) {
-                GlobalStringFreq temp = global_strings[j];
-                global_strings[j] = global_strings[j + 1];
-                global_strings[j + 1] = temp;
+    // Set aggregated string metadata; the merged sketch holds sampled counts like the columns'
+    store_high_freq_strings(row_group_strings, options->max_high_freq_strings,
+                            row_sample_rate_of(options->sample_rate), &metadata->base_metadata->string_metadata);
+    column_analysis_return_sketch(analysis, row_group_strings);
+    
+    // Set the output parameter
+    *out_metadata = metadata;
+    
+    return METADATA_GEN_OK;
+}
+
+/**
+ * Analyze a wave of row groups on the worker threads
+ * 
+ * The column chunks of the row groups become one task each, and the tasks
+ * of string columns get a sketch from the shared state before the workers
+ * start. When an analysis fails, the error of the first failed task, in
+ * row group and column order, is reported.
+ * 
+ * reader_context: Context for reading the parquet file
+ * file: Parquet file structure
+ * first_row_group: ID of the first row group of the wave
+ * row_group_count: Number of row groups in the wave
+ * options: Generator options
+ * analysis: State shared by the column chunks of the call
+ * tasks: Receives the tasks, ordered by row group then column
+ * returns: Error code (METADATA_GEN_OK on success)
+ */
+static MetadataGeneratorError analyze_row_groups(
+    ParquetReaderContext* reader_context,
+    const ParquetFile* file,
+    int first_row_group,
+    int row_group_count,
+    const MetadataGeneratorOptions* options,
+    ColumnAnalysis* analysis,
+    ColumnTask* tasks
+) {
+    uint32_t task_count = 0;
+    bool sketches_missing = false;
+    for (int i = first_row_group; i < first_row_group + row_group_count; i++) {
+        const ParquetRowGroup* row_group = &file->row_groups[i];
+        for (uint32_t j = 0; j < row_group->column_count; j++) {
+            ColumnTask* task = &tasks[task_count++];
+            memset(task, 0, sizeof(ColumnTask));
+            task->row_group_id = i;
+            task->column_id = (int)j;
+            task->wants_bloom_filter = options->bloom_filter_column_count > 0 &&
+                                       wants_bloom_filter(options, row_group->columns[j].name);
+            
+            ParquetValueType type = row_group->columns[j].type;
+            if (options->generate_base_metadata &&
+                (type == PARQUET_TYPE_BYTE_ARRAY || type == PARQUET_TYPE_FIXED_LEN_BYTE_ARRAY)) {
+                task->strings = column_analysis_take_sketch(analysis);
+                sketches_missing = sketches_missing || !task->strings;
             }
         }
     }
+    if (sketches_missing) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate memory for string frequency tracking");
+        return METADATA_GEN_MEMORY_ERROR;
+    }
+    if (task_count == 0) {
+        return METADATA_GEN_OK;
+    }
     
-    // Set aggregated string metadata
-    int count = (global_string_count < options->max_high_freq_strings) ? 
-                global_string_count : options->max_high_freq_strings;
-    
-    metadata->base_metadata->string_metadata.count = count;
-    for (int i = 0; i < count; i++) {
-        strncpy(metadata->base_metadata->string_metadata.high_frequency_strings[i], 
-                global_strings[i].string, MAX_STRING_LENGTH - 1);
-        metadata->base_metadata->string_metadata.high_frequency_strings[i][MAX_STRING_LENGTH - 1] = '\0';
-        metadata->base_metadata->string_metadata.frequencies[i] = global_strings[i].count;
+    // Workers never outnumber the tasks
+    if (file->file_path && !column_analysis_reserve_readers(analysis, task_count)) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate memory for the worker readers");
+        return METADATA_GEN_MEMORY_ERROR;
     }
     
-    // Clean up
-    if (global_strings) {
-        free(global_strings);
+    ColumnTaskBatch batch;
+    batch.reader_context = reader_context;
+    batch.worker_readers = file->file_path ? analysis->worker_readers : NULL;
+    batch.file = file;
+    batch.options = options;
+    batch.keywords = analysis->keywords;
+    batch.tasks = tasks;
+    
+    uint32_t max_threads = batch.worker_readers ? options->thread_count : 1;
+    int result = parallel_process_items_by_worker(analyze_column_task, task_count, max_threads, NULL, &batch);
+    if (result == 0) {
+        return METADATA_GEN_OK;
     }
     
-    // Set the output parameter
-    *out_metadata = metadata;
+    for (uint32_t i = 0; i < task_count; i++) {
+        if (tasks[i].error != METADATA_GEN_OK) {
+            snprintf(s_error_message, sizeof(s_error_message), "%s", tasks[i].error_message);
+            return tasks[i].error;
+        }
+    }
     
-    return METADATA_GEN_OK;
+    // No task failed, so the threads could not be started
+    const char* message = parallel_processor_get_error();
+    snprintf(s_error_message, sizeof(s_error_message),
+            "Failed to analyze column chunks: %s", message ? message : "unknown error");
+    return METADATA_GEN_MEMORY_ERROR;
 }
 
 /**
@@ -1045,77 +1730,128 @@ MetadataGeneratorError metadata_generator_generate(
         
         // Aggregate timestamps across row groups
         bool has_timestamps = false;
+        bool timestamps_from_footer = false;
         time_t global_min_timestamp = 0;
         time_t global_max_timestamp = 0;
         
-        // Aggregate numeric data across row groups
+        // Aggregate numeric data across row groups; the mean is weighted by the values each row group's mean covers
         bool has_numeric_data = false;
+        bool numeric_from_footer = false;
         double global_min = 0.0;
         double global_max = 0.0;
-        double sum_of_means = 0.0;
-        int numeric_row_groups = 0;
-        
-        // Aggregate string data across row groups
-        typedef struct {
-            char string[MAX_STRING_LENGTH];
-            int count;
-        } GlobalStringFreq;
+        double weighted_sum = 0.0;
+        uint64_t mean_count = 0;
+        uint64_t total_count = 0;
+        uint64_t null_count = 0;
         
-        GlobalStringFreq* global_strings = (GlobalStringFreq*)calloc(
-            options->max_high_freq_strings * 2, sizeof(GlobalStringFreq));
+        // Quantile digests of the file, merged from the row groups'
+        QuantileSketch* timestamp_quantiles = (QuantileSketch*)malloc(2 * sizeof(QuantileSketch));
+        QuantileSketch* numeric_quantiles = timestamp_quantiles ? timestamp_quantiles + 1 : NULL;
+        if (!timestamp_quantiles) {
+            if (ext_metadata->base_metadata) {
+                free(ext_metadata->base_metadata);
+            }
+            free(ext_metadata->child_metadata);
+            free(ext_metadata);
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Failed to allocate memory for quantile digests");
+            return METADATA_GEN_MEMORY_ERROR;
+        }
+        quantile_sketch_init(timestamp_quantiles);
+        quantile_sketch_init(numeric_quantiles);
         
-        if (!global_strings && file->row_group_count > 0) {
+        // Aggregate string data across row groups by merging their sketches
+        HeavyHitterSketch* file_strings = heavy_hitters_create(options->string_sketch_counters);
+        if (!file_strings) {
             if (ext_metadata->base_metadata) {
                 free(ext_metadata->base_metadata);
             }
             free(ext_metadata->child_metadata);
             free(ext_metadata);
+            free(timestamp_quantiles);
             snprintf(s_error_message, sizeof(s_error_message),
                     "Failed to allocate memory for global string tracking");
             return METADATA_GEN_MEMORY_ERROR;
         }
         
-        // Initialize global string tracking
-        int global_string_count = 0;
+        // The keyword matcher and the string sketches serve every column chunk of the file
+        ColumnAnalysis analysis;
+        MetadataGeneratorError analysis_error = column_analysis_init(&analysis, options);
+        if (analysis_error != METADATA_GEN_OK) {
+            column_analysis_free(&analysis);
+            heavy_hitters_free(file_strings);
+            if (ext_metadata->base_metadata) {
+                free(ext_metadata->base_metadata);
+            }
+            free(ext_metadata->child_metadata);
+            free(ext_metadata);
+            free(timestamp_quantiles);
+            return analysis_error;
+        }
+        
+        // Column chunks analyzed per wave: enough to keep every worker thread busy,
+        // few enough that the string sketches of a wave stay small
+        uint32_t threads = options->thread_count > 0 ? options->thread_count : parallel_get_optimal_threads();
+        uint32_t wave_limit = (threads > 0 ? threads : 1) * COLUMN_TASKS_PER_THREAD;
+        ColumnTask* wave = NULL;
+        uint32_t wave_capacity = 0;
+        uint32_t wave_task_count = 0;
+        uint32_t wave_position = 0;
+        int wave_end = 0;
         
-        // Generate metadata for each row group
+        // Generate metadata for each row group, analyzing a wave of row groups at a time
         for (int i = 0; i < file->row_group_count; i++) {
-            RowGroupMetadata* row_group_metadata = NULL;
-            MetadataGeneratorError error = generate_row_group_metadata(
-                reader_context, file, i, options, &row_group_metadata
-            );
+            MetadataGeneratorError error = METADATA_GEN_OK;
             
-            if (error != METADATA_GEN_OK) {
-                // Free previously generated row group metadata
-                for (int j = 0; j < i; j++) {
-                    if (ext_metadata->child_metadata[j]) {
-                        // Convert ExtendedMetadata to RowGroupMetadata for cleanup
-                        RowGroupMetadata* rg_meta = (RowGroupMetadata*)ext_metadata->child_metadata[j];
-                        
-                        // Free the column metadata
-                        for (int k = 0; k < rg_meta->column_count; k++) {
-                            if (rg_meta->columns[k]) {
-                                free(rg_meta->columns[k]);
-                            }
-                        }
-                        
-                        // Free the columns array
-                        if (rg_meta->columns) {
-                            free(rg_meta->columns);
-                        }
-                        
-                        // Free the row group metadata
-                        free(rg_meta);
+            if (i == wave_end) {
+                // Next wave: whole row groups, at least one
+                wave_task_count = 0;
+                wave_position = 0;
+                while (wave_end < (int)file->row_group_count &&
+                       (wave_end == i ||
+                        wave_task_count + (uint32_t)file->row_groups[wave_end].column_count <= wave_limit)) {
+                    wave_task_count += (uint32_t)file->row_groups[wave_end].column_count;
+                    wave_end++;
+                }
+                
+                if (wave_task_count > wave_capacity) {
+                    ColumnTask* tasks = (ColumnTask*)realloc(wave, wave_task_count * sizeof(ColumnTask));
+                    if (tasks) {
+                        wave = tasks;
+                        wave_capacity = wave_task_count;
+                    } else {
+                        wave_task_count = 0;
+                        snprintf(s_error_message, sizeof(s_error_message),
+                                "Failed to allocate memory for column tasks");
+                        error = METADATA_GEN_MEMORY_ERROR;
                     }
                 }
-                if (ext_metadata->base_metadata) {
-                    free(ext_metadata->base_metadata);
+                
+                if (error == METADATA_GEN_OK) {
+                    error = analyze_row_groups(reader_context, file, i, wave_end - i, options, &analysis, wave);
                 }
-                free(ext_metadata->child_metadata);
-                if (global_strings) {
-                    free(global_strings);
+            }
+            
+            // Merge the row group's column chunks, in column order
+            RowGroupMetadata* row_group_metadata = NULL;
+            if (error == METADATA_GEN_OK) {
+                error = generate_row_group_metadata(
+                    file, i, options, &analysis, wave ? &wave[wave_position] : NULL, file_strings,
+                    &row_group_metadata
+                );
+                wave_position += (uint32_t)file->row_groups[i].column_count;
+            }
+            
+            if (error != METADATA_GEN_OK) {
+                // Free the wave and the row groups generated so far
+                for (uint32_t j = 0; j < wave_task_count; j++) {
+                    free_column_task(&wave[j]);
                 }
-                free(ext_metadata);
+                free(wave);
+                column_analysis_free(&analysis);
+                heavy_hitters_free(file_strings);
+                free(timestamp_quantiles);
+                metadata_generator_free_metadata((Metadata*)ext_metadata);
                 return error;
             }
             
@@ -1138,6 +1874,9 @@ MetadataGeneratorError metadata_generator_generate(
                         global_max_timestamp = row_group_metadata->base_metadata->timestamp_metadata.max_timestamp;
                     }
                 }
+                quantile_sketch_merge(timestamp_quantiles,
+                                      &row_group_metadata->base_metadata->timestamp_metadata.quantiles);
+                timestamps_from_footer |= row_group_metadata->base_metadata->timestamp_metadata.from_footer;
             }
             
             // Aggregate numeric metadata
@@ -1145,6 +1884,8 @@ MetadataGeneratorError metadata_generator_generate(
                 double rg_min = row_group_metadata->base_metadata->numeric_metadata.min_value;
                 double rg_max = row_group_metadata->base_metadata->numeric_metadata.max_value;
                 double rg_mean = row_group_metadata->base_metadata->numeric_metadata.mean_value;
+                uint64_t rg_count = row_group_metadata->base_metadata->numeric_metadata.total_count;
+                uint64_t rg_nulls = row_group_metadata->base_metadata->numeric_metadata.null_count;
                 
                 if (!has_numeric_data) {
                     // First numeric row group
@@ -1157,45 +1898,25 @@ MetadataGeneratorError metadata_generator_generate(
                     if (rg_max > global_max) global_max = rg_max;
                 }
                 
-                sum_of_means += rg_mean;
-                numeric_row_groups++;
-            }
-            
-            // Aggregate string metadata
-            for (int j = 0; j < row_group_metadata->base_metadata->string_metadata.count; j++) {
-                const char* str = row_group_metadata->base_metadata->string_metadata.high_frequency_strings[j];
-                int freq = row_group_metadata->base_metadata->string_metadata.frequencies[j];
-                
-                // Check if this string is already in our global list
-                bool found = false;
-                for (int k = 0; k < global_string_count; k++) {
-                    if (strcmp(global_strings[k].string, str) == 0) {
-                        global_strings[k].count += freq;
-                        found = true;
-                        break;
-                    }
-                }
-                
-                // Add to global list if not found and we have space
-                if (!found && global_string_count < options->max_high_freq_strings * 2) {
-                    strncpy(global_strings[global_string_count].string, str, MAX_STRING_LENGTH - 1);
-                    global_strings[global_string_count].string[MAX_STRING_LENGTH - 1] = '\0';
-                    global_strings[global_string_count].count = freq;
-                    global_string_count++;
-                }
+                uint64_t rg_mean_count = row_group_metadata->base_metadata->numeric_metadata.count;
+                weighted_sum += rg_mean * (double)rg_mean_count;
+                mean_count += rg_mean_count;
+                total_count += rg_count;
+                null_count += rg_nulls;
+                quantile_sketch_merge(numeric_quantiles,
+                                      &row_group_metadata->base_metadata->numeric_metadata.quantiles);
+                numeric_from_footer |= row_group_metadata->base_metadata->numeric_metadata.from_footer;
             }
         }
+        free(wave);
+        column_analysis_free(&analysis);
+        double global_mean = (mean_count > 0) ? weighted_sum / (double)mean_count : 0.0;
         
-        // Sort global strings by frequency
-        for (int i = 0; i < global_string_count - 1; i++) {
-            for (int j = 0; j < global_string_count - i - 1; j++) {
-                if (global_strings[j].count < global_strings[j + 1].count) {
-                    GlobalStringFreq temp = global_strings[j];
-                    global_strings[j] = global_strings[j + 1];
-                    global_strings[j + 1] = temp;
-                }
-            }
-        }
+        // The file's most frequent strings
+        HeavyHitter global_strings[MAX_HIGH_FREQ_STRINGS];
+        uint32_t max_strings = options->max_high_freq_strings < MAX_HIGH_FREQ_STRINGS ?
+                               options->max_high_freq_strings : MAX_HIGH_FREQ_STRINGS;
+        int high_freq_count = (int)heavy_hitters_top(file_strings, global_strings, max_strings);
         
         // Store aggregated metadata in file metadata
         if (ext_metadata->base_metadata) {
@@ -1204,6 +1925,9 @@ MetadataGeneratorError metadata_generator_generate(
             if (has_timestamps) {
                 ext_metadata->base_metadata->timestamp_metadata.min_timestamp = global_min_timestamp;
                 ext_metadata->base_metadata->timestamp_metadata.max_timestamp = global_max_timestamp;
+                ext_metadata->base_metadata->timestamp_metadata.quantiles = *timestamp_quantiles;
+                ext_metadata->base_metadata->timestamp_metadata.from_footer = timestamps_from_footer;
+                store_timestamp_percentiles(&ext_metadata->base_metadata->timestamp_metadata);
             }
             
             // Store numeric metadata
@@ -1211,23 +1935,22 @@ MetadataGeneratorError metadata_generator_generate(
             if (has_numeric_data) {
                 ext_metadata->base_metadata->numeric_metadata.min_value = global_min;
                 ext_metadata->base_metadata->numeric_metadata.max_value = global_max;
-                ext_metadata->base_metadata->numeric_metadata.mean_value = 
-                    (numeric_row_groups > 0) ? (sum_of_means / numeric_row_groups) : 0.0;
+                ext_metadata->base_metadata->numeric_metadata.mean_value = global_mean;
+                ext_metadata->base_metadata->numeric_metadata.avg_value = global_mean;
+                ext_metadata->base_metadata->numeric_metadata.count = mean_count;
+                ext_metadata->base_metadata->numeric_metadata.total_count = total_count;
+                ext_metadata->base_metadata->numeric_metadata.null_count =
+                    null_count > UINT32_MAX ? UINT32_MAX : (uint32_t)null_count;
                 // Mode is not aggregated as it doesn't make sense to average
                 ext_metadata->base_metadata->numeric_metadata.mode_value = 0.0;
+                ext_metadata->base_metadata->numeric_metadata.quantiles = *numeric_quantiles;
+                ext_metadata->base_metadata->numeric_metadata.from_footer = numeric_from_footer;
+                store_numeric_percentiles(&ext_metadata->base_metadata->numeric_metadata);
             }
             
-            // Store string metadata
-            int high_freq_count = (global_string_count < options->max_high_freq_strings) ? 
-                                  global_string_count : options->max_high_freq_strings;
-            
-            ext_metadata->base_metadata->string_metadata.count = high_freq_count;
-            for (int i = 0; i < high_freq_count; i++) {
-                strncpy(ext_metadata->base_metadata->string_metadata.high_frequency_strings[i],
-                        global_strings[i].string, MAX_STRING_LENGTH - 1);
-                ext_metadata->base_metadata->string_metadata.high_frequency_strings[i][MAX_STRING_LENGTH - 1] = '\0';
-                ext_metadata->base_metadata->string_metadata.frequencies[i] = global_strings[i].count;
-            }
+            // Store string metadata; the merged sketch holds sampled counts like the columns'
+            double sample_rate = row_sample_rate_of(options->sample_rate);
+            store_high_freq_strings(file_strings, max_strings, sample_rate, &ext_metadata->base_metadata->string_metadata);
             
             // Initialize metadata items array if needed
             if (!ext_metadata->base_metadata->items) {
@@ -1244,7 +1967,10 @@ MetadataGeneratorError metadata_generator_generate(
                             timestamp_item->type = METADATA_TYPE_TIMESTAMP;
                             timestamp_item->value.timestamp.min_timestamp = global_min_timestamp;
                             timestamp_item->value.timestamp.max_timestamp = global_max_timestamp;
-                            timestamp_item->value.timestamp.count = 0; // We don't track this across row groups
+                            timestamp_item->value.timestamp.count = timestamp_quantiles->count;
+                            timestamp_item->value.timestamp.quantiles = *timestamp_quantiles;
+                            timestamp_item->value.timestamp.from_footer = timestamps_from_footer;
+                            store_timestamp_percentiles(&timestamp_item->value.timestamp);
                             
                             ext_metadata->base_metadata->items[ext_metadata->base_metadata->item_count++] = timestamp_item;
                         }
@@ -1258,12 +1984,16 @@ MetadataGeneratorError metadata_generator_generate(
                             numeric_item->type = METADATA_TYPE_NUMERIC;
                             numeric_item->value.numeric.min_value = global_min;
                             numeric_item->value.numeric.max_value = global_max;
-                            numeric_item->value.numeric.avg_value = 
-                                (numeric_row_groups > 0) ? (sum_of_means / numeric_row_groups) : 0.0;
+                            numeric_item->value.numeric.avg_value = global_mean;
                             numeric_item->value.numeric.mode_value = 0.0; // Not aggregated
                             numeric_item->value.numeric.mode_count = 0;
-                            numeric_item->value.numeric.total_count = 0; // We don't track this across row groups
-                            numeric_item->value.numeric.null_count = 0;  // We don't track this across row groups
+                            numeric_item->value.numeric.mode_is_sampled = 0;
+                            numeric_item->value.numeric.from_footer = numeric_from_footer;
+                            numeric_item->value.numeric.total_count = total_count;
+                            numeric_item->value.numeric.null_count =
+                                null_count > UINT32_MAX ? UINT32_MAX : (uint32_t)null_count;
+                            numeric_item->value.numeric.quantiles = *numeric_quantiles;
+                            store_numeric_percentiles(&numeric_item->value.numeric);
                             
                             ext_metadata->base_metadata->items[ext_metadata->base_metadata->item_count++] = numeric_item;
                         }
@@ -1280,10 +2010,18 @@ MetadataGeneratorError metadata_generator_generate(
                             string_item->value.string.high_freq_count = high_freq_count;
                             for (int i = 0; i < high_freq_count; i++) {
                                 strncpy(string_item->value.string.high_frequency_strings[i],
-                                        global_strings[i].string, MAX_STRING_LENGTH - 1);
+                                        global_strings[i].value, MAX_STRING_LENGTH - 1);
                                 string_item->value.string.high_frequency_strings[i][MAX_STRING_LENGTH - 1] = '\0';
-                                string_item->value.string.high_freq_counts[i] = global_strings[i].count;
+                                uint64_t estimate = scale_sampled_count(global_strings[i].count, sample_rate);
+                                string_item->value.string.high_freq_counts[i] =
+                                    estimate < UINT32_MAX ? (uint32_t)estimate : UINT32_MAX;
+                                string_item->value.string.frequency_errors[i] =
+                                    scale_sampled_count(global_strings[i].error, sample_rate);
+                                string_item->value.string.sample_errors[i] =
+                                    sampled_count_error(global_strings[i].count, sample_rate);
                             }
+                            string_item->value.string.is_sampled = sample_rate < 1.0;
+                            string_item->value.string.sample_rate = sample_rate;
                             
                             // We don't aggregate special strings across row groups
                             string_item->value.string.special_string_count = 0;
@@ -1297,10 +2035,9 @@ MetadataGeneratorError metadata_generator_generate(
             }
         }
         
-        // Free global strings
-        if (global_strings) {
-            free(global_strings);
-        }
+        // Free the file's string sketch and quantile digests
+        heavy_hitters_free(file_strings);
+        free(timestamp_quantiles);
     }
     
     // Generate custom metadata if requested
@@ -1396,6 +2133,12 @@ void metadata_generator_free_metadata(Metadata* metadata) {
                         free(rg_meta->columns);
                     }
                     
+                    // Free the Bloom filters
+                    for (uint32_t j = 0; j < rg_meta->bloom_filter_count; j++) {
+                        bloom_filter_free(&rg_meta->bloom_filters[j].filter);
+                    }
+                    free(rg_meta->bloom_filters);
+                    
                     // Free the row group metadata
                     free(rg_meta);
                 } else if (ext_metadata->type == METADATA_TYPE_ROW_GROUP) {
@@ -1415,56 +2158,468 @@ void metadata_generator_free_metadata(Metadata* metadata) {
 }
 
 /**
- * Save metadata to a file
+ * Merge the distinct-value sketches of a column's chunks into a sketch
  * 
- * This function serializes metadata to a binary file.
- * The metadata is stored in a compact binary format that can be
- * efficiently loaded using metadata_generator_load_metadata.
+ * This function walks the row groups of metadata generated by
+ * metadata_generator_generate and merges the column's chunk sketches.
  * 
- * metadata: Pointer to metadata structure to save
- * file_path: Path where the metadata will be saved
+ * metadata: Metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * sketch: Sketch receiving the column's distinct values
  * returns: Error code (METADATA_GEN_OK on success)
  */
-MetadataGeneratorError metadata_generator_save_metadata(
+MetadataGeneratorError metadata_generator_merge_distinct_sketch(
     const Metadata* metadata,
-    const char* file_path
+    int column_id,
+    HyperLogLog* sketch
 ) {
-    if (!metadata || !file_path) {
+    if (!metadata || !sketch || column_id < 0) {
         return METADATA_GEN_INVALID_PARAMETER;
     }
     
-    // For now, we'll just serialize to a simple binary format
-    FILE* file = fopen(file_path, "wb");
-    if (!file) {
-        snprintf(s_error_message, sizeof(s_error_message), 
-                "Failed to open output file: %s", file_path);
-        return METADATA_GEN_FILE_ERROR;
+    // Cast to extended metadata; its children are the row group metadata
+    const struct ExtendedMetadata* ext_metadata = (const struct ExtendedMetadata*)metadata;
+    if (ext_metadata->type != METADATA_TYPE_FILE || !ext_metadata->child_metadata) {
+        return METADATA_GEN_INVALID_PARAMETER;
     }
     
-    // Cast to extended metadata
-    const struct ExtendedMetadata* ext_metadata = (const struct ExtendedMetadata*)metadata;
+    bool found = false;
+    for (int i = 0; i < ext_metadata->child_count; i++) {
+        const RowGroupMetadata* rg_meta = (const RowGroupMetadata*)ext_metadata->child_metadata[i];
+        if (!rg_meta || !rg_meta->columns || column_id >= (int)rg_meta->column_count) {
+            continue;
+        }
+        const ColumnMetadata* column = rg_meta->columns[column_id];
+        if (column && column->base_metadata) {
+            if (column->base_metadata->numeric_metadata.from_footer ||
+                column->base_metadata->timestamp_metadata.from_footer) {
+                snprintf(s_error_message, sizeof(s_error_message),
+                        "Column %d of row group %d was answered from footer statistics, without a sketch",
+                        column_id, i);
+                return METADATA_GEN_SKETCH_UNAVAILABLE;
+            }
+            hyperloglog_merge(sketch, &column->base_metadata->categorical_metadata.distinct_sketch);
+            found = true;
+        }
+    }
     
-    // Write header information
-    fwrite(&ext_metadata->type, sizeof(int), 1, file);
-    fwrite(&ext_metadata->id, sizeof(int), 1, file);
-    fwrite(ext_metadata->name, sizeof(char), MAX_METADATA_STRING_LENGTH, file);
+    if (!found) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "No row group has column %d", column_id);
+        return METADATA_GEN_INVALID_PARAMETER;
+    }
+    return METADATA_GEN_OK;
+}
+
+/**
+ * Estimate the number of distinct values of a column across a file
+ * 
+ * metadata: Metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * returns: Estimated number of distinct values (0 if no row group has the column
+ *          or some of its chunks were answered from footer statistics)
+ */
+uint64_t metadata_generator_distinct_count(const Metadata* metadata, int column_id) {
+    HyperLogLog sketch;
+    hyperloglog_init(&sketch);
+    if (metadata_generator_merge_distinct_sketch(metadata, column_id, &sketch) != METADATA_GEN_OK) {
+        return 0;
+    }
+    return hyperloglog_estimate(&sketch);
+}
+
+/**
+ * Merge the quantile digests of a column's chunks into a digest
+ * 
+ * metadata: Metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * sketch: Digest receiving the column's values
+ * returns: Error code (METADATA_GEN_OK on success)
+ */
+MetadataGeneratorError metadata_generator_merge_quantile_sketch(
+    const Metadata* metadata,
+    int column_id,
+    QuantileSketch* sketch
+) {
+    if (!metadata || !sketch || column_id < 0) {
+        return METADATA_GEN_INVALID_PARAMETER;
+    }
     
-    // Write child count
-    fwrite(&ext_metadata->child_count, sizeof(int), 1, file);
+    // Cast to extended metadata; its children are the row group metadata
+    const struct ExtendedMetadata* ext_metadata = (const struct ExtendedMetadata*)metadata;
+    if (ext_metadata->type != METADATA_TYPE_FILE || !ext_metadata->child_metadata) {
+        return METADATA_GEN_INVALID_PARAMETER;
+    }
     
-    // In a real implementation, we would recursively serialize all child metadata
-    // and custom metadata as well
+    bool found = false;
+    for (int i = 0; i < ext_metadata->child_count; i++) {
+        const RowGroupMetadata* rg_meta = (const RowGroupMetadata*)ext_metadata->child_metadata[i];
+        if (!rg_meta || !rg_meta->columns || column_id >= (int)rg_meta->column_count) {
+            continue;
+        }
+        const ColumnMetadata* column = rg_meta->columns[column_id];
+        if (column && column->base_metadata) {
+            if (column->base_metadata->numeric_metadata.from_footer ||
+                column->base_metadata->timestamp_metadata.from_footer) {
+                snprintf(s_error_message, sizeof(s_error_message),
+                        "Column %d of row group %d was answered from footer statistics, without a digest",
+                        column_id, i);
+                return METADATA_GEN_SKETCH_UNAVAILABLE;
+            }
+            // A column fills at most one of the two digests
+            quantile_sketch_merge(sketch, &column->base_metadata->numeric_metadata.quantiles);
+            quantile_sketch_merge(sketch, &column->base_metadata->timestamp_metadata.quantiles);
+            found = true;
+        }
+    }
     
-    fclose(file);
+    if (!found) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "No row group has column %d", column_id);
+        return METADATA_GEN_INVALID_PARAMETER;
+    }
+    return METADATA_GEN_OK;
+}
+
+/* Items a row group's or column's aggregates are exported as */
+#define EXPORTED_ITEMS_PER_BASE 4
+
+/**
+ * Export the aggregates of a row group's or column's base metadata as items
+ *
+ * The items are named like the file-level ones. The distinct count is only
+ * exported when it is known.
+ *
+ * base: Base metadata holding the aggregates
+ * items: Receives the items, room for EXPORTED_ITEMS_PER_BASE
+ * returns: Number of items exported
+ */
+static uint32_t export_base_metadata_items(const BaseMetadata* base, MetadataItem* items) {
+    uint32_t count = 0;
+
+    if (base->timestamp_metadata.has_timestamps) {
+        MetadataItem* item = &items[count++];
+        memset(item, 0, sizeof(MetadataItem));
+        snprintf(item->name, MAX_METADATA_ITEM_NAME_LENGTH, "TimestampRange");
+        item->type = METADATA_TYPE_TIMESTAMP;
+        item->value.timestamp = base->timestamp_metadata;
+        item->value.timestamp.count = base->timestamp_metadata.quantiles.count;
+    }
+
+    if (base->numeric_metadata.has_numeric_data) {
+        MetadataItem* item = &items[count++];
+        memset(item, 0, sizeof(MetadataItem));
+        snprintf(item->name, MAX_METADATA_ITEM_NAME_LENGTH, "NumericStats");
+        item->type = METADATA_TYPE_NUMERIC;
+        item->value.numeric = base->numeric_metadata;
+    }
+
+    // Base string metadata keeps its counts in frequencies, items in high_freq_counts
+    if (base->string_metadata.count > 0 || base->string_metadata.special_string_count > 0) {
+        MetadataItem* item = &items[count++];
+        memset(item, 0, sizeof(MetadataItem));
+        snprintf(item->name, MAX_METADATA_ITEM_NAME_LENGTH, "StringStats");
+        item->type = METADATA_TYPE_STRING;
+        item->value.string = base->string_metadata;
+        item->value.string.high_freq_count = base->string_metadata.count;
+        for (uint32_t i = 0; i < base->string_metadata.count && i < MAX_HIGH_FREQ_STRINGS; i++) {
+            item->value.string.high_freq_counts[i] = (uint32_t)base->string_metadata.frequencies[i];
+        }
+    }
+
+    if (base->categorical_metadata.distinct_count > 0) {
+        MetadataItem* item = &items[count++];
+        memset(item, 0, sizeof(MetadataItem));
+        snprintf(item->name, MAX_METADATA_ITEM_NAME_LENGTH, "DistinctValues");
+        item->type = METADATA_TYPE_CATEGORICAL;
+        item->value.categorical.distinct_count = base->categorical_metadata.distinct_count;
+        item->value.categorical.total_category_count = base->categorical_metadata.total_category_count;
+    }
+
+    return count;
+}
+
+/**
+ * Merge a column's chunks across the row groups of generated metadata
+ *
+ * ext_metadata: File metadata generated by metadata_generator_generate
+ * column_id: ID of the column
+ * column: Receives the column's aggregates (cleared first)
+ * returns: Whether some row group has the column
+ */
+static bool merge_column_chunks(const struct ExtendedMetadata* ext_metadata, int column_id, BaseMetadata* column) {
+    memset(column, 0, sizeof(BaseMetadata));
+    bool found = false;
+    double weighted_sum = 0.0;
+    uint64_t mean_count = 0;
+    uint64_t null_count = 0;
+
+    for (int i = 0; i < ext_metadata->child_count; i++) {
+        const RowGroupMetadata* rg_meta = (const RowGroupMetadata*)ext_metadata->child_metadata[i];
+        if (!rg_meta || !rg_meta->columns || column_id >= (int)rg_meta->column_count ||
+            !rg_meta->columns[column_id] || !rg_meta->columns[column_id]->base_metadata) {
+            continue;
+        }
+        const BaseMetadata* chunk = rg_meta->columns[column_id]->base_metadata;
+        found = true;
+
+        const TimestampMetadata* timestamps = &chunk->timestamp_metadata;
+        if (timestamps->has_timestamps) {
+            TimestampMetadata* merged = &column->timestamp_metadata;
+            if (!merged->has_timestamps || timestamps->min_timestamp < merged->min_timestamp) {
+                merged->min_timestamp = timestamps->min_timestamp;
+            }
+            if (!merged->has_timestamps || timestamps->max_timestamp > merged->max_timestamp) {
+                merged->max_timestamp = timestamps->max_timestamp;
+            }
+            merged->has_timestamps = true;
+            merged->null_count += timestamps->null_count;
+            merged->from_footer |= timestamps->from_footer;
+            quantile_sketch_merge(&merged->quantiles, &timestamps->quantiles);
+        }
+
+        const NumericMetadata* numeric = &chunk->numeric_metadata;
+        if (numeric->has_numeric_data) {
+            NumericMetadata* merged = &column->numeric_metadata;
+            if (!merged->has_numeric_data || numeric->min_value < merged->min_value) {
+                merged->min_value = numeric->min_value;
+            }
+            if (!merged->has_numeric_data || numeric->max_value > merged->max_value) {
+                merged->max_value = numeric->max_value;
+            }
+            merged->has_numeric_data = true;
+            weighted_sum += numeric->mean_value * (double)numeric->count;
+            mean_count += numeric->count;
+            merged->total_count += numeric->total_count;
+            null_count += numeric->null_count;
+            merged->from_footer |= numeric->from_footer;
+            quantile_sketch_merge(&merged->quantiles, &numeric->quantiles);
+        }
+    }
+
+    if (column->timestamp_metadata.has_timestamps) {
+        store_timestamp_percentiles(&column->timestamp_metadata);
+    }
+    if (column->numeric_metadata.has_numeric_data) {
+        // The mode is not aggregated across chunks
+        column->numeric_metadata.mean_value = mean_count > 0 ? weighted_sum / (double)mean_count : 0.0;
+        column->numeric_metadata.avg_value = column->numeric_metadata.mean_value;
+        column->numeric_metadata.count = mean_count;
+        column->numeric_metadata.null_count = null_count > UINT32_MAX ? UINT32_MAX : (uint32_t)null_count;
+        store_numeric_percentiles(&column->numeric_metadata);
+    }
+
+    // Chunks answered from footer statistics have no sketch, so the count stays unknown
+    HyperLogLog sketch;
+    hyperloglog_init(&sketch);
+    if (found && metadata_generator_merge_distinct_sketch((const Metadata*)ext_metadata, column_id, &sketch) ==
+                 METADATA_GEN_OK) {
+        column->categorical_metadata.distinct_count = hyperloglog_estimate(&sketch);
+        column->categorical_metadata.total_category_count =
+            column->categorical_metadata.distinct_count > UINT32_MAX ?
+            UINT32_MAX : (uint32_t)column->categorical_metadata.distinct_count;
+    }
+
+    return found;
+}
+
+/**
+ * Release a view created by create_metadata_view
+ *
+ * The Bloom filters and custom metadata belong to the generated metadata
+ * and are left alone.
+ *
+ * view: The view
+ */
+static void free_metadata_view(Metadata* view) {
+    if (!view) {
+        return;
+    }
+    free(view->file_path);
+    free(view->file_metadata.basic_metadata);
+    for (uint32_t i = 0; view->row_group_metadata && i < view->row_group_metadata_count; i++) {
+        free(view->row_group_metadata[i].metadata);
+    }
+    free(view->row_group_metadata);
+    for (uint32_t i = 0; view->column_metadata && i < view->column_metadata_count; i++) {
+        free(view->column_metadata[i].metadata);
+    }
+    free(view->column_metadata);
+    free(view);
+}
+
+/**
+ * Lay generated metadata out as the Metadata tree the JSON serializer writes
+ *
+ * The view holds the file-level items, the aggregates and Bloom filters of
+ * each row group, and the aggregates of each column merged across the row
+ * groups, so queries can read percentiles and distinct counts per column.
+ *
+ * ext_metadata: File metadata generated by metadata_generator_generate
+ * returns: The view, released with free_metadata_view, or NULL if out of memory
+ */
+static Metadata* create_metadata_view(const struct ExtendedMetadata* ext_metadata) {
+    Metadata* view = (Metadata*)calloc(1, sizeof(Metadata));
+    if (!view) {
+        return NULL;
+    }
+
+    size_t name_length = strlen(ext_metadata->name);
+    view->file_path = (char*)malloc(name_length + 1);
+    if (!view->file_path) {
+        free_metadata_view(view);
+        return NULL;
+    }
+    memcpy(view->file_path, ext_metadata->name, name_length + 1);
+
+    // File-level items
+    const BaseMetadata* base = ext_metadata->base_metadata;
+    view->file_metadata.use_basic_metadata = base != NULL;
+    if (base && base->items && base->item_count > 0) {
+        view->file_metadata.basic_metadata = (MetadataItem*)malloc(base->item_count * sizeof(MetadataItem));
+        if (!view->file_metadata.basic_metadata) {
+            free_metadata_view(view);
+            return NULL;
+        }
+        for (uint32_t i = 0; i < base->item_count; i++) {
+            if (base->items[i]) {
+                view->file_metadata.basic_metadata[view->file_metadata.basic_metadata_count++] = *base->items[i];
+            }
+        }
+    }
+    view->file_metadata.custom_metadata_count = ext_metadata->custom_metadata ?
+                                                (uint32_t)ext_metadata->custom_metadata_count : 0;
+    view->file_metadata.custom_metadata = ext_metadata->custom_metadata;
+
+    // Row groups, with their Bloom filters
+    uint32_t column_count = 0;
+    if (ext_metadata->child_metadata && ext_metadata->child_count > 0) {
+        view->row_group_metadata = (RowGroupMetadata*)calloc(ext_metadata->child_count, sizeof(RowGroupMetadata));
+        if (!view->row_group_metadata) {
+            free_metadata_view(view);
+            return NULL;
+        }
+        view->row_group_metadata_count = (uint32_t)ext_metadata->child_count;
+
+        for (int i = 0; i < ext_metadata->child_count; i++) {
+            const RowGroupMetadata* rg_meta = (const RowGroupMetadata*)ext_metadata->child_metadata[i];
+            RowGroupMetadata* row_group = &view->row_group_metadata[i];
+            row_group->row_group_index = (uint32_t)i;
+            if (!rg_meta) {
+                continue;
+            }
+
+            row_group->row_group_index = rg_meta->row_group_index;
+            row_group->row_count = rg_meta->row_count;
+            row_group->bloom_filter_count = rg_meta->bloom_filter_count;
+            row_group->bloom_filters = rg_meta->bloom_filters;
+            if (rg_meta->column_count > column_count) {
+                column_count = rg_meta->column_count;
+            }
+
+            if (rg_meta->base_metadata) {
+                row_group->metadata = (MetadataItem*)malloc(EXPORTED_ITEMS_PER_BASE * sizeof(MetadataItem));
+                if (!row_group->metadata) {
+                    free_metadata_view(view);
+                    return NULL;
+                }
+                row_group->metadata_count = export_base_metadata_items(rg_meta->base_metadata, row_group->metadata);
+            }
+        }
+    }
+
+    // Columns, merged across the row groups
+    if (column_count > 0) {
+        view->column_metadata = (ColumnMetadata*)calloc(column_count, sizeof(ColumnMetadata));
+        BaseMetadata* merged = (BaseMetadata*)malloc(sizeof(BaseMetadata));
+        if (!view->column_metadata || !merged) {
+            free(merged);
+            free_metadata_view(view);
+            return NULL;
+        }
+
+        for (uint32_t j = 0; j < column_count; j++) {
+            if (!merge_column_chunks(ext_metadata, (int)j, merged)) {
+                continue;
+            }
+
+            ColumnMetadata* column = &view->column_metadata[view->column_metadata_count++];
+            column->column_index = j;
+            for (int i = 0; i < ext_metadata->child_count; i++) {
+                const RowGroupMetadata* rg_meta = (const RowGroupMetadata*)ext_metadata->child_metadata[i];
+                if (rg_meta && rg_meta->columns && j < rg_meta->column_count && rg_meta->columns[j]) {
+                    memcpy(column->column_name, rg_meta->columns[j]->column_name, MAX_METADATA_ITEM_NAME_LENGTH);
+                    break;
+                }
+            }
+
+            column->metadata = (MetadataItem*)malloc(EXPORTED_ITEMS_PER_BASE * sizeof(MetadataItem));
+            if (!column->metadata) {
+                free(merged);
+                free_metadata_view(view);
+                return NULL;
+            }
+            column->metadata_count = export_base_metadata_items(merged, column->metadata);
+        }
+        free(merged);
+    }
+
+    return view;
+}
+
+/**
+ * Save metadata to a file
+ *
+ * The metadata is written as JSON with json_serialization_save_to_binary: the
+ * file-level items, each row group's aggregates and Bloom filters, and each
+ * column's aggregates merged across the row groups.
+ *
+ * metadata: File metadata generated by metadata_generator_generate
+ * file_path: Path where the metadata will be saved
+ * returns: Error code (METADATA_GEN_OK on success)
+ */
+MetadataGeneratorError metadata_generator_save_metadata(
+    const Metadata* metadata,
+    const char* file_path
+) {
+    if (!metadata || !file_path) {
+        return METADATA_GEN_INVALID_PARAMETER;
+    }
+
+    // Cast to extended metadata
+    const struct ExtendedMetadata* ext_metadata = (const struct ExtendedMetadata*)metadata;
+    if (ext_metadata->type != METADATA_TYPE_FILE) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Only file-level metadata can be saved");
+        return METADATA_GEN_INVALID_PARAMETER;
+    }
+
+    Metadata* view = create_metadata_view(ext_metadata);
+    if (!view) {
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate memory for the metadata to save");
+        return METADATA_GEN_MEMORY_ERROR;
+    }
+
+    JsonSerializationError error = json_serialization_save_to_binary(view, file_path);
+    free_metadata_view(view);
+
+    if (error != JSON_SERIALIZATION_OK) {
+        const char* message = json_serialization_get_error();
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to save metadata to %s: %s", file_path, message ? message : "unknown error");
+        return error == JSON_SERIALIZATION_MEMORY_ERROR ? METADATA_GEN_MEMORY_ERROR : METADATA_GEN_FILE_ERROR;
+    }
+
     return METADATA_GEN_OK;
 }
 
 /**
  * Load metadata from a file
- * 
- * This function loads metadata from a binary file created
- * with metadata_generator_save_metadata.
- * 
+ *
+ * This function loads metadata saved with metadata_generator_save_metadata.
+ * The loaded metadata is a plain Metadata tree, released with metadata_release.
+ *
  * file_path: Path to the metadata file
  * metadata: Pointer to store the loaded metadata
  * returns: Error code (METADATA_GEN_OK on success)
@@ -1476,53 +2631,16 @@ MetadataGeneratorError metadata_generator_load_metadata(
     if (!file_path || !metadata) {
         return METADATA_GEN_INVALID_PARAMETER;
     }
-    
-    // Open the input file
-    FILE* file = fopen(file_path, "rb");
-    if (!file) {
-        snprintf(s_error_message, sizeof(s_error_message), 
-                "Failed to open input file: %s", file_path);
-        return METADATA_GEN_FILE_ERROR;
-    }
-    
-    // Allocate memory for the metadata
-    struct ExtendedMetadata* ext_metadata = (struct ExtendedMetadata*)malloc(sizeof(struct ExtendedMetadata));
-    if (!ext_metadata) {
-        fclose(file);
-        snprintf(s_error_message, sizeof(s_error_message), 
-                "Failed to allocate memory for metadata");
-        return METADATA_GEN_MEMORY_ERROR;
-    }
-    
-    // Clear the metadata structure
-    memset(ext_metadata, 0, sizeof(struct ExtendedMetadata));
-    
-    // Read header information
-    if (fread(&ext_metadata->type, sizeof(int), 1, file) != 1 ||
-        fread(&ext_metadata->id, sizeof(int), 1, file) != 1 ||
-        fread(ext_metadata->name, sizeof(char), MAX_METADATA_STRING_LENGTH, file) != MAX_METADATA_STRING_LENGTH) {
-        free(ext_metadata);
-        fclose(file);
-        snprintf(s_error_message, sizeof(s_error_message), 
-                "Failed to read metadata header");
-        return METADATA_GEN_FILE_ERROR;
-    }
-    
-    // Read child count
-    if (fread(&ext_metadata->child_count, sizeof(int), 1, file) != 1) {
-        free(ext_metadata);
-        fclose(file);
-        snprintf(s_error_message, sizeof(s_error_message), 
-                "Failed to read metadata child count");
-        return METADATA_GEN_FILE_ERROR;
+
+    JsonSerializationError error = json_serialization_load_from_binary(file_path, metadata);
+    if (error != JSON_SERIALIZATION_OK) {
+        const char* message = json_serialization_get_error();
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to load metadata from %s: %s", file_path, message ? message : "unknown error");
+        *metadata = NULL;
+        return error == JSON_SERIALIZATION_MEMORY_ERROR ? METADATA_GEN_MEMORY_ERROR : METADATA_GEN_FILE_ERROR;
     }
-    
-    // In a real implementation, we would recursively deserialize all child metadata
-    // and custom metadata as well
-    
-    fclose(file);
-    
-    *metadata = (Metadata*)ext_metadata;
+
     return METADATA_GEN_OK;
 }
 
@@ -1530,7 +2648,8 @@ MetadataGeneratorError metadata_generator_load_metadata(
  * Get the last error message from the metadata generator
  * 
  * This function returns a string describing the last error that occurred.
- * The returned string is valid until the next call to any metadata generator function.
+ * The returned string is valid until the next call to any metadata generator function
+ * on the same thread.
  * 
  * returns: A string describing the last error, or NULL if no error occurred
  */
@@ -1656,6 +2775,15 @@ void metadata_release(Metadata* metadata) {
                 free(row_group->columns);
                 row_group->columns = NULL;
             }
+            
+            // Free the Bloom filters
+            if (row_group->bloom_filters) {
+                for (uint32_t j = 0; j < row_group->bloom_filter_count; j++) {
+                    bloom_filter_free(&row_group->bloom_filters[j].filter);
+                }
+                free(row_group->bloom_filters);
+                row_group->bloom_filters = NULL;
+            }
         }
         free(metadata->row_group_metadata);
         metadata->row_group_metadata = NULL;
@@ -1732,6 +2860,7 @@ MetadataItem* addBasicFileMetadataItem(Metadata* metadata, const char* name, Met
             item->value.timestamp.count = 0;
             item->value.timestamp.min_timestamp = 0;
             item->value.timestamp.max_timestamp = 0;
+            item->value.timestamp.from_footer = false;
             item->timestamp_value = 0;
             break;
             
@@ -1749,6 +2878,7 @@ MetadataItem* addBasicFileMetadataItem(Metadata* metadata, const char* name, Met
             item->value.numeric.mode_value = 0.0;
             item->value.numeric.mode_count = 0;
             item->value.numeric.total_count = 0;
+            item->value.numeric.from_footer = false;
             item->numeric_value = 0.0;
             break;
             
@@ -2379,10 +3509,7 @@ Metadata* metadata_generator_generate_file_metadata(
         uint64_t string_count;
         
         // String frequency tracking
-        struct {
-            char string[MAX_STRING_LENGTH];
-            uint32_t count;
-        } high_freq_strings[MAX_HIGH_FREQ_STRINGS];
+        HighFreqString high_freq_strings[MAX_HIGH_FREQ_STRINGS];
         uint32_t high_freq_string_count;
         
         // For all types
@@ -2612,20 +3739,9 @@ Metadata* metadata_generator_generate_file_metadata(
                             // Bubble up if this string now has a higher count than strings before it
                             while (j > 0 && count > agg_column_metadata[col_index].high_freq_strings[j-1].count) {
                                 // Swap with previous entry
-                                char temp_str[MAX_STRING_LENGTH];
-                                uint32_t temp_count = agg_column_metadata[col_index].high_freq_strings[j-1].count;
-                                
-                                strncpy(temp_str, agg_column_metadata[col_index].high_freq_strings[j-1].string, MAX_STRING_LENGTH-1);
-                                temp_str[MAX_STRING_LENGTH-1] = '\0';
-                                
-                                strncpy(agg_column_metadata[col_index].high_freq_strings[j-1].string, 
-                                        agg_column_metadata[col_index].high_freq_strings[j].string, MAX_STRING_LENGTH-1);
-                                agg_column_metadata[col_index].high_freq_strings[j-1].string[MAX_STRING_LENGTH-1] = '\0';
-                                agg_column_metadata[col_index].high_freq_strings[j-1].count = count;
-                                
-                                strncpy(agg_column_metadata[col_index].high_freq_strings[j].string, temp_str, MAX_STRING_LENGTH-1);
-                                agg_column_metadata[col_index].high_freq_strings[j].string[MAX_STRING_LENGTH-1] = '\0';
-                                agg_column_metadata[col_index].high_freq_strings[j].count = temp_count;
+                                HighFreqString temp = agg_column_metadata[col_index].high_freq_strings[j-1];
+                                agg_column_metadata[col_index].high_freq_strings[j-1] = agg_column_metadata[col_index].high_freq_strings[j];
+                                agg_column_metadata[col_index].high_freq_strings[j] = temp;
                                 
                                 j--;
                             }
@@ -2634,30 +3750,16 @@ Metadata* metadata_generator_generate_file_metadata(
                         // If not found and we have space, add it
                         if (!found && agg_column_metadata[col_index].high_freq_string_count < MAX_HIGH_FREQ_STRINGS) {
                             uint32_t idx = agg_column_metadata[col_index].high_freq_string_count++;
-                            strncpy(agg_column_metadata[col_index].high_freq_strings[idx].string, 
-                                    curr_string, MAX_STRING_LENGTH - 1);
-                            agg_column_metadata[col_index].high_freq_strings[idx].string[MAX_STRING_LENGTH - 1] = '\0';
+                            snprintf(agg_column_metadata[col_index].high_freq_strings[idx].string, MAX_STRING_LENGTH, "%s", curr_string);
                             agg_column_metadata[col_index].high_freq_strings[idx].count = curr_count;
                             
                             // Insert sort to maintain order by count
                             while (idx > 0 && agg_column_metadata[col_index].high_freq_strings[idx].count > 
                                   agg_column_metadata[col_index].high_freq_strings[idx-1].count) {
                                 // Swap with previous entry
-                                char temp_str[MAX_STRING_LENGTH];
-                                uint32_t temp_count = agg_column_metadata[col_index].high_freq_strings[idx-1].count;
-                                
-                                strncpy(temp_str, agg_column_metadata[col_index].high_freq_strings[idx-1].string, MAX_STRING_LENGTH-1);
-                                temp_str[MAX_STRING_LENGTH-1] = '\0';
-                                
-                                strncpy(agg_column_metadata[col_index].high_freq_strings[idx-1].string, 
-                                        agg_column_metadata[col_index].high_freq_strings[idx].string, MAX_STRING_LENGTH-1);
-                                agg_column_metadata[col_index].high_freq_strings[idx-1].string[MAX_STRING_LENGTH-1] = '\0';
-                                agg_column_metadata[col_index].high_freq_strings[idx-1].count = 
-                                    agg_column_metadata[col_index].high_freq_strings[idx].count;
-                                
-                                strncpy(agg_column_metadata[col_index].high_freq_strings[idx].string, temp_str, MAX_STRING_LENGTH-1);
-                                agg_column_metadata[col_index].high_freq_strings[idx].string[MAX_STRING_LENGTH-1] = '\0';
-                                agg_column_metadata[col_index].high_freq_strings[idx].count = temp_count;
+                                HighFreqString temp = agg_column_metadata[col_index].high_freq_strings[idx-1];
+                                agg_column_metadata[col_index].high_freq_strings[idx-1] = agg_column_metadata[col_index].high_freq_strings[idx];
+                                agg_column_metadata[col_index].high_freq_strings[idx] = temp;
                                 
                                 idx--;
                             }
@@ -2677,9 +3779,7 @@ Metadata* metadata_generator_generate_file_metadata(
                             
                             // Replace if this string has a higher count
                             if (curr_count > min_count) {
-                                strncpy(agg_column_metadata[col_index].high_freq_strings[min_idx].string, 
-                                        curr_string, MAX_STRING_LENGTH - 1);
-                                agg_column_metadata[col_index].high_freq_strings[min_idx].string[MAX_STRING_LENGTH - 1] = '\0';
+                                snprintf(agg_column_metadata[col_index].high_freq_strings[min_idx].string, MAX_STRING_LENGTH, "%s", curr_string);
                                 agg_column_metadata[col_index].high_freq_strings[min_idx].count = curr_count;
                                 
                                 // Resort the array to maintain order by frequency
@@ -2688,21 +3788,9 @@ Metadata* metadata_generator_generate_file_metadata(
                                         if (agg_column_metadata[col_index].high_freq_strings[k].count < 
                                             agg_column_metadata[col_index].high_freq_strings[k + 1].count) {
                                             // Swap
-                                            char temp_str[MAX_STRING_LENGTH];
-                                            uint32_t temp_count = agg_column_metadata[col_index].high_freq_strings[k].count;
-                                            
-                                            strncpy(temp_str, agg_column_metadata[col_index].high_freq_strings[k].string, MAX_STRING_LENGTH-1);
-                                            temp_str[MAX_STRING_LENGTH-1] = '\0';
-                                            
-                                            strncpy(agg_column_metadata[col_index].high_freq_strings[k].string, 
-                                                    agg_column_metadata[col_index].high_freq_strings[k+1].string, MAX_STRING_LENGTH-1);
-                                            agg_column_metadata[col_index].high_freq_strings[k].string[MAX_STRING_LENGTH-1] = '\0';
-                                            agg_column_metadata[col_index].high_freq_strings[k].count = 
-                                                agg_column_metadata[col_index].high_freq_strings[k+1].count;
-                                            
-                                            strncpy(agg_column_metadata[col_index].high_freq_strings[k+1].string, temp_str, MAX_STRING_LENGTH-1);
-                                            agg_column_metadata[col_index].high_freq_strings[k+1].string[MAX_STRING_LENGTH-1] = '\0';
-                                            agg_column_metadata[col_index].high_freq_strings[k+1].count = temp_count;
+                                            HighFreqString temp = agg_column_metadata[col_index].high_freq_strings[k];
+                                            agg_column_metadata[col_index].high_freq_strings[k] = agg_column_metadata[col_index].high_freq_strings[k+1];
+                                            agg_column_metadata[col_index].high_freq_strings[k+1] = temp;
                                         }
                                     }
                                 }
@@ -2822,26 +3910,9 @@ Metadata* metadata_generator_generate_file_metadata(
                     if (agg_column_metadata[i].high_freq_strings[k].count > 
                         agg_column_metadata[i].high_freq_strings[j].count) {
                         // Swap if the current count is less than the next count
-                        struct {
-                            char string[MAX_STRING_LENGTH];
-                            uint32_t count;
-                        } temp;
-                        
-                        // Copy data from j to temp
-                        strncpy(temp.string, agg_column_metadata[i].high_freq_strings[j].string, MAX_STRING_LENGTH - 1);
-                        temp.string[MAX_STRING_LENGTH - 1] = '\0';
-                        temp.count = agg_column_metadata[i].high_freq_strings[j].count;
-                        
-                        // Copy data from k to j
-                        strncpy(agg_column_metadata[i].high_freq_strings[j].string, 
-                                agg_column_metadata[i].high_freq_strings[k].string, MAX_STRING_LENGTH - 1);
-                        agg_column_metadata[i].high_freq_strings[j].string[MAX_STRING_LENGTH - 1] = '\0';
-                        agg_column_metadata[i].high_freq_strings[j].count = agg_column_metadata[i].high_freq_strings[k].count;
-                        
-                        // Copy data from temp to k
-                        strncpy(agg_column_metadata[i].high_freq_strings[k].string, temp.string, MAX_STRING_LENGTH - 1);
-                        agg_column_metadata[i].high_freq_strings[k].string[MAX_STRING_LENGTH - 1] = '\0';
-                        agg_column_metadata[i].high_freq_strings[k].count = temp.count;
+                        HighFreqString temp = agg_column_metadata[i].high_freq_strings[j];
+                        agg_column_metadata[i].high_freq_strings[j] = agg_column_metadata[i].high_freq_strings[k];
+                        agg_column_metadata[i].high_freq_strings[k] = temp;
                     }
                 }
             }
@@ -3071,7 +4142,8 @@ Metadata* metadata_generator_generate_row_group_metadata(
 {
     // Validate parameters
     if (!file || row_group_id < 0 || row_group_id >= file->row_group_count) {
-        set_error("Invalid parameters for row group metadata generation");
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Invalid parameters for row group metadata generation");
         return NULL;
     }
     
@@ -3081,7 +4153,8 @@ Metadata* metadata_generator_generate_row_group_metadata(
     // Initialize metadata structure
     Metadata* metadata = (Metadata*)calloc(1, sizeof(Metadata));
     if (!metadata) {
-        set_error("Failed to allocate memory for row group metadata");
+        snprintf(s_error_message, sizeof(s_error_message),
+                "Failed to allocate memory for row group metadata");
         return NULL;
     }
     
@@ -3090,7 +4163,8 @@ Metadata* metadata_generator_generate_row_group_metadata(
         metadata->file_path = strdup(file->file_path);
         if (!metadata->file_path) {
             free(metadata);
-            set_error("Failed to allocate memory for file path");
+            snprintf(s_error_message, sizeof(s_error_message),
+                    "Failed to allocate memory for file path");
             return NULL;
         }
     }
@@ -19,7 +19,7 @@ using json = nlohmann::json;
 extern "C" void releaseMetadata(Metadata* metadata);
 
 /* Static error message buffer */
-static char g_error_message[256] = {0};
+static thread_local char g_error_message[256] = {0};
 
 /**
  * Returns the last error message
@@ -28,6 +28,41 @@ const char* metadata_parser_get_error_message() {
     return g_error_message[0] != '\0' ? g_error_message : NULL;
 }
 
+/**
+ * Serializes a quantile digest to a JSON object
+ */
+static json serializeQuantileSketch(const QuantileSketch* sketch) {
+    json centroids = json::array();
+    for (uint32_t i = 0; i < sketch->centroid_count; i++) {
+        centroids.push_back(json::array({sketch->centroids[i].mean, sketch->centroids[i].weight}));
+    }
+    return json{
+        {"count", sketch->count},
+        {"min", sketch->min},
+        {"max", sketch->max},
+        {"centroids", centroids}
+    };
+}
+
+/**
+ * Deserializes a quantile digest from a JSON object
+ */
+static void deserializeQuantileSketch(const json& j, QuantileSketch* sketch) {
+    quantile_sketch_init(sketch);
+    const json& centroids = j["centroids"];
+    if (centroids.size() > QUANTILE_SKETCH_MAX_CENTROIDS) {
+        throw std::runtime_error("too many quantile centroids");
+    }
+    sketch->count = j["count"].get<uint64_t>();
+    sketch->min = j["min"].get<double>();
+    sketch->max = j["max"].get<double>();
+    for (size_t i = 0; i < centroids.size(); i++) {
+        sketch->centroids[i].mean = centroids[i][0].get<double>();
+        sketch->centroids[i].weight = centroids[i][1].get<uint64_t>();
+    }
+    sketch->centroid_count = (uint32_t)centroids.size();
+}
+
 /**
  * Serializes a timestamp metadata item to a JSON object
  */
@@ -35,6 +70,16 @@ static void serializeTimestampMetadata(json& j, const TimestampMetadata* metadat
     j["min_timestamp"] = metadata->min_timestamp;
     j["max_timestamp"] = metadata->max_timestamp;
     j["count"] = metadata->count;
+    
+    // Percentiles of timestamps known only from footer statistics are unavailable
+    if (metadata->from_footer) {
+        j["from_footer"] = true;
+    } else {
+        j["p50"] = metadata->p50;
+        j["p95"] = metadata->p95;
+        j["p99"] = metadata->p99;
+    }
+    j["quantile_sketch"] = serializeQuantileSketch(&metadata->quantiles);
 }
 
 /**
@@ -46,6 +91,9 @@ static void serializeStringMetadata(json& j, const StringMetadata* metadata) {
         json str_item;
         str_item["string"] = metadata->high_freq_strings[i].string;
         str_item["count"] = metadata->high_freq_strings[i].count;
+        if (metadata->is_sampled) {
+            str_item["count_error"] = metadata->sample_errors[i];
+        }
         high_freq_array.push_back(str_item);
     }
     j["high_freq_strings"] = high_freq_array;
@@ -55,12 +103,21 @@ static void serializeStringMetadata(json& j, const StringMetadata* metadata) {
         json str_item;
         str_item["string"] = metadata->special_strings[i];
         str_item["count"] = metadata->special_string_counts[i];
+        if (metadata->is_sampled) {
+            str_item["count_error"] = metadata->special_string_errors[i];
+        }
         special_array.push_back(str_item);
     }
     j["special_strings"] = special_array;
     
     j["total_count"] = metadata->total_string_count;
     j["avg_length"] = metadata->avg_string_length;
+    
+    // Counts estimated from a row sample are marked with the rate
+    if (metadata->is_sampled) {
+        j["sampled"] = true;
+        j["sample_rate"] = metadata->sample_rate;
+    }
 }
 
 /**
@@ -69,11 +126,28 @@ static void serializeStringMetadata(json& j, const StringMetadata* metadata) {
 static void serializeNumericMetadata(json& j, const NumericMetadata* metadata) {
     j["min_value"] = metadata->min_value;
     j["max_value"] = metadata->max_value;
+    j["total_count"] = metadata->total_count;
+    j["null_count"] = metadata->null_count;
+    j["quantile_sketch"] = serializeQuantileSketch(&metadata->quantiles);
+    
+    // Values known only from footer statistics leave mean, mode and percentiles unavailable
+    if (metadata->from_footer) {
+        j["from_footer"] = true;
+        return;
+    }
     j["avg_value"] = metadata->avg_value;
     j["mode_value"] = metadata->mode_value;
     j["mode_count"] = metadata->mode_count;
-    j["total_count"] = metadata->total_count;
-    j["null_count"] = metadata->null_count;
+    j["p50"] = metadata->p50;
+    j["p95"] = metadata->p95;
+    j["p99"] = metadata->p99;
+    
+    // A mode estimated from a row sample is marked with the rate and its error bound
+    if (metadata->mode_is_sampled) {
+        j["mode_sampled"] = true;
+        j["mode_sample_rate"] = metadata->mode_sample_rate;
+        j["mode_count_error"] = metadata->mode_count_error;
+    }
 }
 
 /**
@@ -91,6 +165,11 @@ static void serializeCategoricalMetadata(json& j, const CategoricalMetadata* met
     
     j["total_category_count"] = metadata->total_category_count;
     j["total_value_count"] = metadata->total_value_count;
+    
+    char sketch_text[HYPERLOGLOG_ENCODED_SIZE];
+    hyperloglog_encode(&metadata->distinct_sketch, sketch_text, sizeof(sketch_text));
+    j["distinct_count"] = metadata->distinct_count;
+    j["distinct_sketch"] = sketch_text;
 }
 
 /**
@@ -178,6 +257,20 @@ static void serializeRowGroupMetadata(json& j, const RowGroupMetadata* metadata)
         items_array.push_back(item_obj);
     }
     j["metadata_items"] = items_array;
+    
+    json filters_array = json::array();
+    for (uint32_t i = 0; i < metadata->bloom_filter_count; i++) {
+        const ColumnBloomFilter* bloom = &metadata->bloom_filters[i];
+        std::string blocks(bloom_filter_encoded_size(&bloom->filter), '\0');
+        blocks.resize(bloom_filter_encode(&bloom->filter, &blocks[0], blocks.size()));
+        filters_array.push_back({
+            {"column_index", bloom->column_index},
+            {"column_name", bloom->column_name},
+            {"value_type", static_cast<int>(bloom->value_type)},
+            {"blocks", blocks}
+        });
+    }
+    j["bloom_filters"] = filters_array;
 }
 
 /**
@@ -204,6 +297,17 @@ static bool deserializeTimestampMetadata(const json& j, TimestampMetadata* metad
         metadata->min_timestamp = j["min_timestamp"].get<time_t>();
         metadata->max_timestamp = j["max_timestamp"].get<time_t>();
         metadata->count = j["count"].get<uint64_t>();
+        metadata->from_footer = j.value("from_footer", false);
+        
+        // Percentiles and digest (absent from metadata written before they existed,
+        // or of timestamps known only from footer statistics)
+        metadata->p50 = j.value("p50", (time_t)0);
+        metadata->p95 = j.value("p95", (time_t)0);
+        metadata->p99 = j.value("p99", (time_t)0);
+        quantile_sketch_init(&metadata->quantiles);
+        if (j.contains("quantile_sketch")) {
+            deserializeQuantileSketch(j["quantile_sketch"], &metadata->quantiles);
+        }
         return true;
     } catch (const std::exception& e) {
         snprintf(g_error_message, sizeof(g_error_message), 
@@ -229,6 +333,7 @@ static bool deserializeStringMetadata(const json& j, StringMetadata* metadata) {
             metadata->high_freq_strings[i].string[MAX_STRING_LENGTH - 1] = '\0';
             metadata->high_freq_counts[i] = high_freq[i]["count"].get<uint32_t>();
             metadata->high_freq_strings[i].count = high_freq[i]["count"].get<uint32_t>();
+            metadata->sample_errors[i] = high_freq[i].value("count_error", (uint64_t)0);
         }
         metadata->high_freq_count = (high_freq.size() > MAX_HIGH_FREQ_STRINGS) ? 
                                    MAX_HIGH_FREQ_STRINGS : high_freq.size();
@@ -241,6 +346,7 @@ static bool deserializeStringMetadata(const json& j, StringMetadata* metadata) {
                    MAX_STRING_LENGTH - 1);
             metadata->special_strings[i][MAX_STRING_LENGTH - 1] = '\0';
             metadata->special_string_counts[i] = special[i]["count"].get<uint32_t>();
+            metadata->special_string_errors[i] = special[i].value("count_error", 0u);
         }
         metadata->special_string_count = (special.size() > MAX_SPECIAL_STRINGS) ? 
                                         MAX_SPECIAL_STRINGS : special.size();
@@ -249,6 +355,10 @@ static bool deserializeStringMetadata(const json& j, StringMetadata* metadata) {
         metadata->total_string_count = j["total_count"].get<uint64_t>();
         metadata->avg_string_length = j["avg_length"].get<uint32_t>();
         
+        // Sampling marks (present only when the counts were estimated from a row sample)
+        metadata->is_sampled = j.value("sampled", false);
+        metadata->sample_rate = j.value("sample_rate", 1.0);
+        
         return true;
     } catch (const std::exception& e) {
         snprintf(g_error_message, sizeof(g_error_message), 
@@ -264,11 +374,34 @@ static bool deserializeNumericMetadata(const json& j, NumericMetadata* metadata)
     try {
         metadata->min_value = j["min_value"].get<double>();
         metadata->max_value = j["max_value"].get<double>();
-        metadata->avg_value = j["avg_value"].get<double>();
-        metadata->mode_value = j["mode_value"].get<double>();
-        metadata->mode_count = j["mode_count"].get<uint64_t>();
         metadata->total_count = j["total_count"].get<uint64_t>();
         metadata->null_count = j["null_count"].get<uint32_t>();
+        
+        // Mean and mode (absent when the values are known only from footer statistics)
+        metadata->from_footer = j.value("from_footer", false);
+        if (metadata->from_footer) {
+            metadata->avg_value = metadata->mode_value = 0.0;
+            metadata->mode_count = 0;
+        } else {
+            metadata->avg_value = j["avg_value"].get<double>();
+            metadata->mode_value = j["mode_value"].get<double>();
+            metadata->mode_count = j["mode_count"].get<uint64_t>();
+        }
+        
+        // Percentiles and digest (absent from metadata written before they existed,
+        // or of values known only from footer statistics)
+        metadata->p50 = j.value("p50", 0.0);
+        metadata->p95 = j.value("p95", 0.0);
+        metadata->p99 = j.value("p99", 0.0);
+        quantile_sketch_init(&metadata->quantiles);
+        if (j.contains("quantile_sketch")) {
+            deserializeQuantileSketch(j["quantile_sketch"], &metadata->quantiles);
+        }
+        
+        // Sampling marks (present only when the mode was estimated from a row sample)
+        metadata->mode_is_sampled = j.value("mode_sampled", false);
+        metadata->mode_sample_rate = j.value("mode_sample_rate", 1.0);
+        metadata->mode_count_error = j.value("mode_count_error", (uint64_t)0);
         return true;
     } catch (const std::exception& e) {
         snprintf(g_error_message, sizeof(g_error_message), 
@@ -301,6 +434,18 @@ static bool deserializeCategoricalMetadata(const json& j, CategoricalMetadata* m
         metadata->total_category_count = j["total_category_count"].get<uint32_t>();
         metadata->total_value_count = j["total_value_count"].get<uint64_t>();
         
+        // Distinct-value sketch (absent from metadata written before it existed)
+        if (j.contains("distinct_sketch") &&
+            hyperloglog_decode(&metadata->distinct_sketch,
+                               j["distinct_sketch"].get<std::string>().c_str()) != 0) {
+            snprintf(g_error_message, sizeof(g_error_message),
+                    "Error parsing categorical metadata: invalid distinct_sketch");
+            return false;
+        }
+        metadata->distinct_count = j.contains("distinct_count") ?
+                                   j["distinct_count"].get<uint64_t>() :
+                                   hyperloglog_estimate(&metadata->distinct_sketch);
+        
         return true;
     } catch (const std::exception& e) {
         snprintf(g_error_message, sizeof(g_error_message), 
@@ -481,6 +626,31 @@ static bool deserializeRowGroupMetadata(const json& j, RowGroupMetadata* metadat
             metadata->metadata_count = items.size();
         }
         
+        // Parse Bloom filters (absent from metadata written before they existed)
+        if (j.contains("bloom_filters") && j["bloom_filters"].size() > 0) {
+            const json& filters = j["bloom_filters"];
+            metadata->bloom_filters = (ColumnBloomFilter*)calloc(filters.size(), sizeof(ColumnBloomFilter));
+            if (!metadata->bloom_filters) {
+                snprintf(g_error_message, sizeof(g_error_message), 
+                        "Failed to allocate memory for row group Bloom filters");
+                return false;
+            }
+            
+            for (size_t i = 0; i < filters.size(); i++) {
+                ColumnBloomFilter* bloom = &metadata->bloom_filters[i];
+                bloom->column_index = filters[i]["column_index"].get<uint32_t>();
+                strncpy(bloom->column_name, filters[i]["column_name"].get<std::string>().c_str(),
+                       MAX_METADATA_ITEM_NAME_LENGTH - 1);
+                bloom->value_type = static_cast<ParquetValueType>(filters[i]["value_type"].get<int>());
+                if (bloom_filter_decode(&bloom->filter, filters[i]["blocks"].get<std::string>().c_str()) != 0) {
+                    snprintf(g_error_message, sizeof(g_error_message),
+                            "Error parsing row group metadata: invalid Bloom filter");
+                    return false;
+                }
+                metadata->bloom_filter_count = i + 1;
+            }
+        }
+        
         return true;
     } catch (const std::exception& e) {
         snprintf(g_error_message, sizeof(g_error_message), 
@@ -0,0 +1,323 @@
+/**
+ * quantile_sketch.c
+ *
+ * This file implements the merging t-digest declared in quantile_sketch.h,
+ * after Dunning, "Computing extremely accurate quantiles using t-digests".
+ * New values are sorted in blocks and merged with the centroids; adjacent
+ * centroids are then combined as long as the combined centroid spans at
+ * most one unit of the scale function k(q) = d / (2 pi) * asin(2q - 1),
+ * which keeps centroids small near the tails, where p95 and p99 live.
+ *
+ * Since any two adjacent centroids span more than one unit and k spans d / 2
+ * units, a digest of compression d holds at most d + 2 centroids.
+ */
+
+#include "metadata/quantile_sketch.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Values sorted and merged into the centroids at once */
+#define BLOCK_VALUES 8192
+
+#define PI 3.14159265358979323846
+
+/* Scale function k(q) and its inverse */
+static double scale(double q) {
+    return QUANTILE_SKETCH_COMPRESSION / (2.0 * PI) * asin(2.0 * q - 1.0);
+}
+
+static double scale_inverse(double k) {
+    if (k >= QUANTILE_SKETCH_COMPRESSION / 4.0) {
+        return 1.0;
+    }
+    return (sin(k * 2.0 * PI / QUANTILE_SKETCH_COMPRESSION) + 1.0) / 2.0;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Convert a block of values into doubles
+ *
+ * returns: Number of values written; NaN values produce none
+ */
+static uint32_t load_values(const void* values, uint64_t first, uint32_t count,
+                            ParquetValueType type, double* out) {
+    uint32_t written = 0;
+    switch (type) {
+        case PARQUET_BOOLEAN: {
+            const bool* data = (const bool*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                out[written++] = data[i] ? 1.0 : 0.0;
+            }
+            break;
+        }
+        case PARQUET_INT32: {
+            const int32_t* data = (const int32_t*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                out[written++] = (double)data[i];
+            }
+            break;
+        }
+        case PARQUET_INT64: {
+            const int64_t* data = (const int64_t*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                out[written++] = (double)data[i];
+            }
+            break;
+        }
+        case PARQUET_FLOAT: {
+            const float* data = (const float*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!isnan(data[i])) {
+                    out[written++] = (double)data[i];
+                }
+            }
+            break;
+        }
+        case PARQUET_DOUBLE: {
+            const double* data = (const double*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!isnan(data[i])) {
+                    out[written++] = data[i];
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return written;
+}
+
+/**
+ * Replace the centroids of a digest by the compression of sorted centroids
+ *
+ * sketch: The digest
+ * sorted: Centroids in increasing mean order, the digest's own among them
+ * count: Number of centroids (at least one)
+ * total: Sum of their weights
+ */
+static void compress(QuantileSketch* sketch, const QuantileCentroid* sorted, uint32_t count, uint64_t total) {
+    uint32_t out = 0;
+    QuantileCentroid current = sorted[0];
+    uint64_t weight_before = 0;
+    double limit = (double)total * scale_inverse(scale(0.0) + 1.0);
+
+    for (uint32_t i = 1; i <= count; i++) {
+        if (i < count && (double)(weight_before + current.weight + sorted[i].weight) <= limit) {
+            current.weight += sorted[i].weight;
+            current.mean += (sorted[i].mean - current.mean) * ((double)sorted[i].weight / (double)current.weight);
+            continue;
+        }
+
+        if (out < QUANTILE_SKETCH_MAX_CENTROIDS) {
+            sketch->centroids[out++] = current;
+        } else {
+            // Unreachable by the bound above; fold into the last centroid rather than overflow
+            QuantileCentroid* last = &sketch->centroids[out - 1];
+            last->weight += current.weight;
+            last->mean += (current.mean - last->mean) * ((double)current.weight / (double)last->weight);
+        }
+        if (i < count) {
+            weight_before += current.weight;
+            limit = (double)total * scale_inverse(scale((double)weight_before / (double)total) + 1.0);
+            current = sorted[i];
+        }
+    }
+    sketch->centroid_count = out;
+}
+
+/* Weighted average of two values, kept between them despite rounding */
+static double weighted_average(double x1, double w1, double x2, double w2) {
+    double low = x1 < x2 ? x1 : x2;
+    double high = x1 < x2 ? x2 : x1;
+    double average = (x1 * w1 + x2 * w2) / (w1 + w2);
+    return average < low ? low : average > high ? high : average;
+}
+
+/**
+ * Initialize an empty digest
+ */
+void quantile_sketch_init(QuantileSketch* sketch) {
+    if (sketch) {
+        memset(sketch, 0, sizeof(QuantileSketch));
+    }
+}
+
+/**
+ * Add an array of values
+ */
+int quantile_sketch_add_values(QuantileSketch* sketch, const void* values, uint64_t value_count,
+                               ParquetValueType type) {
+    if (!sketch || (!values && value_count > 0)) {
+        return 1;
+    }
+    if (type != PARQUET_BOOLEAN && type != PARQUET_INT32 && type != PARQUET_INT64 &&
+        type != PARQUET_FLOAT && type != PARQUET_DOUBLE) {
+        return 1;
+    }
+    if (value_count == 0) {
+        return 0;
+    }
+
+    uint32_t block = value_count < BLOCK_VALUES ? (uint32_t)value_count : BLOCK_VALUES;
+    double* buffer = (double*)malloc(block * sizeof(double));
+    QuantileCentroid* work = (QuantileCentroid*)malloc((block + QUANTILE_SKETCH_MAX_CENTROIDS) * sizeof(QuantileCentroid));
+    if (!buffer || !work) {
+        free(buffer);
+        free(work);
+        return 2;
+    }
+
+    for (uint64_t first = 0; first < value_count; first += block) {
+        uint32_t count = value_count - first < block ? (uint32_t)(value_count - first) : block;
+        uint32_t loaded = load_values(values, first, count, type, buffer);
+        if (loaded == 0) {
+            continue;
+        }
+        qsort(buffer, loaded, sizeof(double), compare_doubles);
+
+        if (sketch->count == 0 || buffer[0] < sketch->min) {
+            sketch->min = buffer[0];
+        }
+        if (sketch->count == 0 || buffer[loaded - 1] > sketch->max) {
+            sketch->max = buffer[loaded - 1];
+        }
+
+        // Merge the sorted block with the centroids
+        uint32_t merged = 0;
+        uint32_t c = 0;
+        uint32_t v = 0;
+        while (c < sketch->centroid_count || v < loaded) {
+            if (v == loaded || (c < sketch->centroid_count && sketch->centroids[c].mean <= buffer[v])) {
+                work[merged++] = sketch->centroids[c++];
+            } else {
+                work[merged].mean = buffer[v++];
+                work[merged++].weight = 1;
+            }
+        }
+        sketch->count += loaded;
+        compress(sketch, work, merged, sketch->count);
+    }
+
+    free(buffer);
+    free(work);
+    return 0;
+}
+
+/**
+ * Merge another digest into a digest
+ */
+void quantile_sketch_merge(QuantileSketch* sketch, const QuantileSketch* other) {
+    if (!sketch || !other || other->count == 0) {
+        return;
+    }
+    if (sketch->count == 0) {
+        *sketch = *other;
+        return;
+    }
+
+    QuantileCentroid work[2 * QUANTILE_SKETCH_MAX_CENTROIDS];
+    uint32_t merged = 0;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    while (a < sketch->centroid_count || b < other->centroid_count) {
+        if (b == other->centroid_count ||
+            (a < sketch->centroid_count && sketch->centroids[a].mean <= other->centroids[b].mean)) {
+            work[merged++] = sketch->centroids[a++];
+        } else {
+            work[merged++] = other->centroids[b++];
+        }
+    }
+
+    sketch->min = other->min < sketch->min ? other->min : sketch->min;
+    sketch->max = other->max > sketch->max ? other->max : sketch->max;
+    sketch->count += other->count;
+    compress(sketch, work, merged, sketch->count);
+}
+
+/**
+ * Estimate a quantile
+ *
+ * Each centroid's weight is spread around its mean, half below and half
+ * above, and the estimate interpolates between the two centroids whose
+ * centers bracket the requested rank; centroids of weight 1 are exact
+ * values and are never interpolated into.
+ */
+double quantile_sketch_quantile(const QuantileSketch* sketch, double q) {
+    if (!sketch || sketch->count == 0 || sketch->centroid_count == 0 || isnan(q)) {
+        return NAN;
+    }
+    if (q <= 0.0) {
+        return sketch->min;
+    }
+    if (q >= 1.0) {
+        return sketch->max;
+    }
+
+    const QuantileCentroid* centroids = sketch->centroids;
+    uint32_t n = sketch->centroid_count;
+    double total = (double)sketch->count;
+    double index = q * total;
+
+    if (n == 1) {
+        return weighted_average(sketch->min, total - index, sketch->max, index);
+    }
+
+    // Between the minimum and the first centroid's center
+    double first_weight = (double)centroids[0].weight;
+    if (index < 1.0) {
+        return sketch->min;
+    }
+    if (first_weight > 1.0 && index < first_weight / 2.0) {
+        return sketch->min + (index - 1.0) / (first_weight / 2.0 - 1.0) * (centroids[0].mean - sketch->min);
+    }
+
+    // Between the last centroid's center and the maximum
+    double last_weight = (double)centroids[n - 1].weight;
+    if (index > total - 1.0) {
+        return sketch->max;
+    }
+    if (last_weight > 1.0 && total - index <= last_weight / 2.0) {
+        return sketch->max - (total - index - 1.0) / (last_weight / 2.0 - 1.0) *
+               (sketch->max - centroids[n - 1].mean);
+    }
+
+    double weight_so_far = first_weight / 2.0;
+    for (uint32_t i = 0; i + 1 < n; i++) {
+        double left = (double)centroids[i].weight;
+        double right = (double)centroids[i + 1].weight;
+        double gap = (left + right) / 2.0;
+        if (weight_so_far + gap > index) {
+            double left_unit = 0.0;
+            if (centroids[i].weight == 1) {
+                if (index - weight_so_far < 0.5) {
+                    return centroids[i].mean;
+                }
+                left_unit = 0.5;
+            }
+            double right_unit = 0.0;
+            if (centroids[i + 1].weight == 1) {
+                if (weight_so_far + gap - index <= 0.5) {
+                    return centroids[i + 1].mean;
+                }
+                right_unit = 0.5;
+            }
+            double z1 = index - weight_so_far - left_unit;
+            double z2 = weight_so_far + gap - index - right_unit;
+            return weighted_average(centroids[i].mean, z2, centroids[i + 1].mean, z1);
+        }
+        weight_so_far += gap;
+    }
+
+    // Past the last centroid's center
+    double z1 = index - total + last_weight / 2.0;
+    double z2 = last_weight / 2.0 - z1;
+    return weighted_average(centroids[n - 1].mean, z2, sketch->max, z1);
+}
@@ -24,7 +24,7 @@
 #endif
 
 // Static error message buffer
-static char s_error_message[1024] = {0};
+static thread_local char s_error_message[1024] = {0};
 
 // Set the error message
 static void set_error(const char* format, ...) {
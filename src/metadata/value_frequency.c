@@ -0,0 +1,357 @@
+/**
+ * value_frequency.c
+ *
+ * This file implements the mode computation declared in value_frequency.h.
+ * Values are turned into 64-bit keys a block at a time and counted in an
+ * open-addressing table with linear probing. The exact pass stops as soon as
+ * the table holds more distinct values than the limit, and the column is
+ * counted again by the Misra-Gries sketch, which keeps at most k counters and
+ * decrements them all whenever a new value finds no free counter.
+ */
+
+#include "metadata/value_frequency.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Values converted to keys per block */
+#define KEY_BLOCK_SIZE 4096
+
+/* Smallest table allocated by the exact pass */
+#define MIN_TABLE_CAPACITY 1024
+
+/**
+ * Hash table of value keys and their counts
+ */
+typedef struct {
+    uint64_t* keys;
+    uint64_t* counts;      /* 0 marks an empty slot */
+    uint64_t mask;         /* Capacity - 1; the capacity is a power of two */
+    uint64_t used;         /* Occupied slots */
+} CountTable;
+
+/* Mix all key bits into the low bits used as the table index */
+static uint64_t hash_key(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+static int table_init(CountTable* table, uint64_t capacity) {
+    table->keys = (uint64_t*)malloc((size_t)capacity * sizeof(uint64_t));
+    table->counts = (uint64_t*)calloc((size_t)capacity, sizeof(uint64_t));
+    table->mask = capacity - 1;
+    table->used = 0;
+    if (!table->keys || !table->counts) {
+        free(table->keys);
+        free(table->counts);
+        table->keys = NULL;
+        table->counts = NULL;
+        return 2;
+    }
+    return 0;
+}
+
+static void table_free(CountTable* table) {
+    free(table->keys);
+    free(table->counts);
+    table->keys = NULL;
+    table->counts = NULL;
+}
+
+/* Slot holding the key, or the empty slot where it belongs */
+static uint64_t table_slot(const CountTable* table, uint64_t key) {
+    uint64_t slot = hash_key(key) & table->mask;
+    while (table->counts[slot] != 0 && table->keys[slot] != key) {
+        slot = (slot + 1) & table->mask;
+    }
+    return slot;
+}
+
+/* Double the capacity of a table */
+static int table_grow(CountTable* table) {
+    CountTable grown;
+    if (table_init(&grown, (table->mask + 1) * 2) != 0) {
+        return 2;
+    }
+    for (uint64_t i = 0; i <= table->mask; i++) {
+        if (table->counts[i] != 0) {
+            uint64_t slot = table_slot(&grown, table->keys[i]);
+            grown.keys[slot] = table->keys[i];
+            grown.counts[slot] = table->counts[i];
+        }
+    }
+    grown.used = table->used;
+    table_free(table);
+    *table = grown;
+    return 0;
+}
+
+/* Key of a value; integers sign-extend, floating-point values use the bits of the double */
+static uint64_t double_key(double value) {
+    uint64_t key;
+    value = value == 0.0 ? 0.0 : value;  // -0.0 == 0.0
+    memcpy(&key, &value, sizeof(key));
+    return key;
+}
+
+static double key_value(uint64_t key, ParquetValueType type) {
+    if (type == PARQUET_FLOAT || type == PARQUET_DOUBLE) {
+        double value;
+        memcpy(&value, &key, sizeof(value));
+        return value;
+    }
+    return (double)(int64_t)key;
+}
+
+static bool key_less(uint64_t a, uint64_t b, ParquetValueType type) {
+    if (type == PARQUET_FLOAT || type == PARQUET_DOUBLE) {
+        return key_value(a, type) < key_value(b, type);
+    }
+    return (int64_t)a < (int64_t)b;
+}
+
+/**
+ * Convert a block of values into keys
+ *
+ * returns: Number of keys written; NaN values produce none
+ */
+static uint32_t load_keys(const void* values, uint64_t first, uint32_t count,
+                          ParquetValueType type, uint64_t* keys) {
+    uint32_t written = 0;
+    switch (type) {
+        case PARQUET_INT32: {
+            const int32_t* data = (const int32_t*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                keys[i] = (uint64_t)(int64_t)data[i];
+            }
+            return count;
+        }
+        case PARQUET_INT64: {
+            const int64_t* data = (const int64_t*)values + first;
+            memcpy(keys, data, (size_t)count * sizeof(uint64_t));
+            return count;
+        }
+        case PARQUET_FLOAT: {
+            const float* data = (const float*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!isnan(data[i])) {
+                    keys[written++] = double_key((double)data[i]);
+                }
+            }
+            return written;
+        }
+        case PARQUET_DOUBLE: {
+            const double* data = (const double*)values + first;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!isnan(data[i])) {
+                    keys[written++] = double_key(data[i]);
+                }
+            }
+            return written;
+        }
+        default:
+            return 0;
+    }
+}
+
+/* The entry with the highest count; ties go to the smaller value */
+static void table_mode(const CountTable* table, ParquetValueType type, ValueMode* mode) {
+    uint64_t best_key = 0;
+    uint64_t best_count = 0;
+    for (uint64_t i = 0; i <= table->mask; i++) {
+        uint64_t count = table->counts[i];
+        if (count > best_count || (count == best_count && count > 0 && key_less(table->keys[i], best_key, type))) {
+            best_key = table->keys[i];
+            best_count = count;
+        }
+    }
+    mode->value = best_count > 0 ? key_value(best_key, type) : 0.0;
+    mode->count = best_count;
+}
+
+/**
+ * Count every value exactly
+ *
+ * returns: 0 on success, 1 if the column has more distinct values than the limit, 2 if out of memory
+ */
+static int exact_mode(const void* values, uint64_t value_count, ParquetValueType type,
+                      uint64_t exact_limit, uint64_t* keys, ValueMode* mode) {
+    CountTable table;
+    if (table_init(&table, MIN_TABLE_CAPACITY) != 0) {
+        return 2;
+    }
+
+    uint64_t counted = 0;
+    for (uint64_t first = 0; first < value_count; first += KEY_BLOCK_SIZE) {
+        uint32_t block = (uint32_t)(value_count - first < KEY_BLOCK_SIZE ? value_count - first : KEY_BLOCK_SIZE);
+        uint32_t key_count = load_keys(values, first, block, type, keys);
+        counted += key_count;
+        for (uint32_t i = 0; i < key_count; i++) {
+            uint64_t slot = table_slot(&table, keys[i]);
+            if (table.counts[slot]++ != 0) {
+                continue;
+            }
+            table.keys[slot] = keys[i];
+
+            // Keep the load factor at most 1/2 so probe sequences stay short
+            if (++table.used > exact_limit && exact_limit > 0) {
+                table_free(&table);
+                return 1;
+            }
+            if (table.used * 2 > table.mask + 1 && table_grow(&table) != 0) {
+                table_free(&table);
+                return 2;
+            }
+        }
+    }
+
+    table_mode(&table, type, mode);
+    mode->max_error = 0;
+    mode->counted = counted;
+    mode->approximate = false;
+    table_free(&table);
+    return 0;
+}
+
+/**
+ * Count the values with a Misra-Gries sketch of k counters
+ *
+ * Each decrement round removes k + 1 occurrences (one per counter and the
+ * value that found no counter) and takes O(k), so updates cost O(1)
+ * amortized. A value's count falls short by at most the number of rounds.
+ *
+ * returns: 0 on success, 2 if out of memory
+ */
+static int sketch_mode(const void* values, uint64_t value_count, ParquetValueType type,
+                       uint32_t counters, uint64_t* keys, ValueMode* mode) {
+    uint64_t capacity = MIN_TABLE_CAPACITY;
+    while (capacity < (uint64_t)counters * 2) {
+        capacity *= 2;
+    }
+
+    CountTable table;
+    if (table_init(&table, capacity) != 0) {
+        return 2;
+    }
+    uint64_t* survivor_keys = (uint64_t*)malloc((size_t)counters * sizeof(uint64_t));
+    uint64_t* survivor_counts = (uint64_t*)malloc((size_t)counters * sizeof(uint64_t));
+    if (!survivor_keys || !survivor_counts) {
+        free(survivor_keys);
+        free(survivor_counts);
+        table_free(&table);
+        return 2;
+    }
+
+    uint64_t counted = 0;
+    uint64_t rounds = 0;
+    for (uint64_t first = 0; first < value_count; first += KEY_BLOCK_SIZE) {
+        uint32_t block = (uint32_t)(value_count - first < KEY_BLOCK_SIZE ? value_count - first : KEY_BLOCK_SIZE);
+        uint32_t key_count = load_keys(values, first, block, type, keys);
+        counted += key_count;
+        for (uint32_t i = 0; i < key_count; i++) {
+            uint64_t slot = table_slot(&table, keys[i]);
+            if (table.counts[slot] != 0) {
+                table.counts[slot]++;
+                continue;
+            }
+            if (table.used < counters) {
+                table.keys[slot] = keys[i];
+                table.counts[slot] = 1;
+                table.used++;
+                continue;
+            }
+
+            // Decrement every counter and rebuild the table without the ones reaching zero
+            uint32_t survivors = 0;
+            for (uint64_t j = 0; j <= table.mask; j++) {
+                if (table.counts[j] > 1) {
+                    survivor_keys[survivors] = table.keys[j];
+                    survivor_counts[survivors++] = table.counts[j] - 1;
+                }
+            }
+            memset(table.counts, 0, (size_t)(table.mask + 1) * sizeof(uint64_t));
+            for (uint32_t j = 0; j < survivors; j++) {
+                uint64_t survivor_slot = table_slot(&table, survivor_keys[j]);
+                table.keys[survivor_slot] = survivor_keys[j];
+                table.counts[survivor_slot] = survivor_counts[j];
+            }
+            table.used = survivors;
+            rounds++;
+        }
+    }
+
+    table_mode(&table, type, mode);
+    mode->max_error = rounds;
+    mode->counted = counted;
+    mode->approximate = true;
+
+    free(survivor_keys);
+    free(survivor_counts);
+    table_free(&table);
+    return 0;
+}
+
+/**
+ * Initialize mode options with default values
+ */
+void value_mode_init_options(ValueModeOptions* options) {
+    if (!options) {
+        return;
+    }
+    options->exact_limit = VALUE_MODE_EXACT_LIMIT;
+    options->sketch_counters = VALUE_MODE_SKETCH_COUNTERS;
+}
+
+/**
+ * Compute the mode of a column of fixed-width values
+ */
+int value_mode_compute(const void* values, uint64_t value_count, ParquetValueType type,
+                       const ValueModeOptions* options, ValueMode* mode) {
+    if (!mode || (!values && value_count > 0)) {
+        return 1;
+    }
+    memset(mode, 0, sizeof(ValueMode));
+
+    ValueModeOptions defaults;
+    if (!options) {
+        value_mode_init_options(&defaults);
+        options = &defaults;
+    }
+
+    // Booleans have two values, so two counters are exact
+    if (type == PARQUET_BOOLEAN) {
+        const uint8_t* data = (const uint8_t*)values;
+        uint64_t true_count = 0;
+        for (uint64_t i = 0; i < value_count; i++) {
+            true_count += data[i] != 0;
+        }
+        mode->value = true_count > value_count - true_count ? 1.0 : 0.0;
+        mode->count = true_count > value_count - true_count ? true_count : value_count - true_count;
+        mode->counted = value_count;
+        return 0;
+    }
+    if (type != PARQUET_INT32 && type != PARQUET_INT64 && type != PARQUET_FLOAT && type != PARQUET_DOUBLE) {
+        return 1;
+    }
+    if (value_count == 0) {
+        return 0;
+    }
+
+    uint64_t* keys = (uint64_t*)malloc(KEY_BLOCK_SIZE * sizeof(uint64_t));
+    if (!keys) {
+        return 2;
+    }
+
+    int result = exact_mode(values, value_count, type, options->exact_limit, keys, mode);
+    if (result == 1) {
+        uint32_t counters = options->sketch_counters > 0 ? options->sketch_counters : VALUE_MODE_SKETCH_COUNTERS;
+        result = sketch_mode(values, value_count, type, counters, keys, mode);
+    }
+
+    free(keys);
+    return result;
+}